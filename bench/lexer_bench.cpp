@@ -0,0 +1,120 @@
+#include "lexer/Lexer.h"
+#include "lexer/TokenStream.h"
+#include "lexer/scan.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief Lexer throughput for each scanner instruction set the cpu supports.
+ *
+ * Usage: sushi_lexer_bench [megabytes] [iterations]
+ *
+ * The input is generated sushi source with the usual mix of indentation, comments,
+ * long identifiers and string literals. 'scalar' is the byte at a time path.
+ * 'stream' pulls the tokens one by one through a TokenStream, like the parser does.
+ */
+static std::string
+generate_source(std::size_t bytes)
+{
+	std::string source;
+	source.reserve(bytes + 1024);
+
+	for( unsigned int i = 0; source.size() < bytes; i++ )
+	{
+		auto n = std::to_string(i);
+		source += "// Computes the running total for item " + n + ", see the design notes.\n";
+		source += "fn accumulate_values_" + n + "(first_operand: i32, second_operand: i32*): i32 {\n";
+		source += "    let running_total: i32 = first_operand * 3 + 17;\n";
+		source += "    if (running_total > 100) {\n";
+		source += "        printf(\"total is %d for \\\"item\\\" " + n + "\\n\", running_total);\n";
+		source += "    }\n";
+		source += "\n";
+		source += "    return running_total; // done\n";
+		source += "}\n\n";
+	}
+
+	return source;
+}
+
+static bool
+same_tokens(LexResult const& l, LexResult const& r)
+{
+	return l.kinds == r.kinds && l.offsets == r.offsets && l.lengths == r.lengths &&
+		   l.line_nums == r.line_nums && l.markers.lines == r.markers.lines;
+}
+
+int
+main(int argc, char* argv[])
+{
+	std::size_t megabytes = argc > 1 ? std::atoi(argv[1]) : 64;
+	int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+
+	auto source = generate_source(megabytes * 1024 * 1024);
+	double size_mb = source.size() / (1024.0 * 1024.0);
+
+	auto default_isa = scan_isa();
+	scan_set_isa(ScanIsa::scalar);
+	auto reference = Lexer{source.c_str()}.lex();
+
+	for( auto isa : {ScanIsa::scalar, ScanIsa::sse2, ScanIsa::avx2, ScanIsa::neon} )
+	{
+		if( !scan_set_isa(isa) )
+			continue;
+
+		double best = 0;
+		bool matches = true;
+		for( int i = 0; i < iterations; i++ )
+		{
+			auto start = std::chrono::steady_clock::now();
+			auto result = Lexer{source.c_str()}.lex();
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			double mb_per_s = size_mb / elapsed.count();
+			if( mb_per_s > best )
+				best = mb_per_s;
+
+			matches = matches && same_tokens(result, reference);
+		}
+
+		std::cout << scan_isa_name(isa) << ": " << (int)best << " MB/s (" << reference.size()
+				  << " tokens, " << (int)size_mb << " MB)" << (matches ? "" : " MISMATCH") << std::endl;
+		if( !matches )
+			return 1;
+	}
+
+	scan_set_isa(default_isa);
+
+	double best = 0;
+	bool matches = true;
+	unsigned int capacity = 0;
+	for( int i = 0; i < iterations; i++ )
+	{
+		auto start = std::chrono::steady_clock::now();
+		TokenStream stream{source.c_str()};
+		unsigned int index = 0;
+		for( ; stream.fill(index); index++ )
+		{
+			matches = matches && index < reference.size() &&
+					  stream.type(index) == reference.type(index);
+			stream.release(index + 1);
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		double mb_per_s = size_mb / elapsed.count();
+		if( mb_per_s > best )
+			best = mb_per_s;
+
+		matches = matches && index == reference.size();
+		capacity = stream.capacity();
+	}
+
+	std::cout << "stream: " << (int)best << " MB/s (" << capacity << " tokens kept)"
+			  << (matches ? "" : " MISMATCH") << std::endl;
+	if( !matches )
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,43 @@
+#!/bin/sh
+# Run time of a program built with -O2, and with -O2 -fprofile-use from a training run.
+#
+# Usage: bench/pgo_bench.sh [file.sushi] [runs]
+#
+# Run from the repository root after building sushi into build/. Needs clang++ and
+# llvm-profdata. The default input is the switch dispatch workload of the PGO test.
+# Prints the median wall time of each build over 'runs' runs, default 9.
+
+set -e
+
+root=$(pwd)
+sushi="$root/build/sushi"
+harness="$root/test/clang_harness/clang_harness.cpp"
+input=$(realpath "${1:-test/suites/pgo/dispatch.pgo.sushi}")
+runs=${2:-9}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+cd "$work"
+
+median_ms() {
+	for i in $(seq "$runs"); do
+		start=$(date +%s%N)
+		./"$1" > /dev/null
+		end=$(date +%s%N)
+		echo $(((end - start) / 1000000))
+	done | sort -n | sed -n "$(((runs + 1) / 2))p"
+}
+
+"$sushi" -O2 -fprofile-generate=train.profraw "$input" > /dev/null
+clang++ -fprofile-generate "$harness" output.o -o train
+./train > /dev/null
+llvm-profdata merge -o train.profdata train.profraw
+
+"$sushi" -O2 "$input" > /dev/null
+clang++ "$harness" output.o -o baseline
+
+"$sushi" -O2 -fprofile-use=train.profdata "$input" > /dev/null
+clang++ "$harness" output.o -o optimized
+
+echo "-O2: $(median_ms baseline) ms"
+echo "-O2 -fprofile-use: $(median_ms optimized) ms"
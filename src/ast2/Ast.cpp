@@ -9,19 +9,60 @@ using namespace ast;
 String*
 Ast::create_string(char const* cstr, unsigned int size)
 {
-	return new String{cstr, size};
+	return owned.own(new String{cstr, size});
 }
 
 AstList<String*>*
 Ast::create_name_parts()
 {
-	return new AstList<String*>{};
+	return owned.own(new AstList<String*>{});
+}
+
+/**
+ * @brief Interns the name parts joined with '#'.
+ */
+Symbol
+Ast::create_symbol(AstList<String*>* name_parts)
+{
+	Symbol symbol{};
+	bool first = true;
+	for( auto part : name_parts )
+	{
+		auto part_symbol = Symbol::intern(*part);
+		symbol = first ? part_symbol : Symbol::qualified(symbol, part_symbol);
+
+		first = false;
+	}
+
+	return symbol;
 }
 
 AstList<AstNode*>*
 Ast::create_list()
 {
-	return new AstList<AstNode*>{};
+	return owned.own(new AstList<AstNode*>{});
+}
+
+AttributeSet*
+Ast::create_attributes()
+{
+	return owned.own(new AttributeSet{AttributeSet::None()});
+}
+
+void
+Ast::set_type_args(AstNode* node, AstList<AstNode*>* type_args)
+{
+	type_args_.insert_or_assign(node, type_args);
+}
+
+AstList<AstNode*>*
+Ast::type_args(AstNode const* node) const
+{
+	auto iter = type_args_.find(node);
+	if( iter != type_args_.end() )
+		return iter->second;
+	else
+		return nullptr;
 }
 
 AstNode*
@@ -60,7 +101,31 @@ AstNode*
 Ast::FnProto(Span span, AstNode* name, AstNode* params, AstNode* return_type)
 {
 	auto node = make_empty<AstFnProto>(span);
-	node->data.fn_proto = AstFnProto{name, params, return_type};
+	node->data.fn_proto = owned.own(new AstFnProto{name, params, return_type, nullptr});
+	return node;
+}
+
+AstNode*
+Ast::FnProto(
+	Span span, AstNode* name, AstNode* params, AstNode* return_type, AttributeSet* attributes)
+{
+	auto node = make_empty<AstFnProto>(span);
+	node->data.fn_proto = owned.own(new AstFnProto{name, params, return_type, attributes});
+	return node;
+}
+
+AstNode*
+Ast::FnProto(
+	Span span,
+	AstNode* name,
+	AstNode* params,
+	AstNode* return_type,
+	AttributeSet* attributes,
+	AstList<AstNode*>* type_params)
+{
+	auto node = make_empty<AstFnProto>(span);
+	node->data.fn_proto =
+		owned.own(new AstFnProto{name, params, return_type, attributes, type_params});
 	return node;
 }
 
@@ -76,7 +141,15 @@ AstNode*
 Ast::ValueDecl(Span span, AstNode* name, AstNode* type_name)
 {
 	auto node = make_empty<AstValueDecl>(span);
-	node->data.value_decl = AstValueDecl{name, type_name};
+	node->data.value_decl = AstValueDecl{name, type_name, nullptr};
+	return node;
+}
+
+AstNode*
+Ast::ValueDecl(Span span, AstNode* name, AstNode* type_name, AttributeSet* attributes)
+{
+	auto node = make_empty<AstValueDecl>(span);
+	node->data.value_decl = AstValueDecl{name, type_name, attributes};
 	return node;
 }
 
@@ -124,7 +197,7 @@ AstNode*
 Ast::Id(Span span, AstList<String*>* name)
 {
 	auto node = make_empty<AstId>(span);
-	node->data.id = AstId{IdClassification::ValueIdentifier, name};
+	node->data.id = AstId{IdClassification::ValueIdentifier, name, create_symbol(name)};
 	return node;
 }
 
@@ -200,6 +273,15 @@ Ast::Struct(Span span, AstNode* type_name, AstList<AstNode*>* members)
 	return node;
 }
 
+AstNode*
+Ast::Struct(
+	Span span, AstNode* type_name, AstList<AstNode*>* members, AstList<AstNode*>* type_params)
+{
+	auto node = make_empty<AstStruct>(span);
+	node->data.structstmt = AstStruct{type_name, members, type_params};
+	return node;
+}
+
 AstNode*
 Ast::Union(Span span, AstNode* type_name, AstList<AstNode*>* members)
 {
@@ -220,7 +302,7 @@ AstNode*
 Ast::EnumMemberEmpty(Span span, String* name)
 {
 	auto node = make_empty<AstEnumMember>(span);
-	node->data.enum_member = AstEnumMember{name};
+	node->data.enum_member = owned.own(new AstEnumMember{name});
 	return node;
 }
 
@@ -228,7 +310,7 @@ AstNode*
 Ast::EnumMemberStruct(Span span, AstNode* member)
 {
 	auto node = make_empty<AstEnumMember>(span);
-	node->data.enum_member = AstEnumMember{member};
+	node->data.enum_member = owned.own(new AstEnumMember{member});
 	return node;
 }
 
@@ -252,7 +334,7 @@ AstNode*
 Ast::For(Span span, AstNode* init, AstNode* condition, AstNode* end_loop, AstNode* body)
 {
 	auto node = make_empty<AstFor>(span);
-	node->data.forstmt = AstFor{init, condition, end_loop, body};
+	node->data.forstmt = owned.own(new AstFor{init, condition, end_loop, body});
 	return node;
 }
 
@@ -276,7 +358,7 @@ AstNode*
 Ast::TypeDeclarator(Span span, AstList<String*>* name, unsigned int indirection_level)
 {
 	auto node = make_empty<AstTypeDeclarator>(span);
-	node->data.type_declarator = AstTypeDeclarator{name, indirection_level};
+	node->data.type_declarator = AstTypeDeclarator{name, create_symbol(name), indirection_level};
 	node->data.type_declarator.empty = false;
 	return node;
 }
@@ -286,7 +368,8 @@ Ast::TypeDeclaratorArray(
 	Span span, AstList<String*>* name, unsigned int indirection_level, unsigned int array_size)
 {
 	auto node = make_empty<AstTypeDeclarator>(span);
-	node->data.type_declarator = AstTypeDeclarator{name, indirection_level, array_size};
+	node->data.type_declarator =
+		AstTypeDeclarator{name, create_symbol(name), indirection_level, array_size};
 	node->data.type_declarator.empty = false;
 	return node;
 }
@@ -324,6 +407,14 @@ Ast::Deref(Span span, AstNode* expr)
 	return node;
 }
 
+AstNode*
+Ast::Await(Span span, AstList<AstNode*>* futures)
+{
+	auto node = make_empty<AstAwait>(span);
+	node->data.await_expr = AstAwait{futures};
+	return node;
+}
+
 AstNode*
 Ast::AddressOf(Span span, AstNode* expr)
 {
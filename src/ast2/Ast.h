@@ -1,21 +1,38 @@
 #pragma once
 #include "AstNode.h"
 #include "AstTags.h"
+#include "CommentTable.h"
 #include "Span.h"
+#include "common/Owned.h"
 #include "common/String.h"
 #include "common/Vec.h"
 
+#include <unordered_map>
+
 namespace ast
 {
 
-// TODO: AST owns all ast nodes.
-// Track all memory allocs
+/**
+ * @brief Owns the nodes it creates and everything they point to, which live as long as
+ * the Ast.
+ */
 class Ast
 {
+	Owned owned;
 	AstTags tags;
+	unsigned int next_node_id = 0;
+
+	// Type arguments of ids and type declarators, e.g. Box<i32>.
+	// Few nodes have them so they are kept out of AstNode. Keyed by node rather than
+	// node id because ids are only unique within one Ast.
+	std::unordered_map<AstNode const*, AstList<AstNode*>*> type_args_;
 
 public:
+	CommentTable comments;
+
 	Ast(){};
+	Ast(Ast&&) = default;
+	Ast& operator=(Ast&&) = default;
 
 	template<
 		typename T,
@@ -29,15 +46,41 @@ private:
 public:
 	String* create_string(char const* cstr, unsigned int size);
 	AstList<String*>* create_name_parts();
+	Symbol create_symbol(AstList<String*>* name_parts);
 	AstList<AstNode*>* create_list();
+	AttributeSet* create_attributes();
+
+	void set_type_args(AstNode* node, AstList<AstNode*>* type_args);
+	/**
+	 * @brief Type arguments of an Id or TypeDeclarator, or null.
+	 */
+	AstList<AstNode*>* type_args(AstNode const* node) const;
+	std::unordered_map<AstNode const*, AstList<AstNode*>*> const& all_type_args() const
+	{
+		return type_args_;
+	}
 
 	AstNode* Module(Span span, AstList<AstNode*>* params);
 	AstNode* Namespace(Span span, AstNode* name, AstList<AstNode*>* params);
 	AstNode* ExternFn(Span span, AstNode* prototype);
 	AstNode* Fn(Span span, AstNode* prototype, AstNode* body);
 	AstNode* FnProto(Span span, AstNode* name, AstNode* params, AstNode* return_type);
+	AstNode* FnProto(
+		Span span,
+		AstNode* name,
+		AstNode* params,
+		AstNode* return_type,
+		AttributeSet* attributes);
+	AstNode* FnProto(
+		Span span,
+		AstNode* name,
+		AstNode* params,
+		AstNode* return_type,
+		AttributeSet* attributes,
+		AstList<AstNode*>* type_params);
 	AstNode* FnParamList(Span span, AstList<AstNode*>* params);
 	AstNode* ValueDecl(Span span, AstNode* name, AstNode* type_name);
+	AstNode* ValueDecl(Span span, AstNode* name, AstNode* type_name, AttributeSet* attributes);
 	AstNode* FnCall(Span span, AstNode* call_target, AstNode* args);
 	AstNode* ArrayAccess(Span span, AstNode* array_target, AstNode* expr);
 	AstNode* ExprList(Span span, AstList<AstNode*>* args);
@@ -53,6 +96,11 @@ public:
 	AstNode* Let(Span span, AstNode* identifier, AstNode* type_declarator, AstNode* rhs);
 	AstNode* Return(Span span, AstNode* expr);
 	AstNode* Struct(Span span, AstNode* type_name, AstList<AstNode*>* members);
+	AstNode* Struct(
+		Span span,
+		AstNode* type_name,
+		AstList<AstNode*>* members,
+		AstList<AstNode*>* type_params);
 	AstNode* Union(Span span, AstNode* type_name, AstList<AstNode*>* members);
 	AstNode* Enum(Span span, AstNode* type_name, AstList<AstNode*>* members);
 	AstNode* EnumMemberEmpty(Span span, String* name);
@@ -68,6 +116,7 @@ public:
 	AstNode* MemberAccess(Span span, AstNode* expr, AstNode* member_name);
 	AstNode* IndirectMemberAccess(Span span, AstNode* expr, AstNode* member_name);
 	AstNode* Deref(Span span, AstNode* expr);
+	AstNode* Await(Span span, AstList<AstNode*>* futures);
 	AstNode* AddressOf(Span span, AstNode* expr);
 	AstNode* Expr(Span span, AstNode* expr);
 	AstNode* Stmt(Span span, AstNode* expr);
@@ -92,10 +141,13 @@ template<typename T>
 AstNode*
 Ast::make_empty(Span span)
 {
-	auto node = new AstNode;
+	auto node = owned.own(new AstNode);
 	node->type = T::nt;
+	node->id = next_node_id++;
 	node->span = span;
 
+	comments.claim(span, node->id);
+
 	return node;
 }
 
@@ -56,7 +56,7 @@ ast::as_fn_proto(ast::AstNode* node)
 	if( node->type != AstFnProto::nt )
 		return Cast<AstFnProto>();
 
-	return &node->data.fn_proto;
+	return node->data.fn_proto;
 }
 
 Cast<AstFnParamList>
@@ -220,6 +220,15 @@ ast::as_deref(ast::AstNode* node)
 	return &node->data.deref;
 }
 
+Cast<AstAwait>
+ast::as_await(ast::AstNode* node)
+{
+	if( node->type != AstAwait::nt )
+		return Cast<AstAwait>();
+
+	return &node->data.await_expr;
+}
+
 Cast<AstMemberAccess>
 ast::as_member_access(ast::AstNode* node)
 {
@@ -253,7 +262,7 @@ ast::as_for(ast::AstNode* node)
 	if( node->type != AstFor::nt )
 		return Cast<AstFor>();
 
-	return &node->data.forstmt;
+	return node->data.forstmt;
 }
 
 Cast<AstWhile>
@@ -298,7 +307,7 @@ ast::as_enum_member(ast::AstNode* node)
 	if( node->type != AstEnumMember::nt )
 		return Cast<AstEnumMember>();
 
-	return &node->data.enum_member;
+	return node->data.enum_member;
 }
 
 Cast<AstIfArrow>
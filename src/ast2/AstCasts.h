@@ -42,6 +42,7 @@ Cast<AstExpr> as_expr(ast::AstNode* node);
 Cast<AstStruct> as_struct(ast::AstNode* node);
 Cast<AstAddressOf> as_address_of(ast::AstNode* node);
 Cast<AstDeref> as_deref(ast::AstNode* node);
+Cast<AstAwait> as_await(ast::AstNode* node);
 Cast<AstMemberAccess> as_member_access(ast::AstNode* node);
 Cast<AstIndirectMemberAccess> as_indirect_member_access(ast::AstNode* node);
 Cast<AstEmpty> as_empty(ast::AstNode* node);
@@ -1,13 +1,16 @@
 #include "AstGen.h"
 
 #include "Ast.h"
+#include "ast/parse_attributes.h"
 #include "ast/parse_common.h"
 #include "ast/parse_enum.h"
+#include "ast/parse_generics.h"
 #include "ast/parse_if_arrow.h"
 #include "ast/parse_namespace.h"
 #include "ast/parse_struct.h"
 #include "bin_op.h"
 
+#include <charconv>
 #include <string>
 
 using namespace ast;
@@ -25,7 +28,7 @@ parse_name_parts(AstGen& astgen)
 	auto name = astgen.ast.create_string(tok_val.start, tok_val.size);
 	name_parts->append(name);
 
-	while( astgen.cursor.peek().type == TokenType::colon_colon )
+	while( astgen.cursor.peek_type() == TokenType::colon_colon )
 	{
 		tok = astgen.cursor.consume(TokenType::colon_colon);
 
@@ -54,9 +57,7 @@ parse_if_block(AstGen& astgen)
 AstGen::AstGen(Ast& ast, TokenCursor& cursor)
 	: ast(ast)
 	, cursor(cursor)
-{
-	init_bin_op_lookup();
-}
+{}
 
 ParseResult<ast::AstNode*>
 AstGen::parse()
@@ -65,7 +66,7 @@ AstGen::parse()
 
 	auto nodes = ast.create_list();
 
-	while( cursor.has_tokens() && cursor.peek().type != TokenType::eof )
+	while( cursor.has_tokens() && cursor.peek_type() != TokenType::eof )
 	{
 		auto item = parse_module_top_level_item();
 		if( !item.ok() )
@@ -73,6 +74,7 @@ AstGen::parse()
 			return item;
 		}
 		nodes->append(item.unwrap());
+		ast.comments.drop_pending();
 	}
 
 	return ast.Module(trail.mark(), nodes);
@@ -87,6 +89,7 @@ AstGen::parse_module_top_level_item()
 	// Fall through
 	case TokenType::extern_keyword:
 		return parse_extern_function();
+	case TokenType::async_keyword:
 	case TokenType::fn:
 		return parse_function();
 	case TokenType::struct_keyword:
@@ -125,7 +128,7 @@ AstGen::parse_let()
 
 	// TODO: This leaks
 	auto type_decl = ast.TypeDeclaratorEmpty();
-	if( tok.unwrap().type == TokenType::colon )
+	if( tok.token_type() == TokenType::colon )
 	{
 		auto type_decl_result = parse_type_decl(true);
 		if( !type_decl_result.ok() )
@@ -137,7 +140,7 @@ AstGen::parse_let()
 	}
 
 	auto equal_present =
-		tok.unwrap().type == TokenType::equal || cursor.consume_if_expected(TokenType::equal).ok();
+		tok.token_type() == TokenType::equal || cursor.consume_if_expected(TokenType::equal).ok();
 	if( !equal_present )
 	{
 		return ast.Let(trail.mark(), identifier.unwrap(), type_decl, ast.Empty(trail.mark()));
@@ -275,6 +278,15 @@ AstGen::parse_type_decl(bool allow_empty)
 		return ParseError(*name_parsed.unwrap_error().get());
 	auto name = name_parsed.unwrap();
 
+	AstList<AstNode*>* type_args = nullptr;
+	if( cursor.peek_type() == TokenType::lt )
+	{
+		auto type_argsr = parse_type_args(*this);
+		if( !type_argsr.ok() )
+			return ParseError(*type_argsr.unwrap_error());
+		type_args = type_argsr.unwrap();
+	}
+
 	int indirection_count = 0;
 	auto star_tok = cursor.consume_if_expected(TokenType::star);
 	while( star_tok.ok() )
@@ -286,7 +298,12 @@ AstGen::parse_type_decl(bool allow_empty)
 	// TODO: Clean this up.
 	auto array_tok = cursor.consume_if_expected(TokenType::open_square);
 	if( !array_tok.ok() )
-		return ast.TypeDeclarator(trail.mark(), name, indirection_count);
+	{
+		auto type_decl = ast.TypeDeclarator(trail.mark(), name, indirection_count);
+		if( type_args )
+			ast.set_type_args(type_decl, type_args);
+		return type_decl;
+	}
 
 	auto literal_parse = parse_literal();
 	if( !literal_parse.ok() )
@@ -299,8 +316,11 @@ AstGen::parse_type_decl(bool allow_empty)
 	if( !end_tok.ok() )
 		return ParseError("Expected ']'.", end_tok.as());
 
-	return ast.TypeDeclaratorArray(
+	auto type_decl = ast.TypeDeclaratorArray(
 		trail.mark(), name, indirection_count, literal->data.number_literal.literal);
+	if( type_args )
+		ast.set_type_args(type_decl, type_args);
+	return type_decl;
 }
 
 ParseResult<ast::AstNode*>
@@ -330,7 +350,7 @@ AstGen::parse_bin_op(int expr_precidence, ast::AstNode* lhs)
 		if( !tok.ok() )
 			return lhs;
 
-		auto token_type = tok.as().type;
+		auto token_type = tok.token_type();
 		auto op = get_bin_op_from_token_type(token_type);
 		int tok_precidence = get_token_precedence(op);
 
@@ -378,14 +398,8 @@ AstGen::parse_assign(ast::AstNode* lhs)
 		return ParseError("Expected '='", tok.as());
 	}
 
-	auto rhs = parse_expr();
-	if( !rhs.ok() )
-	{
-		return rhs;
-	}
-
 	AssignOp op = AssignOp::assign;
-	switch( tok.as().type )
+	switch( tok.token_type() )
 	{
 	case TokenType::equal:
 		op = AssignOp::assign;
@@ -408,6 +422,12 @@ AstGen::parse_assign(ast::AstNode* lhs)
 		break;
 	}
 
+	auto rhs = parse_expr();
+	if( !rhs.ok() )
+	{
+		return rhs;
+	}
+
 	return ast.Assign(trail.mark(), op, lhs, rhs.unwrap());
 }
 
@@ -696,6 +716,17 @@ AstGen::parse_statement()
 		goto no_semi;
 	}
 	break;
+	case TokenType::await_keyword:
+	{
+		auto expr = parse_await(true);
+		if( !expr.ok() )
+		{
+			return expr;
+		}
+
+		stmt = ast.Expr(trail.mark(), expr.unwrap());
+	}
+	break;
 
 	default:
 	{
@@ -861,8 +892,13 @@ AstGen::parse_literal()
 	{
 	case LiteralType::integer:
 	{
-		auto sz = ast.create_string(curr_tok.start, curr_tok.size);
-		int val = std::stoi(*sz);
+		// Not std::stoi, whose exceptions would take down the compile server.
+		int val = 0;
+		auto end = curr_tok.start + curr_tok.size;
+		auto [last, error] = std::from_chars(curr_tok.start, end, val);
+		if( error != std::errc() || last != end )
+			return ParseError("Integer literal is out of range", tok.as());
+
 		return ast.NumberLiteral(trail.mark(), val);
 	}
 	break;
@@ -987,7 +1023,7 @@ AstGen::parse_initializer(AstNode* identifier)
 			ast.InitializerDesignator(member_trail.mark(), name, initilizer_expr.unwrap()));
 
 		tok = cursor.peek();
-		if( consume_result.as().type == TokenType::close_curly )
+		if( consume_result.token_type() == TokenType::close_curly )
 			break;
 	}
 
@@ -1007,12 +1043,20 @@ AstGen::parse_value_list()
 	Token curr_tok = cursor.peek();
 	while( curr_tok.type != TokenType::close_paren )
 	{
+		auto index = cursor.get_index();
 		auto expr = parse_expr();
 		if( !expr.ok() )
 		{
 			return expr;
 		}
 
+		// An expr may be empty, e.g. at ';' or the end of the file, and would be added
+		// forever.
+		if( cursor.get_index() == index )
+		{
+			return ParseError("Expected ')'", curr_tok);
+		}
+
 		args->append(expr.unwrap());
 
 		// Also catches trailing comma.
@@ -1066,8 +1110,6 @@ AstGen::parse_indirect_member_reference(AstNode* base)
 		return identifier;
 	}
 
-	auto member_name = ast.create_string(tok.as().start, tok.as().size);
-
 	return ast.IndirectMemberAccess(trail.mark(), base, identifier.unwrap());
 }
 
@@ -1088,8 +1130,6 @@ AstGen::parse_member_reference(ast::AstNode* base)
 		return identifier;
 	}
 
-	auto member_name = ast.create_string(tok.as().start, tok.as().size);
-
 	return ast.MemberAccess(trail.mark(), base, identifier.unwrap());
 }
 
@@ -1159,6 +1199,36 @@ AstGen::parse_addressof()
 	return ast.AddressOf(trail.mark(), expr.unwrap());
 }
 
+/**
+ * @brief 'await' followed by a future. As a statement, several futures may be
+ * awaited at once, e.g. 'await a, b;'
+ */
+ParseResult<AstNode*>
+AstGen::parse_await(bool allow_list)
+{
+	auto trail = get_parse_trail();
+
+	auto tok = cursor.consume(TokenType::await_keyword);
+	if( !tok.ok() )
+	{
+		return ParseError("Expected 'await'", tok.as());
+	}
+
+	auto futures = ast.create_list();
+	do
+	{
+		auto expr = parse_postfix_expr();
+		if( !expr.ok() )
+		{
+			return expr;
+		}
+
+		futures->append(expr.unwrap());
+	} while( allow_list && cursor.consume_if_expected(TokenType::comma).ok() );
+
+	return ast.Await(trail.mark(), futures);
+}
+
 ParseResult<ast::AstNode*>
 AstGen::parse_simple_expr()
 {
@@ -1186,6 +1256,15 @@ AstGen::parse_simple_expr()
 			return expr;
 		}
 		result = expr.unwrap();
+
+		if( peek_type_args(*this) )
+		{
+			auto type_args = parse_type_args(*this);
+			if( !type_args.ok() )
+				return ParseError(*type_args.unwrap_error());
+
+			ast.set_type_args(result, type_args.unwrap());
+		}
 		break;
 	}
 
@@ -1232,6 +1311,17 @@ AstGen::parse_simple_expr()
 		result = expr.unwrap();
 		break;
 	}
+	case TokenType::await_keyword:
+	{
+		auto expr = parse_await(false);
+		if( !expr.ok() )
+		{
+			return expr;
+		}
+
+		result = expr.unwrap();
+		break;
+	}
 
 	default:
 		// Is this right?
@@ -1316,7 +1406,7 @@ AstGen::parse_expr()
 	if( !op.ok() )
 		return op;
 
-	if( cursor.peek().type == TokenType::is )
+	if( cursor.peek_type() == TokenType::is )
 	{
 		cursor.consume(TokenType::is);
 
@@ -1326,7 +1416,7 @@ AstGen::parse_expr()
 
 		op = ast.Is(trail.mark(), op.unwrap(), type_id.unwrap());
 	}
-	else if( cursor.peek().type == TokenType::open_curly )
+	else if( cursor.peek_type() == TokenType::open_curly )
 	{
 		auto initializer_block = parse_initializer(op.unwrap());
 		if( !initializer_block.ok() )
@@ -1342,6 +1432,12 @@ ParseResult<ast::AstNode*>
 AstGen::parse_non_var_arg_fn_param()
 {
 	auto param_trail = get_parse_trail();
+	auto attributes = parse_attributes(*this, AttributeTarget::Param);
+	if( !attributes.ok() )
+	{
+		return ParseError(*attributes.unwrap_error());
+	}
+
 	auto identifer = parse_identifier();
 	if( !identifer.ok() )
 	{
@@ -1360,14 +1456,15 @@ AstGen::parse_non_var_arg_fn_param()
 		return type_decl;
 	}
 
-	return ast.ValueDecl(param_trail.mark(), identifer.unwrap(), type_decl.unwrap());
+	return ast.ValueDecl(
+		param_trail.mark(), identifer.unwrap(), type_decl.unwrap(), attributes.unwrap());
 }
 
 ParseResult<ast::AstNode*>
 AstGen::parse_fn_param()
 {
 	auto param_trail = get_parse_trail();
-	if( cursor.peek().type != TokenType::var_args )
+	if( cursor.peek_type() != TokenType::var_args )
 	{
 		return parse_non_var_arg_fn_param();
 	}
@@ -1408,12 +1505,27 @@ AstGen::parse_function_proto()
 {
 	auto trail = get_parse_trail();
 
+	auto attributes = parse_attributes(*this, AttributeTarget::Fn);
+	if( !attributes.ok() )
+	{
+		return ParseError(*attributes.unwrap_error());
+	}
+
 	auto fn_identifier = parse_identifier();
 	if( !fn_identifier.ok() )
 	{
 		return fn_identifier;
 	}
 
+	AstList<AstNode*>* type_params = nullptr;
+	if( cursor.peek_type() == TokenType::lt )
+	{
+		auto type_paramsr = parse_type_params(*this);
+		if( !type_paramsr.ok() )
+			return ParseError(*type_paramsr.unwrap_error());
+		type_params = type_paramsr.unwrap();
+	}
+
 	auto tok = cursor.consume(TokenType::open_paren);
 	if( !tok.ok() )
 	{
@@ -1446,12 +1558,22 @@ AstGen::parse_function_proto()
 			return return_type_identifier;
 		}
 		return ast.FnProto(
-			trail.mark(), fn_identifier.unwrap(), params.unwrap(), return_type_identifier.unwrap());
+			trail.mark(),
+			fn_identifier.unwrap(),
+			params.unwrap(),
+			return_type_identifier.unwrap(),
+			attributes.unwrap(),
+			type_params);
 	}
 	else
 	{
 		return ast.FnProto(
-			trail.mark(), fn_identifier.unwrap(), ast.TypeDeclaratorEmpty(), params.unwrap());
+			trail.mark(),
+			fn_identifier.unwrap(),
+			params.unwrap(),
+			ast.TypeDeclaratorEmpty(),
+			attributes.unwrap(),
+			type_params);
 	}
 }
 
@@ -1478,7 +1600,7 @@ AstGen::parse_extern_function()
 		return proto;
 	}
 
-	if( proto.unwrap()->data.fn_proto.return_type == nullptr )
+	if( proto.unwrap()->data.fn_proto->return_type == nullptr )
 	{
 		return ParseError("Extern functions must specify a return type.", cursor.peek());
 	}
@@ -1496,6 +1618,8 @@ AstGen::parse_function()
 {
 	auto trail = get_parse_trail();
 
+	bool is_async = cursor.consume_if_expected(TokenType::async_keyword).ok();
+
 	auto tok = cursor.consume(TokenType::fn);
 	if( !tok.ok() )
 	{
@@ -1507,6 +1631,7 @@ AstGen::parse_function()
 	{
 		return proto;
 	}
+	proto.unwrap()->data.fn_proto->is_async = is_async;
 
 	auto definition = parse_function_body();
 	if( !definition.ok() )
@@ -1527,5 +1652,5 @@ AstGen::parse_function_body()
 ParseTrail
 AstGen::get_parse_trail()
 {
-	return ParseTrail{cursor, meta};
+	return ParseTrail{cursor, meta, ast.comments};
 }
\ No newline at end of file
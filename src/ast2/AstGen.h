@@ -51,6 +51,7 @@ public:
 
 	ParseResult<AstNode*> parse_deref();
 	ParseResult<AstNode*> parse_addressof();
+	ParseResult<AstNode*> parse_await(bool allow_list);
 	ParseResult<AstNode*> parse_simple_expr();
 	ParseResult<AstNode*> parse_postfix_expr();
 	ParseResult<AstNode*> parse_expr();
@@ -1,6 +1,9 @@
 #include "AstNode.h"
 using namespace ast;
 
+// Lock in the node size. Every token of input produces about one node.
+static_assert(sizeof(AstNode) <= 40, "AstNode grew; store large variants out of line.");
+
 String
 ast::to_string(NodeType type)
 {
@@ -70,6 +73,8 @@ ast::to_string(NodeType type)
 		return "...";
 	case NodeType::Deref:
 		return "*";
+	case NodeType::Await:
+		return "Await";
 	case NodeType::Empty:
 		return "";
 	case NodeType::Enum:
@@ -1,7 +1,9 @@
 #pragma once
+#include "Attributes.h"
 #include "Span.h"
 #include "bin_op.h"
 #include "common/String.h"
+#include "common/Symbol.h"
 #include "common/Vec.h"
 
 namespace ast
@@ -49,6 +51,7 @@ enum class NodeType
 	IndirectMemberAccess,
 	AddressOf,
 	Deref,
+	Await,
 	Empty,
 	Expr,
 	Stmt,
@@ -126,12 +129,31 @@ struct AstFnProto
 	AstNode* name;
 	AstNode* params;
 	AstNode* return_type;
+	// Null if no attributes were specified.
+	AttributeSet* attributes;
+	// Ids of the type parameters, e.g. T in fn max<T>. Null if not generic.
+	AstList<AstNode*>* type_params = nullptr;
+	// async fn. Calls return a future of the return type.
+	bool is_async = false;
 
 	AstFnProto() = default;
-	AstFnProto(AstNode* name, AstNode* params, AstNode* return_type)
+	AstFnProto(AstNode* name, AstNode* params, AstNode* return_type, AttributeSet* attributes)
 		: name(name)
 		, params(params)
 		, return_type(return_type)
+		, attributes(attributes)
+	{}
+	AstFnProto(
+		AstNode* name,
+		AstNode* params,
+		AstNode* return_type,
+		AttributeSet* attributes,
+		AstList<AstNode*>* type_params)
+		: name(name)
+		, params(params)
+		, return_type(return_type)
+		, attributes(attributes)
+		, type_params(type_params)
 	{}
 };
 
@@ -153,11 +175,14 @@ struct AstValueDecl
 
 	AstNode* name;
 	AstNode* type_name;
+	// Only parameters have attributes. Null otherwise.
+	AttributeSet* attributes;
 
 	AstValueDecl() = default;
-	AstValueDecl(AstNode* name, AstNode* type_name)
+	AstValueDecl(AstNode* name, AstNode* type_name, AttributeSet* attributes)
 		: name(name)
 		, type_name(type_name)
+		, attributes(attributes)
 	{}
 };
 
@@ -291,11 +316,14 @@ struct AstId
 
 	IdClassification classification;
 	AstList<String*>* name_parts;
+	// name_parts joined, e.g. Enum#Member.
+	Symbol name;
 
 	AstId() = default;
-	AstId(IdClassification classification, AstList<String*>* name)
+	AstId(IdClassification classification, AstList<String*>* name_parts, Symbol name)
 		: classification(classification)
-		, name_parts(name)
+		, name_parts(name_parts)
+		, name(name)
 	{}
 };
 
@@ -404,11 +432,19 @@ struct AstStruct
 
 	AstNode* type_name;
 	AstList<AstNode*>* members;
+	// Ids of the type parameters. Null if not generic.
+	AstList<AstNode*>* type_params;
 
 	AstStruct() = default;
 	AstStruct(AstNode* type_name, AstList<AstNode*>* members)
 		: type_name(type_name)
 		, members(members)
+		, type_params(nullptr)
+	{}
+	AstStruct(AstNode* type_name, AstList<AstNode*>* members, AstList<AstNode*>* type_params)
+		: type_name(type_name)
+		, members(members)
+		, type_params(type_params)
 	{}
 };
 
@@ -580,17 +616,22 @@ struct AstTypeDeclarator
 	unsigned int array_size;
 	unsigned int indirection_level;
 	AstList<String*>* name;
+	// name joined, e.g. Enum#Member.
+	Symbol symbol;
 	bool empty;
 
 	AstTypeDeclarator() = default;
-	AstTypeDeclarator(AstList<String*>* name, unsigned int indirection_level)
+	AstTypeDeclarator(AstList<String*>* name, Symbol symbol, unsigned int indirection_level)
 		: name(name)
+		, symbol(symbol)
 		, indirection_level(indirection_level)
 		, array_size(0)
 		, empty(false)
 	{}
-	AstTypeDeclarator(AstList<String*>* name, unsigned int indirection_level, unsigned array_size)
+	AstTypeDeclarator(
+		AstList<String*>* name, Symbol symbol, unsigned int indirection_level, unsigned array_size)
 		: name(name)
+		, symbol(symbol)
 		, indirection_level(indirection_level)
 		, array_size(array_size)
 		, empty(false)
@@ -649,6 +690,19 @@ struct AstDeref
 	{}
 };
 
+struct AstAwait
+{
+	static constexpr NodeType nt = NodeType::Await;
+
+	// 'await a, b;' waits for all of the futures.
+	AstList<AstNode*>* futures;
+
+	AstAwait() = default;
+	AstAwait(AstList<AstNode*>* futures)
+		: futures(futures)
+	{}
+};
+
 struct AstExpr
 {
 	static constexpr NodeType nt = NodeType::Expr;
@@ -673,17 +727,23 @@ struct AstStmt
 	{}
 };
 
+/**
+ * @brief Variants larger than 24 bytes are stored out of line so they don't set
+ * the size of every node. See the static_assert in AstNode.cpp.
+ */
 struct AstNode
 {
 	Span span;
 	NodeType type = NodeType::Invalid;
+	// Unique within an Ast. Keys side tables, e.g. CommentTable.
+	unsigned int id = 0;
 	union
 	{
 		AstModule mod;
 		AstNamespace namespace_node;
 		AstFn fn;
 		AstExternFn extern_fn;
-		AstFnProto fn_proto;
+		AstFnProto* fn_proto;
 		AstFnParamList fn_params;
 		AstValueDecl value_decl;
 		AstVarArg var_arg;
@@ -707,16 +767,17 @@ struct AstNode
 		AstStruct structstmt;
 		AstUnion unionstmt;
 		AstEnum enumstmt;
-		AstEnumMember enum_member;
+		AstEnumMember* enum_member;
 		// AstMemberDef member;
 		AstWhile whilestmt;
-		AstFor forstmt;
+		AstFor* forstmt;
 		AstStringLiteral string_literal;
 		AstNumberLiteral number_literal;
 		AstTypeDeclarator type_declarator;
 		AstMemberAccess member_access;
 		AstIndirectMemberAccess indirect_member_access;
 		AstDeref deref;
+		AstAwait await_expr;
 		AstEmpty empty;
 		AstAddressOf address_of;
 		AstExpr expr;
@@ -0,0 +1,45 @@
+#pragma once
+
+namespace ast
+{
+
+/**
+ * @brief Attributes are written as '@name' before a function name or a parameter.
+ *
+ * fn @inline @hot add(@noalias @readonly a: i32*, @noalias b: i32*): i32 { ... }
+ */
+enum class Attribute : unsigned int
+{
+	// Function attributes
+	Inline = 1 << 0,
+	NoInline = 1 << 1,
+	Hot = 1 << 2,
+	Cold = 1 << 3,
+
+	// Parameter attributes
+	NoAlias = 1 << 4,
+	ReadOnly = 1 << 5,
+	NoCapture = 1 << 6,
+};
+
+enum class AttributeTarget
+{
+	Fn,
+	Param
+};
+
+/**
+ * @brief Bitmask of attributes. Must stay trivial so it can live in the AstNode union.
+ */
+struct AttributeSet
+{
+	unsigned int mask;
+
+	bool has(Attribute attr) const { return (mask & (unsigned int)attr) != 0; }
+	void add(Attribute attr) { mask |= (unsigned int)attr; }
+	bool empty() const { return mask == 0; }
+
+	static AttributeSet None() { return AttributeSet{0}; }
+};
+
+} // namespace ast
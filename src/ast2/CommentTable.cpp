@@ -0,0 +1,38 @@
+#include "CommentTable.h"
+
+using namespace ast;
+
+static std::uint64_t
+span_key(Span span)
+{
+	return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(span.start)) << 32) |
+		   static_cast<std::uint32_t>(span.size);
+}
+
+void
+CommentTable::add_pending(Span span, NodeComments comments)
+{
+	// The first span marked keeps its comments, as the first node with it claims them.
+	pending.emplace(span_key(span), std::move(comments));
+}
+
+void
+CommentTable::claim_pending(Span span, unsigned int node_id)
+{
+	auto iter = pending.find(span_key(span));
+	if( iter == pending.end() )
+		return;
+
+	table.emplace(node_id, std::move(iter->second));
+	pending.erase(iter);
+}
+
+NodeComments const*
+CommentTable::lookup(unsigned int node_id) const
+{
+	auto iter = table.find(node_id);
+	if( iter == table.end() )
+		return nullptr;
+
+	return &iter->second;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Span.h"
+#include "common/Vec.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace ast
+{
+struct NodeComments
+{
+	// Leading comments are orphaned on their own line,
+	// like this comment.
+	Vec<int> leading_comments;
+
+	// Trailing comments are commends that ar not on their own line.
+	// E.g. if (my_bool) // trailing comment
+	Vec<int> trailing_comments;
+};
+
+/**
+ * @brief Comments attached to ast nodes, keyed by node id.
+ *
+ * Very few nodes have comments so they are kept out of the nodes.
+ * The parser finds comments when it marks a span, before the node exists,
+ * so comments wait in 'pending' until the first node with that span is created.
+ * Pending comments are keyed by span, so a node finds its comments in constant time.
+ */
+class CommentTable
+{
+	std::unordered_map<std::uint64_t, NodeComments> pending;
+
+	std::unordered_map<unsigned int, NodeComments> table;
+
+public:
+	void add_pending(Span span, NodeComments comments);
+	/**
+	 * @brief Drops comments of spans that no node was created for. Once a top level
+	 * item is parsed, no later node has the span of anything in it.
+	 */
+	void drop_pending() { pending.clear(); }
+
+	void claim(Span span, unsigned int node_id)
+	{
+		if( !pending.empty() )
+			claim_pending(span, node_id);
+	}
+
+	/**
+	 * @brief Returns nullptr if the node has no comments.
+	 */
+	NodeComments const* lookup(unsigned int node_id) const;
+
+private:
+	void claim_pending(Span span, unsigned int node_id);
+};
+} // namespace ast
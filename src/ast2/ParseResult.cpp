@@ -32,18 +32,18 @@ ParseError::print() const
 	{
 		line_start = 0;
 	}
-	if( token.neighborhood.lines.num_lines == 0 )
+	if( !token.neighborhood.lines || token.neighborhood.lines->num_lines == 0 )
 		return;
 
 	int line_end = token.neighborhood.line_num + 1;
-	if( line_end > token.neighborhood.lines.num_lines )
+	if( line_end > token.neighborhood.lines->num_lines )
 	{
-		line_end = token.neighborhood.lines.num_lines;
+		line_end = token.neighborhood.lines->num_lines;
 	}
 
 	for( int i = line_start; i <= line_end; i++ )
 	{
-		auto line = get_line(token.neighborhood.lines.lines[i], i);
+		auto line = get_line(token.neighborhood.lines->lines[i], i);
 
 		auto ln_str = std::to_string(i + 1);
 		std::cout << ln_str << " | " << line << "\n";
@@ -51,7 +51,7 @@ ParseError::print() const
 		if( i == token.neighborhood.line_num )
 		{
 			auto sz = String{token.start, token.size};
-			int offset = token.start - token.neighborhood.lines.lines[i];
+			int offset = token.start - token.neighborhood.lines->lines[i];
 			if( i != 0 )
 				offset -= 1; // Skip passed '\n' character.
 			assert(offset > 0);
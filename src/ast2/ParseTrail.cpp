@@ -1,5 +1,7 @@
 #include "ParseTrail.h"
 
+#include <algorithm>
+
 using namespace ast;
 
 Span
@@ -8,37 +10,31 @@ ParseTrail::mark()
 	size = cursor.get_index() - start;
 
 	auto span = Span{start, size};
+	NodeComments found;
 
-	bool leading_mode = true;
-
-	// TODO: Flag on this.
-	// Check for comments.
-	for( int i = 0; i < size; ++i )
+	// Comments at the start of the span lead the node, the others trail something in it.
+	// The comment indices are sorted, so only the comments in the span are visited.
+	auto& comment_indices = cursor.comments();
+	auto iter = std::lower_bound(comment_indices.begin(), comment_indices.end(), start);
+	int leading_end = start;
+	for( ; iter != comment_indices.end() && *iter < start + size; ++iter )
 	{
-		auto ind = start + i;
-		auto passed_tok = cursor.peek(ind);
-		if( passed_tok.type == TokenType::line_comment )
-		{
-			auto already_captured = meta.comments.find(ind);
-			if( already_captured == meta.comments.end() )
-			{
-				if( leading_mode )
-				{
-					span.leading_comments.push_back(ind);
-					meta.comments.insert(ind);
-				}
-				else
-				{
-					span.trailing_comments.push_back(ind);
-					meta.comments.insert(ind);
-				}
-			}
-		}
-		else
+		auto ind = *iter;
+		bool leading = ind == leading_end;
+		if( leading )
+			leading_end += 1;
+
+		if( meta.comments.insert(ind).second )
 		{
-			leading_mode = false;
+			if( leading )
+				found.leading_comments.push_back(ind);
+			else
+				found.trailing_comments.push_back(ind);
 		}
 	}
 
+	if( !found.leading_comments.empty() || !found.trailing_comments.empty() )
+		comments.add_pending(span, std::move(found));
+
 	return span;
 }
\ No newline at end of file
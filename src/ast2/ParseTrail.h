@@ -1,5 +1,6 @@
 #pragma once
 
+#include "CommentTable.h"
 #include "Span.h"
 #include "common/String.h"
 #include "lexer/TokenCursor.h"
@@ -27,13 +28,15 @@ class ParseTrail
 {
 	TokenCursor& cursor;
 	ParserMetaInformation& meta;
+	CommentTable& comments;
 	int start = 0;
 	int size = 0;
 
 public:
-	ParseTrail(TokenCursor& cursor, ParserMetaInformation& meta)
+	ParseTrail(TokenCursor& cursor, ParserMetaInformation& meta, CommentTable& comments)
 		: cursor(cursor)
 		, meta(meta)
+		, comments(comments)
 		, start(cursor.get_index()){};
 
 	Span mark();
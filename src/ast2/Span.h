@@ -1,17 +1,13 @@
-
-
 #pragma once
 
-#include "common/Vec.h"
-
 namespace ast
 {
 
 /**
- * @brief Used to keep track of meta-information in the AST.
+ * @brief Tokens used to produce an AST node.
  *
- * Tracks information for elements of the input source that are valid syntax, but otherwise
- * not represented in the AST. E.g. Comments
+ * Meta-information for elements of the input source that are valid syntax, but otherwise
+ * not represented in the AST, e.g. comments, is kept in the CommentTable.
  *
  */
 struct Span
@@ -20,17 +16,9 @@ struct Span
 	int start = 0;
 	int size = 0;
 
-	// Leading comments are orphaned on their own line,
-	// like this comment.
-	Vec<int> leading_comments;
-
-	// Trailing comments are commends that ar not on their own line.
-	// E.g. if (my_bool) // trailing comment
-	Vec<int> trailing_comments;
-
 	Span() = default;
 	Span(int start, int size)
 		: start(start)
 		, size(size){};
 };
-} // namespace ast
\ No newline at end of file
+} // namespace ast
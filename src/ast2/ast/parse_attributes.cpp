@@ -0,0 +1,71 @@
+#include "parse_attributes.h"
+
+#include "../Ast.h"
+#include "../AstGen.h"
+
+#include <cstring>
+
+using namespace ast;
+
+struct attribute_spelling_t
+{
+	char const* name;
+	Attribute attr;
+	AttributeTarget target;
+};
+
+static attribute_spelling_t const attribute_spellings[] = {
+	{"inline", Attribute::Inline, AttributeTarget::Fn},
+	{"noinline", Attribute::NoInline, AttributeTarget::Fn},
+	{"hot", Attribute::Hot, AttributeTarget::Fn},
+	{"cold", Attribute::Cold, AttributeTarget::Fn},
+	{"noalias", Attribute::NoAlias, AttributeTarget::Param},
+	{"readonly", Attribute::ReadOnly, AttributeTarget::Param},
+	{"nocapture", Attribute::NoCapture, AttributeTarget::Param},
+};
+
+static attribute_spelling_t const*
+find_attribute(Token const& tok)
+{
+	for( auto& spelling : attribute_spellings )
+	{
+		if( strlen(spelling.name) == tok.size && strncmp(spelling.name, tok.start, tok.size) == 0 )
+			return &spelling;
+	}
+
+	return nullptr;
+}
+
+ParseResult<AttributeSet*>
+ast::parse_attributes(AstGen& astgen, AttributeTarget target)
+{
+	auto attributes = astgen.ast.create_attributes();
+
+	while( astgen.cursor.consume_if_expected(TokenType::at).ok() )
+	{
+		auto consume_tok = astgen.cursor.consume(TokenType::identifier);
+		if( !consume_tok.ok() )
+			return ParseError("Expected attribute name after '@'.", consume_tok.as());
+
+		auto tok = consume_tok.unwrap();
+		auto spelling = find_attribute(tok);
+		if( !spelling )
+			return ParseError("Unknown attribute.", tok);
+
+		if( spelling->target != target )
+			return ParseError(
+				target == AttributeTarget::Fn ? "Attribute is only valid on parameters."
+											  : "Attribute is only valid on functions.",
+				tok);
+
+		attributes->add(spelling->attr);
+	}
+
+	if( attributes->has(Attribute::Inline) && attributes->has(Attribute::NoInline) )
+		return ParseError("Conflicting attributes '@inline' and '@noinline'.", astgen.cursor.peek());
+
+	if( attributes->has(Attribute::Hot) && attributes->has(Attribute::Cold) )
+		return ParseError("Conflicting attributes '@hot' and '@cold'.", astgen.cursor.peek());
+
+	return attributes;
+}
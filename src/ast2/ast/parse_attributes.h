@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../Ast.h"
+#include "../AstNode.h"
+#include "../Attributes.h"
+#include "../ParseResult.h"
+
+namespace ast
+{
+class AstGen;
+
+/**
+ * @brief Parse zero or more '@name' attributes.
+ *
+ * Errors if an attribute is unknown, not valid on the target, or conflicts with another.
+ *
+ * @return ParseResult<AttributeSet*>
+ */
+ParseResult<AttributeSet*> parse_attributes(AstGen&, AttributeTarget target);
+
+} // namespace ast
@@ -5,8 +5,12 @@ using namespace ast;
 AstNode*
 ast::to_value_identifier(Ast& ast, ConsumeResult const& tok_res, Span span)
 {
-	auto tok = tok_res.unwrap();
+	return to_value_identifier(ast, tok_res.unwrap(), span);
+}
 
+AstNode*
+ast::to_value_identifier(Ast& ast, Token const& tok, Span span)
+{
 	auto name = ast.create_string(tok.start, tok.size);
 	auto name_parts = ast.create_name_parts();
 	name_parts->append(name);
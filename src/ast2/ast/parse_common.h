@@ -10,5 +10,6 @@ namespace ast
 class AstGen;
 
 AstNode* to_value_identifier(Ast& ast, ConsumeResult const& tok_res, Span span);
+AstNode* to_value_identifier(Ast& ast, Token const& tok, Span span);
 
 } // namespace ast
\ No newline at end of file
@@ -66,8 +66,9 @@ ast::parse_enum(AstGen& astgen)
 			{
 				return ParseError(*struct_members.unwrap_error());
 			}
+			// The struct body was consumed since, so the name comes from the copy.
 			auto member_struct_name =
-				to_value_identifier(astgen.ast, consume_tok, member_trail.mark());
+				to_value_identifier(astgen.ast, name_tok, member_trail.mark());
 			auto as_struct =
 				astgen.ast.Struct(member_trail.mark(), member_struct_name, struct_members.unwrap());
 			members->append(astgen.ast.EnumMemberStruct(member_trail.mark(), as_struct));
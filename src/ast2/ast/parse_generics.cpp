@@ -0,0 +1,93 @@
+#include "parse_generics.h"
+
+#include "../AstGen.h"
+#include "parse_common.h"
+
+using namespace ast;
+
+ParseResult<AstList<AstNode*>*>
+ast::parse_type_params(AstGen& astgen)
+{
+	auto params = astgen.ast.create_list();
+
+	auto consume_tok = astgen.cursor.consume(TokenType::lt);
+	if( !consume_tok.ok() )
+		return ParseError("Expected '<'.", consume_tok.as());
+
+	do
+	{
+		auto param_trail = astgen.get_parse_trail();
+		consume_tok = astgen.cursor.consume(TokenType::identifier);
+		if( !consume_tok.ok() )
+			return ParseError("Expected type parameter name.", consume_tok.as());
+
+		params->append(to_value_identifier(astgen.ast, consume_tok, param_trail.mark()));
+
+		consume_tok = astgen.cursor.consume(TokenType::comma, TokenType::gt);
+		if( !consume_tok.ok() )
+			return ParseError("Expected ',' or '>'.", consume_tok.as());
+	} while( consume_tok.token_type() == TokenType::comma );
+
+	return params;
+}
+
+ParseResult<AstList<AstNode*>*>
+ast::parse_type_args(AstGen& astgen)
+{
+	auto args = astgen.ast.create_list();
+
+	auto consume_tok = astgen.cursor.consume(TokenType::lt);
+	if( !consume_tok.ok() )
+		return ParseError("Expected '<'.", consume_tok.as());
+
+	do
+	{
+		auto type_decl = astgen.parse_type_decl(false);
+		if( !type_decl.ok() )
+			return ParseError(*type_decl.unwrap_error());
+
+		args->append(type_decl.unwrap());
+
+		consume_tok = astgen.cursor.consume(TokenType::comma, TokenType::gt);
+		if( !consume_tok.ok() )
+			return ParseError("Expected ',' or '>'.", consume_tok.as());
+	} while( consume_tok.token_type() == TokenType::comma );
+
+	return args;
+}
+
+bool
+ast::peek_type_args(AstGen& astgen)
+{
+	if( astgen.cursor.peek_type() != TokenType::lt )
+		return false;
+
+	int depth = 0;
+	for( unsigned int i = 0;; i++ )
+	{
+		switch( astgen.cursor.peek_type_ahead(i) )
+		{
+		case TokenType::lt:
+			depth += 1;
+			break;
+		case TokenType::gt:
+			depth -= 1;
+			if( depth == 0 )
+			{
+				auto after = astgen.cursor.peek_type_ahead(i + 1);
+				return after == TokenType::open_paren || after == TokenType::open_curly;
+			}
+			break;
+		case TokenType::identifier:
+		case TokenType::colon_colon:
+		case TokenType::star:
+		case TokenType::comma:
+		case TokenType::open_square:
+		case TokenType::close_square:
+		case TokenType::literal:
+			break;
+		default:
+			return false;
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../Ast.h"
+#include "../AstNode.h"
+#include "../ParseResult.h"
+
+namespace ast
+{
+class AstGen;
+
+/**
+ * @brief Parses type parameters of a generic declaration, e.g. <T, U>.
+ *
+ * @return List of Id nodes.
+ */
+ParseResult<AstList<AstNode*>*> parse_type_params(AstGen&);
+
+/**
+ * @brief Parses type arguments, e.g. <i32, Box<u8>*>.
+ *
+ * @return List of TypeDeclarator nodes.
+ */
+ParseResult<AstList<AstNode*>*> parse_type_args(AstGen&);
+
+/**
+ * @brief In an expression, '<' after a name starts type arguments only if a
+ * balanced type argument list follows and is followed by '(' or '{', e.g. max<i32>(a, b).
+ * Otherwise it is a comparison.
+ */
+bool peek_type_args(AstGen&);
+
+} // namespace ast
@@ -4,6 +4,7 @@
 #include "../AstGen.h"
 #include "../bin_op.h"
 #include "parse_common.h"
+#include "parse_generics.h"
 
 #include <string>
 
@@ -53,12 +54,12 @@ ast::parse_struct_body(AstGen& astgen)
 
 		members->append(astgen.ast.ValueDecl(member_trail.mark(), name, decl.unwrap()));
 
-		if( consume_tok.as().type == TokenType::close_curly )
+		if( consume_tok.token_type() == TokenType::close_curly )
 			break;
 
 		tok = astgen.cursor.peek();
 	}
-	if( consume_tok.as().type != TokenType::close_curly )
+	if( consume_tok.token_type() != TokenType::close_curly )
 		consume_tok = astgen.cursor.consume(TokenType::close_curly);
 
 	return members;
@@ -83,11 +84,20 @@ ast::parse_struct(AstGen& astgen)
 
 	auto struct_name = to_value_identifier(astgen.ast, consume_tok, trail.mark());
 
+	AstList<AstNode*>* type_params = nullptr;
+	if( astgen.cursor.peek_type() == TokenType::lt )
+	{
+		auto type_paramsr = parse_type_params(astgen);
+		if( !type_paramsr.ok() )
+			return ParseError(*type_paramsr.unwrap_error());
+		type_params = type_paramsr.unwrap();
+	}
+
 	auto members = parse_struct_body(astgen);
 	if( !members.ok() )
 	{
 		return ParseError(*members.unwrap_error());
 	}
 
-	return astgen.ast.Struct(trail.mark(), struct_name, members.unwrap());
+	return astgen.ast.Struct(trail.mark(), struct_name, members.unwrap(), type_params);
 }
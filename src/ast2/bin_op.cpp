@@ -1,20 +1,34 @@
 #include "bin_op.h"
 
-#include <map>
-
 using namespace ast;
 
-// TODO: Dont do this
-static std::map<char, int> BinopPrecedence;
-
+/**
+ * @brief -1 if the op is not a binary operator. A switch rather than a table so
+ * files can be parsed on several threads.
+ */
 int
 ast::get_token_precedence(BinOp bin_op_type)
 {
-	// Make sure it's a declared binop.
-	int prec = BinopPrecedence[bin_op_type];
-	if( prec <= 0 )
+	switch( bin_op_type )
+	{
+	case BinOp::ne:
+	case BinOp::cmp:
+	case BinOp::or_op:
+	case BinOp::and_op:
+	case BinOp::lte:
+	case BinOp::gte:
+	case BinOp::lt:
+	case BinOp::gt:
+		return 10;
+	case BinOp::plus:
+	case BinOp::minus:
+		return 20;
+	case BinOp::slash:
+	case BinOp::star:
+		return 40; // highest.
+	default:
 		return -1;
-	return prec;
+	}
 }
 
 ast::BinOp
@@ -64,20 +78,3 @@ ast::get_bin_op_from_token_type(TokenType token_type)
 	}
 	return op;
 }
-
-void
-ast::init_bin_op_lookup()
-{
-	BinopPrecedence[BinOp::ne] = 10;
-	BinopPrecedence[BinOp::cmp] = 10;
-	BinopPrecedence[BinOp::or_op] = 10;
-	BinopPrecedence[BinOp::and_op] = 10;
-	BinopPrecedence[BinOp::lte] = 10;
-	BinopPrecedence[BinOp::gte] = 10;
-	BinopPrecedence[BinOp::lt] = 10;
-	BinopPrecedence[BinOp::gt] = 10;
-	BinopPrecedence[BinOp::plus] = 20;
-	BinopPrecedence[BinOp::minus] = 20;
-	BinopPrecedence[BinOp::slash] = 40; // highest.
-	BinopPrecedence[BinOp::star] = 40;	// highest.
-}
\ No newline at end of file
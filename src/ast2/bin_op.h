@@ -26,6 +26,4 @@ int get_token_precedence(BinOp bin_op_type);
 
 BinOp get_bin_op_from_token_type(TokenType token_type);
 
-void init_bin_op_lookup();
-
 } // namespace ast
@@ -0,0 +1,128 @@
+#include "CGBitcode.h"
+
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/LTO/LTO.h>
+#include <llvm/Support/Caching.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Threading.h>
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+
+using namespace cg;
+
+void
+cg::write_bitcode(llvm::Module& module, llvm::raw_ostream& out, CGOptions const& options)
+{
+	if( !options.thinlto )
+	{
+		llvm::WriteBitcodeToFile(module, out);
+		return;
+	}
+
+	llvm::ProfileSummaryInfo psi(module);
+	auto index = llvm::buildModuleSummaryIndex(module, nullptr, &psi);
+	llvm::WriteBitcodeToFile(module, out, false, &index);
+}
+
+static String
+object_path(unsigned int task)
+{
+	return "output." + std::to_string(task) + ".o";
+}
+
+// A hook of the LTO config that writes the module as text, for --save-temps.
+static llvm::lto::Config::ModuleHookFn
+save_module(char const* stage)
+{
+	return [stage](unsigned int task, llvm::Module const& module) {
+		std::error_code ec;
+		auto path = "output." + std::to_string(task) + "." + stage + ".ll";
+		llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_Text);
+		if( !ec )
+			module.print(out, nullptr);
+		return true;
+	};
+}
+
+CGResult<Vec<String>>
+cg::thinlto_link(Vec<String> const& inputs, CGOptions const& options, unsigned int threads)
+{
+	llvm::lto::Config config;
+	config.CPU = "generic";
+	config.OptLevel = options.opt_level;
+	config.CGOptLevel =
+		options.opt_level == 0 ? llvm::CodeGenOpt::None : llvm::CodeGenOpt::Default;
+	if( options.save_temps )
+	{
+		config.PostImportModuleHook = save_module("import");
+		config.PreCodeGenModuleHook = save_module("precodegen");
+	}
+
+	auto backend =
+		llvm::lto::createInProcessThinBackend(llvm::heavyweight_hardware_concurrency(threads));
+	llvm::lto::LTO lto(std::move(config), std::move(backend));
+
+	// Buffers must outlive the LTO run.
+	Vec<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+	std::set<String> defined;
+	for( auto& input : inputs )
+	{
+		auto bufferr = llvm::MemoryBuffer::getFile(input);
+		if( !bufferr )
+			return CGError("Could not open " + input + ": " + bufferr.getError().message());
+		buffers.push_back(std::move(bufferr.get()));
+
+		auto filer = llvm::lto::InputFile::create(buffers.back()->getMemBufferRef());
+		if( !filer )
+			return CGError(input + ": " + llvm::toString(filer.takeError()));
+		auto file = std::move(filer.get());
+
+		// The first definition of a symbol wins. Everything stays visible to native
+		// objects, i.e. the C harness, so nothing is internalized.
+		Vec<llvm::lto::SymbolResolution> resolutions;
+		for( auto& symbol : file->symbols() )
+		{
+			llvm::lto::SymbolResolution resolution;
+			bool is_definition = !symbol.isUndefined();
+			resolution.Prevailing = is_definition && defined.insert(symbol.getName().str()).second;
+			resolution.FinalDefinitionInLinkageUnit = is_definition;
+			resolution.VisibleToRegularObj = true;
+			resolutions.push_back(resolution);
+		}
+
+		auto err = lto.add(std::move(file), resolutions);
+		if( err )
+			return CGError(input + ": " + llvm::toString(std::move(err)));
+	}
+
+	// Called from the backend threads.
+	std::mutex objects_mutex;
+	Vec<String> objects;
+	auto add_stream =
+		[&](unsigned int task) -> llvm::Expected<std::unique_ptr<llvm::CachedFileStream>>
+	{
+		std::error_code ec;
+		auto path = object_path(task);
+		auto out = std::make_unique<llvm::raw_fd_ostream>(path, ec, llvm::sys::fs::OF_None);
+		if( ec )
+			return llvm::errorCodeToError(ec);
+
+		std::lock_guard<std::mutex> lock(objects_mutex);
+		objects.push_back(path);
+
+		return std::make_unique<llvm::CachedFileStream>(std::move(out), path);
+	};
+
+	auto err = lto.run(add_stream);
+	if( err )
+		return CGError(llvm::toString(std::move(err)));
+
+	std::sort(objects.begin(), objects.end());
+
+	return objects;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CGOptions.h"
+#include "CGResult.h"
+#include "common/String.h"
+#include "common/Vec.h"
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace cg
+{
+
+/**
+ * @brief Writes module as bitcode. With options.thinlto, a ThinLTO summary is
+ * embedded so the module can be imported from by thinlto_link.
+ */
+void write_bitcode(llvm::Module& module, llvm::raw_ostream& out, CGOptions const& options);
+
+/**
+ * @brief Runs the ThinLTO backend over bitcode files written by write_bitcode.
+ *
+ * Each module is optimized on its own thread (threads == 0 uses all cores)
+ * with functions imported from the others, and written as output.<task>.o.
+ * With options.save_temps, its IR is also written after the import, as
+ * output.<task>.import.ll, and before codegen, as output.<task>.precodegen.ll.
+ *
+ * @return The object files written.
+ */
+CGResult<Vec<String>>
+thinlto_link(Vec<String> const& inputs, CGOptions const& options, unsigned int threads);
+
+} // namespace cg
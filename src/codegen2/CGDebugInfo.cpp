@@ -0,0 +1,413 @@
+#include "CGDebugInfo.h"
+
+#include "Codegen.h"
+#include "Codegen/lookup.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/BinaryFormat/Dwarf.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+
+using namespace cg;
+
+CGDebugInfo::CGDebugInfo(
+	CG& codegen, DebugInfoKind kind, String const& filepath, LexResult const& tokens)
+	: codegen(codegen)
+	, kind(kind)
+	, tokens(tokens)
+	, builder(*codegen.Module)
+{
+	llvm::SmallString<128> abs_path(filepath);
+	llvm::sys::fs::make_absolute(abs_path);
+
+	file = builder.createFile(
+		llvm::sys::path::filename(abs_path), llvm::sys::path::parent_path(abs_path));
+
+	auto emission_kind = kind == DebugInfoKind::Full ? llvm::DICompileUnit::FullDebug
+													 : llvm::DICompileUnit::LineTablesOnly;
+
+	// There is no DWARF language code for sushi.
+	compile_unit = builder.createCompileUnit(
+		llvm::dwarf::DW_LANG_C, file, "sushi", false, "", 0, "", emission_kind);
+
+	codegen.Module->addModuleFlag(
+		llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+	codegen.Module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+
+	scopes.push_back(file);
+}
+
+CGDebugInfo::line_col_t
+CGDebugInfo::line_col(ast::AstNode* node) const
+{
+	int ind = node->span.start;
+	int end = node->span.start + node->span.size;
+
+	// The span may start with leading comments.
+	while( ind < end && ind < tokens.size() && tokens.type(ind) == TokenType::line_comment )
+		ind++;
+
+	if( ind >= tokens.size() )
+		return line_col_t{0, 0};
+
+	auto tok = tokens.token(ind);
+	unsigned int line = tok.neighborhood.line_num;
+	unsigned int col = 0;
+
+	// Line markers point to the newline preceeding the line, except the first.
+	auto& lines = tok.neighborhood.lines->lines;
+	if( line < lines.size() )
+		col = (tok.start - lines[line]) + (line == 0 ? 1 : 0);
+
+	return line_col_t{line + 1, col};
+}
+
+void
+CGDebugInfo::begin_function(
+	llvm::Function* llvm_fn, String const& name, sema::Type const* fn_type, ast::AstNode* node)
+{
+	auto loc = line_col(node);
+
+	llvm::DISubprogram* subprogram = builder.createFunction(
+		file,
+		name,
+		name,
+		file,
+		loc.line,
+		di_fn_type(fn_type),
+		loc.line,
+		llvm::DINode::FlagPrototyped,
+		llvm::DISubprogram::SPFlagDefinition);
+
+	llvm_fn->setSubprogram(subprogram);
+	scopes.push_back(subprogram);
+
+	set_location(node);
+}
+
+void
+CGDebugInfo::end_function()
+{
+	auto subprogram = llvm::cast<llvm::DISubprogram>(scopes.back());
+	scopes.pop_back();
+
+	builder.finalizeSubprogram(subprogram);
+	codegen.Builder->SetCurrentDebugLocation(llvm::DebugLoc());
+}
+
+void
+CGDebugInfo::push_lexical_block(ast::AstNode* node)
+{
+	auto loc = line_col(node);
+	scopes.push_back(builder.createLexicalBlock(scopes.back(), file, loc.line, loc.col));
+}
+
+void
+CGDebugInfo::pop_lexical_block()
+{
+	scopes.pop_back();
+}
+
+void
+CGDebugInfo::set_location(ast::AstNode* node)
+{
+	// Only instructions within a function have a location.
+	if( scopes.size() <= 1 )
+		return;
+
+	auto loc = line_col(node);
+	codegen.Builder->SetCurrentDebugLocation(
+		llvm::DILocation::get(*codegen.Context, loc.line, loc.col, scopes.back()));
+}
+
+void
+CGDebugInfo::declare_param(
+	llvm::Value* storage, String const& name, int arg_no, sema::TypeInstance const& type)
+{
+	if( kind != DebugInfoKind::Full )
+		return;
+
+	auto loc = codegen.Builder->getCurrentDebugLocation();
+	auto var = builder.createParameterVariable(
+		scopes.back(), name, arg_no, file, loc.getLine(), di_type(type), true);
+
+	builder.insertDeclare(
+		storage, var, builder.createExpression(), loc.get(), codegen.Builder->GetInsertBlock());
+}
+
+void
+CGDebugInfo::declare_local(
+	llvm::Value* storage, String const& name, sema::TypeInstance const& type, ast::AstNode* node)
+{
+	if( kind != DebugInfoKind::Full )
+		return;
+
+	auto loc = line_col(node);
+	auto var =
+		builder.createAutoVariable(scopes.back(), name, file, loc.line, di_type(type), true);
+
+	builder.insertDeclare(
+		storage,
+		var,
+		builder.createExpression(),
+		llvm::DILocation::get(*codegen.Context, loc.line, loc.col, scopes.back()),
+		codegen.Builder->GetInsertBlock());
+}
+
+void
+CGDebugInfo::finalize()
+{
+	builder.finalize();
+}
+
+llvm::DISubroutineType*
+CGDebugInfo::di_fn_type(sema::Type const* fn_type)
+{
+	Vec<llvm::Metadata*> elements;
+	if( kind == DebugInfoKind::Full )
+	{
+		auto maybe_return_type = fn_type->get_return_type();
+		elements.push_back(
+			maybe_return_type.has_value() ? di_type(maybe_return_type.value()) : nullptr);
+
+		for( int i = 0; i < fn_type->get_member_count(); i++ )
+			elements.push_back(di_type(fn_type->get_member(i).type));
+
+		if( fn_type->is_var_arg() )
+			elements.push_back(builder.createUnspecifiedParameter());
+	}
+
+	return builder.createSubroutineType(builder.getOrCreateTypeArray(elements));
+}
+
+llvm::DIType*
+CGDebugInfo::di_type(sema::TypeInstance const& type)
+{
+	auto& data_layout = codegen.Module->getDataLayout();
+
+	if( type.is_array_type() )
+	{
+		auto llvm_typer = get_type(codegen, type);
+		if( !llvm_typer.ok() )
+			return nullptr;
+		auto llvm_type = llvm_typer.unwrap();
+
+		llvm::Metadata* subscripts[] = {builder.getOrCreateSubrange(0, type.array_size)};
+		return builder.createArrayType(
+			data_layout.getTypeAllocSizeInBits(llvm_type),
+			data_layout.getABITypeAlign(llvm_type).value() * 8,
+			di_type(type.ArrayElementType()),
+			builder.getOrCreateArray(subscripts));
+	}
+
+	if( type.is_pointer_type() )
+		return builder.createPointerType(
+			di_type(type.Dereference()), data_layout.getPointerSizeInBits());
+
+	return di_base_type(type.type);
+}
+
+llvm::DIType*
+CGDebugInfo::di_base_type(sema::Type const* type)
+{
+	auto iter = types.find(type);
+	if( iter != types.end() )
+		return iter->second;
+
+	llvm::DIType* di_type = nullptr;
+	if( type->is_struct_type() || type->is_union_type() )
+		return di_record_type(type);
+	else if( type->is_enum_type() )
+		return di_enum_type(type);
+	else if( type->int_width() != 0 )
+		di_type = builder.createBasicType(
+			type->get_name(),
+			type->int_width(),
+			codegen.sema.types.is_signed_integer_type(sema::TypeInstance::OfType(type))
+				? llvm::dwarf::DW_ATE_signed
+				: llvm::dwarf::DW_ATE_unsigned);
+	else if( type == codegen.sema.types.bool_type() )
+		di_type = builder.createBasicType(type->get_name(), 8, llvm::dwarf::DW_ATE_boolean);
+	else if( type->is_future_type() )
+		// Coroutine handle.
+		di_type = builder.createPointerType(nullptr, 64, 0, llvm::None, type->get_name());
+
+	// Void and functions have no type description.
+	types.emplace(type, di_type);
+	return di_type;
+}
+
+llvm::DIType*
+CGDebugInfo::di_record_type(sema::Type const* type)
+{
+	auto llvm_typer = get_base_type(codegen, type);
+	if( !llvm_typer.ok() )
+		return nullptr;
+	auto llvm_struct_type = llvm::cast<llvm::StructType>(llvm_typer.unwrap());
+
+	auto& data_layout = codegen.Module->getDataLayout();
+	auto layout = data_layout.getStructLayout(llvm_struct_type);
+
+	llvm::DICompositeType* composite = nullptr;
+	if( type->is_union_type() )
+		composite = builder.createUnionType(
+			file,
+			type->get_name(),
+			file,
+			0,
+			layout->getSizeInBits(),
+			layout->getAlignment().value() * 8,
+			llvm::DINode::FlagZero,
+			llvm::DINodeArray());
+	else
+		composite = builder.createStructType(
+			file,
+			type->get_name(),
+			file,
+			0,
+			layout->getSizeInBits(),
+			layout->getAlignment().value() * 8,
+			llvm::DINode::FlagZero,
+			nullptr,
+			llvm::DINodeArray());
+
+	// Cache before the members so self referential types terminate.
+	types.emplace(type, composite);
+
+	Vec<llvm::Metadata*> elements;
+	for( int i = 0; i < type->get_member_count(); i++ )
+	{
+		auto member = type->get_member(i);
+		auto llvm_member_typer = get_type(codegen, member.type);
+		if( !llvm_member_typer.ok() )
+			continue;
+		auto llvm_member_type = llvm_member_typer.unwrap();
+
+		auto offset = type->is_union_type() ? 0 : layout->getElementOffsetInBits(member.idx);
+
+		elements.push_back(builder.createMemberType(
+			composite,
+			member.name,
+			file,
+			0,
+			data_layout.getTypeAllocSizeInBits(llvm_member_type),
+			data_layout.getABITypeAlign(llvm_member_type).value() * 8,
+			offset,
+			llvm::DINode::FlagZero,
+			di_type(member.type)));
+	}
+
+	builder.replaceArrays(composite, builder.getOrCreateArray(elements));
+
+	return composite;
+}
+
+/**
+ * @brief Enums are described as they are laid out.
+ *
+ * struct MyEnum {
+ * 	MyEnumTag tag;
+ * 	union {
+ * 		...
+ * 	} payload;
+ * }
+ */
+llvm::DIType*
+CGDebugInfo::di_enum_type(sema::Type const* type)
+{
+	auto llvm_typer = get_base_type(codegen, type);
+	if( !llvm_typer.ok() )
+		return nullptr;
+	auto llvm_struct_type = llvm::cast<llvm::StructType>(llvm_typer.unwrap());
+
+	auto& data_layout = codegen.Module->getDataLayout();
+	auto layout = data_layout.getStructLayout(llvm_struct_type);
+
+	llvm::DICompositeType* composite = builder.createStructType(
+		file,
+		type->get_name(),
+		file,
+		0,
+		layout->getSizeInBits(),
+		layout->getAlignment().value() * 8,
+		llvm::DINode::FlagZero,
+		nullptr,
+		llvm::DINodeArray());
+
+	types.emplace(type, composite);
+
+	llvm::DICompositeType* payload = nullptr;
+	if( llvm_struct_type->getNumElements() > 1 )
+	{
+		auto llvm_payload_type = llvm_struct_type->getElementType(1);
+		payload = builder.createUnionType(
+			composite,
+			"",
+			file,
+			0,
+			data_layout.getTypeAllocSizeInBits(llvm_payload_type),
+			data_layout.getABITypeAlign(llvm_payload_type).value() * 8,
+			llvm::DINode::FlagZero,
+			llvm::DINodeArray());
+	}
+
+	Vec<llvm::Metadata*> enumerators;
+	Vec<llvm::Metadata*> variants;
+	for( int i = 0; i < type->get_member_count(); i++ )
+	{
+		auto member = type->get_member(i);
+		enumerators.push_back(
+			builder.createEnumerator(member.name, member.type.type->as_nominal().value));
+
+		if( !payload || !member.type.is_struct_type() )
+			continue;
+
+		auto llvm_member_typer = get_type(codegen, member.type);
+		if( !llvm_member_typer.ok() )
+			continue;
+		auto llvm_member_type = llvm_member_typer.unwrap();
+
+		variants.push_back(builder.createMemberType(
+			payload,
+			member.name,
+			file,
+			0,
+			data_layout.getTypeAllocSizeInBits(llvm_member_type),
+			data_layout.getABITypeAlign(llvm_member_type).value() * 8,
+			0,
+			llvm::DINode::FlagZero,
+			di_type(member.type)));
+	}
+
+	auto tag_type = builder.createEnumerationType(
+		composite,
+		type->get_name() + "Tag",
+		file,
+		0,
+		32,
+		32,
+		builder.getOrCreateArray(enumerators),
+		builder.createBasicType("i32", 32, llvm::dwarf::DW_ATE_signed));
+
+	Vec<llvm::Metadata*> elements;
+	elements.push_back(builder.createMemberType(
+		composite, "tag", file, 0, 32, 32, 0, llvm::DINode::FlagZero, tag_type));
+
+	if( payload )
+	{
+		builder.replaceArrays(payload, builder.getOrCreateArray(variants));
+		elements.push_back(builder.createMemberType(
+			composite,
+			"payload",
+			file,
+			0,
+			payload->getSizeInBits(),
+			payload->getAlignInBits(),
+			layout->getElementOffsetInBits(1),
+			llvm::DINode::FlagZero,
+			payload));
+	}
+
+	builder.replaceArrays(composite, builder.getOrCreateArray(elements));
+
+	return composite;
+}
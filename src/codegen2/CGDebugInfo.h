@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CGOptions.h"
+#include "ast2/AstNode.h"
+#include "common/String.h"
+#include "common/Vec.h"
+#include "lexer/Lexer.h"
+#include "sema2/TypeInstance.h"
+#include "sema2/type/Type.h"
+#include <llvm/IR/DIBuilder.h>
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/IR/Function.h>
+
+#include <map>
+
+namespace cg
+{
+class CG;
+
+/**
+ * @brief Emits DWARF debug info for a module.
+ *
+ * Source locations are taken from the first token of an ast node's span.
+ */
+class CGDebugInfo
+{
+	CG& codegen;
+	DebugInfoKind kind;
+	LexResult const& tokens;
+
+	llvm::DIBuilder builder;
+	llvm::DICompileUnit* compile_unit;
+	llvm::DIFile* file;
+
+	// Innermost scope is last.
+	Vec<llvm::DIScope*> scopes;
+	std::map<sema::Type const*, llvm::DIType*> types;
+
+public:
+	CGDebugInfo(CG&, DebugInfoKind kind, String const& filepath, LexResult const& tokens);
+
+	void begin_function(
+		llvm::Function* llvm_fn, String const& name, sema::Type const* fn_type, ast::AstNode* node);
+	void end_function();
+
+	void push_lexical_block(ast::AstNode* node);
+	void pop_lexical_block();
+
+	/**
+	 * @brief Sets the location of subsequent instructions to the start of node.
+	 */
+	void set_location(ast::AstNode* node);
+
+	void declare_param(
+		llvm::Value* storage, String const& name, int arg_no, sema::TypeInstance const& type);
+	void declare_local(
+		llvm::Value* storage, String const& name, sema::TypeInstance const& type, ast::AstNode*);
+
+	void finalize();
+
+private:
+	struct line_col_t
+	{
+		unsigned int line;
+		unsigned int col;
+	};
+	line_col_t line_col(ast::AstNode* node) const;
+
+	llvm::DIType* di_type(sema::TypeInstance const& type);
+	llvm::DIType* di_base_type(sema::Type const* type);
+	llvm::DIType* di_record_type(sema::Type const* type);
+	llvm::DIType* di_enum_type(sema::Type const* type);
+	llvm::DISubroutineType* di_fn_type(sema::Type const* fn_type);
+};
+
+} // namespace cg
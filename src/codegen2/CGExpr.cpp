@@ -1,16 +1,22 @@
 #include "CGExpr.h"
+
+#include <type_traits>
 using namespace cg;
 
+static_assert(std::is_trivially_copyable<CGExpr>::value);
+
 void
-CGExpr::add_discrimination(CGExpr expr)
+CGExpr::add_discrimination(LLVMAddress address)
 {
-	discriminations.push_back(expr);
+	assert(num_discriminations_ < max_discriminations);
+	discriminations_[num_discriminations_++] = address;
 }
 
-CGExpr
-CGExpr::get_discrimination(int ind)
+LLVMAddress
+CGExpr::get_discrimination(int ind) const
 {
-	return discriminations.at(ind);
+	assert(ind < num_discriminations_);
+	return discriminations_[ind];
 }
 
 CGExpr
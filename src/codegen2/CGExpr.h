@@ -14,11 +14,22 @@ enum class CGExprType
 	RValue,
 };
 
+/**
+ * @brief Result of codegen for an expression.
+ *
+ * Trivially copyable so that it can be returned by value without allocating.
+ */
 class CGExpr
 {
+public:
+	static constexpr int max_discriminations = 2;
+
+private:
 	CGExprType type = CGExprType::Empty;
 
-	Vec<CGExpr> discriminations;
+	// Addresses of the enums discriminated by this expression, e.g. the lhs of an 'is'.
+	unsigned char num_discriminations_ = 0;
+	LLVMAddress discriminations_[max_discriminations];
 
 	union
 	{
@@ -36,8 +47,8 @@ class CGExpr
 public:
 	CGExpr(){};
 
-	void add_discrimination(CGExpr expr);
-	CGExpr get_discrimination(int ind);
+	void add_discrimination(LLVMAddress address);
+	LLVMAddress get_discrimination(int ind) const;
 
 	static CGExpr MakeAddress(LValue addr);
 	static CGExpr MakeAddress(LLVMAddress addr);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "common/String.h"
+
+namespace cg
+{
+
+enum class DebugInfoKind
+{
+	None,
+	// -gline-tables-only
+	LineTablesOnly,
+	// -g
+	Full,
+};
+
+enum class ProfileKind
+{
+	None,
+	// -fprofile-generate[=<file>]
+	Generate,
+	// -fprofile-use=<file>
+	Use,
+};
+
+struct CGOptions
+{
+	// -O<n>, 0-3.
+	unsigned int opt_level = 0;
+
+	// --thinlto, optimize for and emit a summary for a later ThinLTO link.
+	bool thinlto = false;
+	// --save-temps, the ThinLTO link also writes the IR of each module after import and
+	// before codegen.
+	bool save_temps = false;
+
+	ProfileKind profile = ProfileKind::None;
+	// Indexed .profdata to read for ProfileKind::Use.
+	// For ProfileKind::Generate, the .profraw the instrumented binary writes;
+	// empty defers to the profile runtime (default.profraw, or $LLVM_PROFILE_FILE).
+	String profile_file;
+
+	DebugInfoKind debug_info = DebugInfoKind::None;
+
+	// Attach !tbaa metadata derived from sema types to loads and stores.
+	// Disable (-fno-strict-aliasing) for code that type puns through unions or pointer casts.
+	bool strict_aliasing = true;
+};
+
+} // namespace cg
@@ -0,0 +1,75 @@
+#include "CGPassPipeline.h"
+
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/PGOOptions.h>
+
+using namespace cg;
+
+static llvm::OptimizationLevel
+optimization_level(unsigned int opt_level)
+{
+	switch( opt_level )
+	{
+	case 0:
+		return llvm::OptimizationLevel::O0;
+	case 1:
+		return llvm::OptimizationLevel::O1;
+	case 2:
+		return llvm::OptimizationLevel::O2;
+	default:
+		return llvm::OptimizationLevel::O3;
+	}
+}
+
+static llvm::Optional<llvm::PGOOptions>
+pgo_options(CGOptions const& options)
+{
+	switch( options.profile )
+	{
+	case ProfileKind::Generate:
+		return llvm::PGOOptions(options.profile_file, "", "", llvm::PGOOptions::IRInstr);
+	case ProfileKind::Use:
+		return llvm::PGOOptions(options.profile_file, "", "", llvm::PGOOptions::IRUse);
+	case ProfileKind::None:
+		break;
+	}
+
+	return llvm::None;
+}
+
+void
+cg::run_pass_pipeline(
+	llvm::Module& module, llvm::TargetMachine* target_machine, CGOptions const& options)
+{
+	auto pgo = pgo_options(options);
+	// Async fns must always be split by the coroutine passes.
+	bool has_coroutines = module.getFunction("llvm.coro.id") != nullptr;
+	if( options.opt_level == 0 && !pgo.hasValue() && !has_coroutines )
+		return;
+
+	llvm::LoopAnalysisManager lam;
+	llvm::FunctionAnalysisManager fam;
+	llvm::CGSCCAnalysisManager cgam;
+	llvm::ModuleAnalysisManager mam;
+
+	llvm::PassBuilder pass_builder(target_machine, llvm::PipelineTuningOptions(), pgo);
+	pass_builder.registerModuleAnalyses(mam);
+	pass_builder.registerCGSCCAnalyses(cgam);
+	pass_builder.registerFunctionAnalyses(fam);
+	pass_builder.registerLoopAnalyses(lam);
+	pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
+
+	auto level = optimization_level(options.opt_level);
+
+	// The O0 pipeline still runs the PGO instrumentation/annotation and coroutine passes.
+	llvm::ModulePassManager mpm;
+	if( level == llvm::OptimizationLevel::O0 )
+		mpm = pass_builder.buildO0DefaultPipeline(level);
+	else if( options.thinlto )
+		// Leaves inlining and most simplification to the link.
+		mpm = pass_builder.buildThinLTOPreLinkDefaultPipeline(level);
+	else
+		mpm = pass_builder.buildPerModuleDefaultPipeline(level);
+	mpm.run(module, mam);
+}
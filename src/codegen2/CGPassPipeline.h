@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CGOptions.h"
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+namespace cg
+{
+
+/**
+ * @brief Runs the optimization pipeline for options.opt_level over module.
+ *
+ * With -fprofile-generate the module is instrumented with PGO counters, with
+ * -fprofile-use the profile is applied as branch weights and function entry counts.
+ * With --thinlto the ThinLTO pre-link pipeline is used instead.
+ * Does nothing at -O0 without a profile option.
+ */
+void run_pass_pipeline(
+	llvm::Module& module, llvm::TargetMachine* target_machine, CGOptions const& options);
+
+} // namespace cg
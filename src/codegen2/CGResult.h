@@ -5,7 +5,9 @@
 #include "common/String.h"
 #include "lexer/token.h"
 
+#include <cassert>
 #include <iostream>
+#include <memory>
 #include <optional>
 namespace cg
 {
@@ -36,10 +38,17 @@ public:
 	void print() const;
 };
 
+/**
+ * @brief A value or an error. Null when there is no error, so the success path never
+ * allocates. Results are copied around, so copies share the error.
+ */
 template<typename T>
 class CGResult
 {
-	OwnPtr<CGError> error = OwnPtr<CGError>::null();
+	template<typename>
+	friend class CGResult;
+
+	std::shared_ptr<CGError const> error;
 	std::optional<T> result;
 
 public:
@@ -67,15 +76,13 @@ public:
 	 * @param err
 	 */
 	CGResult<T>(CGError err)
-		: error(err){};
+		: error(std::make_shared<CGError const>(std::move(err))){};
 
 	/**
 	 * @brief For passing errors.
-	 * If this is somehow used to pass up a non-compatible non-error parse result,
+	 * If this is somehow used to pass up a non-compatible non-error result,
 	 * assert will throw.
 	 *
-	 * Strips the error out of the other parse result.
-	 *
 	 * ParseResult<IncompatibleType>
 	 * parse_inner() {
 	 * 		return ParseError("Bad parse");
@@ -97,19 +104,23 @@ public:
 		typename = std::enable_if_t<!std::is_base_of<T, TOther>::value>,
 		typename = void>
 	CGResult<T>(CGResult<TOther>&& other)
-		: error(std::move(other.unwrap_error()))
+		: error(std::move(other.error))
 	{
 		assert(
-			other.ok() &&
-			"Attempted to pass non-error result through non-polymorphic ParseResult. "
+			error != nullptr &&
+			"Attempted to pass non-error result through non-polymorphic CGResult. "
 			"Did you try returning a Statement from something expecting an Expression or "
 			"vice-versa?");
 	};
 
 	T unwrap() { return result.value(); }
-	OwnPtr<CGError> unwrap_error() { return std::move(error); }
+	OwnPtr<CGError> unwrap_error()
+	{
+		assert(!ok());
+		return OwnPtr<CGError>::of(*error);
+	}
 
-	bool ok() const { return error.is_null(); }
+	bool ok() const { return error == nullptr; }
 
 	static CGResult<T> Ok(T el) { return CGResult(el); }
 };
@@ -2,11 +2,15 @@
 
 #include "Codegen/CGNotImpl.h"
 #include "Codegen/RValue.h"
+#include "Codegen/cg_alloca.h"
+#include "Codegen/cg_coro.h"
 #include "Codegen/cg_discriminations.h"
 #include "Codegen/cg_division.h"
+#include "Codegen/cg_tbaa.h"
 #include "Codegen/codegen_addressof.h"
 #include "Codegen/codegen_array_access.h"
 #include "Codegen/codegen_assign.h"
+#include "Codegen/codegen_await.h"
 #include "Codegen/codegen_binop.h"
 #include "Codegen/codegen_call.h"
 #include "Codegen/codegen_deref.h"
@@ -25,69 +29,153 @@
 using namespace cg;
 using namespace ast;
 
-static String
-to_single_name(Vec<String*>* list)
+static void
+establish_llvm_builtin_types(CG& cg, sema::Types& types)
 {
-	auto name = String();
+	cg.types.resize(types.type_id_end(), nullptr);
+
+	cg.add_type(types.u8_type(), llvm::Type::getInt8Ty(*cg.Context));
+	cg.add_type(types.u16_type(), llvm::Type::getInt16Ty(*cg.Context));
+	cg.add_type(types.u32_type(), llvm::Type::getInt32Ty(*cg.Context));
+	cg.add_type(types.i8_type(), llvm::Type::getInt8Ty(*cg.Context));
+	cg.add_type(types.i16_type(), llvm::Type::getInt16Ty(*cg.Context));
+	cg.add_type(types.i32_type(), llvm::Type::getInt32Ty(*cg.Context));
+	cg.add_type(types.u64_type(), llvm::Type::getInt64Ty(*cg.Context));
+	cg.add_type(types.i64_type(), llvm::Type::getInt64Ty(*cg.Context));
+	cg.add_type(types.void_type(), llvm::Type::getVoidTy(*cg.Context));
+
+	// Futures are coroutine handles.
+	for( auto& [name, type] : types.types )
+		if( type.is_future_type() )
+			cg.add_type(&type, llvm::Type::getInt8PtrTy(*cg.Context));
+}
 
-	bool first = true;
-	for( auto part : *list )
-	{
-		if( !first )
-			name += "#";
-		name += *part;
+static sema::TargetLayout
+target_layout(llvm::DataLayout const& data_layout, llvm::LLVMContext& context)
+{
+	sema::TargetLayout target;
+	target.pointer_size = data_layout.getPointerSize();
+	target.pointer_align = data_layout.getPointerABIAlignment(0).value();
 
-		first = false;
+	unsigned int bits = 8;
+	for( auto& align : target.int_align )
+	{
+		align = data_layout.getABITypeAlign(llvm::IntegerType::get(context, bits)).value();
+		bits *= 2;
 	}
 
-	return name;
+	return target;
 }
 
-static void
-establish_llvm_builtin_types(
-	CG& cg, sema::Types& types, std::map<sema::Type const*, llvm::Type*>& lut)
+CG::CG(sema::Sema2& sema, CGOptions options, llvm::TargetMachine const& target)
+	: CG(sema, options, *new llvm::LLVMContext(), target)
 {
-	lut.emplace(types.u8_type(), llvm::Type::getInt8Ty(*cg.Context));
-	lut.emplace(types.u16_type(), llvm::Type::getInt16Ty(*cg.Context));
-	lut.emplace(types.u32_type(), llvm::Type::getInt32Ty(*cg.Context));
-	lut.emplace(types.i8_type(), llvm::Type::getInt8Ty(*cg.Context));
-	lut.emplace(types.i16_type(), llvm::Type::getInt16Ty(*cg.Context));
-	lut.emplace(types.i32_type(), llvm::Type::getInt32Ty(*cg.Context));
-	lut.emplace(types.void_type(), llvm::Type::getVoidTy(*cg.Context));
+	owned_context.reset(Context);
 }
 
-CG::CG(sema::Sema2& sema)
-	: sema(sema)
+CG::CG(
+	sema::Sema2& sema,
+	CGOptions options,
+	llvm::LLVMContext& context,
+	llvm::TargetMachine const& target)
+	: Context(&context)
+	, options(options)
+	, sema(sema)
 {
-	Context = std::make_unique<llvm::LLVMContext>();
 	Module = std::make_unique<llvm::Module>("this_module", *Context);
+	Module->setDataLayout(target.createDataLayout());
+	Module->setTargetTriple(target.getTargetTriple().str());
+	sema.types.set_target(target_layout(Module->getDataLayout(), *Context));
 	// Create a new builder for the module.
 	Builder = std::make_unique<llvm::IRBuilder<>>(*Context);
 	// TODO: Populate builtin types that automatically map the llvm types.
 
-	establish_llvm_builtin_types(*this, sema.types, this->types);
+	establish_llvm_builtin_types(*this, sema.types);
 }
 
-void
-CG::add_function(String const& name, LLVMFnSigInfo context)
+LLVMFnSigInfo const*
+CG::add_function(Symbol name, LLVMFnSigInfo context)
 {
-	Functions.emplace(name, context);
-	types.emplace(context.sema_fn_ty, context.llvm_fn_ty);
+	auto emplaced = Functions.emplace(name, context);
+	LLVMFnSigInfo const* sig_info = &emplaced.first->second;
+	add_type(sig_info->sema_fn_ty, sig_info->llvm_fn_ty);
 
-	auto lvalue = LValue(context.llvm_fn, context.llvm_fn_ty);
+	auto fn_type_id = sig_info->sema_fn_ty->id();
+	if( fn_type_id >= fn_sigs.size() )
+		fn_sigs.resize(fn_type_id + 1, nullptr);
+	if( fn_sigs[fn_type_id] == nullptr )
+		fn_sigs[fn_type_id] = sig_info;
+
+	auto lvalue = LValue(sig_info->llvm_fn, sig_info->llvm_fn_ty);
 	values.emplace(name, lvalue);
+
+	return sig_info;
+}
+
+LLVMFnSigInfo const*
+CG::find_function(sema::Type const* fn_type) const
+{
+	if( fn_type->id() < fn_sigs.size() )
+		return fn_sigs[fn_type->id()];
+	else
+		return nullptr;
+}
+
+void
+CG::add_type(sema::Type const* type, llvm::Type* llvm_type)
+{
+	assert(type->id() != 0 && "Type was not defined in sema::Types");
+	if( type->id() >= types.size() )
+		types.resize(type->id() + 1, nullptr);
+
+	// First definition wins.
+	if( types[type->id()] == nullptr )
+		types[type->id()] = llvm_type;
+}
+
+void
+CG::enable_debug_info(String const& filepath, LexResult const& tokens)
+{
+	if( options.debug_info == DebugInfoKind::None )
+		return;
+
+	debug_info = std::make_unique<CGDebugInfo>(*this, options.debug_info, filepath, tokens);
 }
 
 CGResult<CGExpr>
 CG::codegen_module(ir::IRModule* mod)
 {
+	// Every fn is declared before any body is generated, so a body may call a fn that
+	// is defined after it.
 	for( auto tls : *mod->stmts )
 	{
+		if( tls->type == ir::IRTopLevelType::Function )
+		{
+			auto protor = codegen_function_proto(*this, tls->stmt.fn->proto);
+			if( !protor.ok() )
+				return protor;
+		}
+		else
+		{
+			auto tlsr = codegen_tls(tls);
+			if( !tlsr.ok() )
+				return tlsr;
+		}
+	}
+
+	for( auto tls : *mod->stmts )
+	{
+		if( tls->type != ir::IRTopLevelType::Function )
+			continue;
+
 		auto tlsr = codegen_tls(tls);
 		if( !tlsr.ok() )
 			return tlsr;
 	}
 
+	if( debug_info )
+		debug_info->finalize();
+
 	return CGExpr();
 }
 
@@ -112,74 +200,85 @@ CG::codegen_tls(ir::IRTopLevelStmt* tls)
 }
 
 CGResult<CGExpr>
-CG::codegen_stmt(cg::LLVMFnInfo& fn, ir::IRStmt* stmt)
+CG::codegen_stmt(cg::LLVMFnInfo& fn, ir::StmtId id)
 {
-	switch( stmt->type )
+	auto& stmt = fn.body().stmt(id);
+	if( debug_info )
+		debug_info->set_location(stmt.node);
+
+	switch( stmt.type )
 	{
 	case ir::IRStmtType::ExprStmt:
-		return codegen_expr(fn, stmt->stmt.expr);
+		return codegen_expr_stmt(fn, stmt);
 	case ir::IRStmtType::Return:
-		return codegen_return(*this, fn, stmt->stmt.ret);
+		return codegen_return(*this, fn, stmt);
 	case ir::IRStmtType::Assign:
-		return codegen_assign(*this, fn, stmt->stmt.assign);
+		return codegen_assign(*this, fn, stmt);
 	case ir::IRStmtType::Let:
-		return codegen_let(fn, stmt->stmt.let);
+		return codegen_let(fn, stmt);
 	case ir::IRStmtType::If:
-		return codegen_if(fn, stmt->stmt.if_stmt);
+		return codegen_if(fn, stmt);
 	case ir::IRStmtType::For:
-		return codegen_for(fn, stmt->stmt.for_stmt);
+		return codegen_for(fn, stmt);
 	case ir::IRStmtType::While:
-		return codegen_while(*this, fn, stmt->stmt.while_stmt);
+		return codegen_while(*this, fn, stmt);
 	case ir::IRStmtType::Else:
-		return codegen_else(fn, stmt->stmt.else_stmt);
+		return codegen_else(fn, stmt);
 	case ir::IRStmtType::Block:
-		return codegen_block(fn, stmt->stmt.block);
+		return codegen_block(fn, stmt);
 	case ir::IRStmtType::Switch:
-		return codegen_switch(*this, fn, stmt->stmt.switch_stmt);
+		return codegen_switch(*this, fn, stmt);
 	case ir::IRStmtType::Case:
-		return codegen_case(*this, fn, stmt->stmt.case_stmt);
+		return codegen_case(*this, fn, stmt);
 	}
 
 	return NotImpl();
 }
 
 CGResult<CGExpr>
-CG::codegen_expr(cg::LLVMFnInfo& fn, ir::IRExpr* expr)
+CG::codegen_expr(cg::LLVMFnInfo& fn, ir::ExprId id)
 {
-	return codegen_expr(fn, expr, std::optional<LValue>());
+	return codegen_expr(fn, id, std::optional<LValue>());
 }
 
 CGResult<CGExpr>
-CG::codegen_expr(cg::LLVMFnInfo& fn, ir::IRExpr* expr, std::optional<LValue> lvalue)
+CG::codegen_expr(cg::LLVMFnInfo& fn, ir::ExprId id, std::optional<LValue> lvalue)
 {
-	switch( expr->type )
+	auto& expr = fn.body().expr(id);
+	switch( expr.type )
 	{
 	case ir::IRExprType::Call:
-		return codegen_call(*this, fn, expr->expr.call, lvalue);
+		if( debug_info )
+			debug_info->set_location(expr.node);
+		return codegen_call(*this, fn, expr, lvalue);
 	case ir::IRExprType::ArrayAccess:
-		return codegen_array_access(*this, fn, expr->expr.array_access);
+		return codegen_array_access(*this, fn, expr);
 	case ir::IRExprType::Id:
-		return codegen_id(expr->expr.id);
+		return codegen_id(expr);
 	case ir::IRExprType::NumberLiteral:
-		return codegen_number_literal(expr->expr.num_literal);
+		return codegen_number_literal(expr);
 	case ir::IRExprType::StringLiteral:
-		return codegen_string_literal(*this, expr->expr.str_literal);
+		return codegen_string_literal(*this, fn.body().strings[expr.data.index]);
 	case ir::IRExprType::ValueDecl:
-		return codegen_value_decl(expr->expr.decl);
+		return codegen_value_decl(expr);
 	case ir::IRExprType::BinOp:
-		return codegen_binop(*this, fn, expr->expr.binop);
+		return codegen_binop(*this, fn, expr);
 	case ir::IRExprType::MemberAccess:
-		return codegen_member_access(*this, fn, expr->expr.member_access);
+		return codegen_member_access(*this, fn, expr);
 	case ir::IRExprType::IndirectMemberAccess:
-		return codegen_indirect_member_access(*this, fn, expr->expr.indirect_member_access);
+		return codegen_indirect_member_access(*this, fn, expr);
 	case ir::IRExprType::AddressOf:
-		return codegen_addressof(*this, fn, expr->expr.addr_of);
+		return codegen_addressof(*this, fn, expr);
 	case ir::IRExprType::Deref:
-		return codegen_deref(*this, fn, expr->expr.deref);
+		return codegen_deref(*this, fn, expr);
 	case ir::IRExprType::Is:
-		return codegen_is(*this, fn, expr->expr.is);
+		return codegen_is(*this, fn, expr);
 	case ir::IRExprType::Initializer:
-		return codegen_initializer(*this, fn, expr->expr.initializer, lvalue);
+		return codegen_initializer(*this, fn, expr, lvalue);
+	case ir::IRExprType::Await:
+		if( debug_info )
+			debug_info->set_location(expr.node);
+		return codegen_await(*this, fn, expr);
 	case ir::IRExprType::Empty:
 		return CGExpr();
 	}
@@ -187,17 +286,36 @@ CG::codegen_expr(cg::LLVMFnInfo& fn, ir::IRExpr* expr, std::optional<LValue> lva
 	return NotImpl();
 }
 
+CGResult<CGExpr>
+CG::codegen_expr_stmt(cg::LLVMFnInfo& fn, ir::FlatStmt const& stmt)
+{
+	auto exprr = codegen_expr(fn, stmt.expr);
+	if( !exprr.ok() )
+		return exprr;
+	auto expr = exprr.unwrap();
+
+	// Nothing can await a discarded future, so it is dropped right away.
+	if( cg_coro_is_future(fn.body().expr(stmt.expr).type_instance) )
+		Builder->CreateCall(cg_coro_drop_fn(*this), {codegen_operand_expr(*this, expr)});
+
+	return CGExpr();
+}
+
 CGResult<CGExpr>
 CG::codegen_extern_fn(ir::IRExternFn* extern_fn)
 {
-	return codegen_function_proto(*this, extern_fn->proto);
+	auto protor = codegen_function_proto(*this, extern_fn->proto);
+	if( !protor.ok() )
+		return protor;
+
+	return CGExpr();
 }
 
 CGResult<CGExpr>
-CG::codegen_let(cg::LLVMFnInfo& fn, ir::IRLet* ir_let)
+CG::codegen_let(cg::LLVMFnInfo& fn, ir::FlatStmt const& let)
 {
-	auto name = ir_let->name;
-	auto type = ir_let->type_instance;
+	auto& name = let.name.str();
+	auto type = let.type_instance;
 
 	auto storage_type = type.storage_type();
 
@@ -206,13 +324,27 @@ CG::codegen_let(cg::LLVMFnInfo& fn, ir::IRLet* ir_let)
 		return typer;
 	auto llvm_allocated_type = typer.unwrap();
 
-	llvm::AllocaInst* llvm_alloca = Builder->CreateAlloca(llvm_allocated_type, nullptr, *name);
-	auto lvalue = LValue(llvm_alloca, llvm_allocated_type);
-	values.insert_or_assign(*name, lvalue);
+	llvm::AllocaInst* llvm_alloca = cg_alloca(*this, llvm_allocated_type, name);
+	auto lvalue = LValue(LLVMAddress(llvm_alloca, llvm_allocated_type)
+							 .with_tbaa(cg_tbaa_access_tag(*this, type)));
+	values.insert_or_assign(let.name, lvalue);
+
+	if( debug_info )
+		debug_info->declare_local(llvm_alloca, name, type, let.node);
 
-	if( !ir_let->is_empty() )
+	// Null until assigned so the drop at the end of the block is a no-op.
+	if( cg_coro_is_future(type) )
 	{
-		auto assignr = codegen_assign(*this, fn, ir_let->assign);
+		Builder->CreateStore(
+			llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(llvm_allocated_type)),
+			llvm_alloca);
+		fn.add_future(llvm_alloca);
+	}
+
+	// Empty lets have no initializing assign.
+	if( let.body.valid() )
+	{
+		auto assignr = codegen_assign(*this, fn, fn.body().stmt(let.body));
 		if( !assignr.ok() )
 			return assignr;
 	}
@@ -221,28 +353,29 @@ CG::codegen_let(cg::LLVMFnInfo& fn, ir::IRLet* ir_let)
 }
 
 CGResult<CGExpr>
-CG::codegen_number_literal(ir::IRNumberLiteral* lit)
+CG::codegen_number_literal(ir::FlatExpr const& lit)
 {
 	//
-	llvm::Value* llvm_const_int = llvm::ConstantInt::get(*Context, llvm::APInt(32, lit->val, true));
+	llvm::Value* llvm_const_int =
+		llvm::ConstantInt::get(*Context, llvm::APInt(32, lit.data.number, true));
 
 	return CGExpr::MakeRValue(RValue(llvm_const_int, llvm_const_int->getType()));
 }
 
 CGResult<CGExpr>
-CG::codegen_value_decl(ir::IRValueDecl* decl)
+CG::codegen_value_decl(ir::FlatExpr const& decl)
 {
-	auto valuer = get_value(*this, *decl->name);
+	auto valuer = get_value(*this, decl.data.symbol);
 	assert(valuer.has_value());
 
 	return CGExpr::MakeAddress(valuer.value().address());
 }
 
 CGResult<CGExpr>
-CG::codegen_id(ir::IRId* id)
+CG::codegen_id(ir::FlatExpr const& id)
 {
 	// auto iter_type = types.find(id->type_instance.type);
-	auto value = get_value(*this, to_single_name(id->name));
+	auto value = get_value(*this, id.data.symbol);
 	if( value.has_value() )
 		return CGExpr::MakeAddress(value.value().address());
 
@@ -255,14 +388,14 @@ CG::codegen_id(ir::IRId* id)
 	// if( maybe_type.ok() )
 	// 	return CGExpr();
 
-	return CGError("Undeclared identifier! " + to_single_name(id->name));
+	return CGError("Undeclared identifier! " + id.data.symbol.str());
 }
 
 CGResult<CGExpr>
-CG::codegen_if(cg::LLVMFnInfo& fn, ir::IRIf* ir_if)
+CG::codegen_if(cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_if)
 {
 	//
-	auto exprr = codegen_expr(fn, ir_if->expr);
+	auto exprr = codegen_expr(fn, ir_if.expr);
 	if( !exprr.ok() )
 		return exprr;
 	auto cond_expr = exprr.unwrap();
@@ -291,10 +424,9 @@ CG::codegen_if(cg::LLVMFnInfo& fn, ir::IRIf* ir_if)
 	Builder->SetInsertPoint(llvm_then_bb);
 
 	// Inject any discriminations
-	if( ir_if->discriminations )
-		cg_discriminations(*this, cond_expr, *ir_if->discriminations);
+	cg_discriminations(*this, fn, cond_expr, ir_if.bindings);
 
-	auto then_stmtr = codegen_stmt(fn, ir_if->stmt);
+	auto then_stmtr = codegen_stmt(fn, ir_if.body);
 	if( !then_stmtr.ok() )
 		return then_stmtr;
 
@@ -302,9 +434,9 @@ CG::codegen_if(cg::LLVMFnInfo& fn, ir::IRIf* ir_if)
 	llvm_fn->getBasicBlockList().push_back(llvm_else_bb);
 	Builder->SetInsertPoint(llvm_else_bb);
 
-	if( ir_if->else_stmt != nullptr )
+	if( ir_if.else_stmt.valid() )
 	{
-		auto then_stmtr = codegen_else(fn, ir_if->else_stmt);
+		auto then_stmtr = codegen_else(fn, fn.body().stmt(ir_if.else_stmt));
 		if( !then_stmtr.ok() )
 			return then_stmtr;
 	}
@@ -322,9 +454,9 @@ CG::codegen_if(cg::LLVMFnInfo& fn, ir::IRIf* ir_if)
 }
 
 CGResult<CGExpr>
-CG::codegen_for(cg::LLVMFnInfo& fn, ir::IRFor* ir_for)
+CG::codegen_for(cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_for)
 {
-	auto forr = codegen_stmt(fn, ir_for->init);
+	auto forr = codegen_stmt(fn, ir_for.init);
 	if( !forr.ok() )
 		return forr;
 	auto for_stmt = forr.unwrap();
@@ -339,7 +471,7 @@ CG::codegen_for(cg::LLVMFnInfo& fn, ir::IRFor* ir_for)
 	Builder->CreateBr(llvm_cond_bb);
 	Builder->SetInsertPoint(llvm_cond_bb);
 
-	auto condr = codegen_expr(fn, ir_for->condition);
+	auto condr = codegen_expr(fn, ir_for.expr);
 	if( !condr.ok() )
 		return condr;
 	auto cond = condr.unwrap();
@@ -350,12 +482,12 @@ CG::codegen_for(cg::LLVMFnInfo& fn, ir::IRFor* ir_for)
 	llvm_fn->getBasicBlockList().push_back(llvm_loop_bb);
 	Builder->SetInsertPoint(llvm_loop_bb);
 
-	auto bodyr = codegen_stmt(fn, ir_for->body);
+	auto bodyr = codegen_stmt(fn, ir_for.body);
 	if( !bodyr.ok() )
 		return bodyr;
 	auto body = bodyr.unwrap();
 
-	auto endr = codegen_stmt(fn, ir_for->end);
+	auto endr = codegen_stmt(fn, ir_for.step);
 	if( !endr.ok() )
 		return endr;
 	auto end = endr.unwrap();
@@ -369,27 +501,40 @@ CG::codegen_for(cg::LLVMFnInfo& fn, ir::IRFor* ir_for)
 }
 
 CGResult<CGExpr>
-CG::codegen_else(cg::LLVMFnInfo& fn, ir::IRElse* ir_else)
+CG::codegen_else(cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_else)
 {
 	//
-	return codegen_stmt(fn, ir_else->stmt);
+	return codegen_stmt(fn, ir_else.body);
 }
 
 CGResult<CGExpr>
-CG::codegen_block(cg::LLVMFnInfo& fn, ir::IRBlock* ir_block)
+CG::codegen_block(cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_block)
 {
 	//
 	auto restore_merge = fn.merge_block();
 	fn.clear_merge_block();
 
 	auto previous_scope = this->values;
-	for( auto stmt : *ir_block->stmts )
+	fn.push_future_scope();
+	if( debug_info )
+		debug_info->push_lexical_block(ir_block.node);
+
+	auto& body = fn.body();
+	for( std::uint32_t i = 0; i < ir_block.children.size; i++ )
 	{
 		//
-		auto stmtr = codegen_stmt(fn, stmt);
+		auto stmtr = codegen_stmt(fn, body.child_stmt(ir_block.children, i));
 		if( !stmtr.ok() )
 			return stmtr;
 	}
+
+	// Blocks that end in a return already dropped their futures.
+	auto futures = fn.pop_future_scope();
+	if( Builder->GetInsertBlock()->getTerminator() == nullptr )
+		cg_coro_drop(*this, futures);
+
+	if( debug_info )
+		debug_info->pop_lexical_block();
 	this->values = previous_scope;
 	fn.set_merge_block(restore_merge);
 
@@ -418,7 +563,7 @@ CG::codegen_struct(ir::IRStruct* st)
 	auto name = struct_type->get_name();
 	llvm::StructType* llvm_struct_type = llvm::StructType::create(*Context, members, name);
 
-	this->types.emplace(struct_type, llvm_struct_type);
+	add_type(struct_type, llvm_struct_type);
 
 	return CGExpr();
 }
@@ -427,7 +572,7 @@ CGResult<CGExpr>
 CG::codegen_union(ir::IRUnion* st)
 {
 	llvm::Type* max_type_by_size = nullptr;
-	int max_size = 0;
+	unsigned int max_size = 0;
 	for( auto& member : *st->members )
 	{
 		auto value_decl = member.second;
@@ -437,11 +582,12 @@ CG::codegen_union(ir::IRUnion* st)
 
 		auto llvm_type = typerr.unwrap();
 
-		auto llvm_size = Module->getDataLayout().getTypeAllocSize(llvm_type);
-		if( llvm_size.getKnownMinSize() > max_size )
+		auto size = sema.types.layout(value_decl->type_decl->type_instance).size;
+		assert(size == Module->getDataLayout().getTypeAllocSize(llvm_type).getKnownMinSize());
+		if( size > max_size )
 		{
 			max_type_by_size = llvm_type;
-			max_size = llvm_size.getKnownMinSize();
+			max_size = size;
 		}
 	}
 
@@ -451,7 +597,7 @@ CG::codegen_union(ir::IRUnion* st)
 	auto name = union_type->get_name();
 	llvm::StructType* llvm_union_type = llvm::StructType::create(*Context, members, name);
 
-	this->types.emplace(union_type, llvm_union_type);
+	add_type(union_type, llvm_union_type);
 
 	return CGExpr();
 }
@@ -476,10 +622,10 @@ CGResult<CGExpr>
 CG::codegen_enum(ir::IREnum* st)
 {
 	llvm::Type* llvm_max_type_by_size = nullptr;
-	int max_size = 0;
+	unsigned int max_size = 0;
 
 	llvm::Type* llvm_current_type = nullptr;
-	int current_type_size = 0;
+	unsigned int current_type_size = 0;
 	for( auto& member : *st->members )
 	{
 		auto enum_member = member.second;
@@ -490,13 +636,15 @@ CG::codegen_enum(ir::IREnum* st)
 			if( !cg.ok() )
 				return cg;
 
-			auto typer = get_type(
-				*this, sema::TypeInstance::OfType(enum_member->struct_member->struct_type));
+			auto member_type = sema::TypeInstance::OfType(enum_member->struct_member->struct_type);
+			auto typer = get_type(*this, member_type);
 			if( !typer.ok() )
 				return typer;
 			llvm_current_type = typer.unwrap();
-			auto llvm_size = Module->getDataLayout().getTypeAllocSize(llvm_current_type);
-			current_type_size = llvm_size.getKnownMinSize();
+			current_type_size = sema.types.layout(member_type).size;
+			assert(
+				current_type_size ==
+				Module->getDataLayout().getTypeAllocSize(llvm_current_type).getKnownMinSize());
 		}
 		else
 		{
@@ -519,7 +667,7 @@ CG::codegen_enum(ir::IREnum* st)
 	auto name = enum_type->get_name();
 	llvm::StructType* llvm_struct_type = llvm::StructType::create(*Context, members, name);
 
-	this->types.emplace(enum_type, llvm_struct_type);
+	add_type(enum_type, llvm_struct_type);
 
 	return CGExpr();
 }
@@ -527,9 +675,8 @@ CG::codegen_enum(ir::IREnum* st)
 std::optional<llvm::Type*>
 CG::find_type(sema::Type const* ty)
 {
-	auto t = types.find(ty);
-	if( t != types.end() )
-		return t->second;
+	if( ty->id() < types.size() && types[ty->id()] != nullptr )
+		return types[ty->id()];
 	else
 		return std::optional<llvm::Type*>();
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
+#include "CGDebugInfo.h"
 #include "CGExpr.h"
+#include "CGOptions.h"
 #include "CGResult.h"
 #include "Codegen/LLVMFnInfo.h"
 #include "LValue.h"
@@ -7,6 +9,8 @@
 #include "ast2/Ast.h"
 #include "ast2/AstNode.h"
 #include "common/String.h"
+#include "common/Symbol.h"
+#include "sema2/FlatIR.h"
 #include "sema2/IR.h"
 #include "sema2/Scope.h"
 #include "sema2/Sema2.h"
@@ -15,10 +19,12 @@
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Value.h>
+#include <llvm/Target/TargetMachine.h>
 
 #include <map>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 
 namespace cg
 {
@@ -26,42 +32,71 @@ namespace cg
 class CG
 {
 public:
-	std::map<std::string, LLVMFnSigInfo> Functions;
-	std::unique_ptr<llvm::LLVMContext> Context;
+	// Owns the signatures. Node based, so handles into it are stable.
+	std::unordered_map<Symbol, LLVMFnSigInfo> Functions;
+	// Signature handles indexed by the sema::Type::id of the function type.
+	Vec<LLVMFnSigInfo const*> fn_sigs;
+	// Null if the context was passed in.
+	std::unique_ptr<llvm::LLVMContext> owned_context;
+	llvm::LLVMContext* Context;
 	std::unique_ptr<llvm::IRBuilder<>> Builder;
 
 	std::unique_ptr<llvm::Module> Module;
 	// TODO: Need scoping on these types.
-	std::map<sema::Type const*, llvm::Type*> types;
-	std::map<String, LValue> values;
+	// Indexed by sema::Type::id. Null if not yet emitted.
+	Vec<llvm::Type*> types;
+	std::unordered_map<Symbol, LValue> values;
+	// TBAA type descriptors. See Codegen/cg_tbaa.h
+	std::map<sema::Type const*, llvm::MDNode*> tbaa_types;
+
+	CGOptions options;
+	// Null unless debug info is enabled.
+	std::unique_ptr<CGDebugInfo> debug_info;
 
 	// Vec<cg::Scope> scopes;
 	// Scope* current_scope;
 
 	sema::Sema2& sema;
-	CG(sema::Sema2& sema);
+	/**
+	 * @brief The module gets the data layout and triple of the target before anything is
+	 * emitted, so sizes, offsets and alignments in the IR, debug info and TBAA are the
+	 * ones of the object.
+	 */
+	CG(sema::Sema2& sema, CGOptions options, llvm::TargetMachine const& target);
+	/**
+	 * @brief Emits into a context of the caller, which must outlive the CG.
+	 */
+	CG(
+		sema::Sema2& sema,
+		CGOptions options,
+		llvm::LLVMContext& context,
+		llvm::TargetMachine const& target);
 
 	// Scope* push_scope();
 	// void pop_scope();
 
-	void add_function(String const& name, LLVMFnSigInfo);
+	LLVMFnSigInfo const* add_function(Symbol name, LLVMFnSigInfo);
+	LLVMFnSigInfo const* find_function(sema::Type const* fn_type) const;
+	void add_type(sema::Type const* type, llvm::Type* llvm_type);
+	void enable_debug_info(String const& filepath, LexResult const& tokens);
 
 	CGResult<CGExpr> codegen_module(ir::IRModule*);
 	CGResult<CGExpr> codegen_tls(ir::IRTopLevelStmt*);
-	CGResult<CGExpr> codegen_stmt(cg::LLVMFnInfo&, ir::IRStmt*);
-	CGResult<CGExpr> codegen_expr(cg::LLVMFnInfo&, ir::IRExpr*);
-	CGResult<CGExpr> codegen_expr(cg::LLVMFnInfo&, ir::IRExpr*, std::optional<LValue>);
+	CGResult<CGExpr> codegen_stmt(cg::LLVMFnInfo&, ir::StmtId);
+	CGResult<CGExpr> codegen_expr(cg::LLVMFnInfo&, ir::ExprId);
+	CGResult<CGExpr> codegen_expr(cg::LLVMFnInfo&, ir::ExprId, std::optional<LValue>);
+	CGResult<CGExpr> codegen_expr_stmt(cg::LLVMFnInfo&, ir::FlatStmt const&);
 	CGResult<CGExpr> codegen_extern_fn(ir::IRExternFn*);
-	CGResult<CGExpr> codegen_let(cg::LLVMFnInfo&, ir::IRLet*);
+	CGResult<CGExpr> codegen_let(cg::LLVMFnInfo&, ir::FlatStmt const&);
 
 	// TODO: Return RValue type?
-	CGResult<CGExpr> codegen_number_literal(ir::IRNumberLiteral*);
-	CGResult<CGExpr> codegen_value_decl(ir::IRValueDecl*);
-	CGResult<CGExpr> codegen_id(ir::IRId*);
-	CGResult<CGExpr> codegen_if(cg::LLVMFnInfo&, ir::IRIf*);
-	CGResult<CGExpr> codegen_for(cg::LLVMFnInfo&, ir::IRFor*);
-	CGResult<CGExpr> codegen_else(cg::LLVMFnInfo&, ir::IRElse*);
-	CGResult<CGExpr> codegen_block(cg::LLVMFnInfo&, ir::IRBlock*);
+	CGResult<CGExpr> codegen_number_literal(ir::FlatExpr const&);
+	CGResult<CGExpr> codegen_value_decl(ir::FlatExpr const&);
+	CGResult<CGExpr> codegen_id(ir::FlatExpr const&);
+	CGResult<CGExpr> codegen_if(cg::LLVMFnInfo&, ir::FlatStmt const&);
+	CGResult<CGExpr> codegen_for(cg::LLVMFnInfo&, ir::FlatStmt const&);
+	CGResult<CGExpr> codegen_else(cg::LLVMFnInfo&, ir::FlatStmt const&);
+	CGResult<CGExpr> codegen_block(cg::LLVMFnInfo&, ir::FlatStmt const&);
 	CGResult<CGExpr> codegen_struct(ir::IRStruct* st);
 	CGResult<CGExpr> codegen_union(ir::IRUnion* st);
 	CGResult<CGExpr> codegen_enum(ir::IREnum* st);
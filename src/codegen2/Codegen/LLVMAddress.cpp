@@ -56,6 +56,20 @@ LLVMAddress::llvm_pointer() const
 	return this->pointer;
 }
 
+llvm::MDNode*
+LLVMAddress::tbaa() const
+{
+	return this->tbaa_;
+}
+
+LLVMAddress
+LLVMAddress::with_tbaa(llvm::MDNode* tbaa) const
+{
+	LLVMAddress address = *this;
+	address.tbaa_ = tbaa;
+	return address;
+}
+
 LLVMAddress
 LLVMAddress::fixup() const
 {
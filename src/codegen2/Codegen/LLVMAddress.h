@@ -1,5 +1,6 @@
 #pragma once
 
+#include <llvm/IR/Metadata.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
 
@@ -42,13 +43,21 @@ class LLVMAddress
 	// This is a pointer to the containing enum.
 	std::optional<LLVMFixup> fixup_;
 
+	// TBAA access tag for loads and stores through this address.
+	// nullptr if the access may alias anything. See cg_tbaa.h
+	llvm::MDNode* tbaa_ = nullptr;
+
 public:
+	LLVMAddress() = default;
 	LLVMAddress(llvm::Value* ptr, llvm::Type* allocated_type);
 	LLVMAddress(llvm::Value*, llvm::Type*, LLVMFixup);
 
 	llvm::Type* llvm_allocated_type() const;
 	llvm::Value* llvm_pointer() const;
 
+	llvm::MDNode* tbaa() const;
+	LLVMAddress with_tbaa(llvm::MDNode*) const;
+
 	// TODO: Better name
 	LLVMAddress fixup() const;
 	std::optional<LLVMFixup> fixup_info() const;
@@ -4,6 +4,7 @@
 #include "../Scope.h"
 #include "LLVMFnSigInfo.h"
 #include "common/Vec.h"
+#include "sema2/FlatIR.h"
 #include "sema2/type/Type.h"
 #include <llvm-c/Core.h>
 #include <llvm/IR/Function.h>
@@ -58,6 +59,26 @@ struct LLVMSwitchInfo
 	llvm::BasicBlock* default_bb() const { return default_block_; }
 };
 
+/**
+ * @brief State of an async fn being lowered to a switched-resume coroutine.
+ * See cg_coro.h
+ */
+struct LLVMCoroInfo
+{
+	// Token returned by llvm.coro.id
+	llvm::Value* id;
+	// Handle returned by llvm.coro.begin. This is the future returned to the caller.
+	llvm::Value* handle;
+	// Holds the result. None if the result is void.
+	std::optional<LLVMAddress> promise;
+	// Returns store the result and branch here.
+	llvm::BasicBlock* final_bb;
+	// Frees the frame. Reached when the coroutine is destroyed.
+	llvm::BasicBlock* cleanup_bb;
+	// Returns the handle to the caller or resumer.
+	llvm::BasicBlock* suspend_bb;
+};
+
 /**
  * @brief Contains the llvm argument values and their.
  *
@@ -71,6 +92,10 @@ struct LLVMFnInfo
 	std::optional<LLVMFnArgInfo> sret_arg;
 	std::optional<llvm::BasicBlock*> merge_block_;
 	std::optional<LLVMSwitchInfo> switch_info_;
+	std::optional<LLVMCoroInfo> coro_;
+	ir::FlatFunction const* body_ = nullptr;
+	// Allocas of the future lets of each enclosing block, innermost last.
+	Vec<Vec<llvm::Value*>> future_scopes_;
 
 	LLVMFnInfo(
 		LLVMFnSigInfo sig_info,
@@ -82,6 +107,31 @@ struct LLVMFnInfo
 
 	llvm::Function* llvm_fn() const { return sig_info.llvm_fn; }
 
+	ir::FlatFunction const& body() const { return *body_; }
+
+	// Set if this is an async fn.
+	std::optional<LLVMCoroInfo> const& coro() const { return coro_; }
+	void set_coro(LLVMCoroInfo coro) { coro_ = coro; }
+	void set_body(ir::FlatFunction const* body) { body_ = body; }
+
+	// Futures that are still owned when a block ends are dropped, see cg_coro_drop.
+	void push_future_scope() { future_scopes_.emplace_back(); }
+	Vec<llvm::Value*> pop_future_scope()
+	{
+		auto slots = future_scopes_.back();
+		future_scopes_.pop_back();
+		return slots;
+	}
+	void add_future(llvm::Value* llvm_slot) { future_scopes_.back().push_back(llvm_slot); }
+	// The futures of every enclosing block, for returns.
+	Vec<llvm::Value*> all_futures() const
+	{
+		Vec<llvm::Value*> slots;
+		for( auto& scope : future_scopes_ )
+			slots.insert(slots.end(), scope.begin(), scope.end());
+		return slots;
+	}
+
 	// TODO: This is inviting bad code.
 	// How to keep track of if - else if - chains, without
 	// creating a huge chain of merge blocks.
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Scope.h"
+#include "ast2/Attributes.h"
 #include "common/String.h"
 #include "common/Vec.h"
 #include "sema2/type/Type.h"
@@ -40,9 +41,16 @@ struct LLVMArgABIInfo
 	Kind attr = Default;
 	llvm::Type* llvm_type;
 
+	// User specified attributes, e.g. @noalias.
+	ast::AttributeSet attributes = ast::AttributeSet::None();
+
 	LLVMArgABIInfo(Kind attr, llvm::Type* llvm_type)
 		: attr(attr)
 		, llvm_type(llvm_type){};
+	LLVMArgABIInfo(Kind attr, llvm::Type* llvm_type, ast::AttributeSet attributes)
+		: attr(attr)
+		, llvm_type(llvm_type)
+		, attributes(attributes){};
 
 	bool is_sret() const { return attr == SRet; }
 
@@ -41,6 +41,12 @@ LLVMFnSigInfoBuilder::set_llvm_ret_ty(llvm::Type* llvm_ret_ty)
 	this->llvm_ret_ty = llvm_ret_ty;
 }
 
+void
+LLVMFnSigInfoBuilder::set_fn_attributes(ast::AttributeSet attributes)
+{
+	this->fn_attributes = attributes;
+}
+
 void
 LLVMFnSigInfoBuilder::set_is_var_arg(bool is)
 {
@@ -27,6 +27,7 @@ public:
 	String name;
 	llvm::Type* llvm_ret_ty;
 	LLVMFnSigRetType ret_type = LLVMFnSigRetType::Default;
+	ast::AttributeSet fn_attributes = ast::AttributeSet::None();
 
 	LLVMFnSigInfoBuilder(String name, sema::Type const* sema_ty);
 
@@ -35,6 +36,7 @@ public:
 	LLVMArgABIInfo arg_type(int idx);
 
 	void set_llvm_ret_ty(llvm::Type*);
+	void set_fn_attributes(ast::AttributeSet);
 
 	void set_is_var_arg(bool);
 	bool is_var_arg(void) const;
@@ -1,6 +1,7 @@
 #include "cg_access.h"
 
 #include "../Codegen.h"
+#include "cg_tbaa.h"
 #include "lookup.h"
 
 using namespace cg;
@@ -22,17 +23,21 @@ cg::cg_access(
 		return llvm_member_tyr;
 	auto llvm_member_type = llvm_member_tyr.unwrap();
 
+	auto tbaa = cg_tbaa_member_access_tag(codegen, address, type, member);
+
 	if( type.is_struct_type() )
 	{
 		auto llvm_member_value =
 			codegen.Builder->CreateStructGEP(llvm_expr_type, llvm_expr_value, member.idx);
 
-		return CGExpr::MakeAddress(LLVMAddress(llvm_member_value, llvm_member_type));
+		return CGExpr::MakeAddress(
+			LLVMAddress(llvm_member_value, llvm_member_type).with_tbaa(tbaa));
 	}
 	else
 	{
 		auto llvm_member_value =
 			codegen.Builder->CreateBitCast(llvm_expr_value, llvm_member_type->getPointerTo());
-		return CGExpr::MakeAddress(LLVMAddress(llvm_member_value, llvm_member_type));
+		return CGExpr::MakeAddress(
+			LLVMAddress(llvm_member_value, llvm_member_type).with_tbaa(tbaa));
 	}
 }
\ No newline at end of file
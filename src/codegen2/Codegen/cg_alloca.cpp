@@ -0,0 +1,14 @@
+#include "cg_alloca.h"
+
+#include "../Codegen.h"
+
+using namespace cg;
+
+llvm::AllocaInst*
+cg::cg_alloca(CG& codegen, llvm::Type* llvm_type, llvm::Twine const& name)
+{
+	auto& llvm_entry = codegen.Builder->GetInsertBlock()->getParent()->getEntryBlock();
+
+	llvm::IRBuilder<> entry_builder(&llvm_entry, llvm_entry.begin());
+	return entry_builder.CreateAlloca(llvm_type, nullptr, name);
+}
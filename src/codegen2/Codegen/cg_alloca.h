@@ -0,0 +1,18 @@
+#pragma once
+
+#include <llvm/ADT/Twine.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Type.h>
+
+namespace cg
+{
+class CG;
+
+/**
+ * @brief Allocates a local in the entry block of the fn being emitted.
+ *
+ * Allocas outside the entry block grow the stack each time they run, for example
+ * in a loop, and are not promoted to registers by mem2reg.
+ */
+llvm::AllocaInst* cg_alloca(CG&, llvm::Type* llvm_type, llvm::Twine const& name = "");
+} // namespace cg
@@ -1,6 +1,7 @@
 #include "cg_copy.h"
 
 #include "../Codegen.h"
+#include "cg_alloca.h"
 #include "cg_fixdown.h"
 
 using namespace cg;
@@ -11,8 +12,7 @@ cg::cg_copy(CG& codegen, LLVMAddress& src)
 	//
 	auto src_address = src.fixup();
 
-	llvm::AllocaInst* llvm_cpy_alloca =
-		codegen.Builder->CreateAlloca(src_address.llvm_allocated_type(), nullptr);
+	llvm::AllocaInst* llvm_cpy_alloca = cg_alloca(codegen, src_address.llvm_allocated_type());
 	auto llvm_size =
 		codegen.Module->getDataLayout().getTypeAllocSize(src_address.llvm_allocated_type());
 	auto llvm_align =
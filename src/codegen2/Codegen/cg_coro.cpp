@@ -0,0 +1,178 @@
+#include "cg_coro.h"
+
+#include "../Codegen.h"
+#include "lookup.h"
+
+#include <llvm/IR/Intrinsics.h>
+
+using namespace cg;
+
+static llvm::Type*
+i8_ptr_ty(CG& codegen)
+{
+	return llvm::Type::getInt8PtrTy(*codegen.Context);
+}
+
+static llvm::FunctionCallee
+coro_alloc_fn(CG& codegen)
+{
+	return codegen.Module->getOrInsertFunction(
+		"sushi_coro_alloc", i8_ptr_ty(codegen), llvm::Type::getInt64Ty(*codegen.Context));
+}
+
+static llvm::FunctionCallee
+coro_free_fn(CG& codegen)
+{
+	return codegen.Module->getOrInsertFunction(
+		"sushi_coro_free", llvm::Type::getVoidTy(*codegen.Context), i8_ptr_ty(codegen));
+}
+
+llvm::FunctionCallee
+cg::cg_coro_await_fn(CG& codegen)
+{
+	return codegen.Module->getOrInsertFunction(
+		"sushi_await",
+		llvm::Type::getVoidTy(*codegen.Context),
+		i8_ptr_ty(codegen),
+		i8_ptr_ty(codegen));
+}
+
+llvm::FunctionCallee
+cg::cg_coro_block_on_fn(CG& codegen)
+{
+	return codegen.Module->getOrInsertFunction(
+		"sushi_block_on",
+		llvm::Type::getVoidTy(*codegen.Context),
+		i8_ptr_ty(codegen)->getPointerTo(),
+		llvm::Type::getInt32Ty(*codegen.Context));
+}
+
+llvm::FunctionCallee
+cg::cg_coro_drop_fn(CG& codegen)
+{
+	return codegen.Module->getOrInsertFunction(
+		"sushi_drop", llvm::Type::getVoidTy(*codegen.Context), i8_ptr_ty(codegen));
+}
+
+bool
+cg::cg_coro_is_future(sema::TypeInstance type)
+{
+	return type.indirection_level == 0 && !type.is_array_type() && type.type->is_future_type();
+}
+
+void
+cg::cg_coro_drop(CG& codegen, Vec<llvm::Value*> const& slots)
+{
+	for( auto llvm_slot : slots )
+	{
+		auto llvm_future = codegen.Builder->CreateLoad(i8_ptr_ty(codegen), llvm_slot);
+		codegen.Builder->CreateCall(cg_coro_drop_fn(codegen), {llvm_future});
+	}
+}
+
+llvm::Align
+cg::cg_coro_promise_align(CG& codegen, llvm::Type* llvm_type)
+{
+	return codegen.Module->getDataLayout().getPrefTypeAlign(llvm_type);
+}
+
+static llvm::Function*
+intrinsic(CG& codegen, llvm::Intrinsic::ID id, llvm::ArrayRef<llvm::Type*> tys = {})
+{
+	return llvm::Intrinsic::getDeclaration(codegen.Module.get(), id, tys);
+}
+
+void
+cg::cg_coro_suspend(CG& codegen, cg::LLVMFnInfo& fn, llvm::BasicBlock* resume_bb)
+{
+	auto& coro = fn.coro().value();
+
+	auto llvm_save = llvm::ConstantTokenNone::get(*codegen.Context);
+	auto llvm_suspend = codegen.Builder->CreateCall(
+		intrinsic(codegen, llvm::Intrinsic::coro_suspend),
+		{llvm_save, codegen.Builder->getFalse()});
+
+	// 0 is resume, 1 is destroy, anything else returns to the resumer.
+	auto llvm_switch = codegen.Builder->CreateSwitch(llvm_suspend, coro.suspend_bb, 2);
+	llvm_switch->addCase(codegen.Builder->getInt8(0), resume_bb);
+	llvm_switch->addCase(codegen.Builder->getInt8(1), coro.cleanup_bb);
+}
+
+CGResult<CGExpr>
+cg::cg_coro_begin(CG& codegen, cg::LLVMFnInfo& fn, sema::TypeInstance result_type)
+{
+	auto llvm_fn = fn.sig_info.llvm_fn;
+
+	LLVMCoroInfo coro;
+	llvm::Value* llvm_promise_ptr = llvm::ConstantPointerNull::get(
+		llvm::cast<llvm::PointerType>(i8_ptr_ty(codegen)));
+	auto typer = get_type(codegen, result_type);
+	if( !typer.ok() )
+		return typer;
+	auto llvm_result_type = typer.unwrap();
+	if( !llvm_result_type->isVoidTy() )
+	{
+		auto llvm_promise = codegen.Builder->CreateAlloca(llvm_result_type, nullptr, "promise");
+		llvm_promise->setAlignment(cg_coro_promise_align(codegen, llvm_result_type));
+		coro.promise = LLVMAddress(llvm_promise, llvm_result_type);
+		llvm_promise_ptr = codegen.Builder->CreateBitCast(llvm_promise, i8_ptr_ty(codegen));
+	}
+
+	auto llvm_null = llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(i8_ptr_ty(codegen)));
+	coro.id = codegen.Builder->CreateCall(
+		intrinsic(codegen, llvm::Intrinsic::coro_id),
+		{codegen.Builder->getInt32(0), llvm_promise_ptr, llvm_null, llvm_null});
+
+	auto llvm_size = codegen.Builder->CreateCall(
+		intrinsic(codegen, llvm::Intrinsic::coro_size, {llvm::Type::getInt64Ty(*codegen.Context)}));
+	auto llvm_mem = codegen.Builder->CreateCall(coro_alloc_fn(codegen), {llvm_size});
+	coro.handle = codegen.Builder->CreateCall(
+		intrinsic(codegen, llvm::Intrinsic::coro_begin), {coro.id, llvm_mem}, "handle");
+
+	coro.final_bb = llvm::BasicBlock::Create(*codegen.Context, "coro.final");
+	coro.cleanup_bb = llvm::BasicBlock::Create(*codegen.Context, "coro.cleanup");
+	coro.suspend_bb = llvm::BasicBlock::Create(*codegen.Context, "coro.suspend");
+	fn.set_coro(coro);
+
+	// Initial suspend. The executor starts the body.
+	auto llvm_start_bb = llvm::BasicBlock::Create(*codegen.Context, "coro.start", llvm_fn);
+	cg_coro_suspend(codegen, fn, llvm_start_bb);
+	codegen.Builder->SetInsertPoint(llvm_start_bb);
+
+	return CGExpr();
+}
+
+void
+cg::cg_coro_end(CG& codegen, cg::LLVMFnInfo& fn)
+{
+	auto& coro = fn.coro().value();
+	auto llvm_fn = fn.sig_info.llvm_fn;
+
+	// Falling off the end of a void async fn.
+	if( codegen.Builder->GetInsertBlock()->getTerminator() == nullptr )
+		codegen.Builder->CreateBr(coro.final_bb);
+
+	// Final suspend. The frame stays alive so awaiters can read the promise;
+	// it is destroyed by whoever consumes the future.
+	llvm_fn->getBasicBlockList().push_back(coro.final_bb);
+	codegen.Builder->SetInsertPoint(coro.final_bb);
+	auto llvm_save = llvm::ConstantTokenNone::get(*codegen.Context);
+	auto llvm_suspend = codegen.Builder->CreateCall(
+		intrinsic(codegen, llvm::Intrinsic::coro_suspend),
+		{llvm_save, codegen.Builder->getTrue()});
+	auto llvm_switch = codegen.Builder->CreateSwitch(llvm_suspend, coro.suspend_bb, 1);
+	llvm_switch->addCase(codegen.Builder->getInt8(1), coro.cleanup_bb);
+
+	llvm_fn->getBasicBlockList().push_back(coro.cleanup_bb);
+	codegen.Builder->SetInsertPoint(coro.cleanup_bb);
+	auto llvm_mem = codegen.Builder->CreateCall(
+		intrinsic(codegen, llvm::Intrinsic::coro_free), {coro.id, coro.handle});
+	codegen.Builder->CreateCall(coro_free_fn(codegen), {llvm_mem});
+	codegen.Builder->CreateBr(coro.suspend_bb);
+
+	llvm_fn->getBasicBlockList().push_back(coro.suspend_bb);
+	codegen.Builder->SetInsertPoint(coro.suspend_bb);
+	codegen.Builder->CreateCall(
+		intrinsic(codegen, llvm::Intrinsic::coro_end), {coro.handle, codegen.Builder->getFalse()});
+	codegen.Builder->CreateRet(coro.handle);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../CGExpr.h"
+#include "../CGResult.h"
+#include "LLVMFnInfo.h"
+#include "sema2/TypeInstance.h"
+
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/Support/Alignment.h>
+
+namespace cg
+{
+class CG;
+
+/**
+ * @brief Lowers the start of an async fn to a switched-resume coroutine.
+ *
+ * The frame is allocated with sushi_coro_alloc, so the runtime decides where
+ * frames live. The coroutine suspends before running the body, so calling an
+ * async fn only creates the future; the executor starts it.
+ */
+CGResult<CGExpr> cg_coro_begin(CG&, cg::LLVMFnInfo&, sema::TypeInstance result_type);
+
+/**
+ * @brief Emits the final suspend point, frame cleanup and the return of the handle.
+ */
+void cg_coro_end(CG&, cg::LLVMFnInfo&);
+
+/**
+ * @brief Suspends the current coroutine. Continues in 'resume_bb' when resumed.
+ */
+void cg_coro_suspend(CG&, cg::LLVMFnInfo&, llvm::BasicBlock* resume_bb);
+
+/**
+ * @brief Alignment of the promise of a coroutine whose result has type 'llvm_type'.
+ * Both the coroutine and awaiters must agree on it.
+ */
+llvm::Align cg_coro_promise_align(CG&, llvm::Type* llvm_type);
+
+/**
+ * @brief Whether values of 'type' are futures, which own the frame they point to.
+ */
+bool cg_coro_is_future(sema::TypeInstance type);
+
+/**
+ * @brief Destroys the futures stored in 'slots' unless they were consumed.
+ * Consuming a future stores null in its slot, see codegen_await.
+ */
+void cg_coro_drop(CG&, Vec<llvm::Value*> const& slots);
+
+// Runtime entry points, see runtime/sushi_async.h
+llvm::FunctionCallee cg_coro_await_fn(CG&);
+llvm::FunctionCallee cg_coro_block_on_fn(CG&);
+llvm::FunctionCallee cg_coro_drop_fn(CG&);
+
+} // namespace cg
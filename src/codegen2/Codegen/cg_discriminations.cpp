@@ -6,18 +6,15 @@
 using namespace cg;
 
 void
-cg::cg_discriminations(CG& codegen, CGExpr& discriminating_expr, Vec<ir::IRParam*>& discriminations)
+cg::cg_discriminations(
+	CG& codegen, cg::LLVMFnInfo& fn, CGExpr& discriminating_expr, ir::FlatRange bindings)
 {
-	int ind = 0;
-	for( auto param : discriminations )
+	for( std::uint32_t ind = 0; ind < bindings.size; ind++ )
 	{
-		auto ir_value_decl = param->data.value_decl;
-		auto ir_type_decl = param->data.value_decl->type_decl;
-		auto llvm_type = get_type(codegen, ir_type_decl).unwrap();
+		auto& binding = fn.body().binding(bindings, ind);
+		auto llvm_type = get_type(codegen, binding.type_instance).unwrap();
 
-		auto name = ir_value_decl->name;
-
-		auto enum_value = discriminating_expr.get_discrimination(ind).address();
+		auto enum_value = discriminating_expr.get_discrimination(ind);
 		auto llvm_enum_value = enum_value.llvm_pointer();
 		auto llvm_enum_type = enum_value.llvm_allocated_type();
 		auto llvm_member_value_ptr =
@@ -27,8 +24,6 @@ cg::cg_discriminations(CG& codegen, CGExpr& discriminating_expr, Vec<ir::IRParam
 			codegen.Builder->CreateBitCast(llvm_member_value_ptr, llvm_type->getPointerTo());
 
 		auto lval = LValue(llvm_member_value, llvm_type);
-		codegen.values.insert_or_assign(*name, lval);
-
-		ind++;
+		codegen.values.insert_or_assign(binding.name, lval);
 	}
 }
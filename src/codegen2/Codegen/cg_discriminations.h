@@ -2,11 +2,12 @@
 #include "../CGExpr.h"
 #include "../CGResult.h"
 #include "LLVMAddress.h"
+#include "LLVMFnInfo.h"
 #include "common/Vec.h"
 #include "sema2/IR.h"
 
 namespace cg
 {
 class CG;
-void cg_discriminations(CG&, CGExpr&, Vec<ir::IRParam*>&);
+void cg_discriminations(CG&, cg::LLVMFnInfo&, CGExpr&, ir::FlatRange bindings);
 } // namespace cg
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "cg_enum_helpers.h"
 
 #include "../Codegen.h"
+#include "cg_tbaa.h"
 
 using namespace cg;
 
@@ -13,5 +14,6 @@ cg::cg_enum_nominal(CG& codegen, LLVMAddress const& address)
 
 	llvm::Type* llvm_int_type = llvm::Type::getInt32Ty(*codegen.Context);
 	// TODO: Enum backing type
-	return LLVMAddress(llvm_enum_nominal_value, llvm_int_type);
+	return LLVMAddress(llvm_enum_nominal_value, llvm_int_type)
+		.with_tbaa(cg_tbaa_may_alias_tag(codegen));
 }
\ No newline at end of file
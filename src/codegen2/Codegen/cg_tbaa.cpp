@@ -0,0 +1,194 @@
+#include "cg_tbaa.h"
+
+#include "../Codegen.h"
+#include "lookup.h"
+
+#include <llvm/IR/MDBuilder.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace cg;
+
+static llvm::MDNode*
+tbaa_root(CG& codegen)
+{
+	llvm::MDBuilder md(*codegen.Context);
+	return md.createTBAARoot("Sushi TBAA");
+}
+
+static llvm::MDNode*
+tbaa_char(CG& codegen)
+{
+	llvm::MDBuilder md(*codegen.Context);
+	return md.createTBAAScalarTypeNode("omnipotent char", tbaa_root(codegen));
+}
+
+static llvm::MDNode* tbaa_type_node(CG& codegen, sema::TypeInstance const& type);
+
+static llvm::MDNode*
+tbaa_struct_type_node(CG& codegen, sema::Type const* type)
+{
+	auto llvm_typer = get_base_type(codegen, type);
+	if( !llvm_typer.ok() )
+		return nullptr;
+
+	auto llvm_struct_type = llvm::dyn_cast<llvm::StructType>(llvm_typer.unwrap());
+	if( !llvm_struct_type || llvm_struct_type->isOpaque() )
+		return nullptr;
+
+	auto layout = codegen.Module->getDataLayout().getStructLayout(llvm_struct_type);
+
+	Vec<std::pair<llvm::MDNode*, uint64_t>> fields;
+	for( int i = 0; i < type->get_member_count(); i++ )
+	{
+		auto member = type->get_member(i);
+		auto member_node = tbaa_type_node(codegen, member.type);
+		if( !member_node )
+			return nullptr;
+
+		fields.emplace_back(member_node, layout->getElementOffset(member.idx));
+	}
+
+	std::sort(
+		fields.begin(),
+		fields.end(),
+		[](auto const& lhs, auto const& rhs) { return lhs.second < rhs.second; });
+
+	llvm::MDBuilder md(*codegen.Context);
+	return md.createTBAAStructTypeNode(type->get_name(), fields);
+}
+
+static llvm::MDNode*
+tbaa_base_type_node(CG& codegen, sema::Type const* type)
+{
+	auto iter = codegen.tbaa_types.find(type);
+	if( iter != codegen.tbaa_types.end() )
+		return iter->second;
+
+	llvm::MDBuilder md(*codegen.Context);
+	llvm::MDNode* node = nullptr;
+	if( type->is_enum_member() || type->is_union_type() || type->is_enum_type() )
+		node = tbaa_char(codegen);
+	else if( type->is_struct_type() )
+		node = tbaa_struct_type_node(codegen, type);
+	else if( type->is_function_type() )
+		node = nullptr;
+	// i8 and u8 are bytes and may alias anything.
+	else if( type->int_width() == 8 )
+		node = tbaa_char(codegen);
+	// Signed and unsigned integers of the same width alias.
+	else if( type->int_width() != 0 )
+		node = md.createTBAAScalarTypeNode(
+			"int" + std::to_string(type->int_width()), tbaa_char(codegen));
+	else if( type == codegen.sema.types.bool_type() )
+		node = md.createTBAAScalarTypeNode("bool", tbaa_char(codegen));
+
+	codegen.tbaa_types.emplace(type, node);
+	return node;
+}
+
+static llvm::MDNode*
+tbaa_type_node(CG& codegen, sema::TypeInstance const& type)
+{
+	if( type.is_array_type() )
+		return tbaa_type_node(codegen, type.ArrayElementType());
+
+	if( type.is_pointer_type() )
+	{
+		llvm::MDBuilder md(*codegen.Context);
+		return md.createTBAAScalarTypeNode("any pointer", tbaa_char(codegen));
+	}
+
+	return tbaa_base_type_node(codegen, type.type);
+}
+
+llvm::MDNode*
+cg::cg_tbaa_may_alias_tag(CG& codegen)
+{
+	if( !codegen.options.strict_aliasing )
+		return nullptr;
+
+	auto char_node = tbaa_char(codegen);
+
+	llvm::MDBuilder md(*codegen.Context);
+	return md.createTBAAStructTagNode(char_node, char_node, 0);
+}
+
+llvm::MDNode*
+cg::cg_tbaa_access_tag(CG& codegen, sema::TypeInstance const& type)
+{
+	if( !codegen.options.strict_aliasing )
+		return nullptr;
+
+	if( type.is_union_type() || type.is_enum_type() )
+		return cg_tbaa_may_alias_tag(codegen);
+
+	if( type.is_struct_type() || type.is_array_type() )
+		return nullptr;
+
+	auto node = tbaa_type_node(codegen, type);
+	if( !node )
+		return nullptr;
+
+	llvm::MDBuilder md(*codegen.Context);
+	return md.createTBAAStructTagNode(node, node, 0);
+}
+
+llvm::MDNode*
+cg::cg_tbaa_member_access_tag(
+	CG& codegen,
+	LLVMAddress const& base,
+	sema::TypeInstance const& type,
+	sema::MemberTypeInstance const& member)
+{
+	if( !codegen.options.strict_aliasing )
+		return nullptr;
+
+	auto may_alias_tag = cg_tbaa_may_alias_tag(codegen);
+	if( base.tbaa() == may_alias_tag || !type.is_struct_type() || type.type->is_enum_member() )
+		return may_alias_tag;
+
+	auto member_type = member.type;
+	if( member_type.is_struct_type() || member_type.is_array_type() )
+		return nullptr;
+	if( member_type.is_union_type() || member_type.is_enum_type() )
+		return may_alias_tag;
+
+	auto base_node = tbaa_type_node(codegen, type);
+	auto access_node = tbaa_type_node(codegen, member_type);
+	if( !base_node || !access_node )
+		return nullptr;
+
+	auto llvm_struct_type = llvm::cast<llvm::StructType>(base.llvm_allocated_type());
+	auto layout = codegen.Module->getDataLayout().getStructLayout(llvm_struct_type);
+
+	llvm::MDBuilder md(*codegen.Context);
+	return md.createTBAAStructTagNode(
+		base_node, access_node, layout->getElementOffset(member.idx));
+}
+
+llvm::LoadInst*
+cg::cg_load(CG& codegen, LLVMAddress const& address)
+{
+	auto llvm_load =
+		codegen.Builder->CreateLoad(address.llvm_allocated_type(), address.llvm_pointer());
+	if( address.tbaa() )
+		llvm_load->setMetadata(llvm::LLVMContext::MD_tbaa, address.tbaa());
+
+	return llvm_load;
+}
+
+llvm::StoreInst*
+cg::cg_store(CG& codegen, llvm::Value* value, LLVMAddress const& address)
+{
+	auto llvm_stored_type = address.llvm_allocated_type();
+	if( value->getType()->isIntegerTy() && llvm_stored_type->isIntegerTy() )
+		value = codegen.Builder->CreateSExtOrTrunc(value, llvm_stored_type);
+
+	auto llvm_store = codegen.Builder->CreateStore(value, address.llvm_pointer());
+	if( address.tbaa() )
+		llvm_store->setMetadata(llvm::LLVMContext::MD_tbaa, address.tbaa());
+
+	return llvm_store;
+}
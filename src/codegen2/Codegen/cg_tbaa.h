@@ -0,0 +1,46 @@
+#pragma once
+
+#include "LLVMAddress.h"
+#include "sema2/MemberTypeInstance.h"
+#include "sema2/TypeInstance.h"
+
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
+
+namespace cg
+{
+class CG;
+
+/**
+ * @brief TBAA access tag for loading or storing a value of 'type'.
+ *
+ * Unions and enums may alias anything. Returns nullptr for aggregates
+ * (they are copied with memcpy) or if strict aliasing is disabled.
+ */
+llvm::MDNode* cg_tbaa_access_tag(CG&, sema::TypeInstance const& type);
+
+/**
+ * @brief TBAA access tag for 'member' of the struct/union at 'base'.
+ *
+ * Struct members get a struct-path tag. Members of unions and enums, and anything
+ * nested in them, may alias anything.
+ */
+llvm::MDNode* cg_tbaa_member_access_tag(
+	CG&,
+	LLVMAddress const& base,
+	sema::TypeInstance const& type,
+	sema::MemberTypeInstance const& member);
+
+/**
+ * @brief Tag for accesses that may alias any other access. e.g. union type punning.
+ */
+llvm::MDNode* cg_tbaa_may_alias_tag(CG&);
+
+llvm::LoadInst* cg_load(CG&, LLVMAddress const& address);
+/**
+ * @brief Sema lets any integer be stored to any integer, so an integer of another
+ * width is sign extended or truncated to the stored type first.
+ */
+llvm::StoreInst* cg_store(CG&, llvm::Value* value, LLVMAddress const& address);
+
+} // namespace cg
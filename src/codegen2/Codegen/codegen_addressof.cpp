@@ -6,9 +6,9 @@
 using namespace cg;
 
 CGResult<CGExpr>
-cg::codegen_addressof(CG& codegen, cg::LLVMFnInfo& fn, ir::IRAddressOf* ir_addrof)
+cg::codegen_addressof(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_addrof)
 {
-	auto exprr = codegen.codegen_expr(fn, ir_addrof->expr);
+	auto exprr = codegen.codegen_expr(fn, ir_addrof.lhs);
 	if( !exprr.ok() )
 		return exprr;
 	auto expr = exprr.unwrap();
@@ -10,5 +10,5 @@
 namespace cg
 {
 class CG;
-CGResult<CGExpr> codegen_addressof(CG&, cg::LLVMFnInfo&, ir::IRAddressOf*);
+CGResult<CGExpr> codegen_addressof(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&);
 } // namespace cg
\ No newline at end of file
@@ -1,15 +1,16 @@
 #include "codegen_array_access.h"
 
 #include "../Codegen.h"
+#include "cg_tbaa.h"
 #include "lookup.h"
 #include "operand.h"
 
 using namespace cg;
 
 CGResult<CGExpr>
-cg::codegen_array_access(CG& codegen, cg::LLVMFnInfo& fn, ir::IRArrayAccess* ir_array_access)
+cg::codegen_array_access(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_array_access)
 {
-	auto array_targetr = codegen.codegen_expr(fn, ir_array_access->array_target);
+	auto array_targetr = codegen.codegen_expr(fn, ir_array_access.lhs);
 	if( !array_targetr.ok() )
 		return array_targetr;
 	auto array_target = array_targetr.unwrap();
@@ -17,7 +18,7 @@ cg::codegen_array_access(CG& codegen, cg::LLVMFnInfo& fn, ir::IRArrayAccess* ir_
 	auto llvm_target_type = array_target.address().llvm_allocated_type();
 	auto llvm_target_value = array_target.address().llvm_pointer();
 
-	auto exprr = codegen.codegen_expr(fn, ir_array_access->expr);
+	auto exprr = codegen.codegen_expr(fn, ir_array_access.rhs);
 	if( !exprr.ok() )
 		return exprr;
 	auto expr = exprr.unwrap();
@@ -30,6 +31,10 @@ cg::codegen_array_access(CG& codegen, cg::LLVMFnInfo& fn, ir::IRArrayAccess* ir_
 	auto llvm_array_value =
 		codegen.Builder->CreateInBoundsGEP(llvm_target_type, llvm_target_value, indices);
 
+	auto tbaa = array_target.address().tbaa() == cg_tbaa_may_alias_tag(codegen)
+					? array_target.address().tbaa()
+					: cg_tbaa_access_tag(codegen, ir_array_access.type_instance);
+
 	return CGExpr::MakeAddress(
-		LLVMAddress(llvm_array_value, llvm_target_type->getArrayElementType()));
+		LLVMAddress(llvm_array_value, llvm_target_type->getArrayElementType()).with_tbaa(tbaa));
 }
\ No newline at end of file
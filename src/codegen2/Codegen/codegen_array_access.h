@@ -7,5 +7,5 @@
 namespace cg
 {
 class CG;
-CGResult<CGExpr> codegen_array_access(CG&, cg::LLVMFnInfo&, ir::IRArrayAccess*);
+CGResult<CGExpr> codegen_array_access(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&);
 } // namespace cg
\ No newline at end of file
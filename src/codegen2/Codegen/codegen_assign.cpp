@@ -2,6 +2,7 @@
 
 #include "../Codegen.h"
 #include "cg_division.h"
+#include "cg_tbaa.h"
 #include "codegen_binop.h"
 #include "lookup.h"
 #include "operand.h"
@@ -47,6 +48,9 @@ sizefor(CG& codegen, int size)
 static llvm::Value*
 trunc(CG& codegen, sema::TypeInstance dest, llvm::Value* rhs)
 {
+	if( !rhs->getType()->isIntegerTy() )
+		return rhs;
+
 	auto size = dest.type->int_width();
 	auto other_size = rhs->getType()->getIntegerBitWidth();
 	if( size == other_size )
@@ -59,16 +63,19 @@ trunc(CG& codegen, sema::TypeInstance dest, llvm::Value* rhs)
 }
 
 CGResult<CGExpr>
-cg::codegen_assign(CG& codegen, cg::LLVMFnInfo& fn, ir::IRAssign* ir_assign)
+cg::codegen_assign(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_assign)
 {
-	auto lhsr = codegen.codegen_expr(fn, ir_assign->lhs);
+	auto& lhs_type = fn.body().expr(ir_assign.expr).type_instance;
+	auto& rhs_type = fn.body().expr(ir_assign.rhs).type_instance;
+
+	auto lhsr = codegen.codegen_expr(fn, ir_assign.expr);
 	if( !lhsr.ok() )
 		return lhsr;
 
 	LValue __temp_replace = LValue(lhsr.unwrap().address());
 
 	auto lexpr = lhsr.unwrap();
-	auto rhsr = codegen.codegen_expr(fn, ir_assign->rhs, __temp_replace);
+	auto rhsr = codegen.codegen_expr(fn, ir_assign.rhs, __temp_replace);
 	if( !rhsr.ok() )
 		return rhsr;
 
@@ -78,12 +85,12 @@ cg::codegen_assign(CG& codegen, cg::LLVMFnInfo& fn, ir::IRAssign* ir_assign)
 	if( rexpr.is_empty() )
 		return CGExpr();
 
-	auto lhs = lexpr.address().llvm_pointer();
+	auto lhs = lexpr.address();
 	auto rhs = codegen_operand_expr(codegen, rexpr);
 
-	assert(lhs && rhs && "nullptr for assignment!");
+	assert(lhs.llvm_pointer() && rhs && "nullptr for assignment!");
 
-	switch( ir_assign->op )
+	switch( ir_assign.op )
 	{
 	case ast::AssignOp::add:
 	case ast::AssignOp::sub:
@@ -93,17 +100,17 @@ cg::codegen_assign(CG& codegen, cg::LLVMFnInfo& fn, ir::IRAssign* ir_assign)
 		auto lhs_value = codegen_operand_expr(codegen, lexpr);
 		auto llvm_rval = codegen_arithmetic_binop(
 			codegen, //
-			SemaTypedInt(ir_assign->lhs->type_instance, lhs_value),
-			SemaTypedInt(ir_assign->rhs->type_instance, rhs),
-			to_binop(ir_assign->op));
+			SemaTypedInt(lhs_type, lhs_value),
+			SemaTypedInt(rhs_type, rhs),
+			to_binop(ir_assign.op));
 
-		rhs = trunc(codegen, ir_assign->lhs->type_instance, rhs);
-		codegen.Builder->CreateStore(rhs, lhs);
+		rhs = trunc(codegen, lhs_type, rhs);
+		cg_store(codegen, rhs, lhs);
 	}
 	break;
 	case ast::AssignOp::assign:
-		rhs = trunc(codegen, ir_assign->lhs->type_instance, rhs);
-		codegen.Builder->CreateStore(rhs, lhs);
+		rhs = trunc(codegen, lhs_type, rhs);
+		cg_store(codegen, rhs, lhs);
 		break;
 	}
 
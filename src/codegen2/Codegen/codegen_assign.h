@@ -7,5 +7,5 @@
 namespace cg
 {
 class CG;
-CGResult<CGExpr> codegen_assign(CG&, cg::LLVMFnInfo&, ir::IRAssign*);
+CGResult<CGExpr> codegen_assign(CG&, cg::LLVMFnInfo&, ir::FlatStmt const&);
 } // namespace cg
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "codegen_await.h"
+
+#include "../Codegen.h"
+#include "cg_alloca.h"
+#include "cg_coro.h"
+#include "cg_tbaa.h"
+#include "lookup.h"
+#include "operand.h"
+
+#include <llvm/IR/Intrinsics.h>
+
+using namespace cg;
+
+static void
+codegen_suspend_until_done(CG& codegen, cg::LLVMFnInfo& fn, Vec<llvm::Value*> const& futures)
+{
+	auto& coro = fn.coro().value();
+	auto llvm_fn = fn.sig_info.llvm_fn;
+
+	for( auto llvm_future : futures )
+		codegen.Builder->CreateCall(cg_coro_await_fn(codegen), {coro.handle, llvm_future});
+
+	auto llvm_check_bb = llvm::BasicBlock::Create(*codegen.Context, "await.check", llvm_fn);
+	auto llvm_wait_bb = llvm::BasicBlock::Create(*codegen.Context, "await.wait", llvm_fn);
+	auto llvm_done_bb = llvm::BasicBlock::Create(*codegen.Context, "await.done", llvm_fn);
+	codegen.Builder->CreateBr(llvm_check_bb);
+
+	// The executor resumes us each time one of the futures finishes.
+	codegen.Builder->SetInsertPoint(llvm_check_bb);
+	auto llvm_done_fn =
+		llvm::Intrinsic::getDeclaration(codegen.Module.get(), llvm::Intrinsic::coro_done);
+	llvm::Value* llvm_all_done = codegen.Builder->getTrue();
+	for( auto llvm_future : futures )
+		llvm_all_done = codegen.Builder->CreateAnd(
+			llvm_all_done, codegen.Builder->CreateCall(llvm_done_fn, {llvm_future}));
+	codegen.Builder->CreateCondBr(llvm_all_done, llvm_done_bb, llvm_wait_bb);
+
+	codegen.Builder->SetInsertPoint(llvm_wait_bb);
+	cg_coro_suspend(codegen, fn, llvm_check_bb);
+
+	codegen.Builder->SetInsertPoint(llvm_done_bb);
+}
+
+static void
+codegen_block_until_done(CG& codegen, Vec<llvm::Value*> const& futures)
+{
+	auto llvm_handle_ty = llvm::Type::getInt8PtrTy(*codegen.Context);
+	auto llvm_array_ty = llvm::ArrayType::get(llvm_handle_ty, futures.size());
+	auto llvm_array = cg_alloca(codegen, llvm_array_ty, "futures");
+
+	for( int i = 0; i < futures.size(); i++ )
+		codegen.Builder->CreateStore(
+			futures[i], codegen.Builder->CreateConstInBoundsGEP2_32(llvm_array_ty, llvm_array, 0, i));
+
+	codegen.Builder->CreateCall(
+		cg_coro_block_on_fn(codegen),
+		{codegen.Builder->CreateConstInBoundsGEP2_32(llvm_array_ty, llvm_array, 0, 0),
+		 codegen.Builder->getInt32(futures.size())});
+}
+
+/**
+ * @brief Copies the result out of a finished future and destroys its frame.
+ * If the future was read from a variable, the variable is set to null so awaiting
+ * it again aborts in the runtime instead of reading the freed frame.
+ */
+static CGResult<CGExpr>
+codegen_consume(
+	CG& codegen, CGExpr& future, llvm::Value* llvm_future, sema::TypeInstance result_type)
+{
+	auto typer = get_type(codegen, result_type);
+	if( !typer.ok() )
+		return typer;
+	auto llvm_result_type = typer.unwrap();
+
+	CGExpr result;
+	if( !llvm_result_type->isVoidTy() )
+	{
+		auto llvm_align = cg_coro_promise_align(codegen, llvm_result_type);
+		auto llvm_promise = codegen.Builder->CreateCall(
+			llvm::Intrinsic::getDeclaration(codegen.Module.get(), llvm::Intrinsic::coro_promise),
+			{llvm_future, codegen.Builder->getInt32(llvm_align.value()), codegen.Builder->getFalse()});
+		auto llvm_promise_ptr =
+			codegen.Builder->CreateBitCast(llvm_promise, llvm_result_type->getPointerTo());
+
+		// The frame is destroyed below, so the result must be copied out first.
+		if( llvm_result_type->isAggregateType() )
+		{
+			auto llvm_copy = cg_alloca(codegen, llvm_result_type, "result");
+			auto llvm_size = codegen.Module->getDataLayout().getTypeAllocSize(llvm_result_type);
+			codegen.Builder->CreateMemCpy(
+				llvm_copy, llvm_align, llvm_promise_ptr, llvm_align, llvm_size);
+			result = CGExpr::MakeAddress(LLVMAddress(llvm_copy, llvm_result_type));
+		}
+		else
+		{
+			auto llvm_value = codegen.Builder->CreateAlignedLoad(
+				llvm_result_type, llvm_promise_ptr, llvm_align, "result");
+			result = CGExpr::MakeRValue(RValue(llvm_value));
+		}
+	}
+
+	codegen.Builder->CreateCall(
+		llvm::Intrinsic::getDeclaration(codegen.Module.get(), llvm::Intrinsic::coro_destroy),
+		{llvm_future});
+
+	if( future.is_address() )
+	{
+		auto address = future.address();
+		cg_store(
+			codegen,
+			llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(llvm_future->getType())),
+			address);
+	}
+
+	return result;
+}
+
+CGResult<CGExpr>
+cg::codegen_await(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_await)
+{
+	Vec<CGExpr> exprs;
+	Vec<llvm::Value*> futures;
+	for( int i = 0; i < ir_await.children.size; i++ )
+	{
+		auto exprr = codegen.codegen_expr(fn, fn.body().child_expr(ir_await.children, i));
+		if( !exprr.ok() )
+			return exprr;
+		auto expr = exprr.unwrap();
+		futures.push_back(codegen_operand_expr(codegen, expr));
+		exprs.push_back(expr);
+	}
+
+	if( fn.coro().has_value() )
+		codegen_suspend_until_done(codegen, fn, futures);
+	else
+		codegen_block_until_done(codegen, futures);
+
+	// 'await a, b' only waits. Each future is consumed by awaiting it alone.
+	if( futures.size() != 1 )
+		return CGExpr();
+
+	return codegen_consume(codegen, exprs[0], futures[0], ir_await.type_instance);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../CGExpr.h"
+#include "../CGResult.h"
+#include "LLVMFnInfo.h"
+#include "sema2/IR.h"
+
+namespace cg
+{
+class CG;
+
+/**
+ * @brief Waits for every future of the await.
+ *
+ * Inside an async fn this suspends until the futures are done, otherwise it runs
+ * the executor until they are. Awaiting a single future consumes it: the result
+ * is copied out of the promise and the coroutine frame is destroyed. A consumed
+ * variable is set to null; futures still set when their block ends are dropped.
+ */
+CGResult<CGExpr> codegen_await(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&);
+} // namespace cg
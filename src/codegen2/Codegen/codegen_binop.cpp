@@ -85,13 +85,13 @@ cg::codegen_arithmetic_binop(CG& codegen, SemaTypedInt lhs, SemaTypedInt rhs, as
 }
 
 CGResult<CGExpr>
-cg::codegen_binop(CG& codegen, cg::LLVMFnInfo& fn, ir::IRBinOp* ir_binop)
+cg::codegen_binop(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_binop)
 {
-	auto lhsr = codegen.codegen_expr(fn, ir_binop->lhs);
+	auto lhsr = codegen.codegen_expr(fn, ir_binop.lhs);
 	if( !lhsr.ok() )
 		return lhsr;
 
-	auto rhsr = codegen.codegen_expr(fn, ir_binop->rhs);
+	auto rhsr = codegen.codegen_expr(fn, ir_binop.rhs);
 	if( !rhsr.ok() )
 		return rhsr;
 
@@ -105,7 +105,7 @@ cg::codegen_binop(CG& codegen, cg::LLVMFnInfo& fn, ir::IRBinOp* ir_binop)
 
 	// assert(llvm_lhs->getType()->isIntegerTy() && llvm_rhs->getType()->isIntegerTy());
 
-	switch( ir_binop->op )
+	switch( ir_binop.data.op )
 	{
 	case ast::BinOp::plus:
 	case ast::BinOp::minus:
@@ -113,9 +113,9 @@ cg::codegen_binop(CG& codegen, cg::LLVMFnInfo& fn, ir::IRBinOp* ir_binop)
 	case ast::BinOp::slash:
 		return codegen_arithmetic_binop(
 			codegen,
-			SemaTypedInt(ir_binop->lhs->type_instance, llvm_lhs),
-			SemaTypedInt(ir_binop->rhs->type_instance, llvm_rhs),
-			ir_binop->op);
+			SemaTypedInt(fn.body().expr(ir_binop.lhs).type_instance, llvm_lhs),
+			SemaTypedInt(fn.body().expr(ir_binop.rhs).type_instance, llvm_rhs),
+			ir_binop.data.op);
 	case ast::BinOp::gt:
 		return CGExpr::MakeRValue(RValue(codegen.Builder->CreateICmpSGT(llvm_lhs, llvm_rhs)));
 	case ast::BinOp::gte:
@@ -22,5 +22,5 @@ struct SemaTypedInt
 };
 
 CGResult<CGExpr> codegen_arithmetic_binop(CG&, SemaTypedInt, SemaTypedInt, ast::BinOp);
-CGResult<CGExpr> codegen_binop(CG&, cg::LLVMFnInfo&, ir::IRBinOp*);
+CGResult<CGExpr> codegen_binop(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&);
 } // namespace cg
\ No newline at end of file
@@ -1,34 +1,44 @@
 #include "codegen_call.h"
 
 #include "../Codegen.h"
+#include "cg_alloca.h"
 #include "lookup.h"
 #include "operand.h"
 
 using namespace cg;
 
 CGResult<CGExpr>
-cg::codegen_call(CG& codegen, cg::LLVMFnInfo& fn, ir::IRCall* ir_call)
+cg::codegen_call(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_call)
 {
 	return codegen_call(codegen, fn, ir_call, std::optional<LValue>());
 }
 
 CGResult<CGExpr>
-cg::codegen_call(CG& codegen, cg::LLVMFnInfo& fn, ir::IRCall* ir_call, std::optional<LValue> lvalue)
+cg::codegen_call(
+	CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_call, std::optional<LValue> lvalue)
 {
-	auto call_target_type = ir_call->call_target->type_instance;
+	auto& body = fn.body();
+	auto call_target_type = body.expr(ir_call.lhs).type_instance;
 	assert(call_target_type.type->is_function_type() && call_target_type.indirection_level <= 1);
 
 	// TODO: EmitCallee like clang.
-	auto exprr = codegen.codegen_expr(fn, ir_call->call_target);
+	auto exprr = codegen.codegen_expr(fn, ir_call.lhs);
 	if( !exprr.ok() )
 		return exprr;
 
 	auto expr = exprr.unwrap();
-	auto llvm_function = static_cast<llvm::Function*>(expr.address().llvm_pointer());
 
-	auto iter_callee = codegen.Functions.find(llvm_function->getName().str());
-	assert(iter_callee != codegen.Functions.end());
-	auto callee_sig_info = iter_callee->second;
+	// Function types are nominal, so the type identifies the signature for direct
+	// calls and calls through function pointers alike.
+	auto callee_sig_info_ptr = codegen.find_function(call_target_type.type);
+	assert(callee_sig_info_ptr != nullptr);
+	auto const& callee_sig_info = *callee_sig_info_ptr;
+
+	llvm::Value* llvm_callee = nullptr;
+	if( call_target_type.indirection_level == 0 )
+		llvm_callee = expr.address().llvm_pointer();
+	else
+		llvm_callee = codegen_operand_expr(codegen, expr);
 
 	std::vector<llvm::Value*> llvm_arg_values;
 	int arg_ind = 0;
@@ -44,15 +54,15 @@ cg::codegen_call(CG& codegen, cg::LLVMFnInfo& fn, ir::IRCall* ir_call, std::opti
 		{
 			// If no value was provided for the return value create a dummy alloca.
 			llvm::AllocaInst* llvm_sret_alloca =
-				codegen.Builder->CreateAlloca(sret_arg_info.llvm_type, nullptr, ".dummy");
+				cg_alloca(codegen, sret_arg_info.llvm_type, ".dummy");
 			llvm_arg_values.push_back(llvm_sret_alloca);
 		}
 		arg_ind += 1;
 	}
 
-	for( auto arg_expr_node : *ir_call->args->args )
+	for( std::uint32_t i = 0; i < ir_call.children.size; i++ )
 	{
-		auto arg_exprr = codegen.codegen_expr(fn, arg_expr_node);
+		auto arg_exprr = codegen.codegen_expr(fn, body.child_expr(ir_call.children, i));
 		if( !arg_exprr.ok() )
 			return arg_exprr;
 
@@ -77,8 +87,7 @@ cg::codegen_call(CG& codegen, cg::LLVMFnInfo& fn, ir::IRCall* ir_call, std::opti
 			// that alloca
 			auto address = arg_expr.address();
 			auto llvm_arg_expr_value = arg_expr.address().llvm_pointer();
-			llvm::AllocaInst* llvm_cpy_alloca =
-				codegen.Builder->CreateAlloca(address.llvm_allocated_type(), nullptr);
+			llvm::AllocaInst* llvm_cpy_alloca = cg_alloca(codegen, address.llvm_allocated_type());
 			auto llvm_size =
 				codegen.Module->getDataLayout().getTypeAllocSize(address.llvm_allocated_type());
 			auto llvm_align =
@@ -102,7 +111,8 @@ cg::codegen_call(CG& codegen, cg::LLVMFnInfo& fn, ir::IRCall* ir_call, std::opti
 
 	// https://github.com/ark-lang/ark/issues/362
 
-	auto llvm_call = codegen.Builder->CreateCall(callee_sig_info.llvm_fn, llvm_arg_values);
+	auto llvm_call = codegen.Builder->CreateCall(
+		llvm::cast<llvm::FunctionType>(callee_sig_info.llvm_fn_ty), llvm_callee, llvm_arg_values);
 	// If an sret arg was provided, then we have already turned the value.
 	if( callee_sig_info.has_sret_arg() )
 		return CGExpr();
@@ -10,6 +10,7 @@
 namespace cg
 {
 class CG;
-CGResult<CGExpr> codegen_call(CG&, cg::LLVMFnInfo&, ir::IRCall*);
-CGResult<CGExpr> codegen_call(CG&, cg::LLVMFnInfo&, ir::IRCall*, std::optional<LValue>);
+CGResult<CGExpr> codegen_call(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&);
+CGResult<CGExpr>
+codegen_call(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&, std::optional<LValue>);
 } // namespace cg
\ No newline at end of file
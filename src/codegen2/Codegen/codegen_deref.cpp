@@ -1,22 +1,24 @@
 #include "codegen_deref.h"
 
 #include "../Codegen.h"
+#include "cg_tbaa.h"
 #include "lookup.h"
 
 using namespace cg;
 
 CGResult<CGExpr>
-cg::codegen_deref(CG& codegen, cg::LLVMFnInfo& fn, ir::IRDeref* ir_addrof)
+cg::codegen_deref(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_deref)
 {
-	auto exprr = codegen.codegen_expr(fn, ir_addrof->expr);
+	auto exprr = codegen.codegen_expr(fn, ir_deref.lhs);
 	if( !exprr.ok() )
 		return exprr;
 	auto expr = exprr.unwrap();
 
 	auto address = expr.address();
-	// TODO: Expr should return l or rvalue. With the type.
-	auto llvm_value =
-		codegen.Builder->CreateLoad(address.llvm_allocated_type(), address.llvm_pointer());
+	auto llvm_pointer_value = cg_load(codegen, address);
 
-	return CGExpr::MakeRValue(RValue(llvm_value, address.llvm_allocated_type()));
+	auto pointee_type = fn.body().expr(ir_deref.lhs).type_instance.Dereference();
+	return CGExpr::MakeAddress(
+		LLVMAddress(llvm_pointer_value, address.llvm_allocated_type()->getPointerElementType())
+			.with_tbaa(cg_tbaa_access_tag(codegen, pointee_type)));
 }
\ No newline at end of file
@@ -6,6 +6,30 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Value.h>
 
+static void
+add_fn_attributes(llvm::Function* llvm_fn, ast::AttributeSet attributes)
+{
+	if( attributes.has(ast::Attribute::Inline) )
+		llvm_fn->addFnAttr(llvm::Attribute::AlwaysInline);
+	if( attributes.has(ast::Attribute::NoInline) )
+		llvm_fn->addFnAttr(llvm::Attribute::NoInline);
+	if( attributes.has(ast::Attribute::Hot) )
+		llvm_fn->addFnAttr(llvm::Attribute::Hot);
+	if( attributes.has(ast::Attribute::Cold) )
+		llvm_fn->addFnAttr(llvm::Attribute::Cold);
+}
+
+static void
+add_param_attributes(llvm::Function* llvm_fn, int arg_ind, ast::AttributeSet attributes)
+{
+	if( attributes.has(ast::Attribute::NoAlias) )
+		llvm_fn->addParamAttr(arg_ind, llvm::Attribute::NoAlias);
+	if( attributes.has(ast::Attribute::ReadOnly) )
+		llvm_fn->addParamAttr(arg_ind, llvm::Attribute::ReadOnly);
+	if( attributes.has(ast::Attribute::NoCapture) )
+		llvm_fn->addParamAttr(arg_ind, llvm::Attribute::NoCapture);
+}
+
 cg::LLVMFnSigInfo
 cg::codegen_fn_sig_info(CG& codegen, LLVMFnSigInfoBuilder const& builder)
 {
@@ -15,6 +39,8 @@ cg::codegen_fn_sig_info(CG& codegen, LLVMFnSigInfoBuilder const& builder)
 	llvm::Function* llvm_fn = llvm::Function::Create(
 		llvm_fn_ty, llvm::Function::ExternalLinkage, builder.name, codegen.Module.get());
 
+	add_fn_attributes(llvm_fn, builder.fn_attributes);
+
 	int arg_ind = 0;
 	for( auto& abi_arg : builder.abi_arg_infos )
 	{
@@ -41,6 +67,8 @@ cg::codegen_fn_sig_info(CG& codegen, LLVMFnSigInfoBuilder const& builder)
 		}
 		}
 
+		add_param_attributes(llvm_fn, arg_ind, abi_arg.attributes);
+
 		arg_ind++;
 	}
 
@@ -5,6 +5,8 @@
 #include "LLVMFnInfoBuilder.h"
 #include "LLVMFnSigInfo.h"
 #include "LLVMFnSigInfoBuilder.h"
+#include "cg_coro.h"
+#include "cg_tbaa.h"
 #include "codegen_fn_sig_info.h"
 #include "lookup.h"
 
@@ -43,7 +45,8 @@ get_named_params(CG& cg, ir::IRProto* proto)
 			else
 			{
 				args.args.emplace_back(
-					String(name), LLVMArgABIInfo(LLVMArgABIInfo::Default, llvm_arg_ty));
+					String(name),
+					LLVMArgABIInfo(LLVMArgABIInfo::Default, llvm_arg_ty, arg->attributes));
 			}
 		}
 		else
@@ -55,8 +58,17 @@ get_named_params(CG& cg, ir::IRProto* proto)
 	return args;
 }
 
+/**
+ * @brief 1-based position of the arg in the sushi signature, i.e. excluding sret.
+ */
+static int
+named_arg_no(cg::LLVMFnSigInfo& fn_info, int arg_ind)
+{
+	return arg_ind + 1 - (fn_info.has_sret_arg() ? 1 : 0);
+}
+
 static cg::CGResult<LLVMFnInfo>
-codegen_function_entry(CG& codegen, cg::LLVMFnSigInfo& fn_info)
+codegen_function_entry(CG& codegen, cg::LLVMFnSigInfo& fn_info, bool is_async)
 {
 	LLVMFnInfoBuilder builder(fn_info);
 
@@ -78,13 +90,23 @@ codegen_function_entry(CG& codegen, cg::LLVMFnSigInfo& fn_info)
 			assert(maybe_name.has_value());
 			auto name = maybe_name.value();
 
+			llvm::MDNode* tbaa = nullptr;
+			auto maybe_member = fn_info.sema_fn_ty->get_member(name);
+			if( maybe_member.has_value() )
+				tbaa = cg_tbaa_access_tag(codegen, maybe_member.value().type);
+
 			llvm::AllocaInst* llvm_alloca =
 				codegen.Builder->CreateAlloca(arg_abi.llvm_type, nullptr, name);
-			codegen.Builder->CreateStore(llvm_arg, llvm_alloca);
+			auto address = LLVMAddress(llvm_alloca, arg_abi.llvm_type).with_tbaa(tbaa);
+			cg_store(codegen, llvm_arg, address);
 
-			auto lvalue = LValue(llvm_alloca, arg_abi.llvm_type);
+			auto lvalue = LValue(address);
 			builder.add_arg(LLVMFnArgInfo::Named(name, arg_abi, lvalue));
 
+			if( codegen.debug_info && maybe_member.has_value() )
+				codegen.debug_info->declare_param(
+					llvm_alloca, name, named_arg_no(fn_info, arg_ind), maybe_member.value().type);
+
 			break;
 		}
 		case LLVMArgABIInfo::SRet:
@@ -100,9 +122,29 @@ codegen_function_entry(CG& codegen, cg::LLVMFnSigInfo& fn_info)
 			assert(maybe_name.has_value());
 			auto name = maybe_name.value();
 
+			llvm::Value* llvm_storage = llvm_arg;
 			auto lvalue = LValue(llvm_arg, llvm_arg->getType()->getPointerElementType());
 
+			// The caller's copy may be gone by the time an async fn is resumed.
+			if( is_async )
+			{
+				auto llvm_type = llvm_arg->getType()->getPointerElementType();
+				auto llvm_size = codegen.Module->getDataLayout().getTypeAllocSize(llvm_type);
+				auto llvm_align = codegen.Module->getDataLayout().getPrefTypeAlign(llvm_type);
+				llvm::AllocaInst* llvm_alloca =
+					codegen.Builder->CreateAlloca(llvm_type, nullptr, name);
+				codegen.Builder->CreateMemCpy(
+					llvm_alloca, llvm_align, llvm_arg, llvm_align, llvm_size);
+				llvm_storage = llvm_alloca;
+				lvalue = LValue(llvm_alloca, llvm_type);
+			}
+
 			builder.add_arg(LLVMFnArgInfo::Named(name, arg_abi, lvalue));
+
+			auto maybe_member = fn_info.sema_fn_ty->get_member(name);
+			if( codegen.debug_info && maybe_member.has_value() )
+				codegen.debug_info->declare_param(
+					llvm_storage, name, named_arg_no(fn_info, arg_ind), maybe_member.value().type);
 			break;
 		}
 		}
@@ -128,18 +170,41 @@ cg::codegen_function(CG& cg, ir::IRFunction* ir_fn)
 	if( !protor.ok() )
 		return protor;
 
-	auto fn_sig_info = protor.unwrap();
+	auto fn_sig_info = *protor.unwrap();
 
-	auto entryr = codegen_function_entry(cg, fn_sig_info);
+	if( cg.debug_info )
+		cg.debug_info->begin_function(
+			fn_sig_info.llvm_fn, *ir_fn->proto->name, ir_fn->proto->fn_type, ir_fn->node);
+
+	auto is_async = ir_fn->proto->is_async;
+	auto entryr = codegen_function_entry(cg, fn_sig_info, is_async);
 	if( !entryr.ok() )
 		return entryr;
 	auto fn_info = entryr.unwrap();
+	fn_info.set_body(ir_fn->body);
+
+	if( is_async )
+	{
+		auto coror = cg_coro_begin(cg, fn_info, ir_fn->proto->rt->type_instance);
+		if( !coror.ok() )
+			return coror;
+	}
 
-	auto bodyr = codegen_function_body(cg, fn_info, ir_fn->block);
+	auto bodyr = codegen_function_body(cg, fn_info, ir_fn->body->body);
 	if( !bodyr.ok() )
 		return bodyr;
 
-	return protor;
+	if( is_async )
+	{
+		cg_coro_end(cg, fn_info);
+		// Tells the coroutine passes to split this fn.
+		fn_sig_info.llvm_fn->addFnAttr("coroutine.presplit", "0");
+	}
+
+	if( cg.debug_info )
+		cg.debug_info->end_function();
+
+	return CGExpr();
 }
 
 static Vec<llvm::Type*>
@@ -153,9 +218,13 @@ from_argtypes(Vec<LLVMArgABIInfo>& args)
 	return vec;
 }
 
-CGResult<LLVMFnSigInfo>
+CGResult<LLVMFnSigInfo const*>
 cg::codegen_function_proto(CG& codegen, ir::IRProto* ir_proto)
 {
+	// Already declared, e.g. by an extern fn or before the bodies were generated.
+	if( auto sig_info = codegen.find_function(ir_proto->fn_type) )
+		return sig_info;
+
 	auto name = ir_proto->name;
 
 	auto paramsr = get_named_params(codegen, ir_proto);
@@ -163,12 +232,14 @@ cg::codegen_function_proto(CG& codegen, ir::IRProto* ir_proto)
 		return paramsr;
 	auto params_info = paramsr.unwrap();
 
-	auto ir_rt_decl = ir_proto->rt;
-	auto retr = get_type(codegen, ir_rt_decl);
+	// Async fns return their future, a coroutine handle.
+	auto sema_rt_ty = ir_proto->rt->type_instance;
+	if( ir_proto->is_async )
+		sema_rt_ty = ir_proto->fn_type->get_return_type().value();
+
+	auto retr = get_type(codegen, sema_rt_ty);
 	if( !retr.ok() )
 		return retr;
-
-	auto sema_rt_ty = ir_rt_decl->type_instance;
 	auto llvm_rt_ty = retr.unwrap();
 
 	LLVMFnSigInfoBuilder builder(*name, ir_proto->fn_type);
@@ -189,25 +260,24 @@ cg::codegen_function_proto(CG& codegen, ir::IRProto* ir_proto)
 		builder.add_arg_type(arg_name, arg_abi);
 
 	builder.set_is_var_arg(params_info.is_var_arg);
+	builder.set_fn_attributes(ir_proto->attributes);
 
 	auto sig_info = codegen_fn_sig_info(codegen, builder);
 
-	codegen.add_function(*name, sig_info);
-
-	return sig_info;
+	return codegen.add_function(Symbol::intern(*name), sig_info);
 }
 
 CGResult<CGExpr>
-cg::codegen_function_body(CG& cg, cg::LLVMFnInfo& ctx, ir::IRBlock* block)
+cg::codegen_function_body(CG& cg, cg::LLVMFnInfo& ctx, ir::StmtId block)
 {
 	auto previous_scope = cg.values;
 
 	for( auto [name, arg] : ctx.named_args )
 	{
-		cg.values.insert_or_assign(name, arg.lvalue);
+		cg.values.insert_or_assign(Symbol::intern(name), arg.lvalue);
 	}
 
-	auto block_return = cg.codegen_block(ctx, block);
+	auto block_return = cg.codegen_block(ctx, ctx.body().stmt(block));
 
 	cg.values = previous_scope;
 
@@ -10,6 +10,6 @@ namespace cg
 class CG;
 
 CGResult<CGExpr> codegen_function(CG&, ir::IRFunction*);
-CGResult<LLVMFnSigInfo> codegen_function_proto(CG&, ir::IRProto*);
-CGResult<CGExpr> codegen_function_body(CG&, cg::LLVMFnInfo&, ir::IRBlock*);
+CGResult<LLVMFnSigInfo const*> codegen_function_proto(CG&, ir::IRProto*);
+CGResult<CGExpr> codegen_function_body(CG&, cg::LLVMFnInfo&, ir::StmtId);
 } // namespace cg
\ No newline at end of file
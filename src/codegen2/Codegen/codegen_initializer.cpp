@@ -3,6 +3,7 @@
 #include "../Codegen.h"
 #include "cg_access.h"
 #include "cg_enum_helpers.h"
+#include "cg_tbaa.h"
 #include "lookup.h"
 #include "operand.h"
 
@@ -13,19 +14,19 @@ struct_initializer(
 	CG& codegen,
 	cg::LLVMFnInfo& fn,
 	sema::TypeInstance const& struct_type,
-	Vec<ir::IRDesignator*>& initializers,
+	ir::FlatRange initializers,
 	LValue lvalue)
 {
-	for( auto designator : initializers )
+	for( std::uint32_t i = 0; i < initializers.size; i++ )
 	{
-		auto member = designator->member;
-		auto ir_expr = designator->expr;
+		auto designator = fn.body().designator(initializers, i);
+		auto& member = designator.member;
+		auto ir_expr = designator.expr;
 
 		auto designator_address =
 			cg_access(codegen, lvalue.address(), struct_type, member).unwrap().address();
 
-		auto designator_lvalue =
-			LValue(designator_address.llvm_pointer(), designator_address.llvm_allocated_type());
+		auto designator_lvalue = LValue(designator_address);
 
 		auto rexprr = codegen.codegen_expr(fn, ir_expr, designator_lvalue);
 		auto rexpr = rexprr.unwrap();
@@ -34,7 +35,7 @@ struct_initializer(
 
 		auto rhs = codegen_operand_expr(codegen, rexpr);
 
-		codegen.Builder->CreateStore(rhs, designator_lvalue.address().llvm_pointer());
+		cg_store(codegen, rhs, designator_lvalue.address());
 	}
 
 	return CGExpr();
@@ -44,7 +45,7 @@ static CGResult<CGExpr>
 enum_initializer(
 	CG& codegen,
 	cg::LLVMFnInfo& fn,
-	ir::IRInitializer* ir_initializer,
+	ir::FlatExpr const& ir_initializer,
 	sema::TypeInstance member_type,
 	LValue lvalue)
 {
@@ -52,13 +53,12 @@ enum_initializer(
 
 	auto nominal = member_type.as_nominal();
 
-	auto nominal_value = cg_enum_nominal(codegen, lvalue.address());
-	auto llvm_enum_nominal_value = nominal_value.llvm_pointer();
+	auto nominal_address = cg_enum_nominal(codegen, lvalue.address());
 
 	llvm::Value* llvm_nominal_value =
 		llvm::ConstantInt::get(*codegen.Context, llvm::APInt(32, nominal.value, true));
 
-	codegen.Builder->CreateStore(llvm_nominal_value, llvm_enum_nominal_value);
+	cg_store(codegen, llvm_nominal_value, nominal_address);
 
 	// For enum fields with no value.
 	if( !member_type.is_struct_type() )
@@ -75,16 +75,17 @@ enum_initializer(
 	auto llvm_enum_union_casted_value = codegen.Builder->CreateBitCast(
 		llvm_enum_union_value, llvm_enum_member_type->getPointerTo());
 
-	auto member_lvalue = LValue(llvm_enum_union_casted_value, llvm_enum_member_type);
+	auto member_lvalue = LValue(LLVMAddress(llvm_enum_union_casted_value, llvm_enum_member_type)
+									.with_tbaa(cg_tbaa_may_alias_tag(codegen)));
 	return struct_initializer(
-		codegen, fn, ir_initializer->type_instance, *ir_initializer->initializers, member_lvalue);
+		codegen, fn, ir_initializer.type_instance, ir_initializer.children, member_lvalue);
 }
 
 static CGResult<CGExpr>
 union_initializer(
 	CG& codegen,
 	cg::LLVMFnInfo& fn,
-	ir::IRInitializer* ir_initializer,
+	ir::FlatExpr const& ir_initializer,
 	sema::TypeInstance member_type,
 	LValue lvalue)
 {
@@ -96,12 +97,13 @@ union_initializer(
 	auto llvm_union_value = codegen.Builder->CreateBitCast(
 		lvalue.address().llvm_pointer(), llvm_union_type->getPointerTo());
 
-	auto bitcasted_lvalue = LValue(llvm_union_value, llvm_union_type);
+	auto bitcasted_lvalue = LValue(
+		LLVMAddress(llvm_union_value, llvm_union_type).with_tbaa(cg_tbaa_may_alias_tag(codegen)));
 	return struct_initializer(
 		codegen,
 		fn,
-		ir_initializer->type_instance,
-		*ir_initializer->initializers,
+		ir_initializer.type_instance,
+		ir_initializer.children,
 		bitcasted_lvalue);
 }
 
@@ -109,21 +111,21 @@ CGResult<CGExpr>
 cg::codegen_initializer(
 	CG& codegen,
 	cg::LLVMFnInfo& fn,
-	ir::IRInitializer* ir_initializer,
+	ir::FlatExpr const& ir_initializer,
 	std::optional<LValue> maybe_lvalue)
 {
 	auto lvalue = maybe_lvalue.value();
 	// TODO: Allocate if not provided?
 
-	auto storage_type = ir_initializer->type_instance.storage_type();
+	auto storage_type = ir_initializer.type_instance.storage_type();
 	if( storage_type.is_enum_type() )
-		return enum_initializer(codegen, fn, ir_initializer, ir_initializer->type_instance, lvalue);
+		return enum_initializer(codegen, fn, ir_initializer, ir_initializer.type_instance, lvalue);
 	else if( storage_type.is_struct_type() )
 		return struct_initializer(
-			codegen, fn, ir_initializer->type_instance, *ir_initializer->initializers, lvalue);
+			codegen, fn, ir_initializer.type_instance, ir_initializer.children, lvalue);
 	else if( storage_type.is_union_type() )
 		return union_initializer(
-			codegen, fn, ir_initializer, ir_initializer->type_instance, lvalue);
+			codegen, fn, ir_initializer, ir_initializer.type_instance, lvalue);
 	else
 		return CGExpr();
 }
\ No newline at end of file
@@ -12,5 +12,5 @@ namespace cg
 class CG;
 
 CGResult<CGExpr>
-codegen_initializer(CG&, cg::LLVMFnInfo&, ir::IRInitializer*, std::optional<LValue>);
+codegen_initializer(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&, std::optional<LValue>);
 } // namespace cg
\ No newline at end of file
@@ -9,5 +9,5 @@ namespace cg
 {
 class CG;
 
-CGResult<CGExpr> codegen_is(CG&, cg::LLVMFnInfo&, ir::IRIs*);
+CGResult<CGExpr> codegen_is(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&);
 } // namespace cg
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "../Codegen.h"
 #include "cg_access.h"
+#include "cg_tbaa.h"
 #include "lookup.h"
 #include "operand.h"
 
@@ -10,10 +11,9 @@ using namespace cg;
 static LLVMAddress
 dereference(CG& codegen, LLVMAddress const& address)
 {
-	auto llvm_expr_ptr_value = address.llvm_pointer();
 	auto llvm_expr_ptr_type = address.llvm_allocated_type();
 
-	auto llvm_expr_value = codegen.Builder->CreateLoad(llvm_expr_ptr_type, llvm_expr_ptr_value);
+	auto llvm_expr_value = cg_load(codegen, address);
 	auto llvm_expr_type = llvm_expr_ptr_type->getPointerElementType();
 
 	return LLVMAddress(llvm_expr_value, llvm_expr_type);
@@ -21,27 +21,30 @@ dereference(CG& codegen, LLVMAddress const& address)
 
 CGResult<CGExpr>
 cg::codegen_indirect_member_access(
-	CG& codegen, cg::LLVMFnInfo& fn, ir::IRIndirectMemberAccess* ir_ma)
+	CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_ma)
 {
-	auto exprr = codegen.codegen_expr(fn, ir_ma->expr);
+	auto exprr = codegen.codegen_expr(fn, ir_ma.lhs);
 	if( !exprr.ok() )
 		return exprr;
 	auto expr = exprr.unwrap();
 
+	auto& body = fn.body();
 	return cg_access(
 		codegen,
 		dereference(codegen, expr.address()),
-		ir_ma->expr->type_instance.Dereference(),
-		ir_ma->member);
+		body.expr(ir_ma.lhs).type_instance.Dereference(),
+		body.members[ir_ma.data.index]);
 }
 
 CGResult<CGExpr>
-cg::codegen_member_access(CG& codegen, cg::LLVMFnInfo& fn, ir::IRMemberAccess* ir_ma)
+cg::codegen_member_access(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatExpr const& ir_ma)
 {
-	auto exprr = codegen.codegen_expr(fn, ir_ma->expr);
+	auto exprr = codegen.codegen_expr(fn, ir_ma.lhs);
 	if( !exprr.ok() )
 		return exprr;
 	auto expr = exprr.unwrap();
 
-	return cg_access(codegen, expr.address(), ir_ma->expr->type_instance, ir_ma->member);
+	auto& body = fn.body();
+	return cg_access(
+		codegen, expr.address(), body.expr(ir_ma.lhs).type_instance, body.members[ir_ma.data.index]);
 }
\ No newline at end of file
@@ -9,6 +9,6 @@ namespace cg
 {
 class CG;
 
-CGResult<CGExpr> codegen_indirect_member_access(CG&, cg::LLVMFnInfo&, ir::IRIndirectMemberAccess*);
-CGResult<CGExpr> codegen_member_access(CG&, cg::LLVMFnInfo&, ir::IRMemberAccess*);
+CGResult<CGExpr> codegen_indirect_member_access(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&);
+CGResult<CGExpr> codegen_member_access(CG&, cg::LLVMFnInfo&, ir::FlatExpr const&);
 } // namespace cg
\ No newline at end of file
@@ -1,18 +1,58 @@
 #include "codegen_return.h"
 
 #include "../Codegen.h"
+#include "cg_coro.h"
+#include "cg_tbaa.h"
 #include "operand.h"
 
 using namespace cg;
 
+/**
+ * @brief Async fns store the result in the promise and go to the final suspend point.
+ */
+static CGResult<CGExpr>
+codegen_coro_return(CG& codegen, cg::LLVMFnInfo& fn, CGExpr& expr)
+{
+	auto& coro = fn.coro().value();
+	if( !expr.is_empty() && coro.promise.has_value() )
+	{
+		auto promise = coro.promise.value();
+		auto llvm_promise_type = promise.llvm_allocated_type();
+		if( llvm_promise_type->isAggregateType() )
+		{
+			auto llvm_size = codegen.Module->getDataLayout().getTypeAllocSize(llvm_promise_type);
+			auto llvm_align = codegen.Module->getDataLayout().getPrefTypeAlign(llvm_promise_type);
+			codegen.Builder->CreateMemCpy(
+				promise.llvm_pointer(),
+				llvm_align,
+				expr.address().llvm_pointer(),
+				llvm_align,
+				llvm_size);
+		}
+		else
+		{
+			cg_store(codegen, codegen_operand_expr(codegen, expr), promise);
+		}
+	}
+
+	codegen.Builder->CreateBr(coro.final_bb);
+	return CGExpr();
+}
+
 CGResult<CGExpr>
-cg::codegen_return(CG& codegen, cg::LLVMFnInfo& fn, ir::IRReturn* ir_return)
+cg::codegen_return(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_return)
 {
-	auto exprr = codegen.codegen_expr(fn, ir_return->expr);
+	auto exprr = codegen.codegen_expr(fn, ir_return.expr);
 	if( !exprr.ok() )
 		return exprr;
 	auto expr = exprr.unwrap();
 
+	// The result was computed above, so nothing reads the futures in scope after this.
+	cg_coro_drop(codegen, fn.all_futures());
+
+	if( fn.coro().has_value() )
+		return codegen_coro_return(codegen, fn, expr);
+
 	if( expr.is_empty() )
 	{
 		codegen.Builder->CreateRetVoid();
@@ -74,12 +74,12 @@ escape_string(String s)
 }
 
 CGResult<CGExpr>
-cg::codegen_string_literal(CG& codegen, ir::IRStringLiteral* lit)
+cg::codegen_string_literal(CG& codegen, String const& value)
 {
 	//
 
 	auto llvm_literal = llvm::ConstantDataArray::getString(
-		*codegen.Context, escape_string(*lit->value).c_str(), true);
+		*codegen.Context, escape_string(value).c_str(), true);
 
 	llvm::GlobalVariable* llvm_global = new llvm::GlobalVariable(
 		*codegen.Module,
@@ -1,10 +1,10 @@
 #pragma once
 #include "../CGExpr.h"
 #include "../CGResult.h"
-#include "sema2/IR.h"
+#include "common/String.h"
 
 namespace cg
 {
 class CG;
-CGResult<CGExpr> codegen_string_literal(CG&, ir::IRStringLiteral* lit);
+CGResult<CGExpr> codegen_string_literal(CG&, String const& value);
 } // namespace cg
\ No newline at end of file
@@ -25,14 +25,15 @@ cg_switch_expr(CG& codegen, CGExpr expr, sema::TypeInstance expr_type)
 }
 
 CGResult<CGExpr>
-cg::codegen_switch(CG& codegen, cg::LLVMFnInfo& fn, ir::IRSwitch* ir_switch)
+cg::codegen_switch(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_switch)
 {
-	auto exprr = codegen.codegen_expr(fn, ir_switch->expr);
+	auto exprr = codegen.codegen_expr(fn, ir_switch.expr);
 	if( !exprr.ok() )
 		return exprr;
 	auto expr = exprr.unwrap();
 
-	auto llvm_switch_value = cg_switch_expr(codegen, expr, ir_switch->expr->type_instance);
+	auto llvm_switch_value =
+		cg_switch_expr(codegen, expr, fn.body().expr(ir_switch.expr).type_instance);
 
 	auto restore_merge_block = fn.merge_block();
 	llvm::BasicBlock* llvm_merge_bb = llvm::BasicBlock::Create(*codegen.Context, "Merge");
@@ -45,7 +46,7 @@ cg::codegen_switch(CG& codegen, cg::LLVMFnInfo& fn, ir::IRSwitch* ir_switch)
 		codegen.Builder->CreateSwitch(llvm_switch_value, llvm_default_bb, 4);
 	fn.set_switch_inst(LLVMSwitchInfo(llvm_switch, expr.address(), llvm_merge_bb, llvm_default_bb));
 
-	auto blockgen = codegen.codegen_block(fn, ir_switch->block);
+	auto blockgen = codegen.codegen_block(fn, fn.body().stmt(ir_switch.body));
 	if( !blockgen.ok() )
 		return blockgen;
 
@@ -63,7 +64,7 @@ cg::codegen_switch(CG& codegen, cg::LLVMFnInfo& fn, ir::IRSwitch* ir_switch)
 }
 
 CGResult<CGExpr>
-cg::codegen_case(CG& codegen, cg::LLVMFnInfo& fn, ir::IRCase* ir_case)
+cg::codegen_case(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_case)
 {
 	assert(fn.switch_inst().has_value());
 
@@ -72,31 +73,32 @@ cg::codegen_case(CG& codegen, cg::LLVMFnInfo& fn, ir::IRCase* ir_case)
 
 	// TODO: backing int type
 	llvm::ConstantInt* llvm_const_int =
-		llvm::ConstantInt::get(*codegen.Context, llvm::APInt(32, ir_case->value, true));
+		llvm::ConstantInt::get(*codegen.Context, llvm::APInt(32, ir_case.case_value, true));
 
 	// TODO: If default block.
 	llvm::BasicBlock* llvm_case_bb =
-		ir_case->is_default ? switch_info.default_bb()
-							: llvm::BasicBlock::Create(
-								  *codegen.Context, std::to_string(ir_case->value), fn.llvm_fn());
+		ir_case.is_default
+			? switch_info.default_bb()
+			: llvm::BasicBlock::Create(
+				  *codegen.Context, std::to_string(ir_case.case_value), fn.llvm_fn());
 
 	llvm_switch_inst->addCase(llvm_const_int, llvm_case_bb);
 
 	codegen.Builder->SetInsertPoint(llvm_case_bb);
 
-	if( ir_case->discriminations )
+	if( ir_case.bindings.size != 0 )
 	{
 		auto temp_address = CGExpr();
-		temp_address.add_discrimination(CGExpr::MakeAddress(switch_info.switch_cond()));
-		cg_discriminations(codegen, temp_address, *ir_case->discriminations);
+		temp_address.add_discrimination(switch_info.switch_cond());
+		cg_discriminations(codegen, fn, temp_address, ir_case.bindings);
 	}
 
-	auto codegen_result = codegen.codegen_stmt(fn, ir_case->block);
+	auto codegen_result = codegen.codegen_stmt(fn, ir_case.body);
 	if( !codegen_result.ok() )
 		return codegen_result;
 
 	// TODO: Have fallthrough block stored in switch ctx.
-	if( !ir_case->is_default )
+	if( !ir_case.is_default )
 		codegen.Builder->CreateBr(switch_info.merge_bb());
 
 	return CGExpr();
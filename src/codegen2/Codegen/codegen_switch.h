@@ -7,7 +7,7 @@
 namespace cg
 {
 class CG;
-CGResult<CGExpr> codegen_switch(CG&, cg::LLVMFnInfo&, ir::IRSwitch*);
+CGResult<CGExpr> codegen_switch(CG&, cg::LLVMFnInfo&, ir::FlatStmt const&);
 
-CGResult<CGExpr> codegen_case(CG&, cg::LLVMFnInfo&, ir::IRCase*);
+CGResult<CGExpr> codegen_case(CG&, cg::LLVMFnInfo&, ir::FlatStmt const&);
 } // namespace cg
\ No newline at end of file
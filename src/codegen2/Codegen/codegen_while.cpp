@@ -7,7 +7,7 @@
 using namespace cg;
 
 CGResult<CGExpr>
-cg::codegen_while(CG& codegen, cg::LLVMFnInfo& fn, ir::IRWhile* ir_while)
+cg::codegen_while(CG& codegen, cg::LLVMFnInfo& fn, ir::FlatStmt const& ir_while)
 {
 	auto llvm_fn = fn.llvm_fn();
 	llvm::BasicBlock* llvm_cond_bb =
@@ -25,7 +25,7 @@ cg::codegen_while(CG& codegen, cg::LLVMFnInfo& fn, ir::IRWhile* ir_while)
 	codegen.Builder->CreateBr(llvm_cond_bb);
 	codegen.Builder->SetInsertPoint(llvm_cond_bb);
 
-	auto condr = codegen.codegen_expr(fn, ir_while->condition);
+	auto condr = codegen.codegen_expr(fn, ir_while.expr);
 	if( !condr.ok() )
 		return condr;
 	auto cond = condr.unwrap();
@@ -36,7 +36,7 @@ cg::codegen_while(CG& codegen, cg::LLVMFnInfo& fn, ir::IRWhile* ir_while)
 	llvm_fn->getBasicBlockList().push_back(llvm_loop_bb);
 	codegen.Builder->SetInsertPoint(llvm_loop_bb);
 
-	auto bodyr = codegen.codegen_stmt(fn, ir_while->body);
+	auto bodyr = codegen.codegen_stmt(fn, ir_while.body);
 	if( !bodyr.ok() )
 		return bodyr;
 	auto body = bodyr.unwrap();
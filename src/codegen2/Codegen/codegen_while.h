@@ -8,5 +8,5 @@ namespace cg
 {
 class CG;
 
-CGResult<CGExpr> codegen_while(CG&, cg::LLVMFnInfo&, ir::IRWhile*);
+CGResult<CGExpr> codegen_while(CG&, cg::LLVMFnInfo&, ir::FlatStmt const&);
 } // namespace cg
\ No newline at end of file
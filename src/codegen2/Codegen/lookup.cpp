@@ -49,7 +49,7 @@ cg::get_type(CG& cg, ir::IRValueDecl* decl)
 
 // Get LValue?
 std::optional<LValue>
-cg::get_value(CG& cg, String const& name)
+cg::get_value(CG& cg, Symbol name)
 {
 	auto iter_value = cg.values.find(name);
 	if( iter_value != cg.values.end() )
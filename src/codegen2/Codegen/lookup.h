@@ -5,6 +5,7 @@
 #include "../CGResult.h"
 #include "../LValue.h"
 #include "LLVMFnSigInfo.h"
+#include "common/Symbol.h"
 #include "common/Vec.h"
 #include "sema2/IR.h"
 #include "sema2/Scope.h"
@@ -30,5 +31,5 @@ CGResult<llvm::Type*> get_type(CG& cg, ir::IRTypeDeclaraor* decl);
 
 CGResult<llvm::Type*> get_type(CG& cg, ir::IRValueDecl* decl);
 
-std::optional<LValue> get_value(CG&, String const&);
+std::optional<LValue> get_value(CG&, Symbol name);
 } // namespace cg
\ No newline at end of file
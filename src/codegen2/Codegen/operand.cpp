@@ -1,6 +1,7 @@
 #include "operand.h"
 
 #include "../Codegen.h"
+#include "cg_tbaa.h"
 
 using namespace cg;
 
@@ -9,8 +10,7 @@ cg::codegen_operand_expr(CG& codegen, CGExpr& result)
 {
 	if( result.is_address() )
 	{
-		auto address = result.address();
-		return codegen.Builder->CreateLoad(address.llvm_allocated_type(), address.llvm_pointer());
+		return cg_load(codegen, result.address());
 	}
 	else
 	{
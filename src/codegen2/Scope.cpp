@@ -6,13 +6,13 @@ Scope::Scope(Scope* parent)
 {}
 
 void
-Scope::add_lvalue(String const& name, LValue lvalue)
+Scope::add_lvalue(Symbol name, LValue lvalue)
 {
 	values.emplace(name, lvalue);
 }
 
 std::optional<LValue>
-Scope::lookup(String const& name) const
+Scope::lookup(Symbol name) const
 {
 	auto iter_values = values.find(name);
 	if( iter_values != values.end() )
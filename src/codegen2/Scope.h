@@ -1,22 +1,23 @@
 #pragma once
 #include "LValue.h"
 #include "common/String.h"
+#include "common/Symbol.h"
 
-#include <map>
 #include <optional>
+#include <unordered_map>
 
 namespace cg
 {
 class Scope
 {
-	std::map<String, LValue> values;
+	std::unordered_map<Symbol, LValue> values;
 	Scope* parent = nullptr;
 
 public:
 	Scope(Scope* parent);
 
-	void add_lvalue(String const& name, LValue lvalue);
-	std::optional<LValue> lookup(String const& name) const;
+	void add_lvalue(Symbol name, LValue lvalue);
+	std::optional<LValue> lookup(Symbol name) const;
 	Scope* get_parent() const;
 };
 } // namespace cg
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Vec.h"
+
+#include <memory>
+
+/**
+ * @brief Owns objects of any type and deletes them with it. For nodes that point into
+ * each other and so live and die together, e.g. the AstNodes of an Ast.
+ */
+class Owned
+{
+	Vec<std::unique_ptr<void, void (*)(void*)>> objects;
+
+public:
+	Owned() = default;
+	Owned(Owned&&) = default;
+	Owned& operator=(Owned&&) = default;
+	Owned(Owned const&) = delete;
+	Owned& operator=(Owned const&) = delete;
+
+	template<typename T>
+	T* own(T* object)
+	{
+		objects.emplace_back(object, [](void* p) { delete static_cast<T*>(p); });
+		return object;
+	}
+
+	/**
+	 * @brief Takes the objects of 'other', which is left empty.
+	 */
+	void take(Owned& other)
+	{
+		objects.reserve(objects.size() + other.objects.size());
+		for( auto& object : other.objects )
+			objects.push_back(std::move(object));
+		other.objects.clear();
+	}
+
+	unsigned int size() const { return objects.size(); }
+};
@@ -0,0 +1,138 @@
+#include "Symbol.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+// Files are parsed on several threads, so the table is split into shards by hash, each
+// with its own lock. Names are stored in fixed size blocks that never move, so str()
+// reads them without a lock.
+constexpr unsigned int block_bits = 12;
+constexpr unsigned int block_size = 1u << block_bits;
+constexpr unsigned int max_blocks = 1u << 16;
+constexpr unsigned int shard_count = 64;
+
+struct Shard
+{
+	std::mutex mutex;
+	std::unordered_map<std::string_view, unsigned int> ids;
+};
+
+struct SymbolTable
+{
+	std::unique_ptr<std::atomic<String*>[]> blocks{new std::atomic<String*>[max_blocks]{}};
+	std::mutex blocks_mutex;
+	std::atomic<unsigned int> next_id{1};
+
+	Shard shards[shard_count];
+
+	std::mutex qualified_mutex;
+	std::unordered_map<std::uint64_t, unsigned int> qualified_ids;
+
+	SymbolTable()
+	{
+		// Symbol{} is the empty name.
+		auto& shard = shard_of("");
+		shard.ids.emplace(*slot(0), 0);
+	}
+
+	~SymbolTable()
+	{
+		for( unsigned int i = 0; i < max_blocks; i++ )
+			delete[] blocks[i].load();
+	}
+
+	Shard& shard_of(std::string_view name)
+	{
+		return shards[std::hash<std::string_view>{}(name) % shard_count];
+	}
+
+	String* slot(unsigned int id)
+	{
+		auto& block = blocks[id >> block_bits];
+		auto names = block.load(std::memory_order_acquire);
+		if( names == nullptr )
+		{
+			std::lock_guard<std::mutex> lock{blocks_mutex};
+			names = block.load(std::memory_order_relaxed);
+			if( names == nullptr )
+			{
+				names = new String[block_size];
+				block.store(names, std::memory_order_release);
+			}
+		}
+
+		return &names[id & (block_size - 1)];
+	}
+};
+
+SymbolTable&
+table()
+{
+	static SymbolTable symbols;
+	return symbols;
+}
+} // namespace
+
+Symbol
+Symbol::intern(std::string_view name)
+{
+	auto& symbols = table();
+	auto& shard = symbols.shard_of(name);
+
+	std::lock_guard<std::mutex> lock{shard.mutex};
+	auto iter = shard.ids.find(name);
+	if( iter != shard.ids.end() )
+		return Symbol(iter->second);
+
+	unsigned int id = symbols.next_id.fetch_add(1, std::memory_order_relaxed);
+	// Symbols are never freed, so a server or session that runs long enough could use
+	// them all up. The table cannot grow past its blocks without moving them.
+	if( (id >> block_bits) >= max_blocks )
+	{
+		std::fprintf(
+			stderr,
+			"sushi: out of symbols, more than %u distinct names\n",
+			max_blocks * block_size - 1);
+		std::abort();
+	}
+
+	auto slot = symbols.slot(id);
+	*slot = String(name);
+	shard.ids.emplace(*slot, id);
+
+	return Symbol(id);
+}
+
+Symbol
+Symbol::qualified(Symbol scope, Symbol name)
+{
+	auto& symbols = table();
+
+	std::uint64_t key = (std::uint64_t(scope.id_) << 32) | name.id_;
+	{
+		std::lock_guard<std::mutex> lock{symbols.qualified_mutex};
+		auto iter = symbols.qualified_ids.find(key);
+		if( iter != symbols.qualified_ids.end() )
+			return Symbol(iter->second);
+	}
+
+	auto symbol = intern(scope.str() + "#" + name.str());
+
+	std::lock_guard<std::mutex> lock{symbols.qualified_mutex};
+	symbols.qualified_ids.emplace(key, symbol.id_);
+
+	return symbol;
+}
+
+String const&
+Symbol::str() const
+{
+	return *table().slot(id_);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "String.h"
+
+#include <functional>
+#include <string_view>
+
+/**
+ * @brief Interned name. Names with the same spelling have the same Symbol,
+ * so comparing and hashing are integer operations.
+ *
+ * The intern table is global, thread safe and lives for the whole process.
+ * Trivial so it can live in the ast node unions; Symbol{} is the empty name.
+ */
+class Symbol
+{
+	unsigned int id_;
+
+	explicit Symbol(unsigned int id)
+		: id_(id)
+	{}
+
+public:
+	Symbol() = default;
+
+	static Symbol intern(std::string_view name);
+
+	/**
+	 * @brief Interns the qualified name "scope#name", i.e. Enum#Member.
+	 *
+	 * Repeat lookups for the same pair do not touch the string.
+	 */
+	static Symbol qualified(Symbol scope, Symbol name);
+
+	String const& str() const;
+	unsigned int id() const { return id_; }
+	bool empty() const { return id_ == 0; }
+
+	bool operator==(Symbol other) const { return id_ == other.id_; }
+	bool operator!=(Symbol other) const { return id_ != other.id_; }
+	bool operator<(Symbol other) const { return id_ < other.id_; }
+};
+
+template<>
+struct std::hash<Symbol>
+{
+	std::size_t operator()(Symbol symbol) const noexcept { return symbol.id(); }
+};
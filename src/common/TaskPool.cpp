@@ -0,0 +1,141 @@
+#include "TaskPool.h"
+
+#include <algorithm>
+
+namespace
+{
+// The pool and queue of the worker running on this thread.
+thread_local TaskPool const* current_pool = nullptr;
+thread_local unsigned int current_index = 0;
+} // namespace
+
+TaskPool::TaskPool(unsigned int thread_count)
+{
+	if( thread_count == 0 )
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	for( unsigned int i = 0; i < thread_count + 1; i++ )
+		queues.push_back(std::make_unique<Queue>());
+
+	for( unsigned int i = 0; i < thread_count; i++ )
+		threads.emplace_back([this, i]() { work(i); });
+}
+
+TaskPool::~TaskPool()
+{
+	wait();
+
+	{
+		std::lock_guard<std::mutex> lock{sleep_mutex};
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for( auto& thread : threads )
+		thread.join();
+}
+
+unsigned int
+TaskPool::current_queue() const
+{
+	return current_pool == this ? current_index : threads.size();
+}
+
+void
+TaskPool::spawn(Task task)
+{
+	auto& queue = *queues[current_queue()];
+	unfinished.fetch_add(1);
+	queued.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> lock{queue.mutex};
+		queue.tasks.push_back(std::move(task));
+	}
+
+	// A worker that saw nothing queued is either already waiting or will see the task.
+	{
+		std::lock_guard<std::mutex> lock{sleep_mutex};
+	}
+	wake.notify_one();
+}
+
+/**
+ * @brief Runs the newest task of queue 'index', or steals the oldest task of another
+ * queue. False if every queue is empty.
+ */
+bool
+TaskPool::run_one(unsigned int index)
+{
+	Task task;
+	for( unsigned int i = 0; i < queues.size() && !task; i++ )
+	{
+		auto& queue = *queues[(index + i) % queues.size()];
+		std::lock_guard<std::mutex> lock{queue.mutex};
+		if( queue.tasks.empty() )
+			continue;
+
+		if( i == 0 )
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+	}
+
+	if( !task )
+		return false;
+
+	queued.fetch_sub(1);
+	task();
+
+	{
+		std::lock_guard<std::mutex> lock{sleep_mutex};
+		unfinished.fetch_sub(1);
+	}
+	// Waiters in run_until may be waiting on what this task produced.
+	wake.notify_all();
+
+	return true;
+}
+
+void
+TaskPool::work(unsigned int index)
+{
+	current_pool = this;
+	current_index = index;
+
+	while( true )
+	{
+		if( run_one(index) )
+			continue;
+
+		std::unique_lock<std::mutex> lock{sleep_mutex};
+		wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+		if( stopping && queued.load() == 0 )
+			return;
+	}
+}
+
+void
+TaskPool::run_until(std::function<bool()> const& done)
+{
+	auto index = current_queue();
+	while( !done() )
+	{
+		if( run_one(index) )
+			continue;
+
+		std::unique_lock<std::mutex> lock{sleep_mutex};
+		wake.wait(lock, [&]() { return queued.load() > 0 || done(); });
+	}
+}
+
+void
+TaskPool::wait()
+{
+	run_until([this]() { return unfinished.load() == 0; });
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Vec.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Runs tasks on a fixed set of threads.
+ *
+ * Each worker has its own queue. A task spawned on a worker goes to the back of that
+ * worker's queue, and the worker takes from the back, so related work stays on one
+ * thread. Idle workers steal from the front of the other queues.
+ */
+class TaskPool
+{
+public:
+	using Task = std::function<void()>;
+
+	/**
+	 * @brief threads == 0 uses one thread per core.
+	 */
+	explicit TaskPool(unsigned int threads = 0);
+
+	/**
+	 * @brief Finishes the queued tasks, then joins the threads.
+	 */
+	~TaskPool();
+
+	TaskPool(TaskPool const&) = delete;
+	TaskPool& operator=(TaskPool const&) = delete;
+
+	void spawn(Task task);
+
+	/**
+	 * @brief Runs tasks on the calling thread until 'done' returns true.
+	 *
+	 * 'done' is checked again each time a task finishes, so it must only read state
+	 * that tasks publish, e.g. atomics.
+	 */
+	void run_until(std::function<bool()> const& done);
+
+	/**
+	 * @brief Runs tasks on the calling thread until every task has finished.
+	 */
+	void wait();
+
+	unsigned int size() const { return threads.size(); }
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	// One per worker, and a last one for tasks spawned from other threads.
+	Vec<std::unique_ptr<Queue>> queues;
+	Vec<std::thread> threads;
+
+	// Spawned and not yet taken, and spawned and not yet finished.
+	std::atomic<unsigned int> queued{0};
+	std::atomic<unsigned int> unfinished{0};
+	bool stopping = false;
+
+	std::mutex sleep_mutex;
+	std::condition_variable wake;
+
+	void work(unsigned int index);
+	bool run_one(unsigned int index);
+	unsigned int current_queue() const;
+};
@@ -0,0 +1,343 @@
+#include "CompilerInstance.h"
+
+#include "ast2/AstTags.h"
+#include "codegen2/CGBitcode.h"
+#include "codegen2/CGPassPipeline.h"
+#include "codegen2/Codegen.h"
+#include "lexer/Lexer.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "sema2/ModuleInterface.h"
+#include "sema2/Sema2.h"
+#include "sema2/SemaGen.h"
+
+#include <iomanip>
+#include <iostream>
+#include <optional>
+
+using namespace driver;
+using namespace llvm;
+
+static TargetMachine*
+create_target_machine(String const& TargetTriple, String& error)
+{
+	auto CPU = "generic";
+	auto Features = "";
+
+	InitializeAllTargetInfos();
+	InitializeAllTargets();
+	InitializeAllTargetMCs();
+	InitializeAllAsmParsers();
+	InitializeAllAsmPrinters();
+	TargetOptions opt;
+	auto RM = Optional<Reloc::Model>();
+
+	auto Target = TargetRegistry::lookupTarget(TargetTriple, error);
+	if( !Target )
+		return nullptr;
+
+	return Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM);
+}
+
+// main is a root of -fonly-reachable when it exists, so it needs no --root.
+static bool
+declares_main(Vec<sema::DeclaredModule> const& modules)
+{
+	for( auto const& module : modules )
+	{
+		for( auto const& item : module.items )
+		{
+			if( item.proto != nullptr && *item.proto->name == "main" )
+				return true;
+		}
+	}
+
+	return false;
+}
+
+namespace
+{
+/**
+ * @brief Adds the time from construction to the end of the scope to a phase.
+ */
+class PhaseTimer
+{
+	CompileStats::Duration& phase;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+	explicit PhaseTimer(CompileStats::Duration& phase)
+		: phase(phase)
+	{}
+	~PhaseTimer() { phase += std::chrono::steady_clock::now() - start; }
+};
+} // namespace
+
+void
+CompileStats::print(std::ostream& out) const
+{
+	auto row = [&out](char const* name, Duration duration) {
+		auto ms = std::chrono::duration<double, std::milli>(duration).count();
+		out << std::left << std::setw(10) << name << std::right << std::fixed
+			<< std::setprecision(3) << std::setw(10) << ms << " ms" << std::endl;
+	};
+
+	row("parse", parse);
+	row("declare", declare);
+	row("check", check);
+	row("codegen", codegen);
+	row("optimize", optimize);
+	row("emit", emit);
+	row("total", total());
+	out << files << (files == 1 ? " file" : " files")
+		<< (reused_context ? ", LLVMContext reused" : "") << std::endl;
+}
+
+CompileError::CompileError(String message)
+	: message(std::move(message))
+{}
+
+CompileError::CompileError(OwnPtr<ParseError> error)
+	: message(error->error)
+	, parse_error(std::move(error))
+{}
+
+CompileError::CompileError(OwnPtr<sema::SemaError> error)
+	: message(error->error)
+	, sema_error(std::move(error))
+{}
+
+CompileError::CompileError(OwnPtr<cg::CGError> error)
+	: message(error->error)
+	, cg_error(std::move(error))
+{}
+
+void
+CompileError::print() const
+{
+	if( !parse_error.is_null() )
+		parse_error->print();
+	else if( !sema_error.is_null() )
+		sema_error->print();
+	else if( !cg_error.is_null() )
+		cg_error->print();
+	else
+		std::cout << message << std::endl;
+}
+
+CompilerInstance::CompilerInstance() = default;
+
+CompilerInstance::~CompilerInstance() = default;
+
+TaskPool&
+CompilerInstance::pool_for(unsigned int jobs)
+{
+	if( !pool || pool_jobs != jobs )
+	{
+		pool.reset();
+		pool = std::make_unique<TaskPool>(jobs);
+		pool_jobs = jobs;
+	}
+
+	return *pool;
+}
+
+LLVMContext&
+CompilerInstance::context_for_compile(CompileStats& stats)
+{
+	stats.reused_context = context && context_uses < context_reuse_limit;
+	if( !stats.reused_context )
+	{
+		context = std::make_unique<LLVMContext>();
+		context_uses = 0;
+	}
+
+	context_uses += 1;
+	return *context;
+}
+
+CompileOutput
+CompilerInstance::compile(Vec<frontend::SourceBuffer> const& sources, CompileOptions const& options)
+{
+	frontend::Frontend front{pool_for(options.jobs), options.keep_tokens()};
+	front.start(sources);
+	return run(front, options);
+}
+
+CompileOutput
+CompilerInstance::compile_files(Vec<String> const& paths, CompileOptions const& options)
+{
+	frontend::Frontend front{pool_for(options.jobs), options.keep_tokens(), file_cache};
+	front.start(paths);
+	return run(front, options);
+}
+
+CompileOutput
+CompilerInstance::run(frontend::Frontend& front, CompileOptions const& options)
+{
+	CompileOutput output;
+	auto& stats = output.stats;
+	stats.files = front.size();
+
+	auto fail = [&output, &front](CompileError error) {
+		error.sources = front.sources();
+		output.error = OwnPtr<CompileError>(std::move(error));
+		return std::move(output);
+	};
+
+	auto triple =
+		options.target_triple.empty() ? sys::getDefaultTargetTriple() : options.target_triple;
+	if( !target_machine || triple != target_triple )
+	{
+		String target_error;
+		target_machine.reset(create_target_machine(triple, target_error));
+		if( !target_machine )
+			return fail(CompileError(target_error));
+		target_triple = triple;
+	}
+
+	auto const& cg_options = options.cg_options;
+
+	Vec<std::shared_ptr<sema::ModuleInterface const>> interfaces;
+	for( auto const& path : options.interfaces )
+	{
+		auto interfacer = sema::ModuleInterface::open(path);
+		if( !interfacer.ok() )
+			return fail(CompileError(interfacer.unwrap_error()));
+		interfaces.push_back(interfacer.unwrap());
+	}
+
+	// The files are declared in order, as if they were one file. Each file is declared
+	// as soon as it and the files before it are parsed, while the pool parses the rest.
+	// Then the fn bodies of every file are checked on the pool.
+	std::optional<sema::Sema2> sema;
+	Vec<sema::DeclaredModule> declared;
+	for( unsigned int i = 0; i < front.size(); i++ )
+	{
+		OwnPtr<ParseError> error = OwnPtr<ParseError>::null();
+		{
+			PhaseTimer timer{stats.parse};
+			error = front.merge(i);
+		}
+		if( !error.is_null() )
+			return fail(CompileError(std::move(error)));
+
+		PhaseTimer timer{stats.declare};
+		auto& file = front.wait(i);
+		if( options.echo )
+		{
+			std::cout << file.text << std::endl;
+			if( file.tokens )
+				Lexer::print_tokens(*file.tokens);
+		}
+
+		for( auto const& declaration : file.declarations )
+		{
+			for( auto const& interface : interfaces )
+			{
+				if( declaration.kind != ast::NodeType::ExternFn &&
+					interface->has(declaration.name) )
+				{
+					return fail(CompileError(
+						"'" + declaration.name.str() + "' is declared in " + file.path + " and " +
+						interface->path() + "."));
+				}
+			}
+		}
+
+		if( !sema )
+		{
+			sema.emplace(file.ast);
+			for( auto const& interface : interfaces )
+				sema->add_interface(interface);
+		}
+		else
+		{
+			sema->add_ast(file.ast);
+		}
+
+		auto declaredr = sema::sema_declarations(*sema, file.module);
+		if( !declaredr.ok() )
+			return fail(CompileError(declaredr.unwrap_error()));
+
+		declared.push_back(declaredr.unwrap());
+	}
+
+	if( !options.emit_interface.empty() )
+	{
+		PhaseTimer timer{stats.declare};
+		auto writer = sema::write_module_interface(options.emit_interface, declared);
+		if( !writer.ok() )
+			return fail(CompileError(writer.unwrap_error()));
+	}
+
+	ir::IRModule* module;
+	{
+		PhaseTimer timer{stats.check};
+		auto roots = options.roots;
+		if( options.only_reachable && declares_main(declared) )
+			roots.push_back(Symbol::intern("main"));
+		// Nothing would be checked or emitted, which is never what was meant.
+		if( options.only_reachable && roots.empty() )
+			return fail(CompileError(
+				"-fonly-reachable needs a root. The inputs declare no main, so pass --root=<fn>."));
+
+		auto sema_result =
+			sema::sema_bodies(*sema, declared, pool.get(), options.only_reachable ? &roots : nullptr);
+		if( !sema_result.ok() )
+			return fail(CompileError(sema_result.unwrap_error()));
+		module = sema_result.unwrap();
+	}
+
+	std::optional<PhaseTimer> timer;
+	timer.emplace(stats.codegen);
+	cg::CG cg{*sema, cg_options, context_for_compile(stats), *target_machine};
+	if( options.keep_tokens() )
+		cg.enable_debug_info(front.wait(0).path, *front.wait(0).tokens);
+
+	auto cgr = cg.codegen_module(module);
+	if( !cgr.ok() )
+		return fail(CompileError(cgr.unwrap_error()));
+
+	timer.emplace(stats.optimize);
+	run_pass_pipeline(*cg.Module, target_machine.get(), cg_options);
+
+	timer.emplace(stats.emit);
+	if( options.keep_ir || options.echo )
+	{
+		raw_string_ostream OS(output.ir);
+		cg.Module->print(OS, nullptr);
+		OS.flush();
+
+		if( options.echo )
+			std::cout << output.ir;
+		if( !options.keep_ir )
+			output.ir.clear();
+	}
+
+	SmallVector<char, 0> buffer;
+	raw_svector_ostream dest(buffer);
+	if( options.emit_kind == EmitKind::Bitcode )
+	{
+		cg::write_bitcode(*cg.Module, dest, cg_options);
+	}
+	else
+	{
+		legacy::PassManager pass;
+		if( target_machine->addPassesToEmitFile(pass, dest, nullptr, CGFT_ObjectFile) )
+			return fail(CompileError("TheTargetMachine can't emit a file of this type"));
+
+		pass.run(*cg.Module);
+	}
+
+	output.buffer.assign(buffer.begin(), buffer.end());
+	timer.reset();
+
+	return output;
+}
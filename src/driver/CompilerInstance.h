@@ -0,0 +1,171 @@
+#pragma once
+
+#include "ast2/ParseResult.h"
+#include "codegen2/CGOptions.h"
+#include "codegen2/CGResult.h"
+#include "common/OwnPtr.h"
+#include "common/String.h"
+#include "common/Symbol.h"
+#include "common/TaskPool.h"
+#include "common/Vec.h"
+#include "frontend/Frontend.h"
+#include "sema2/SemaResult.h"
+
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+
+namespace llvm
+{
+class LLVMContext;
+class TargetMachine;
+} // namespace llvm
+
+namespace driver
+{
+
+enum class EmitKind
+{
+	Object,
+	Bitcode,
+};
+
+struct CompileOptions
+{
+	cg::CGOptions cg_options;
+	EmitKind emit_kind = EmitKind::Object;
+	// Target triple, e.g. "x86_64-pc-linux-gnu". Empty uses the host's default triple.
+	String target_triple;
+	// Threads for the front end. 0 uses one per core.
+	unsigned int jobs = 0;
+	// Only fns reachable from main, if the inputs declare it, and the roots are checked
+	// and emitted.
+	bool only_reachable = false;
+	Vec<Symbol> roots;
+	// Module interfaces to import, and the file to write the interface of the inputs to.
+	Vec<String> interfaces;
+	String emit_interface;
+	// Returns the optimized IR as text in CompileOutput::ir.
+	bool keep_ir = false;
+	// Prints each source as it is declared, its tokens if kept, and the optimized IR to
+	// stdout, as the sushi command does.
+	bool echo = false;
+
+	// Debug info looks up the token positions of nodes after parsing, so it needs all
+	// the tokens. Otherwise tokens are lexed as the parser reaches them and dropped.
+	bool keep_tokens() const { return cg_options.debug_info != cg::DebugInfoKind::None; }
+};
+
+/**
+ * @brief Wall time of each phase. Parsing runs on the pool while earlier files are
+ * declared, so 'parse' is only the time spent waiting for files.
+ */
+struct CompileStats
+{
+	using Duration = std::chrono::steady_clock::duration;
+
+	Duration parse{};
+	Duration declare{};
+	Duration check{};
+	Duration codegen{};
+	Duration optimize{};
+	Duration emit{};
+
+	unsigned int files = 0;
+	// True if the LLVMContext of an earlier compile was used.
+	bool reused_context = false;
+
+	Duration total() const { return parse + declare + check + codegen + optimize + emit; }
+	void print(std::ostream& out) const;
+};
+
+/**
+ * @brief The error of the phase that failed. It keeps the sources it points into.
+ */
+class CompileError
+{
+public:
+	String message;
+
+	CompileError(String message);
+	CompileError(OwnPtr<ParseError> error);
+	CompileError(OwnPtr<sema::SemaError> error);
+	CompileError(OwnPtr<cg::CGError> error);
+
+	/**
+	 * @brief Prints the error as the sushi command does.
+	 */
+	void print() const;
+
+private:
+	friend class CompilerInstance;
+
+	OwnPtr<ParseError> parse_error = OwnPtr<ParseError>::null();
+	OwnPtr<sema::SemaError> sema_error = OwnPtr<sema::SemaError>::null();
+	OwnPtr<cg::CGError> cg_error = OwnPtr<cg::CGError>::null();
+	Vec<std::shared_ptr<frontend::SourceFile>> sources;
+};
+
+struct CompileOutput
+{
+	// Null unless a phase failed, in which case there is no buffer.
+	OwnPtr<CompileError> error = OwnPtr<CompileError>::null();
+	// The object file, or the bitcode with EmitKind::Bitcode.
+	Vec<char> buffer;
+	// Only with CompileOptions::keep_ir.
+	String ir;
+	CompileStats stats;
+
+	bool ok() const { return error.is_null(); }
+};
+
+/**
+ * @brief Compiles sources to an object or bitcode in memory, for tools that embed the
+ * compiler. An instance keeps its target machine, thread pool and LLVMContext across
+ * compiles, so only the first compile pays for setting them up.
+ *
+ * Compiles on one instance must not overlap. Symbols and type instances are interned
+ * for the whole process, so they are shared by every instance already.
+ */
+class CompilerInstance
+{
+public:
+	/**
+	 * @brief Types and constants that a module creates stay in its LLVMContext, so the
+	 * context is replaced after this many compiles.
+	 */
+	static constexpr unsigned int context_reuse_limit = 64;
+
+	CompilerInstance();
+	~CompilerInstance();
+
+	CompilerInstance(CompilerInstance const&) = delete;
+	CompilerInstance& operator=(CompilerInstance const&) = delete;
+
+	/**
+	 * @brief Files found in the cache are not parsed again. For the compile server.
+	 */
+	void set_file_cache(frontend::FileCache* cache) { file_cache = cache; }
+
+	CompileOutput compile(Vec<frontend::SourceBuffer> const& sources, CompileOptions const& options);
+	CompileOutput compile_files(Vec<String> const& paths, CompileOptions const& options);
+
+private:
+	// Made for the triple of the last compile, and kept while the triple stays the same.
+	std::unique_ptr<llvm::TargetMachine> target_machine;
+	String target_triple;
+
+	// Created on the first compile, so an instance can be made before a fork.
+	std::unique_ptr<TaskPool> pool;
+	unsigned int pool_jobs = 0;
+	std::unique_ptr<llvm::LLVMContext> context;
+	unsigned int context_uses = 0;
+
+	frontend::FileCache* file_cache = nullptr;
+
+	TaskPool& pool_for(unsigned int jobs);
+	llvm::LLVMContext& context_for_compile(CompileStats& stats);
+	CompileOutput run(frontend::Frontend& front, CompileOptions const& options);
+};
+
+} // namespace driver
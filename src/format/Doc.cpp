@@ -0,0 +1,67 @@
+#include "Doc.h"
+
+using namespace format;
+
+static std::uint32_t
+add_width(std::uint32_t l, std::uint32_t r)
+{
+	if( l == Doc::broken || r == Doc::broken )
+		return Doc::broken;
+	return l + r;
+}
+
+DocArena::DocArena()
+{
+	clear();
+}
+
+void
+DocArena::clear()
+{
+	docs.clear();
+	children.clear();
+	text_.clear();
+	scratch.clear();
+
+	line_ = docs.size();
+	docs.push_back(Doc{DocType::line, true, 0, 0, 1});
+	soft_line_ = docs.size();
+	docs.push_back(Doc{DocType::soft_line, true, 0, 0, 0});
+	hard_line_ = docs.size();
+	docs.push_back(Doc{DocType::hard_line, true, 0, 0, Doc::broken});
+}
+
+DocId
+DocArena::text(char const* str, std::uint32_t size)
+{
+	DocId id = docs.size();
+	docs.push_back(Doc{DocType::text, false, (std::uint32_t)text_.size(), size, size});
+	text_.append(str, size);
+	return id;
+}
+
+DocId
+DocArena::parent(DocType type, std::uint32_t mark)
+{
+	Doc doc{type, false, (std::uint32_t)children.size(), (std::uint32_t)(scratch.size() - mark), 0};
+
+	for( std::uint32_t i = mark; i < scratch.size(); i++ )
+	{
+		auto& child = docs[scratch[i]];
+		doc.has_line = doc.has_line || child.has_line;
+		doc.flat_width = add_width(doc.flat_width, child.flat_width);
+		children.push_back(scratch[i]);
+	}
+	scratch.resize(mark);
+
+	// Suffixes are moved to the end of the line, they never make a group break.
+	if( type == DocType::line_suffix )
+	{
+		doc.has_line = false;
+		doc.flat_width = 0;
+	}
+
+	DocId id = docs.size();
+	docs.push_back(doc);
+	return id;
+}
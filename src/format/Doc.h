@@ -0,0 +1,107 @@
+#pragma once
+
+#include "common/String.h"
+#include "common/Vec.h"
+
+#include <cstdint>
+
+namespace format
+{
+
+/**
+ * @brief Index of a doc in DocArena.
+ */
+using DocId = std::uint32_t;
+
+enum class DocType : std::uint8_t
+{
+	text,
+	concat,
+	// A space, or a line break if the enclosing group does not fit.
+	line,
+	// Nothing, or a line break if the enclosing group does not fit.
+	soft_line,
+	// Always a line break.
+	hard_line,
+	// Children are indented one level when they start a new line.
+	indent,
+	// Children are printed flat if they fit on the rest of the line.
+	group,
+	// Printed at the end of the line, e.g. trailing comments.
+	line_suffix,
+};
+
+/**
+ * @brief A node of the document tree. See Wadler, "A prettier printer".
+ */
+struct Doc
+{
+	static constexpr std::uint32_t broken = ~std::uint32_t(0);
+
+	DocType type;
+	// True if any line, soft line or hard line is below this doc.
+	bool has_line = false;
+
+	// text: range of DocArena::text. Otherwise range of DocArena::children.
+	std::uint32_t start = 0;
+	std::uint32_t size = 0;
+
+	// Width when printed on one line, computed once when the doc is created.
+	// 'broken' if it contains a hard line and can never be flat.
+	std::uint32_t flat_width = 0;
+};
+
+/**
+ * @brief Owns every doc of a document in flat arrays.
+ *
+ * Docs are built bottom up. Children are pushed on a scratch stack and the
+ * parent takes them when it is created, so each parent's children are contiguous.
+ */
+class DocArena
+{
+	Vec<Doc> docs;
+	Vec<DocId> children;
+	String text_;
+
+	Vec<DocId> scratch;
+
+	DocId line_;
+	DocId soft_line_;
+	DocId hard_line_;
+
+public:
+	DocArena();
+
+	DocId text(char const* str, std::uint32_t size);
+	DocId text(String const& str) { return text(str.data(), str.size()); }
+
+	DocId line() const { return line_; }
+	DocId soft_line() const { return soft_line_; }
+	DocId hard_line() const { return hard_line_; }
+
+	/**
+	 * @brief Start of the children of the next parent. See 'push'.
+	 */
+	std::uint32_t mark() const { return scratch.size(); }
+	void push(DocId doc) { scratch.push_back(doc); }
+	void push_text(char const* str) { push(text(str, std::char_traits<char>::length(str))); }
+
+	/**
+	 * @brief Creates a parent from the docs pushed since 'mark'.
+	 */
+	DocId concat(std::uint32_t mark) { return parent(DocType::concat, mark); }
+	DocId indent(std::uint32_t mark) { return parent(DocType::indent, mark); }
+	DocId group(std::uint32_t mark) { return parent(DocType::group, mark); }
+	DocId line_suffix(std::uint32_t mark) { return parent(DocType::line_suffix, mark); }
+
+	Doc const& doc(DocId id) const { return docs[id]; }
+	DocId child(Doc const& doc, std::uint32_t i) const { return children[doc.start + i]; }
+	char const* text_of(Doc const& doc) const { return text_.data() + doc.start; }
+
+	void clear();
+
+private:
+	DocId parent(DocType type, std::uint32_t mark);
+};
+
+} // namespace format
@@ -1,541 +1,951 @@
 #include "FormatParser.h"
 
-#include "ast/ast.h"
+#include "ast2/bin_op.h"
 
-FormatParser::GroupScope::GroupScope(FormatParser& ctx)
-	: ctx(ctx)
-{
-	previous = ctx.current_line;
+#include <algorithm>
+#include <string>
 
-	ctx.current_line = NodeSpan::Group();
-}
+using namespace ast;
+using namespace format;
 
-FormatParser::GroupScope::~GroupScope()
+struct attribute_spelling_t
 {
-	previous.append_span(ctx.current_line);
+	char const* name;
+	Attribute attr;
+};
 
-	ctx.current_line = previous;
-}
+// Same order as the parser's spellings so attributes print in a stable order.
+static attribute_spelling_t const attribute_spellings[] = {
+	{"inline", Attribute::Inline},
+	{"noinline", Attribute::NoInline},
+	{"hot", Attribute::Hot},
+	{"cold", Attribute::Cold},
+	{"noalias", Attribute::NoAlias},
+	{"readonly", Attribute::ReadOnly},
+	{"nocapture", Attribute::NoCapture},
+};
 
-FormatParser::DocumentScope::DocumentScope(FormatParser& ctx)
-	: ctx(ctx)
+static char const*
+bin_op_spelling(BinOp op)
 {
-	previous = ctx.current_line;
-
-	ctx.current_line = NodeSpan::Document();
+	switch( op )
+	{
+	case BinOp::plus:
+		return "+";
+	case BinOp::star:
+		return "*";
+	case BinOp::minus:
+		return "-";
+	case BinOp::slash:
+		return "/";
+	case BinOp::gt:
+		return ">";
+	case BinOp::gte:
+		return ">=";
+	case BinOp::lt:
+		return "<";
+	case BinOp::lte:
+		return "<=";
+	case BinOp::and_op:
+		return "&&";
+	case BinOp::or_op:
+		return "||";
+	case BinOp::cmp:
+		return "==";
+	case BinOp::ne:
+		return "!=";
+	case BinOp::bad:
+		break;
+	}
+	return "?";
 }
 
-FormatParser::DocumentScope::~DocumentScope()
+static char const*
+assign_op_spelling(AssignOp op)
 {
-	previous.append_span(ctx.current_line);
-
-	ctx.current_line = previous;
+	switch( op )
+	{
+	case AssignOp::assign:
+		return " = ";
+	case AssignOp::add:
+		return " += ";
+	case AssignOp::sub:
+		return " -= ";
+	case AssignOp::mul:
+		return " *= ";
+	case AssignOp::div:
+		return " /= ";
+	}
+	return " = ";
 }
 
-FormatParser::IndentScope::IndentScope(FormatParser& ctx)
-	: ctx(ctx)
+/**
+ * @brief Prefix operators and 'is' or initializer expressions take everything to
+ * their right, so they need parens when anything follows them.
+ */
+static bool
+is_open_ended(AstNode* node)
 {
-	previous = ctx.current_line;
-
-	ctx.current_line = NodeSpan::Indent();
+	switch( node->type )
+	{
+	case NodeType::Deref:
+	case NodeType::AddressOf:
+	case NodeType::Is:
+	case NodeType::Initializer:
+		return true;
+	default:
+		return false;
+	}
 }
 
-FormatParser::IndentScope::~IndentScope()
+static bool
+is_block_stmt(AstNode* node)
 {
-	previous.append_span(ctx.current_line);
-
-	ctx.current_line = previous;
+	return node->type == NodeType::Stmt && node->data.stmt.stmt->type == NodeType::Block;
 }
 
-void
-FormatParser::visit(ast::Module const* node)
+AstNode*
+format::unwrap_expr(AstNode* node)
 {
-	DocumentScope scope{*this};
+	while( node->type == NodeType::Expr )
+		node = node->data.expr.expr;
+	return node;
+}
 
-	for( auto const& s : node->statements )
+FormatParser::FormatParser(DocArena& docs, LexResult const& tokens, Ast const& ast)
+	: docs(docs)
+	, tokens(tokens)
+	, ast(ast)
+{
+	for( unsigned int i = 0; i < tokens.size(); i++ )
 	{
-		visit_node(s.get());
+		if( tokens.type(i) == TokenType::line_comment )
+			comments.push_back(i);
 	}
 }
 
-void
-FormatParser::visit(ast::Function const* node)
+unsigned int
+FormatParser::first_token(AstNode* node) const
 {
-	DocumentScope st{*this};
-	visit_node(node->Proto.get());
-
-	visit_node(node->Body.get());
+	// Spans start wherever the cursor was, which may be before some comments.
+	unsigned int index = node->span.start;
+	while( index + 1 < tokens.size() && tokens.type(index) == TokenType::line_comment )
+		index++;
+	return index;
+}
 
-	append_newline_if_source(node);
+unsigned int
+FormatParser::last_token(AstNode* node) const
+{
+	// A failed lookahead skips comments, so spans may also end after some.
+	unsigned int index = node->span.start + std::max(node->span.size, 1) - 1;
+	while( index > (unsigned int)node->span.start &&
+		   tokens.type(index) == TokenType::line_comment )
+		index--;
+	return index;
 }
 
-void
-FormatParser::visit(ast::Block const* node)
+DocId
+FormatParser::module(AstNode* node)
 {
-	DocumentScope scope{*this};
+	auto mark = docs.mark();
 
-	append_span(NodeSpan{"{"});
+	next_comment = 0;
+	items(node->data.mod.statements, tokens.size());
+	if( docs.mark() != mark )
+		docs.push(docs.hard_line());
 
-	{
-		IndentScope s{*this};
-		append_span(NodeSpan::HardLine());
+	return docs.concat(mark);
+}
 
-		int idx = 0;
-		for( auto& stmt : node->statements )
-		{
-			visit_node(stmt.get());
+DocId
+FormatParser::item(AstNode* item)
+{
+	auto mark = docs.mark();
 
-			if( idx != node->statements.size() - 1 )
-			{
-				append_span(NodeSpan::MinNewLine(1));
-			}
-			idx += 1;
-		}
-	}
+	seek(first_token(item));
+	node(item);
 
-	append_span(NodeSpan::MinNewLine(1));
-	append_span(NodeSpan{"}"});
-	append_span(NodeSpan::HardLine());
+	// Comments inside the item that no statement claimed.
+	trailing_comments(last_token(item));
+
+	return docs.concat(mark);
 }
 
 void
-FormatParser::visit(ast::BinaryOperation const* node)
+FormatParser::seek(unsigned int token)
 {
-	visit_node(node->LHS.get());
-
-	append_span(NodeSpan{" "});
+	next_comment = std::lower_bound(comments.begin(), comments.end(), token) - comments.begin();
+}
 
-	switch( node->Op )
-	{
-	case ast::BinOp ::plus:
-		append_span(NodeSpan{"+"});
-		break;
-	case ast::BinOp ::star:
-		append_span(NodeSpan{"*"});
-		break;
-	case ast::BinOp ::minus:
-		append_span(NodeSpan{"-"});
-		break;
-	case ast::BinOp ::slash:
-		append_span(NodeSpan{"/"});
-		break;
-	case ast::BinOp ::gt:
-		append_span(NodeSpan{">"});
-		break;
-	case ast::BinOp ::gte:
-		append_span(NodeSpan{">="});
-		break;
-	case ast::BinOp ::lt:
-		append_span(NodeSpan{"<"});
-		break;
-	case ast::BinOp ::lte:
-		append_span(NodeSpan{"<="});
-		break;
-	case ast::BinOp ::and_lex:
-		append_span(NodeSpan{"&&"});
-		break;
-	case ast::BinOp ::or_lex:
-		append_span(NodeSpan{"||"});
-		break;
-	case ast::BinOp ::cmp:
-		append_span(NodeSpan{"=="});
-		break;
-	case ast::BinOp ::ne:
-		append_span(NodeSpan{"!="});
-		break;
-	default:
-		break;
-		// Todo: panic
-	}
-	append_span(NodeSpan{String{node->Op} + " "});
+bool
+FormatParser::blank_line_between(unsigned int token, unsigned int next_token) const
+{
+	return tokens.line_nums[next_token] > tokens.line_nums[token] + 1;
+}
 
-	visit_node(node->RHS.get());
+bool
+FormatParser::comments_before(unsigned int token) const
+{
+	return next_comment < comments.size() && comments[next_comment] < token;
 }
 
 void
-FormatParser::visit(ast::Number const* node)
+FormatParser::comment(unsigned int token)
 {
-	append_span(NodeSpan{std::to_string(node->Val)});
+	char const* start = tokens.input + tokens.offsets[token];
+	std::uint32_t size = tokens.lengths[token];
+	while( size > 0 && (start[size - 1] == ' ' || start[size - 1] == '\t' || start[size - 1] == '\r') )
+		size--;
+
+	docs.push(docs.text(start, size));
 }
 
+/**
+ * @brief Comments before 'before_token', each on its own line.
+ */
 void
-FormatParser::visit(ast::StringLiteral const* node)
+FormatParser::leading_comments(unsigned int before_token)
 {
-	append_span(NodeSpan{(node->Val)});
+	while( next_comment < comments.size() && comments[next_comment] < before_token )
+	{
+		auto token = comments[next_comment++];
+		comment(token);
+		docs.push(docs.hard_line());
+
+		auto next = next_comment < comments.size() && comments[next_comment] < before_token
+						? comments[next_comment]
+						: before_token;
+		if( blank_line_between(token, next) )
+			docs.push(docs.hard_line());
+	}
 }
 
+/**
+ * @brief Comments that are left inside the item ending at 'after_token', and the
+ * comment that follows it on the same line, are moved to the end of the line.
+ */
 void
-FormatParser::visit(ast::Return const* node)
+FormatParser::trailing_comments(unsigned int after_token)
 {
-	append_span(NodeSpan{"return "});
-
-	visit_node(node->ReturnExpr.get());
-	append_span(NodeSpan{";"});
+	while( next_comment < comments.size() )
+	{
+		auto token = comments[next_comment];
+		bool inside = token < after_token;
+		bool same_line =
+			token == after_token + 1 && tokens.line_nums[token] == tokens.line_nums[after_token];
+		if( !inside && !same_line )
+			break;
+
+		auto mark = docs.mark();
+		docs.push_text(" ");
+		comment(token);
+		docs.push(docs.line_suffix(mark));
+
+		next_comment++;
+	}
 }
 
+/**
+ * @brief Statements or members, one per line. Source blank lines between them are
+ * kept, at most one. Comments up to 'end_token' are printed with them.
+ */
 void
-FormatParser::visit(ast::Prototype const* node)
+FormatParser::items(AstList<AstNode*>* list, unsigned int end_token, char const* terminator)
 {
-	append_span("fn ");
-	visit_node(node->Name.get());
-	append_span("(");
-
+	bool first = true;
+	unsigned int prev_last = 0;
+	for( auto item : list->list )
 	{
-		GroupScope g{*this};
+		auto first_tok = first_token(item);
+		if( !first )
 		{
-			IndentScope ind{*this};
-			append_span(NodeSpan::SoftLine());
-
-			auto& args = node->get_parameters()->Parameters;
+			auto next = next_comment < comments.size() && comments[next_comment] < first_tok
+							? comments[next_comment]
+							: first_tok;
 
-			for( int i = 0; i < args.size(); i++ )
-			{
-				auto& arg = args[i];
-
-				visit_node(arg->Name.get());
+			docs.push(docs.hard_line());
+			if( blank_line_between(prev_last, next) )
+				docs.push(docs.hard_line());
+		}
 
-				append_span(": ");
+		leading_comments(first_tok);
+		node(item);
+		if( terminator )
+			docs.push_text(terminator);
 
-				visit_node(arg->Type.get());
+		prev_last = last_token(item);
+		trailing_comments(prev_last);
+		first = false;
+	}
 
-				if( i != args.size() - 1 )
-				{
-					append_span(",");
-					append_span(NodeSpan::SoftLine());
-				}
-			}
+	// Comments after the last item.
+	while( next_comment < comments.size() && comments[next_comment] < end_token )
+	{
+		auto token = comments[next_comment++];
+		if( !first )
+		{
+			docs.push(docs.hard_line());
+			if( blank_line_between(prev_last, token) )
+				docs.push(docs.hard_line());
 		}
-		append_span(NodeSpan::SoftLine());
-	}
 
-	append_span("): ");
-	visit_node(node->ReturnType.get());
-	append_span(" ");
+		comment(token);
+		prev_last = token;
+		first = false;
+	}
 }
 
 void
-FormatParser::visit(ast::ValueIdentifier const* node)
+FormatParser::name_parts(AstList<String*>* parts)
 {
-	append_span(NodeSpan{node->get_name()});
+	bool first = true;
+	for( auto part : parts->list )
+	{
+		if( !first )
+			docs.push_text("::");
+		docs.push(docs.text(*part));
+		first = false;
+	}
 }
 
 void
-FormatParser::visit(ast::TypeIdentifier const* node)
+FormatParser::type_params(AstList<AstNode*>* params)
 {
-	append_span(NodeSpan{node->get_name()});
+	if( !params )
+		return;
+
+	docs.push_text("<");
+	bool first = true;
+	for( auto param : params->list )
+	{
+		if( !first )
+			docs.push_text(", ");
+		node(param);
+		first = false;
+	}
+	docs.push_text(">");
 }
 
 void
-FormatParser::visit(ast::Let const* node)
+FormatParser::type_args(AstNode* node)
 {
-	append_span(NodeSpan{"let "});
+	type_params(ast.type_args(node));
+}
 
-	visit_node(node->Name.get());
-	if( !node->Type->is_empty() )
-	{
-		append_span(NodeSpan{": "});
-		visit_node(node->Type.get());
-	}
+void
+FormatParser::attributes(AttributeSet const* attributes)
+{
+	if( !attributes )
+		return;
 
-	append_span(NodeSpan{" = "});
-	// append_span(NodeSpan::Line());
+	for( auto& spelling : attribute_spellings )
 	{
-		IndentScope ind{*this};
-		visit_node(node->RHS.get());
-		append_span(NodeSpan{";"});
+		if( attributes->has(spelling.attr) )
+		{
+			docs.push_text("@");
+			docs.push_text(spelling.name);
+			docs.push_text(" ");
+		}
 	}
 }
 
+/**
+ * @brief open, the elements separated by ", ", then close. Each element gets its own
+ * line if they don't fit on one.
+ */
 void
-FormatParser::visit(ast::Struct const* node)
+FormatParser::comma_list(AstList<AstNode*>* list, char const* open, char const* close)
 {
-	DocumentScope st{*this};
-	append_span(NodeSpan{"struct "});
-
-	visit_node(node->TypeName.get());
-	append_span(NodeSpan{" {"});
-
+	docs.push_text(open);
+	if( list->list.empty() )
 	{
-		GroupScope g{*this};
-		IndentScope s{*this};
-
-		append_span(NodeSpan::HardLine());
+		docs.push_text(close);
+		return;
+	}
 
-		int idx = 0;
-		for( auto& m : node->MemberVariables )
+	auto group_mark = docs.mark();
+	auto indent_mark = docs.mark();
+	docs.push(docs.soft_line());
+	bool first = true;
+	for( auto elem : list->list )
+	{
+		if( !first )
 		{
-			visit_node(m->Name.get());
-
-			append_span(NodeSpan{": "});
-
-			visit_node(m->Type.get());
-
-			append_span(NodeSpan{";"});
-			if( idx != node->MemberVariables.size() - 1 )
-			{
-				append_span(NodeSpan::HardLine());
-			}
-
-			idx += 1;
+			docs.push_text(",");
+			docs.push(docs.line());
 		}
+		node(elem);
+		first = false;
 	}
+	docs.push(docs.indent(indent_mark));
+	docs.push(docs.soft_line());
+	docs.push_text(close);
 
-	append_span(NodeSpan::HardLine());
-	append_span(NodeSpan{"}"});
-	append_span(NodeSpan::HardLine());
-
-	append_newline_if_source(node);
+	docs.push(docs.group(group_mark));
 }
 
 void
-FormatParser::visit(ast::MemberReference const* node)
+FormatParser::fn_proto(AstNode* node)
 {
-	visit_node(node->base.get());
-	append_span(NodeSpan{"."});
-	visit_node(node->name.get());
-}
+	auto& proto = *node->data.fn_proto;
 
-void
-FormatParser::visit(ast::TypeDeclarator const* node)
-{
-	auto base = node->get_base();
-	if( base )
+	attributes(proto.attributes);
+	this->node(proto.name);
+	type_params(proto.type_params);
+	params(proto.params);
+
+	auto return_type = proto.return_type;
+	if( return_type && !return_type->data.type_declarator.empty )
 	{
-		visit_node(base);
+		docs.push_text(": ");
+		this->node(return_type);
 	}
-	append_span(NodeSpan{node->get_name()});
 }
 
 void
-FormatParser::visit(ast::If const* node)
+FormatParser::params(AstNode* node)
 {
-	append_span(NodeSpan{"if "});
+	comma_list(node->data.fn_params.params, "(", ")");
+}
 
-	append_span("(");
+void
+FormatParser::block(AstNode* node)
+{
+	auto close = last_token(node);
+	if( node->data.block.statements->list.empty() && !comments_before(close) )
 	{
-		GroupScope g{*this};
-		{
-			IndentScope ind{*this};
-			append_span(NodeSpan::SoftLine());
-			visit_node(node->condition.get());
-		}
-		append_span(NodeSpan::SoftLine());
+		docs.push_text("{}");
+		return;
 	}
-	append_span(")");
-	append_span(NodeSpan{" "});
-	visit_node(node->then_block.get());
 
-	if( !node->else_block.is_null() )
+	docs.push_text("{");
+	trailing_comments(first_token(node));
+	if( node->data.block.statements->list.empty() && !comments_before(close) )
 	{
-		append_span(NodeSpan{"else "});
-
-		visit_node(node->else_block.get());
+		docs.push(docs.hard_line());
+		docs.push_text("}");
+		return;
 	}
+
+	auto mark = docs.mark();
+	docs.push(docs.hard_line());
+	items(node->data.block.statements, close);
+	docs.push(docs.indent(mark));
+	docs.push(docs.hard_line());
+	docs.push_text("}");
 }
 
+/**
+ * @brief keyword Name { members } for structs, unions, enums and namespaces.
+ */
 void
-FormatParser::visit(ast::For const* node)
-{
-	append_span(NodeSpan{"for "});
+FormatParser::record(
+	char const* keyword, AstNode* name, AstList<AstNode*>* members, AstNode* node)
+{
+	docs.push_text(keyword);
+	docs.push_text(" ");
+	this->node(name);
+	if( node->type == NodeType::Struct )
+		type_params(node->data.structstmt.type_params);
+	docs.push_text(" ");
+
+	auto close = last_token(node);
+	if( members->list.empty() && !comments_before(close) )
+	{
+		docs.push_text("{}");
+		return;
+	}
 
-	append_span("(");
+	docs.push_text("{");
+	auto open = first_token(node);
+	while( tokens.type(open) != TokenType::open_curly )
+		open++;
+	trailing_comments(open);
+	if( members->list.empty() && !comments_before(close) )
 	{
-		GroupScope g{*this};
-		{
-			IndentScope ind{*this};
-			append_span(NodeSpan::SoftLine());
-			visit_node(node->init.get());
-			append_span(NodeSpan::SoftLine());
-			visit_node(node->condition.get());
-			append_span(NodeSpan{"; "});
-			append_span(NodeSpan::SoftLine());
-			visit_node(node->end_loop.get());
-		}
-		append_span(NodeSpan::SoftLine());
+		docs.push(docs.hard_line());
+		docs.push_text("}");
+		return;
 	}
-	append_span(")");
-	append_span(NodeSpan{" "});
-	visit_node(node->body.get());
+
+	auto mark = docs.mark();
+	docs.push(docs.hard_line());
+	bool has_fields = node->type == NodeType::Struct || node->type == NodeType::Union;
+	items(members, close, has_fields ? ";" : nullptr);
+	docs.push(docs.indent(mark));
+	docs.push(docs.hard_line());
+	docs.push_text("}");
 }
 
+/**
+ * @brief The statement of an if, else or loop. Blocks stay on the same line,
+ * other statements move to the next line if they don't fit.
+ */
 void
-FormatParser::visit(ast::Assign const* node)
+FormatParser::stmt(AstNode* node)
 {
-	visit_node(node->lhs.get());
-	append_span(NodeSpan{" "});
-
-	auto op = node->Op;
-	switch( op )
+	if( is_block_stmt(node) )
 	{
-	case ast::AssignOp::assign:
-		append_span(NodeSpan::Text("="));
-		break;
-	case ast::AssignOp::add:
-		append_span(NodeSpan::Text("+="));
-		break;
-	case ast::AssignOp::sub:
-		append_span(NodeSpan::Text("-="));
-		break;
-	case ast::AssignOp::mul:
-		append_span(NodeSpan::Text("*="));
-		break;
-	case ast::AssignOp::div:
-		append_span(NodeSpan::Text("/="));
-		break;
-	default:
-		break;
+		docs.push_text(" ");
+		this->node(node);
+		return;
 	}
 
-	append_span(NodeSpan::Line());
-
-	visit_node(node->rhs.get());
-	append_span(NodeSpan{";"});
+	auto group_mark = docs.mark();
+	auto indent_mark = docs.mark();
+	docs.push(docs.line());
+	this->node(node);
+	docs.push(docs.indent(indent_mark));
+	docs.push(docs.group(group_mark));
 }
 
 void
-FormatParser::visit(ast::While const* node)
+FormatParser::if_stmt(AstNode* node)
 {
-	append_span(NodeSpan{"while "});
+	auto& ifcond = node->data.ifcond;
 
-	append_span("(");
+	docs.push_text("if (");
+	this->node(ifcond.condition);
+	docs.push_text(")");
+
+	bool then_block = true;
+	if( ifcond.then_block->type == NodeType::IfArrow )
 	{
-		GroupScope g{*this};
-		{
-			IndentScope ind{*this};
-			append_span(NodeSpan::SoftLine());
-			visit_node(node->condition.get());
-		}
-		append_span(NodeSpan::SoftLine());
+		docs.push_text(" ");
+		this->node(ifcond.then_block);
+	}
+	else
+	{
+		then_block = is_block_stmt(ifcond.then_block);
+		stmt(ifcond.then_block);
 	}
-	append_span(")");
-	append_span(NodeSpan{" "});
-	visit_node(node->loop_block.get());
-}
 
-void
-FormatParser::visit(ast::Call const* node)
-{
-	visit_node(node->call_target.get());
+	if( !ifcond.else_block )
+		return;
 
-	append_span(NodeSpan{"("});
+	if( then_block )
+		docs.push_text(" ");
+	else
+		docs.push(docs.hard_line());
+	docs.push_text("else");
 
+	auto else_stmt = ifcond.else_block->data.else_stmt.stmt;
+	if( else_stmt->type == NodeType::Stmt && else_stmt->data.stmt.stmt->type == NodeType::If )
 	{
-		GroupScope grp{*this};
-		{
-			IndentScope indent{*this};
-			append_span(NodeSpan::SoftLine());
-
-			auto& args = node->args.args;
-			for( int i = 0; i < args.size(); i++ )
-			{
-				auto& arg = args[i];
-				visit_node(arg.get());
-
-				if( i != args.size() - 1 )
-				{
-					append_span(NodeSpan{","});
-					append_span(NodeSpan::Line());
-				}
-			}
-		}
-		append_span(NodeSpan::SoftLine());
+		docs.push_text(" ");
+		this->node(else_stmt);
+	}
+	else
+	{
+		stmt(else_stmt);
 	}
-
-	append_span(NodeSpan{")"});
 }
 
 void
-FormatParser::visit(ast::Statement const* node)
+FormatParser::case_stmt(AstNode* node)
 {
-	visit_node(node->stmt.get());
+	auto& case_stmt = node->data.case_stmt;
 
-	append_newline_if_source(node);
+	if( case_stmt.const_expr )
+	{
+		docs.push_text("case ");
+		this->node(case_stmt.const_expr);
+	}
+	else
+	{
+		docs.push_text("default");
+	}
+
+	if( case_stmt.stmt->type == NodeType::IfArrow )
+	{
+		docs.push_text(" ");
+		this->node(case_stmt.stmt);
+	}
+	else
+	{
+		docs.push_text(":");
+		stmt(case_stmt.stmt);
+	}
 }
 
 void
-FormatParser::visit(ast::Expression const* node)
+FormatParser::operand(AstNode* node, bool parens)
 {
-	visit_node(node->base.get());
+	if( parens )
+		docs.push_text("(");
+	this->node(node);
+	if( parens )
+		docs.push_text(")");
 }
 
 void
-FormatParser::visit_node(ast::IAstNode const* node)
+FormatParser::postfix_base(AstNode* node)
 {
-	append_comments(node);
-	node->visit(this);
+	node = unwrap_expr(node);
+	operand(node, is_open_ended(node) || node->type == NodeType::BinOp || node->type == NodeType::Await);
 }
 
+/**
+ * @brief Source parens are not in the ast, so they are added back from precedence.
+ *
+ * 'followed' is set when an operator follows this expression. The parser drops an
+ * operator of lower precedence that follows a nested higher precedence right
+ * operand, so such operands keep their parens.
+ */
 void
-FormatParser::append_span(NodeSpan span)
+FormatParser::binop(AstNode* node, bool followed)
 {
-	current_line.append_span(span);
+	auto& binop = node->data.binop;
+	int prec = get_token_precedence(binop.op);
+	auto left = unwrap_expr(binop.left);
+	auto right = unwrap_expr(binop.right);
+
+	auto group_mark = docs.mark();
+
+	if( left->type == NodeType::BinOp )
+	{
+		bool parens = get_token_precedence(left->data.binop.op) < prec;
+		if( parens )
+			docs.push_text("(");
+		this->binop(left, !parens);
+		if( parens )
+			docs.push_text(")");
+	}
+	else
+	{
+		operand(left, is_open_ended(left));
+	}
+
+	docs.push_text(" ");
+	docs.push_text(bin_op_spelling(binop.op));
+
+	auto indent_mark = docs.mark();
+	docs.push(docs.line());
+	if( right->type == NodeType::BinOp )
+	{
+		bool parens = get_token_precedence(right->data.binop.op) <= prec || followed;
+		if( parens )
+			docs.push_text("(");
+		this->binop(right, false);
+		if( parens )
+			docs.push_text(")");
+	}
+	else
+	{
+		operand(right, is_open_ended(right));
+	}
+	docs.push(docs.indent(indent_mark));
+
+	docs.push(docs.group(group_mark));
 }
 
 void
-FormatParser::append_comments(ast::IAstNode const* node)
+FormatParser::node(AstNode* node)
 {
-	auto span = node->get_span();
-	if( source )
+	switch( node->type )
+	{
+	case NodeType::Module:
+		items(node->data.mod.statements, tokens.size());
+		break;
+	case NodeType::Namespace:
+		record("namespace", node->data.namespace_node.namespace_name, node->data.namespace_node.statements, node);
+		break;
+	case NodeType::Fn:
+		if( node->data.fn.prototype->data.fn_proto->is_async )
+			docs.push_text("async ");
+		docs.push_text("fn ");
+		fn_proto(node->data.fn.prototype);
+		docs.push_text(" ");
+		block(node->data.fn.body);
+		break;
+	case NodeType::ExternFn:
+		docs.push_text("extern fn ");
+		fn_proto(node->data.extern_fn.prototype);
+		docs.push_text(";");
+		break;
+	case NodeType::FnProto:
+		fn_proto(node);
+		break;
+	case NodeType::FnParamList:
+		params(node);
+		break;
+	case NodeType::ValueDecl:
+		attributes(node->data.value_decl.attributes);
+		this->node(node->data.value_decl.name);
+		docs.push_text(": ");
+		this->node(node->data.value_decl.type_name);
+		break;
+	case NodeType::VarArg:
+		docs.push_text("...");
+		break;
+	case NodeType::Struct:
+		record("struct", node->data.structstmt.type_name, node->data.structstmt.members, node);
+		break;
+	case NodeType::Union:
+		record("union", node->data.unionstmt.type_name, node->data.unionstmt.members, node);
+		break;
+	case NodeType::Enum:
+		record("enum", node->data.enumstmt.type_name, node->data.enumstmt.members, node);
+		break;
+	case NodeType::EnumMember:
 	{
-		for( auto& comment : span.leading_comments )
+		auto member = node->data.enum_member;
+		if( member->type == AstEnumMember::Type::Id )
 		{
-			auto token = source->at(comment);
-			current_line.append_span(NodeSpan::Text(String(token.start, token.size)));
-			current_line.append_span(NodeSpan::HardLine());
-			append_newline_if_source(token);
+			docs.push(docs.text(*member->identifier));
+			docs.push_text(",");
+			break;
 		}
 
-		for( auto& comment : span.trailing_comments )
+		// Members of an enum struct, e.g. 'Circle { r: i32; }', stay on one line if they fit.
+		auto& structstmt = member->struct_stmt->data.structstmt;
+		this->node(structstmt.type_name);
+		docs.push_text(" {");
+		if( structstmt.members->list.empty() )
+		{
+			docs.push_text("}");
+			break;
+		}
+		auto group_mark = docs.mark();
+		auto indent_mark = docs.mark();
+		for( auto struct_member : structstmt.members->list )
 		{
-			auto token = source->at(comment);
-			current_line.append_span(NodeSpan::LineSuffix(String(token.start, token.size)));
+			docs.push(docs.line());
+			this->node(struct_member);
+			docs.push_text(";");
 		}
+		docs.push(docs.indent(indent_mark));
+		docs.push(docs.line());
+		docs.push_text("}");
+		docs.push(docs.group(group_mark));
+		break;
 	}
-}
-
-/**
- * @brief
- * Depending on where this is called, a new line is already expected to be emitted,
- * so we only need to respect additional source line new lines
- *
- * @param node
- * @param threshold
- */
-void
-FormatParser::append_newline_if_source(ast::IAstNode const* node, int threshold)
-{
-	auto ast_span = node->get_span();
-	append_newline_if_source(ast_span, threshold);
-}
-
-void
-FormatParser::append_newline_if_source(ast::Span& ast_span, int threshold)
-{
-	if( source )
+	case NodeType::Block:
+		block(node);
+		break;
+	case NodeType::Stmt:
 	{
-		if( ast_span.size > 0 )
+		auto inner = node->data.stmt.stmt;
+		this->node(inner);
+		switch( inner->type )
 		{
-			auto token = source->at(ast_span.start + ast_span.size - 1);
-			append_newline_if_source(token, threshold);
+		case NodeType::While:
+		case NodeType::Switch:
+		case NodeType::Case:
+		case NodeType::If:
+		case NodeType::For:
+		case NodeType::Block:
+			break;
+		default:
+			docs.push_text(";");
+			break;
 		}
+		break;
 	}
-}
+	case NodeType::Let:
+	{
+		auto& let = node->data.let;
+		docs.push_text("let ");
+		this->node(let.identifier);
+		if( !let.type_declarator->data.type_declarator.empty )
+		{
+			docs.push_text(": ");
+			this->node(let.type_declarator);
+		}
+		if( unwrap_expr(let.rhs)->type != NodeType::Empty )
+		{
+			docs.push_text(" = ");
+			this->node(let.rhs);
+		}
+		break;
+	}
+	case NodeType::Return:
+		docs.push_text("return");
+		if( unwrap_expr(node->data.returnexpr.expr)->type != NodeType::Empty )
+		{
+			docs.push_text(" ");
+			this->node(node->data.returnexpr.expr);
+		}
+		break;
+	case NodeType::If:
+		if_stmt(node);
+		break;
+	case NodeType::IfArrow:
+		docs.push_text("=> ");
+		params(node->data.if_arrow.args);
+		docs.push_text(" ");
+		block(node->data.if_arrow.block);
+		break;
+	case NodeType::Else:
+		docs.push_text("else");
+		stmt(node->data.else_stmt.stmt);
+		break;
+	case NodeType::While:
+		docs.push_text("while (");
+		this->node(node->data.whilestmt.condition);
+		docs.push_text(")");
+		stmt(node->data.whilestmt.block);
+		break;
+	case NodeType::For:
+	{
+		auto& forstmt = *node->data.forstmt;
+		docs.push_text("for (");
+		this->node(forstmt.init);
+		if( unwrap_expr(forstmt.condition)->type != NodeType::Empty )
+		{
+			docs.push_text(" ");
+			this->node(forstmt.condition);
+		}
+		docs.push_text(";");
+		auto end_loop = forstmt.end_loop->data.stmt.stmt;
+		if( unwrap_expr(end_loop)->type != NodeType::Empty )
+		{
+			docs.push_text(" ");
+			this->node(end_loop);
+		}
+		docs.push_text(")");
+		stmt(forstmt.body);
+		break;
+	}
+	case NodeType::Switch:
+		docs.push_text("switch (");
+		this->node(node->data.switch_stmt.expr);
+		docs.push_text(") ");
+		block(node->data.switch_stmt.block);
+		break;
+	case NodeType::Case:
+		case_stmt(node);
+		break;
+	case NodeType::Assign:
+		this->node(node->data.assign.left);
+		docs.push_text(assign_op_spelling(node->data.assign.op));
+		this->node(node->data.assign.right);
+		break;
+	case NodeType::Expr:
+		this->node(unwrap_expr(node));
+		break;
+	case NodeType::BinOp:
+		binop(node, false);
+		break;
+	case NodeType::Is:
+	{
+		auto lhs = unwrap_expr(node->data.is.expr);
+		operand(lhs, is_open_ended(lhs));
+		docs.push_text(" is ");
+		this->node(node->data.is.type_name);
+		break;
+	}
+	case NodeType::Initializer:
+	{
+		auto& initializer = node->data.initializer;
+		this->node(initializer.type_name);
+		docs.push_text(" {");
+		if( initializer.members->list.empty() )
+		{
+			docs.push_text("}");
+			break;
+		}
 
-void
-FormatParser::append_newline_if_source(Token& token, int threshold)
-{
-	if( token.num_trailing_newlines > threshold )
+		auto group_mark = docs.mark();
+		auto indent_mark = docs.mark();
+		bool first = true;
+		for( auto designator : initializer.members->list )
+		{
+			if( !first )
+				docs.push_text(",");
+			docs.push(docs.line());
+			this->node(designator);
+			first = false;
+		}
+		docs.push(docs.indent(indent_mark));
+		docs.push(docs.line());
+		docs.push_text("}");
+		docs.push(docs.group(group_mark));
+		break;
+	}
+	case NodeType::InitializerDesignator:
+		docs.push_text(".");
+		this->node(node->data.designator.name);
+		docs.push_text(" = ");
+		this->node(node->data.designator.expr);
+		break;
+	case NodeType::FnCall:
+		postfix_base(node->data.fn_call.call_target);
+		this->node(node->data.fn_call.args);
+		break;
+	case NodeType::ExprList:
+		comma_list(node->data.expr_list.exprs, "(", ")");
+		break;
+	case NodeType::ArrayAccess:
+		postfix_base(node->data.array_access.array_target);
+		docs.push_text("[");
+		this->node(node->data.array_access.expr);
+		docs.push_text("]");
+		break;
+	case NodeType::MemberAccess:
+		postfix_base(node->data.member_access.expr);
+		docs.push_text(".");
+		this->node(node->data.member_access.member_name);
+		break;
+	case NodeType::IndirectMemberAccess:
+		postfix_base(node->data.indirect_member_access.expr);
+		docs.push_text("->");
+		this->node(node->data.indirect_member_access.member_name);
+		break;
+	case NodeType::AddressOf:
+		docs.push_text("&");
+		this->node(node->data.address_of.expr);
+		break;
+	case NodeType::Deref:
+		docs.push_text("*");
+		this->node(node->data.deref.expr);
+		break;
+	case NodeType::Await:
+	{
+		docs.push_text("await ");
+		bool first = true;
+		for( auto future : node->data.await_expr.futures->list )
+		{
+			if( !first )
+				docs.push_text(", ");
+			postfix_base(future);
+			first = false;
+		}
+		break;
+	}
+	case NodeType::Id:
+		name_parts(node->data.id.name_parts);
+		type_args(node);
+		break;
+	case NodeType::TypeDeclarator:
 	{
-		append_span(NodeSpan::MinNewLine(2));
+		auto& type_declarator = node->data.type_declarator;
+		if( type_declarator.empty )
+			break;
+
+		name_parts(type_declarator.name);
+		type_args(node);
+		for( unsigned int i = 0; i < type_declarator.indirection_level; i++ )
+			docs.push_text("*");
+		if( type_declarator.array_size != 0 )
+		{
+			docs.push_text("[");
+			docs.push(docs.text(std::to_string(type_declarator.array_size)));
+			docs.push_text("]");
+		}
+		break;
+	}
+	case NodeType::StringLiteral:
+		docs.push_text("\"");
+		docs.push(docs.text(*node->data.string_literal.literal));
+		docs.push_text("\"");
+		break;
+	case NodeType::NumberLiteral:
+		docs.push(docs.text(std::to_string(node->data.number_literal.literal)));
+		break;
+	case NodeType::Empty:
+	case NodeType::Invalid:
+		break;
 	}
 }
-
-NodeSpan
-FormatParser::get_span(Vec<Token> const* source, ast::IAstNode const* node)
-{
-	FormatParser g{source};
-
-	node->visit(&g);
-
-	return g.current_line.children[0];
-}
\ No newline at end of file
@@ -1,83 +1,76 @@
 #pragma once
-#include "NodeSpan.h"
-#include "ast/IAstNode.h"
-#include "ast/IAstVisitor.h"
-#include "ast/Span.h"
-#include "common/String.h"
+
+#include "Doc.h"
+#include "ast2/Ast.h"
+#include "ast2/AstNode.h"
 #include "common/Vec.h"
-#include "lexer/token.h"
+#include "lexer/Lexer.h"
+
+namespace format
+{
 
 /**
- * @brief Create the "Formatting AST".
+ * @brief Creates the document tree of an ast.
  *
+ * Comments are not part of the ast. They are taken from the tokens in source order
+ * and printed before the next statement or member, or at the end of the line if
+ * they trailed code in the source.
  */
-class FormatParser : public IAstVisitor
+class FormatParser
 {
-	struct GroupScope
-	{
-		FormatParser& ctx;
-		NodeSpan previous;
-		GroupScope(FormatParser& ctx);
-		~GroupScope();
-	};
-
-	struct DocumentScope
-	{
-		FormatParser& ctx;
-		NodeSpan previous;
-		DocumentScope(FormatParser& ctx);
-		~DocumentScope();
-	};
-
-	struct IndentScope
-	{
-		FormatParser& ctx;
-		NodeSpan previous;
-		IndentScope(FormatParser& ctx);
-		~IndentScope();
-	};
-
-	NodeSpan current_line{};
+	DocArena& docs;
+	LexResult const& tokens;
+	ast::Ast const& ast;
 
-	Vec<Token> const* source = nullptr;
+	// Indices of the comment tokens, and the first one that is not printed yet.
+	Vec<unsigned int> comments;
+	unsigned int next_comment = 0;
 
 public:
-	FormatParser(Vec<Token> const* source)
-		: source(source){};
+	FormatParser(DocArena& docs, LexResult const& tokens, ast::Ast const& ast);
 
-	// Vec<NodeSpan> gather_into_lines(ast::IAstNode const* node);
+	DocId module(ast::AstNode* node);
 
-	virtual void visit(ast::Module const*) override;
-	virtual void visit(ast::Function const*) override;
-	virtual void visit(ast::Block const*) override;
-	virtual void visit(ast::BinaryOperation const*) override;
-	virtual void visit(ast::Number const*) override;
-	virtual void visit(ast::StringLiteral const*) override;
-	virtual void visit(ast::Return const*) override;
-	virtual void visit(ast::Prototype const*) override;
-	virtual void visit(ast::TypeIdentifier const*) override;
-	virtual void visit(ast::ValueIdentifier const*) override;
-	virtual void visit(ast::Let const*) override;
-	virtual void visit(ast::Struct const*) override;
-	virtual void visit(ast::MemberReference const*) override;
-	virtual void visit(ast::TypeDeclarator const*) override;
-	virtual void visit(ast::If const*) override;
-	virtual void visit(ast::For const*) override;
-	virtual void visit(ast::Assign const*) override;
-	virtual void visit(ast::While const*) override;
-	virtual void visit(ast::Call const*) override;
-	virtual void visit(ast::Statement const*) override;
-	virtual void visit(ast::Expression const*) override;
+	/**
+	 * @brief A single top level item, without the comments around it.
+	 */
+	DocId item(ast::AstNode* node);
+
+	unsigned int first_token(ast::AstNode* node) const;
+	unsigned int last_token(ast::AstNode* node) const;
 
 private:
-	void visit_node(ast::IAstNode const* node);
-	void append_span(NodeSpan span);
-	void append_comments(ast::IAstNode const* node);
+	void node(ast::AstNode* node);
 
-	void append_newline_if_source(ast::IAstNode const* node, int threshold = 1);
-	void append_newline_if_source(ast::Span& span, int threshold = 1);
-	void append_newline_if_source(Token& token, int threshold = 1);
+	void items(ast::AstList<ast::AstNode*>* list, unsigned int end_token, char const* terminator = nullptr);
+	void leading_comments(unsigned int before_token);
+	void trailing_comments(unsigned int after_token);
+	// Whether a comment that is not printed yet comes before 'token'.
+	bool comments_before(unsigned int token) const;
+	void seek(unsigned int token);
+	bool blank_line_between(unsigned int token, unsigned int next_token) const;
+	void comment(unsigned int token);
 
-public:
-	static NodeSpan get_span(Vec<Token> const* source, ast::IAstNode const* node);
+	void fn_proto(ast::AstNode* node);
+	void params(ast::AstNode* node);
+	void type_params(ast::AstList<ast::AstNode*>* type_params);
+	void type_args(ast::AstNode* node);
+	void attributes(ast::AttributeSet const* attributes);
+	void block(ast::AstNode* node);
+	void record(char const* keyword, ast::AstNode* name, ast::AstList<ast::AstNode*>* members, ast::AstNode* node);
+	void stmt(ast::AstNode* node);
+	void if_stmt(ast::AstNode* node);
+	void case_stmt(ast::AstNode* node);
+	void binop(ast::AstNode* node, bool followed);
+	void operand(ast::AstNode* node, bool parens);
+	void postfix_base(ast::AstNode* node);
+	void comma_list(ast::AstList<ast::AstNode*>* list, char const* open, char const* close);
+	void name_parts(ast::AstList<String*>* parts);
 };
+
+/**
+ * @brief Skips the Expr wrappers of an expression.
+ */
+ast::AstNode* unwrap_expr(ast::AstNode* node);
+
+} // namespace format
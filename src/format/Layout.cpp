@@ -0,0 +1,178 @@
+#include "Layout.h"
+
+using namespace format;
+
+namespace
+{
+struct Frame
+{
+	DocId doc;
+	std::uint32_t indent;
+	bool flat;
+	// Width of the text that follows this doc before the next possible line break.
+	std::uint32_t trail;
+};
+
+class Printer
+{
+	DocArena const& arena;
+	LayoutOptions const& options;
+	String& out;
+
+	Vec<Frame> stack;
+	// Line suffixes waiting for the end of the line.
+	Vec<Frame> suffixes;
+
+	std::uint32_t column = 0;
+	// Indentation is written lazily so empty lines have no trailing whitespace.
+	bool at_line_start = true;
+	std::uint32_t line_indent = 0;
+
+public:
+	Printer(DocArena const& arena, LayoutOptions const& options, String& out)
+		: arena(arena)
+		, options(options)
+		, out(out)
+		, line_indent(options.indent)
+	{}
+
+	void print(DocId root);
+
+private:
+	std::uint32_t current_column() const
+	{
+		return at_line_start ? line_indent * options.indent_width : column;
+	}
+
+	void emit_text(char const* str, std::uint32_t size);
+	void emit_line_break(Frame const& frame);
+	void push_children(Frame const& frame, std::uint32_t indent, bool flat);
+	void flush_suffixes();
+};
+} // namespace
+
+void
+Printer::emit_text(char const* str, std::uint32_t size)
+{
+	if( size == 0 )
+		return;
+
+	if( at_line_start )
+	{
+		column = line_indent * options.indent_width;
+		out.append(column, ' ');
+		at_line_start = false;
+	}
+
+	out.append(str, size);
+	column += size;
+}
+
+void
+Printer::emit_line_break(Frame const& frame)
+{
+	// Print the pending suffixes first, then come back to this line break.
+	if( !suffixes.empty() )
+	{
+		stack.push_back(frame);
+		flush_suffixes();
+		return;
+	}
+
+	out.push_back('\n');
+	at_line_start = true;
+	line_indent = frame.indent;
+	column = 0;
+}
+
+void
+Printer::push_children(Frame const& frame, std::uint32_t indent, bool flat)
+{
+	auto& doc = arena.doc(frame.doc);
+
+	// Children are pushed last to first, so the trail of each child is the
+	// unbreakable text after it.
+	std::uint32_t trail = frame.trail;
+	for( std::uint32_t i = doc.size; i-- > 0; )
+	{
+		auto child = arena.child(doc, i);
+		stack.push_back(Frame{child, indent, flat, trail});
+
+		auto& child_doc = arena.doc(child);
+		if( child_doc.has_line || child_doc.flat_width == Doc::broken )
+			trail = 0;
+		else
+			trail += child_doc.flat_width;
+	}
+}
+
+/**
+ * @brief Schedules the children of the pending suffixes to be printed next.
+ */
+void
+Printer::flush_suffixes()
+{
+	for( auto iter = suffixes.rbegin(); iter != suffixes.rend(); ++iter )
+		push_children(*iter, iter->indent, true);
+	suffixes.clear();
+}
+
+void
+Printer::print(DocId root)
+{
+	stack.push_back(Frame{root, options.indent, false, 0});
+
+	while( !stack.empty() || !suffixes.empty() )
+	{
+		// Suffixes at the end of the document.
+		if( stack.empty() )
+			flush_suffixes();
+
+		auto frame = stack.back();
+		stack.pop_back();
+
+		auto& doc = arena.doc(frame.doc);
+		switch( doc.type )
+		{
+		case DocType::text:
+			emit_text(arena.text_of(doc), doc.size);
+			break;
+		case DocType::concat:
+			push_children(frame, frame.indent, frame.flat);
+			break;
+		case DocType::indent:
+			push_children(frame, frame.indent + 1, frame.flat);
+			break;
+		case DocType::group:
+		{
+			bool fits = doc.flat_width != Doc::broken &&
+						current_column() + doc.flat_width + frame.trail <= options.max_width;
+			push_children(frame, frame.indent, frame.flat || fits);
+			break;
+		}
+		case DocType::line:
+			if( frame.flat )
+				emit_text(" ", 1);
+			else
+				emit_line_break(frame);
+			break;
+		case DocType::soft_line:
+			if( !frame.flat )
+				emit_line_break(frame);
+			break;
+		case DocType::hard_line:
+			emit_line_break(frame);
+			break;
+		case DocType::line_suffix:
+			suffixes.push_back(frame);
+			break;
+		}
+	}
+}
+
+void
+format::layout(DocArena const& arena, DocId root, LayoutOptions const& options, String& out)
+{
+	Printer printer(arena, options, out);
+	printer.print(root);
+}
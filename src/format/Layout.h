@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Doc.h"
+#include "common/String.h"
+
+namespace format
+{
+
+struct LayoutOptions
+{
+	unsigned int max_width = 100;
+	// Spaces per indentation level.
+	unsigned int indent_width = 4;
+	// Indentation level of the first line.
+	unsigned int indent = 0;
+};
+
+/**
+ * @brief Prints 'root' to 'out' in a single pass.
+ *
+ * A group is printed flat if its cached flat width and the text that must follow
+ * it on the same line fit in the rest of the line. Nothing is measured twice, so
+ * this is linear in the size of the document.
+ */
+void layout(DocArena const& arena, DocId root, LayoutOptions const& options, String& out);
+
+} // namespace format
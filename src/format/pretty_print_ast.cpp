@@ -1,274 +1,114 @@
 #include "pretty_print_ast.h"
 
+#include "Doc.h"
 #include "FormatParser.h"
-#include "NodeSpan.h"
-#include "common/String.h"
-#include "common/Vec.h"
-#include "reverse.h"
-#include "utils.h"
 
-#include <iostream>
+using namespace ast;
+using namespace format;
 
-enum class PrintMode
+String
+format::pretty_print_ast(
+	LexResult const& tokens, Ast const& ast, AstNode* module, LayoutOptions const& options)
 {
-	line,
-	break_line
-};
-
-struct AstCallIteration
-{
-	int indentation = 0;
-	PrintMode mode;
-	NodeSpan* doc;
+	DocArena arena;
+	FormatParser parser{arena, tokens, ast};
 
-	AstCallIteration(int ind, PrintMode mode, NodeSpan* doc)
-		: indentation(ind)
-		, mode(mode)
-		, doc(doc){};
-};
+	auto root = parser.module(module);
 
-static int calc_len(NodeSpan& root_doc);
+	String out;
+	layout(arena, root, options, out);
+	return out;
+}
 
-template<typename Callback>
-static void
-traverse_format_ast(NodeSpan& root_doc, Callback out)
+namespace
 {
-	int max_line_len = 10;
-
-	Vec<AstCallIteration> stack;
-
-	// Line suffixes are defered and printed at the nearest line break.
-	Vec<AstCallIteration> line_suffixes;
-	int current_line_len = 0;
-
-	// this value is used to support the 'min_spacing' node.
-	int distance_to_non_empty = -1;
-
-	// this is used to support the 'min_newline' node.
-	int num_consecutive_newlines = 0;
-
-	auto emit_string =
-		[&current_line_len, &distance_to_non_empty, &num_consecutive_newlines, &out](String s) {
-			if( s.back() == '\n' )
-			{
-				current_line_len = 0;
-				distance_to_non_empty = -1;
-				num_consecutive_newlines += 1;
-			}
-			else
-			{
-				auto ending_whitespace = count_end_whitespace(s);
-				if( ending_whitespace != s.length() && distance_to_non_empty == -1 )
-					distance_to_non_empty = 0;
-
-				if( ending_whitespace != s.length() )
-					num_consecutive_newlines = 0;
-
-				distance_to_non_empty = ending_whitespace;
-
-				current_line_len += s.length();
-			}
+struct LineRange
+{
+	DocArena& arena;
+	FormatParser& parser;
+	LexResult const& tokens;
+	LayoutOptions const& options;
+	// 0-based, inclusive.
+	unsigned int first_line;
+	unsigned int last_line;
 
-			out(s);
-		};
+	Vec<FormatEdit> edits;
 
-	stack.emplace_back(0, PrintMode::line, &root_doc);
+	void format_items(AstList<AstNode*>* items, std::uint32_t depth);
+};
+} // namespace
 
-	while( !stack.empty() )
+void
+LineRange::format_items(AstList<AstNode*>* items, std::uint32_t depth)
+{
+	for( auto item : items->list )
 	{
-		auto iter = stack.back();
-		stack.pop_back();
-
-		auto ind = iter.indentation;
-		auto mode = iter.mode;
-		auto doc = iter.doc;
-
-		auto emit_line_break = [&emit_string, &line_suffixes, &stack, &ind, &mode, &doc]() {
-			// If there are line breaks, insert the line_suffixes
-			// before breaking the line.
-			if( line_suffixes.size() != 0 )
-			{
-				stack.emplace_back(ind, mode, doc);
-
-				for( auto& suffix : reverse(line_suffixes) )
-				{
-					stack.emplace_back(suffix);
-				}
-
-				line_suffixes.clear();
-			}
-			else
-			{
-				emit_string("\n");
-				emit_string(String(ind, ' '));
-			}
-		};
-
-		switch( doc->type )
-		{
-		case NodeSpan::SpanType::text:
+		auto first = parser.first_token(item);
+		auto last = parser.last_token(item);
+		auto item_first_line = tokens.line_nums[first];
+		auto item_last_line = tokens.line_nums[last];
+		if( item_last_line < first_line || item_first_line > last_line )
+			continue;
+
+		bool covered = first_line <= item_first_line && item_last_line <= last_line;
+		if( item->type == NodeType::Namespace && !covered )
 		{
-			emit_string(doc->content);
+			format_items(item->data.namespace_node.statements, depth + 1);
+			continue;
 		}
-		break;
-		case NodeSpan::SpanType::document:
-		{
-			for( auto& node : reverse(doc->children) )
-			{
-				stack.emplace_back(ind, mode, &node);
-			}
-		}
-		break;
-		case NodeSpan::SpanType::min_padding:
-		{
-			if( distance_to_non_empty != -1 && distance_to_non_empty < doc->min_spacing )
-			{
-				emit_string(String(doc->min_spacing - distance_to_non_empty, ' '));
-			}
-		}
-		break;
-		case NodeSpan::SpanType::min_newline:
-		{
-			if( num_consecutive_newlines < doc->min_spacing )
-			{
-				auto need = doc->min_spacing - num_consecutive_newlines;
-				for( int i = 0; i < need; ++i )
-				{
-					emit_line_break();
-				}
-			}
-		}
-		break;
-		case NodeSpan::SpanType::group:
-		{
-			auto group_mode = PrintMode::line;
-			// If the group wants to be printed on a single line, then allow it
-			// to do so if it fits.
-			if( !doc->is_break() )
-			{
-				auto size = current_line_len;
-				for( auto& node : doc->children )
-				{
-					size += calc_len(node);
-				}
-
-				if( size > max_line_len )
-				{
-					group_mode = PrintMode::break_line;
-				}
-				else
-				{
-					group_mode = PrintMode::line;
-				}
-			}
-			else
-			{
-				group_mode = PrintMode::break_line;
-			}
 
-			for( auto& node : reverse(doc->children) )
-			{
-				stack.emplace_back(ind, group_mode, &node);
-			}
-		}
-		break;
+		// The edit starts at the beginning of the line so the indentation is redone too.
+		// Items that share their first line with something else are left alone.
+		std::uint32_t start = tokens.offsets[first];
+		while( start > 0 && (tokens.input[start - 1] == ' ' || tokens.input[start - 1] == '\t') )
+			start--;
+		if( start > 0 && tokens.input[start - 1] != '\n' )
+			continue;
 
-		case NodeSpan::SpanType::hard_line:
-			// hard_line is always break.
-			mode = PrintMode::break_line;
-			// Fallthrough
-		case NodeSpan::SpanType::soft_line:
-			if( mode == PrintMode::line )
-			{
-				// soft_line is nothing in line mode.
-				break;
-			}
-			else
-			{
-				// Fallthrough!
-			}
+		arena.clear();
+		auto doc = parser.item(item);
 
-		// The 'line' span is either a space if we are printing on
-		// one line, or a line break if we are in break mode.
-		case NodeSpan::SpanType::line:
-		{
-			if( mode == PrintMode::line )
-			{
-				emit_string(" ");
-			}
-			else
-			{
-				emit_line_break();
-			}
-		}
-		break;
+		LayoutOptions item_options = options;
+		item_options.indent = depth;
 
-		case NodeSpan::SpanType::indent:
-		{
-			for( auto& node : reverse(doc->children) )
-			{
-				stack.emplace_back(ind + 4, mode, &node);
-			}
-		}
-		break;
-		case NodeSpan::SpanType::line_suffix:
-		{
-			for( auto& elem : doc->children )
-			{
-				line_suffixes.emplace_back(ind, mode, &elem);
-			}
-		}
-		break;
-		default:
-			std::cout << "Unsupported SpanType" << std::endl;
-			break;
-		}
+		FormatEdit edit{start, tokens.offsets[last] + tokens.lengths[last] - start, String{}};
+		layout(arena, doc, item_options, edit.text);
+		edits.push_back(std::move(edit));
 	}
 }
 
-// Performs look ahead to calculate the length of a group node.
-// And returns the length of the first line.
-static int
-calc_len(NodeSpan& root_doc)
+Vec<FormatEdit>
+format::pretty_print_lines(
+	LexResult const& tokens,
+	Ast const& ast,
+	AstNode* module,
+	unsigned int first_line,
+	unsigned int last_line,
+	LayoutOptions const& options)
 {
-	int len = 0;
-	bool done = false;
+	DocArena arena;
+	FormatParser parser{arena, tokens, ast};
 
-	// TODO: Way to stop traversal?
-	traverse_format_ast(root_doc, [&len, &done](String s) {
-		if( done )
-			return;
-		auto break_line = s.find("\n");
-		if( break_line == String::npos )
-			len += s.length();
-		else
-		{
-			len += break_line;
-			done = true;
-		}
-	});
+	LineRange range{arena, parser, tokens, options, first_line - 1, last_line - 1, {}};
+	range.format_items(module->data.mod.statements, options.indent);
 
-	return len;
+	return std::move(range.edits);
 }
 
-static int
-pretty_print_ast_stdout(NodeSpan& span)
+String
+format::apply_edits(String const& source, Vec<FormatEdit> const& edits)
 {
-	Vec<String> out;
-	traverse_format_ast(span, [&out](String s) { out.emplace_back(s); });
+	String out;
+	out.reserve(source.size());
 
-	for( auto& s : out )
+	std::uint32_t cursor = 0;
+	for( auto& edit : edits )
 	{
-		std::cout << s;
+		out.append(source, cursor, edit.offset - cursor);
+		out.append(edit.text);
+		cursor = edit.offset + edit.size;
 	}
-	std::cout << std::flush;
-	return 0;
-}
+	out.append(source, cursor, String::npos);
 
-void
-pretty_print_ast(Vec<Token> const& source, ast::IAstNode const* node)
-{
-	auto root_doc = FormatParser::get_span(&source, node);
-
-	pretty_print_ast_stdout(root_doc);
-}
\ No newline at end of file
+	return out;
+}
@@ -1,8 +1,26 @@
 #pragma once
 
-#include "ast/IAstNode.h"
+#include "Layout.h"
+#include "ast2/Ast.h"
+#include "ast2/AstNode.h"
+#include "common/String.h"
 #include "common/Vec.h"
-#include "lexer/token.h"
+#include "lexer/Lexer.h"
+
+#include <cstdint>
+
+namespace format
+{
+
+/**
+ * @brief Replaces 'size' bytes of the source at 'offset' with 'text'.
+ */
+struct FormatEdit
+{
+	std::uint32_t offset;
+	std::uint32_t size;
+	String text;
+};
 
 /**
  * @brief
@@ -11,16 +29,31 @@
  *
  * https://homepages.inf.ed.ac.uk/wadler/papers/prettier/prettier.pdf
  *
- * The idea is to create a "Formatting AST" out of the AST, then traverse the
- * and print the result.
- *
- * The complexity comes in how the AST is traversed. Some nodes require look ahead
- * and back-tracking (i.e. a group node), to calculate if it can fit on a line.
- *
- * Bug: Line suffixes sometimes don't get accounted for when determining the length of a
- * line.
+ * The ast is turned into a document tree (see Doc.h), then the document is laid out.
+ * The flat width of every group is computed once when the doc is created, so layout
+ * never looks ahead and the whole pass is linear in the size of the source.
+ */
+String pretty_print_ast(
+	LexResult const& tokens,
+	ast::Ast const& ast,
+	ast::AstNode* module,
+	LayoutOptions const& options = LayoutOptions{});
+
+/**
+ * @brief Formats only the top level items that overlap the 1-based lines
+ * [first_line, last_line], e.g. the function that was just edited.
  *
- * @param source
- * @param node
+ * Items inside a namespace are formatted on their own unless the range covers the
+ * whole namespace. Returns the edits in source order.
  */
-void pretty_print_ast(Vec<Token> const& source, ast::IAstNode const* node);
\ No newline at end of file
+Vec<FormatEdit> pretty_print_lines(
+	LexResult const& tokens,
+	ast::Ast const& ast,
+	ast::AstNode* module,
+	unsigned int first_line,
+	unsigned int last_line,
+	LayoutOptions const& options = LayoutOptions{});
+
+String apply_edits(String const& source, Vec<FormatEdit> const& edits);
+
+} // namespace format
@@ -1,4 +0,0 @@
-#pragma once
-#include "common/String.h"
-
-int count_end_whitespace(String const& s);
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include "Frontend.h"
+
+#include "ast2/AstGen.h"
+#include "lexer/TokenCursor.h"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace frontend;
+using namespace ast;
+
+Frontend::Frontend(TaskPool& pool, bool keep_tokens, FileCache* cache)
+	: pool(pool)
+	, keep_tokens(keep_tokens)
+	, cache(cache)
+{}
+
+void
+Frontend::start(Vec<String> const& paths)
+{
+	Vec<SourceFile*> parse;
+	for( auto const& path : paths )
+	{
+		std::shared_ptr<SourceFile> file;
+		if( cache )
+			file = cache->find(path, keep_tokens);
+
+		if( file )
+		{
+			// Errors name the file as this compile does.
+			file->path = path;
+		}
+		else
+		{
+			file = std::make_shared<SourceFile>();
+			file->path = path;
+			if( cache )
+				cache->insert(path, keep_tokens, file);
+			parse.push_back(file.get());
+		}
+
+		files.push_back(std::move(file));
+	}
+
+	for( auto source : parse )
+		pool.spawn([source, keep_tokens = keep_tokens]() { parse_file(*source, keep_tokens); });
+}
+
+void
+Frontend::start(Vec<SourceBuffer> const& buffers)
+{
+	Vec<SourceFile*> parse;
+	for( auto const& buffer : buffers )
+	{
+		auto file = std::make_shared<SourceFile>();
+		file->path = buffer.name;
+		file->text = buffer.text;
+		parse.push_back(file.get());
+		files.push_back(std::move(file));
+	}
+
+	for( auto source : parse )
+		pool.spawn([source, keep_tokens = keep_tokens]() { parse_text(*source, keep_tokens); });
+}
+
+SourceFile&
+Frontend::wait(unsigned int index)
+{
+	auto& file = *files[index];
+	pool.run_until([&file]() { return file.ready.load(std::memory_order_acquire); });
+	return file;
+}
+
+OwnPtr<ParseError>
+Frontend::merge(unsigned int index)
+{
+	assert(index == merged && "Files must be merged in order");
+
+	auto& file = wait(index);
+	merged += 1;
+	if( !file.error.is_null() )
+		return std::move(file.error);
+
+	for( auto const& declaration : file.declarations )
+	{
+		// An extern fn may declare a fn that another file defines.
+		if( declaration.kind == NodeType::ExternFn )
+			continue;
+
+		auto [iter, inserted] = declared.emplace(declaration.name, &file);
+		if( !inserted && iter->second != &file )
+		{
+			return OwnPtr<ParseError>(ParseError(
+				"'" + declaration.name.str() + "' is declared in " + file.path + " and " +
+				iter->second->path + "."));
+		}
+	}
+
+	return OwnPtr<ParseError>::null();
+}
+
+void
+Frontend::parse_file(SourceFile& file, bool keep_tokens)
+{
+	std::ifstream stream{file.path};
+	if( !stream.good() )
+	{
+		file.error = OwnPtr<ParseError>(ParseError("Could not open file " + file.path));
+		file.ready.store(true, std::memory_order_release);
+		return;
+	}
+
+	std::stringstream buffer;
+	buffer << stream.rdbuf();
+	file.text = buffer.str();
+	parse_text(file, keep_tokens);
+}
+
+void
+Frontend::parse_text(SourceFile& file, bool keep_tokens)
+{
+	auto parse = [&file](TokenCursor& cursor) {
+		AstGen gen{file.ast, cursor};
+		auto result = gen.parse();
+		if( result.ok() )
+		{
+			file.module = result.unwrap();
+			file.declarations = collect_declarations(file.module);
+		}
+		else
+		{
+			file.error = result.unwrap_error();
+		}
+	};
+
+	if( keep_tokens )
+	{
+		Lexer lexer{file.text.c_str()};
+		file.tokens.emplace(lexer.lex());
+		TokenCursor cursor{*file.tokens};
+		parse(cursor);
+	}
+	else
+	{
+		file.stream = std::make_unique<TokenStream>(file.text.c_str());
+		TokenCursor cursor{*file.stream};
+		parse(cursor);
+	}
+
+	file.ready.store(true, std::memory_order_release);
+}
+
+std::optional<FileCache::Stamp>
+FileCache::stamp(String const& path, String& absolute)
+{
+	std::error_code error;
+	auto canonical = std::filesystem::canonical(path, error);
+	if( error )
+		return std::nullopt;
+
+	auto size = std::filesystem::file_size(canonical, error);
+	if( error )
+		return std::nullopt;
+
+	auto modified = std::filesystem::last_write_time(canonical, error);
+	if( error )
+		return std::nullopt;
+
+	absolute = canonical.string();
+	return Stamp{size, modified.time_since_epoch().count()};
+}
+
+std::shared_ptr<SourceFile>
+FileCache::find(String const& path, bool keep_tokens) const
+{
+	String absolute;
+	auto current = stamp(path, absolute);
+	if( !current )
+		return nullptr;
+
+	auto iter = entries.find(absolute);
+	if( iter == entries.end() )
+		return nullptr;
+
+	auto const& entry = iter->second;
+	if( !(entry.stamp == *current) || entry.keep_tokens != keep_tokens )
+		return nullptr;
+
+	// Merging takes the error out of the file, so failed files are parsed again.
+	auto& file = *entry.file;
+	if( !file.ready.load(std::memory_order_acquire) || !file.error.is_null() )
+		return nullptr;
+
+	return entry.file;
+}
+
+void
+FileCache::insert(String const& path, bool keep_tokens, std::shared_ptr<SourceFile> file)
+{
+	// Stamped before the file is read. If it changes in between, the stamp is stale and
+	// the next compile parses it again.
+	String absolute;
+	auto current = stamp(path, absolute);
+	if( !current )
+		return;
+
+	entries[absolute] = Entry{*current, keep_tokens, std::move(file)};
+}
+
+static Symbol
+declared_name(AstNode* name)
+{
+	if( name != nullptr && name->type == NodeType::Id )
+		return name->data.id.name;
+	return Symbol{};
+}
+
+Vec<Declaration>
+frontend::collect_declarations(AstNode* module)
+{
+	Vec<Declaration> declarations;
+	for( auto item : module->data.mod.statements )
+	{
+		Symbol name;
+		switch( item->type )
+		{
+		case NodeType::Fn:
+			name = declared_name(item->data.fn.prototype->data.fn_proto->name);
+			break;
+		case NodeType::ExternFn:
+			name = declared_name(item->data.extern_fn.prototype->data.fn_proto->name);
+			break;
+		case NodeType::Struct:
+			name = declared_name(item->data.structstmt.type_name);
+			break;
+		case NodeType::Union:
+			name = declared_name(item->data.unionstmt.type_name);
+			break;
+		case NodeType::Enum:
+			name = declared_name(item->data.enumstmt.type_name);
+			break;
+		default:
+			break;
+		}
+
+		if( !name.empty() )
+			declarations.push_back(Declaration{name, item->type, item});
+	}
+
+	return declarations;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "ast2/Ast.h"
+#include "ast2/AstNode.h"
+#include "ast2/ParseResult.h"
+#include "common/OwnPtr.h"
+#include "common/String.h"
+#include "common/Symbol.h"
+#include "common/TaskPool.h"
+#include "common/Vec.h"
+#include "lexer/Lexer.h"
+#include "lexer/TokenStream.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+namespace frontend
+{
+
+/**
+ * @brief A top level item of a file, found before sema.
+ */
+struct Declaration
+{
+	Symbol name;
+	ast::NodeType kind;
+	ast::AstNode* node;
+};
+
+/**
+ * @brief A source held in memory instead of a file. The name stands for the path in
+ * errors and debug info.
+ */
+struct SourceBuffer
+{
+	String name;
+	String text;
+};
+
+/**
+ * @brief One input file. Filled in by the task that parses it; read it only after
+ * Frontend::wait returns it.
+ */
+struct SourceFile
+{
+	String path;
+	String text;
+
+	// Only kept when debug info needs the token positions after parsing.
+	std::optional<LexResult> tokens;
+	// Parse errors point into the line markers of the stream.
+	std::unique_ptr<TokenStream> stream;
+
+	ast::Ast ast;
+	ast::AstNode* module = nullptr;
+	Vec<Declaration> declarations;
+
+	// Set if the file could not be read or parsed.
+	OwnPtr<ParseError> error = OwnPtr<ParseError>::null();
+
+	std::atomic<bool> ready{false};
+};
+
+/**
+ * @brief Parsed files kept across compiles by the compile server. A file is parsed
+ * again once its size or modification time changes.
+ */
+class FileCache
+{
+public:
+	/**
+	 * @brief The file as parsed by an earlier compile, or null if it changed since, or
+	 * was parsed with other tokens kept, or failed.
+	 */
+	std::shared_ptr<SourceFile> find(String const& path, bool keep_tokens) const;
+	void insert(String const& path, bool keep_tokens, std::shared_ptr<SourceFile> file);
+
+private:
+	struct Stamp
+	{
+		std::uintmax_t size;
+		std::int64_t modified;
+
+		bool operator==(Stamp const& other) const
+		{
+			return size == other.size && modified == other.modified;
+		}
+	};
+
+	struct Entry
+	{
+		Stamp stamp;
+		bool keep_tokens;
+		std::shared_ptr<SourceFile> file;
+	};
+
+	// By absolute path, so clients in other directories share them.
+	std::unordered_map<String, Entry> entries;
+
+	static std::optional<Stamp> stamp(String const& path, String& absolute);
+};
+
+/**
+ * @brief Reads, lexes and parses each file, and collects its declarations, as a task
+ * on the pool. Files do not depend on each other until sema, so the caller can
+ * analyse a file as soon as it and the files before it are ready.
+ */
+class Frontend
+{
+	TaskPool& pool;
+	bool keep_tokens;
+	FileCache* cache;
+	Vec<std::shared_ptr<SourceFile>> files;
+
+	// Declarations of the files merged so far, by name.
+	std::unordered_map<Symbol, SourceFile const*> declared;
+	unsigned int merged = 0;
+
+public:
+	/**
+	 * @brief Files found in the cache are not parsed again, and the files parsed are
+	 * added to it. The cache may be null.
+	 */
+	Frontend(TaskPool& pool, bool keep_tokens, FileCache* cache = nullptr);
+
+	/**
+	 * @brief Starts a task per file that is not cached and returns.
+	 */
+	void start(Vec<String> const& paths);
+	/**
+	 * @brief Starts a task per buffer and returns. Buffers are never cached.
+	 */
+	void start(Vec<SourceBuffer> const& buffers);
+
+	unsigned int size() const { return files.size(); }
+	Vec<std::shared_ptr<SourceFile>> const& sources() const { return files; }
+
+	/**
+	 * @brief Runs tasks on the calling thread until the file is ready.
+	 */
+	SourceFile& wait(unsigned int index);
+
+	/**
+	 * @brief Waits for the file, then adds its declarations to the ones of the files
+	 * before it. Files must be merged in order. Returns an error if the file failed,
+	 * or declares a name that an earlier file already declared.
+	 */
+	OwnPtr<ParseError> merge(unsigned int index);
+
+private:
+	static void parse_file(SourceFile& file, bool keep_tokens);
+	static void parse_text(SourceFile& file, bool keep_tokens);
+};
+
+/**
+ * @brief The named top level items of a module.
+ */
+Vec<Declaration> collect_declarations(ast::AstNode* module);
+
+} // namespace frontend
@@ -0,0 +1,618 @@
+#include "Session.h"
+
+#include "Frontend.h"
+#include "ast2/AstGen.h"
+#include "lexer/TokenCursor.h"
+#include "sema2/Sema2.h"
+#include "sema2/SemaGen.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+using namespace frontend;
+using namespace ast;
+
+static bool
+is_identifier_char(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+		   c == '_';
+}
+
+/**
+ * @brief Offsets of the lines that start with a top level keyword. A region that does
+ * not parse is split there, so one broken item does not take its neighbours with it.
+ */
+static Vec<unsigned int>
+segment_starts(String const& text)
+{
+	static char const* const keywords[] = {
+		"fn", "async", "extern", "struct", "union", "enum", "namespace"};
+
+	Vec<unsigned int> starts{0};
+	for( unsigned int line = 0; line < text.size(); )
+	{
+		if( line != 0 )
+		{
+			for( auto keyword : keywords )
+			{
+				auto len = strlen(keyword);
+				if( text.compare(line, len, keyword) == 0 &&
+					(line + len == text.size() || !is_identifier_char(text[line + len])) )
+				{
+					starts.push_back(line);
+					break;
+				}
+			}
+		}
+
+		auto newline = text.find('\n', line);
+		if( newline == String::npos )
+			break;
+		line = newline + 1;
+	}
+
+	return starts;
+}
+
+/**
+ * @brief Index one past the last token of 'item' that is not a comment.
+ */
+static unsigned int
+item_token_end(LexResult const& tokens, AstNode const* item)
+{
+	int end = item->span.start + item->span.size;
+	while( end > item->span.start && tokens.type(end - 1) == TokenType::line_comment )
+		end -= 1;
+	return end;
+}
+
+/**
+ * @brief Index of the first token of 'item' that is not a comment.
+ */
+static unsigned int
+item_token_begin(LexResult const& tokens, AstNode const* item)
+{
+	int begin = item->span.start;
+	int end = item->span.start + item->span.size;
+	while( begin < end && tokens.type(begin) == TokenType::line_comment )
+		begin += 1;
+	return begin;
+}
+
+char const*
+Session::Piece::item_begin() const
+{
+	return chunk->text.c_str() + chunk->tokens->offsets[item_token_begin(*chunk->tokens, item)];
+}
+
+Session::Session(String const& text)
+{
+	pieces = std::move(*parse_region(text, true));
+	size_ = text.size();
+	update_offsets(0);
+
+	for( auto& piece : pieces )
+		add_users(piece.get());
+}
+
+Session::~Session() = default;
+
+String
+Session::text() const
+{
+	String result;
+	result.reserve(size_);
+	for( auto const& piece : pieces )
+		result.append(piece->chunk->text, piece->chunk_offset, piece->size);
+	return result;
+}
+
+AstNode*
+Session::item(unsigned int piece) const
+{
+	return pieces[piece]->item;
+}
+
+unsigned int
+Session::piece_offset(unsigned int piece) const
+{
+	return offsets[piece];
+}
+
+bool
+Session::dirty(unsigned int piece) const
+{
+	return pieces[piece]->dirty;
+}
+
+unsigned int
+Session::find_piece(unsigned int offset) const
+{
+	auto iter = std::upper_bound(offsets.begin(), offsets.end(), offset);
+	return iter - offsets.begin() - 1;
+}
+
+void
+Session::update_offsets(unsigned int from)
+{
+	offsets.resize(pieces.size());
+	unsigned int offset = from == 0 ? 0 : offsets[from - 1] + pieces[from - 1]->size;
+	for( unsigned int i = from; i < pieces.size(); i++ )
+	{
+		offsets[i] = offset;
+		offset += pieces[i]->size;
+	}
+}
+
+Reparse
+Session::edit(unsigned int offset, unsigned int removed, String const& inserted)
+{
+	assert(offset + removed <= size_ && "Edit past the end of the text");
+
+	// An edit at the start of a piece may join it to the item before, e.g. by extending
+	// the last identifier of an extern fn.
+	unsigned int first = find_piece(offset);
+	if( first > 0 && offset == offsets[first] )
+		first -= 1;
+	unsigned int last = find_piece(offset + removed);
+
+	// Text that failed to parse may parse together with the edited text.
+	while( first > 0 && pieces[first - 1]->parse_error )
+		first -= 1;
+	while( last + 1 < pieces.size() && pieces[last + 1]->parse_error )
+		last += 1;
+
+	String region;
+	std::optional<Vec<std::unique_ptr<Piece>>> parsed;
+	while( true )
+	{
+		region.clear();
+		for( unsigned int i = first; i <= last; i++ )
+			region.append(pieces[i]->chunk->text, pieces[i]->chunk_offset, pieces[i]->size);
+		region.replace(offset - offsets[first], removed, inserted);
+
+		parsed = parse_region(region, last + 1 == pieces.size());
+		if( parsed )
+			break;
+
+		// The region does not end where an item ends, so its last token could continue
+		// into the next piece.
+		last += 1;
+	}
+
+	Vec<std::unique_ptr<Piece>> old_pieces;
+	for( unsigned int i = first; i <= last; i++ )
+	{
+		remove_users(pieces[i].get());
+		if( sema && pieces[i]->chunk->sema_generation == sema_generation )
+			retired.push_back(pieces[i]->chunk);
+		old_pieces.push_back(std::move(pieces[i]));
+	}
+
+	Vec<Piece*> added;
+	for( auto& piece : *parsed )
+	{
+		add_users(piece.get());
+		added.push_back(piece.get());
+	}
+
+	auto removed_pieces = last - first + 1;
+	auto added_pieces = parsed->size();
+	pieces.erase(pieces.begin() + first, pieces.begin() + last + 1);
+	pieces.insert(
+		pieces.begin() + first,
+		std::make_move_iterator(parsed->begin()),
+		std::make_move_iterator(parsed->end()));
+
+	size_ = size_ - removed + inserted.size();
+	update_offsets(first);
+
+	invalidate(old_pieces, added);
+
+	return Reparse{first, removed_pieces, (unsigned int)added_pieces, (unsigned int)region.size()};
+}
+
+/**
+ * @brief Parses 'text' into pieces. Nullopt if a piece would end in the middle of a line
+ * without ending an item, or the text ends in the middle of an item, unless 'is_tail',
+ * i.e. the text runs to the end of the file.
+ */
+std::optional<Vec<std::unique_ptr<Session::Piece>>>
+Session::parse_region(String const& text, bool is_tail) const
+{
+	Vec<std::unique_ptr<Piece>> result;
+
+	auto chunk = std::make_shared<Chunk>();
+	chunk->text = text;
+	auto parsed = parse_chunk(chunk, is_tail, result);
+	if( parsed == ChunkParse::ok )
+		return result;
+	if( parsed == ChunkParse::unsafe_end )
+		return std::nullopt;
+
+	// Parse each segment on its own. The segments that fail become broken pieces.
+	result.clear();
+	auto starts = segment_starts(text);
+	for( unsigned int i = 0; i < starts.size(); i++ )
+	{
+		bool last_segment = i + 1 == starts.size();
+		auto end = last_segment ? text.size() : starts[i + 1];
+
+		auto segment = std::make_shared<Chunk>();
+		segment->text = text.substr(starts[i], end - starts[i]);
+		auto segment_parsed = parse_chunk(segment, !last_segment || is_tail, result);
+		if( segment_parsed == ChunkParse::unsafe_end )
+			return std::nullopt;
+	}
+
+	return result;
+}
+
+Session::ChunkParse
+Session::parse_chunk(
+	std::shared_ptr<Chunk> const& chunk, bool is_tail, Vec<std::unique_ptr<Piece>>& out) const
+{
+	Lexer lexer{chunk->text.c_str()};
+	chunk->tokens.emplace(lexer.lex());
+	auto const& tokens = *chunk->tokens;
+
+	TokenCursor cursor{tokens};
+	AstGen gen{chunk->ast, cursor};
+	auto result = gen.parse();
+	if( !result.ok() )
+	{
+		auto error = result.unwrap_error();
+		auto piece = make_piece(chunk, 0, chunk->text.size(), nullptr);
+		piece->parse_error = Diagnostic{0, error->error};
+		if( error->token.start != nullptr )
+			piece->parse_error->offset = error->token.start - chunk->text.c_str();
+
+		// The text ran out in the middle of an item, which the text after it may end.
+		if( !is_tail && piece->parse_error->offset >= chunk->text.size() )
+			return ChunkParse::unsafe_end;
+
+		// Only kept if the caller gives up on parsing a larger region.
+		out.push_back(std::move(piece));
+		return ChunkParse::failed;
+	}
+
+	auto items = result.unwrap()->data.mod.statements;
+	auto const& text = chunk->text;
+
+	// Each item ends its piece, except that the last piece runs to the end of the text.
+	unsigned int begin = 0;
+	Vec<std::unique_ptr<Piece>> made;
+	for( unsigned int i = 0; i < items->list.size(); i++ )
+	{
+		auto item = items->list[i];
+		unsigned int end = text.size();
+		if( i + 1 < items->list.size() )
+		{
+			auto last_token = item_token_end(tokens, item) - 1;
+			end = tokens.offsets[last_token] + tokens.lengths[last_token];
+		}
+
+		made.push_back(make_piece(chunk, begin, end, item));
+		begin = end;
+	}
+
+	if( made.empty() )
+		made.push_back(make_piece(chunk, 0, text.size(), nullptr));
+
+	if( !is_tail && !text.empty() && text.back() != '\n' )
+	{
+		auto last = items->list.empty() ? nullptr : items->list.back();
+		if( !last )
+			return ChunkParse::unsafe_end;
+
+		auto last_token = item_token_end(tokens, last) - 1;
+		if( tokens.offsets[last_token] + tokens.lengths[last_token] != text.size() )
+			return ChunkParse::unsafe_end;
+	}
+
+	for( auto& piece : made )
+		out.push_back(std::move(piece));
+
+	return ChunkParse::ok;
+}
+
+std::unique_ptr<Session::Piece>
+Session::make_piece(
+	std::shared_ptr<Chunk> const& chunk, unsigned int begin, unsigned int end, AstNode* item) const
+{
+	auto piece = std::make_unique<Piece>();
+	piece->chunk = chunk;
+	piece->chunk_offset = begin;
+	piece->size = end - begin;
+	piece->item = item;
+	if( !item )
+		return piece;
+
+	auto list = chunk->ast.create_list();
+	list->append(item);
+	piece->module = chunk->ast.Module(item->span, list);
+
+	auto declarations = collect_declarations(piece->module);
+	if( !declarations.empty() )
+		piece->declares = declarations[0].name;
+
+	// A fn is declared by everything before its body. Anything in a generic can change
+	// its instances, so all of a generic is its declaration.
+	auto const& tokens = *chunk->tokens;
+	unsigned int token_begin = item->span.start;
+	unsigned int token_end = item_token_end(tokens, item);
+	unsigned int interface_end = token_end;
+	if( item->type == NodeType::Fn && !item->data.fn.prototype->data.fn_proto->type_params )
+		interface_end = item->data.fn.body->span.start;
+
+	std::uint64_t hash = 14695981039346656037ull;
+	for( unsigned int i = token_begin; i < token_end; i++ )
+	{
+		auto type = tokens.type(i);
+		if( type == TokenType::line_comment )
+			continue;
+
+		std::string_view spelling{chunk->text.c_str() + tokens.offsets[i], tokens.lengths[i]};
+		if( i < interface_end )
+			hash = (hash ^ std::hash<std::string_view>{}(spelling)) * 1099511628211ull;
+
+		if( type == TokenType::identifier )
+		{
+			auto symbol = Symbol::intern(spelling);
+			piece->refs.push_back(symbol);
+			if( i < interface_end )
+				piece->interface_refs.push_back(symbol);
+		}
+	}
+	piece->interface_hash = hash;
+
+	for( auto refs : {&piece->refs, &piece->interface_refs} )
+	{
+		std::sort(refs->begin(), refs->end());
+		refs->erase(std::unique(refs->begin(), refs->end()), refs->end());
+	}
+
+	return piece;
+}
+
+void
+Session::add_users(Piece* piece)
+{
+	if( !piece->declares.empty() )
+		declared[piece->declares] += 1;
+	for( auto name : piece->refs )
+		users[name].insert(piece);
+	for( auto name : piece->interface_refs )
+		interface_users[name].insert(piece);
+}
+
+void
+Session::remove_users(Piece* piece)
+{
+	if( !piece->declares.empty() )
+		declared[piece->declares] -= 1;
+	for( auto name : piece->refs )
+		users[name].erase(piece);
+	for( auto name : piece->interface_refs )
+		interface_users[name].erase(piece);
+}
+
+void
+Session::invalidate(Vec<std::unique_ptr<Piece>> const& removed, Vec<Piece*> const& added)
+{
+	Vec<Symbol> changed;
+
+	// A name declared twice by the edited pieces changed, since which one sema sees may
+	// have.
+	std::unordered_map<Symbol, std::uint64_t> before;
+	std::unordered_map<Symbol, std::uint64_t> after;
+	for( auto const& piece : removed )
+	{
+		if( !piece->declares.empty() && !before.emplace(piece->declares, piece->interface_hash).second )
+			changed.push_back(piece->declares);
+	}
+	for( auto piece : added )
+	{
+		if( !piece->declares.empty() && !after.emplace(piece->declares, piece->interface_hash).second )
+			changed.push_back(piece->declares);
+	}
+
+	for( auto [name, hash] : before )
+	{
+		auto iter = after.find(name);
+		if( iter == after.end() || iter->second != hash )
+			changed.push_back(name);
+	}
+	for( auto [name, hash] : after )
+	{
+		if( before.find(name) == before.end() )
+			changed.push_back(name);
+	}
+
+	// A declaration that names a changed declaration changes with it, e.g. a struct
+	// with a member of a changed struct.
+	std::unordered_set<Symbol> seen(changed.begin(), changed.end());
+	for( unsigned int i = 0; i < changed.size(); i++ )
+	{
+		auto iter = interface_users.find(changed[i]);
+		if( iter == interface_users.end() )
+			continue;
+
+		for( auto piece : iter->second )
+		{
+			if( !piece->declares.empty() && seen.insert(piece->declares).second )
+				changed.push_back(piece->declares);
+		}
+	}
+
+	for( auto name : changed )
+	{
+		auto iter = users.find(name);
+		if( iter == users.end() )
+			continue;
+
+		for( auto piece : iter->second )
+			piece->dirty = true;
+	}
+
+	// Items without a name, e.g. namespaces, are not tracked, and prototypes are carried
+	// over by name, so both always redeclare.
+	bool untracked = std::any_of(added.begin(), added.end(), [this](Piece const* piece) {
+		return (piece->module && piece->declares.empty()) || declared[piece->declares] > 1;
+	});
+	if( !changed.empty() || untracked )
+	{
+		redeclare = true;
+		return;
+	}
+
+	// Every declaration is as it was, so the new pieces reuse the prototypes.
+	std::unordered_map<Symbol, ir::IRProto*> protos;
+	for( auto const& piece : removed )
+	{
+		if( !piece->declares.empty() )
+			protos[piece->declares] = piece->proto;
+	}
+	for( auto piece : added )
+	{
+		if( !piece->declares.empty() )
+			piece->proto = protos[piece->declares];
+	}
+}
+
+/**
+ * @brief Offset of the token from the start of the piece. Errors without a token in the
+ * piece point to the start of the item, so they do not move with the trivia before it.
+ */
+static unsigned int
+piece_relative_offset(
+	char const* piece_begin, unsigned int piece_size, char const* item_begin, Token const& token)
+{
+	if( token.start < piece_begin || token.start >= piece_begin + piece_size )
+		return item_begin - piece_begin;
+
+	return token.start - piece_begin;
+}
+
+void
+Session::declare()
+{
+	sema.reset();
+	retired.clear();
+	sema_generation += 1;
+	sema_uses = 0;
+	redeclare = false;
+
+	for( auto const& piece : pieces )
+	{
+		piece->proto = nullptr;
+		piece->declaration_error.reset();
+		if( !piece->module || piece->chunk->sema_generation == sema_generation )
+			continue;
+
+		piece->chunk->sema_generation = sema_generation;
+		if( !sema )
+			sema = std::make_unique<sema::Sema2>(piece->chunk->ast);
+		else
+			sema->add_ast(piece->chunk->ast);
+	}
+
+	for( auto& piece : pieces )
+	{
+		if( !piece->module )
+			continue;
+
+		auto declaredr = sema::sema_declarations(*sema, piece->module);
+		if( !declaredr.ok() )
+		{
+			auto error = declaredr.unwrap_error();
+			auto offset = piece_relative_offset(
+				piece->begin(), piece->size, piece->item_begin(), error->token);
+			piece->declaration_error = Diagnostic{offset, error->error};
+			sema->reset_to_module_scope();
+			sema->take_generated();
+
+			// Its users may see the declaration once it is fixed.
+			redeclare = true;
+			continue;
+		}
+
+		for( auto& item : declaredr.unwrap().items )
+		{
+			if( item.proto )
+				piece->proto = item.proto;
+		}
+	}
+}
+
+Vec<Diagnostic>
+Session::check()
+{
+	if( redeclare || !sema || sema_uses >= sema_reuse_limit )
+	{
+		declare();
+	}
+	else
+	{
+		for( auto const& piece : pieces )
+		{
+			if( !piece->module || piece->chunk->sema_generation == sema_generation )
+				continue;
+
+			piece->chunk->sema_generation = sema_generation;
+			sema->add_ast(piece->chunk->ast);
+			sema_uses += 1;
+		}
+	}
+
+	for( auto& piece : pieces )
+	{
+		if( piece->declaration_error )
+		{
+			// Checked once the declaration is fixed, which makes the piece dirty.
+			piece->body_error.reset();
+			continue;
+		}
+		if( !piece->dirty )
+			continue;
+
+		piece->body_error.reset();
+		if( piece->proto )
+		{
+			auto bodyr = sema::sema_fn_body(*sema, piece->item, piece->proto);
+			sema->take_generated();
+			sema_uses += 1;
+			if( !bodyr.ok() )
+			{
+				auto error = bodyr.unwrap_error();
+				auto offset = piece_relative_offset(
+					piece->begin(), piece->size, piece->item_begin(), error->token);
+				piece->body_error = Diagnostic{offset, error->error};
+				sema->reset_to_module_scope();
+			}
+		}
+
+		piece->dirty = false;
+	}
+
+	Vec<Diagnostic> diagnostics;
+	for( unsigned int i = 0; i < pieces.size(); i++ )
+	{
+		auto& piece = *pieces[i];
+		for( auto error : {&piece.parse_error, &piece.declaration_error, &piece.body_error} )
+		{
+			if( !*error )
+				continue;
+
+			auto diagnostic = **error;
+			diagnostic.offset += offsets[i];
+			diagnostics.push_back(diagnostic);
+		}
+	}
+
+	return diagnostics;
+}
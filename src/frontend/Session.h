@@ -0,0 +1,202 @@
+#pragma once
+
+#include "ast2/Ast.h"
+#include "ast2/AstNode.h"
+#include "common/String.h"
+#include "common/Symbol.h"
+#include "common/Vec.h"
+#include "lexer/Lexer.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ir
+{
+struct IRProto;
+}
+
+namespace sema
+{
+class Sema2;
+}
+
+namespace frontend
+{
+
+/**
+ * @brief An error at a byte offset of the session text.
+ */
+struct Diagnostic
+{
+	unsigned int offset;
+	String message;
+};
+
+/**
+ * @brief Which pieces an edit replaced, by index before and after the edit.
+ */
+struct Reparse
+{
+	unsigned int first;
+	unsigned int removed;
+	unsigned int added;
+	// Bytes that were lexed and parsed again.
+	unsigned int bytes;
+};
+
+/**
+ * @brief One file kept parsed across edits, for editors and the compile server.
+ *
+ * The text is split into pieces, each holding one top level item, or only trivia, or
+ * text that failed to parse. Pieces are lexed and parsed on their own: an edit re-lexes
+ * and re-parses just the pieces it touches, and the pieces next to them if the edit
+ * moves an item boundary. Every other piece keeps its tokens and AstNodes.
+ *
+ * Sema is invalidated per piece. Editing a fn body only invalidates that fn. Changing
+ * a declaration, i.e. a fn prototype, a struct, union or enum, or anything of a generic,
+ * invalidates every piece that names it. A declaration that names a changed declaration
+ * changes too.
+ */
+class Session
+{
+public:
+	/**
+	 * @brief Every body check adds IR to the Sema2, and the chunks it was given are kept
+	 * after they are replaced, see 'retired'. Both are freed when the Sema2 is made again,
+	 * which it is after this many body checks and new chunks.
+	 */
+	static constexpr unsigned int sema_reuse_limit = 512;
+
+	explicit Session(String const& text);
+	~Session();
+
+	/**
+	 * @brief Replaces 'removed' bytes at 'offset' with 'inserted'.
+	 */
+	Reparse edit(unsigned int offset, unsigned int removed, String const& inserted);
+
+	String text() const;
+	unsigned int text_size() const { return size_; }
+
+	unsigned int piece_count() const { return pieces.size(); }
+	/**
+	 * @brief The top level item of a piece, or null for trivia and text that failed to
+	 * parse.
+	 */
+	ast::AstNode* item(unsigned int piece) const;
+	unsigned int piece_offset(unsigned int piece) const;
+	/**
+	 * @brief True if the piece changed, or something it depends on changed, since the
+	 * last check().
+	 */
+	bool dirty(unsigned int piece) const;
+
+	/**
+	 * @brief Checks the fn bodies of the dirty pieces and returns the errors of all
+	 * pieces in text order. Bodies that are not dirty keep their errors from the previous
+	 * check.
+	 *
+	 * Declarations are analysed again only if one changed since the previous check, or
+	 * one failed, or the Sema2 reached sema_reuse_limit. Otherwise the dirty bodies are
+	 * checked against the previous analysis.
+	 */
+	Vec<Diagnostic> check();
+
+private:
+	// Text lexed and parsed as a unit. Shared by the pieces it was split into.
+	struct Chunk
+	{
+		String text;
+		std::optional<LexResult> tokens;
+		ast::Ast ast;
+		// Whether sema has the type arguments of 'ast', see Session::sema_generation.
+		unsigned int sema_generation = 0;
+	};
+
+	struct Piece
+	{
+		std::shared_ptr<Chunk> chunk;
+		// Bytes of chunk->text.
+		unsigned int chunk_offset;
+		unsigned int size;
+
+		ast::AstNode* item = nullptr;
+		// Module of just 'item', for sema.
+		ast::AstNode* module = nullptr;
+
+		// Offsets are from the start of the piece, so they stay valid as the text
+		// before the piece changes.
+		std::optional<Diagnostic> parse_error;
+		std::optional<Diagnostic> declaration_error;
+		std::optional<Diagnostic> body_error;
+		bool dirty = true;
+
+		// Prototype of the fn, from the analysis of the declarations. Carried over to the
+		// new piece if an edit leaves the declaration as it was.
+		ir::IRProto* proto = nullptr;
+
+		// Declared name, or empty.
+		Symbol declares;
+		// Hash of the tokens that make up the declaration.
+		std::uint64_t interface_hash = 0;
+		// Identifiers in the declaration, and in the whole item.
+		Vec<Symbol> interface_refs;
+		Vec<Symbol> refs;
+
+		char const* begin() const { return chunk->text.c_str() + chunk_offset; }
+		// First token of the item that is not a comment. Only for pieces with an item.
+		char const* item_begin() const;
+	};
+
+	enum class ChunkParse
+	{
+		ok,
+		failed,
+		// Parsed, but the last piece would end in the middle of a line without ending
+		// an item, or failed at the end of the text. The next piece must be parsed with
+		// it.
+		unsafe_end,
+	};
+
+	Vec<std::unique_ptr<Piece>> pieces;
+	// Byte offset of each piece. Kept in step with pieces.
+	Vec<unsigned int> offsets;
+	unsigned int size_ = 0;
+
+	std::unique_ptr<sema::Sema2> sema;
+	// Counts the Sema2s made, starting from 1.
+	unsigned int sema_generation = 0;
+	// Body checks and chunks added since the Sema2 was made.
+	unsigned int sema_uses = 0;
+	// Replaced chunks that the Sema2 was given. Its IR, its type arguments and the
+	// carried over prototypes point into their AstNodes.
+	Vec<std::shared_ptr<Chunk>> retired;
+	bool redeclare = true;
+
+	// Pieces that declare a name.
+	std::unordered_map<Symbol, unsigned int> declared;
+	// Pieces that name a symbol, and pieces whose declaration names it.
+	std::unordered_map<Symbol, std::unordered_set<Piece*>> users;
+	std::unordered_map<Symbol, std::unordered_set<Piece*>> interface_users;
+
+	unsigned int find_piece(unsigned int offset) const;
+	std::optional<Vec<std::unique_ptr<Piece>>> parse_region(String const& text, bool is_tail) const;
+	ChunkParse parse_chunk(
+		std::shared_ptr<Chunk> const& chunk, bool is_tail, Vec<std::unique_ptr<Piece>>& out) const;
+	std::unique_ptr<Piece> make_piece(
+		std::shared_ptr<Chunk> const& chunk,
+		unsigned int begin,
+		unsigned int end,
+		ast::AstNode* item) const;
+
+	void add_users(Piece* piece);
+	void remove_users(Piece* piece);
+	void invalidate(Vec<std::unique_ptr<Piece>> const& removed, Vec<Piece*> const& added);
+	void update_offsets(unsigned int from);
+	void declare();
+};
+
+} // namespace frontend
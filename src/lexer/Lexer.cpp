@@ -2,27 +2,47 @@
 
 #include "character_sets.h"
 #include "keywords.h"
+#include "scan.h"
 
 #include <iomanip>
 #include <iostream>
 
-LexResult::LexResult(unsigned int num_lines, Vec<char const*> lines, Vec<Token> tokens)
-	: tokens(std::move(tokens))
+LexResult::LexResult(char const* input)
+	: input(input)
+{}
+
+Token
+LexResult::token(unsigned int index) const
 {
-	markers.lines = lines;
-	markers.num_lines = num_lines;
+	Token token{type(index)};
+	token.literal_type = LiteralType(literal_types[index]);
+	token.start = input + offsets[index];
+	token.size = lengths[index];
+	token.neighborhood.lines = &markers;
+	token.neighborhood.line_num = line_nums[index];
 
-	for( auto& tok : this->tokens )
-	{
-		tok.neighborhood.lines = markers;
-	}
+	return token;
+}
+
+void
+LexResult::push_back(Token const& token)
+{
+	if( token.type == TokenType::line_comment )
+		comments.push_back(kinds.size());
+
+	kinds.push_back(static_cast<std::uint8_t>(token.type));
+	literal_types.push_back(static_cast<std::uint8_t>(token.literal_type));
+	offsets.push_back(token.start - input);
+	lengths.push_back(token.size);
+	line_nums.push_back(token.neighborhood.line_num);
 }
 
 void
-Lexer::print_tokens(Vec<Token> const& tokens)
+Lexer::print_tokens(LexResult const& tokens)
 {
-	for( auto& tok : tokens )
+	for( unsigned int i = 0; i < tokens.size(); i++ )
 	{
+		auto tok = tokens.token(i);
 		std::string sz{tok.start, tok.start + tok.size};
 		std::cout << std::setw(10) << sz << " : " << get_tokentype_string(tok) << std::endl;
 	}
@@ -31,33 +51,45 @@ Lexer::print_tokens(Vec<Token> const& tokens)
 LexResult
 Lexer::lex()
 {
-	Vec<Token> tokens{};
-	tokens.reserve(30);
-	cursor_ = 0;
-	lines_.push_back(&input_[cursor_]);
+	LexResult tokens{input_};
+
+	Token token;
+	do
+	{
+		token = next();
+		tokens.push_back(token);
+	} while( token.type != TokenType::eof );
+
+	tokens.markers = markers_;
 
+	return tokens;
+}
+
+Token
+Lexer::next()
+{
 	for( ; cursor_ < input_len_; cursor_++ )
 	{
 		char c = input_[cursor_];
+		Token token;
 
 		switch( c )
 		{
 		case CHAR_WHITESPACE_CASES:
 		{
-			if( c == '\n' )
-			{
-				lines_.push_back(&input_[cursor_]);
-				curr_line_++;
-				track_newline(tokens);
-			}
+			auto lines_before = markers_.lines.size();
+			auto run_end = scan_whitespace(&input_[cursor_], input_ + input_len_, markers_.lines);
+			curr_line_ += markers_.lines.size() - lines_before;
+			markers_.num_lines = curr_line_;
+			cursor_ = run_end - input_ - 1;
 		}
-		break;
+			continue;
 		case CHAR_IDENTIFIER_START_CASES:
-			tokens.push_back(lex_consume_identifier());
+			token = lex_consume_identifier();
 			break;
 
 		case CHAR_DIGIT_CASES:
-			tokens.push_back(lex_consume_number());
+			token = lex_consume_number();
 			break;
 
 		case '(':
@@ -68,7 +100,8 @@ Lexer::lex()
 		case '}':
 		case ';':
 		case ',':
-			tokens.push_back(lex_consume_single());
+		case '@':
+			token = lex_consume_single();
 			break;
 		case ':':
 		case '.':
@@ -81,22 +114,26 @@ Lexer::lex()
 		case '-':
 		case '&':
 		case '|':
-			tokens.push_back(lex_consume_ambiguous_lexeme());
+			token = lex_consume_ambiguous_lexeme();
 			break;
 		case '"':
-			tokens.push_back(lex_consume_string_literal());
+			token = lex_consume_string_literal();
 			break;
 		default:
 			std::cout << "Unexpected character: '" << c << "'" << std::endl;
-			break;
+			continue;
 		}
-	}
 
-	tokens.emplace_back(TokenType::eof);
+		// The consume functions leave the cursor on the last character of the token.
+		cursor_++;
+		return token;
+	}
 
-	auto result = LexResult{curr_line_, lines_, tokens};
+	Token eof{TokenType::eof};
+	eof.start = &input_[input_len_];
+	eof.neighborhood.line_num = curr_line_;
 
-	return result;
+	return eof;
 }
 
 Token
@@ -167,6 +204,9 @@ Lexer::lex_consume_single()
 	case '.':
 		token.type = TokenType::dot;
 		break;
+	case '@':
+		token.type = TokenType::at;
+		break;
 
 	default:
 		token.type = TokenType::bad;
@@ -183,25 +223,12 @@ Lexer::lex_consume_identifier()
 	token.start = &input_[cursor_];
 	token.neighborhood.line_num = curr_line_;
 
-	for( ; cursor_ < input_len_; cursor_++ )
-	{
-		char c = input_[cursor_];
-
-		switch( c )
-		{
-		case CHAR_IDENTIFIER_CASES:
-			token.size += 1;
-			break;
-
-		default:
-			goto done;
-			break;
-		}
-	}
-done:
+	// The first character was already matched by the caller.
+	auto ident_end = scan_identifier(token.start + 1, input_ + input_len_);
+	token.size = ident_end - token.start;
 	token.type = get_identifier_or_keyword_type(token);
 
-	cursor_--;
+	cursor_ = ident_end - input_ - 1;
 
 	return token;
 }
@@ -212,17 +239,13 @@ Lexer::lex_consume_line_comment()
 	Token token{};
 	token.type = TokenType::line_comment;
 	token.start = &input_[cursor_];
-	token.size = 1;
 	token.neighborhood.line_num = curr_line_;
 
-	char c = input_[++cursor_];
-	while( c != '\n' )
-	{
-		token.size += 1;
-		c = input_[++cursor_];
-	}
+	// A comment on the last line may end at the end of the input instead of '\n'.
+	auto comment_end = scan_line_end(token.start, input_ + input_len_);
+	token.size = comment_end - token.start;
 
-	--cursor_;
+	cursor_ = comment_end - input_ - 1;
 
 	return token;
 }
@@ -384,55 +407,20 @@ Lexer::lex_consume_string_literal()
 	token.type = TokenType::literal;
 	token.literal_type = LiteralType::string;
 	token.start = &input_[cursor_];
-	token.size = 1;
 	token.neighborhood.line_num = curr_line_;
-	cursor_ += 1;
-
-	char c = input_[cursor_];
-	while( c != '"' )
-	{
-		token.size += 1;
-		cursor_ += 1;
-		c = input_[cursor_];
-	}
-	token.size += 1;
-
-done:
-	return token;
-}
-
-void
-Lexer::track_newline(std::vector<Token>& tokens)
-{
-	if( tokens.size() != 0 )
-	{
-		tokens.back().num_trailing_newlines += 1;
-	}
-}
 
-bool
-Lexer::peek(char const* seq)
-{
-	auto len = strlen(seq);
+	// Skip escapes so '\"' does not end the literal. Escapes are resolved in codegen.
+	char const* end = input_ + input_len_;
+	char const* p = scan_string_body(token.start + 1, end);
+	while( p < end && *p == '\\' )
+		p = scan_string_body(p + 2 < end ? p + 2 : end, end);
 
-	for( int i = 0; i < len; ++i )
-	{
-		int look_ahead = cursor_ + i + 1;
-		if( look_ahead < input_len_ )
-		{
-			auto c = input_[look_ahead];
-			if( c != seq[i] )
-			{
-				return false;
-			}
-		}
-		else
-		{
-			return false;
-		}
-	}
+	// Unterminated literals end at the end of the input.
+	char const* literal_end = p < end ? p + 1 : end;
+	token.size = literal_end - token.start;
+	cursor_ = literal_end - input_ - 1;
 
-	return true;
+	return token;
 }
 
 Token
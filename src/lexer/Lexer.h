@@ -3,16 +3,39 @@
 
 #include "token.h"
 
+#include <cstdint>
 #include <cstring>
 #include <vector>
 
+/**
+ * @brief Tokens as parallel arrays, indexed by token index.
+ *
+ * The parser mostly scans kinds, so keeping them apart from the
+ * offsets/lengths/lines puts 64 tokens on a cache line.
+ */
 class LexResult
 {
 public:
 	LineMarkers markers;
-	std::vector<Token> tokens;
+	char const* input;
 
-	LexResult(unsigned int num_lines, Vec<char const*> lines, Vec<Token> tokens);
+	Vec<std::uint8_t> kinds;
+	Vec<std::uint8_t> literal_types;
+	// From input.
+	Vec<std::uint32_t> offsets;
+	Vec<std::uint32_t> lengths;
+	Vec<std::uint32_t> line_nums;
+
+	// Indices of the comment tokens.
+	Vec<int> comments;
+
+	LexResult(char const* input);
+
+	unsigned int size() const { return kinds.size(); }
+	TokenType type(unsigned int index) const { return TokenType(kinds[index]); }
+	Token token(unsigned int index) const;
+
+	void push_back(Token const& token);
 };
 
 class Lexer
@@ -23,12 +46,27 @@ public:
 		, cursor_(0)
 		, curr_line_(0)
 		, input_len_(strlen(in))
-	{}
+	{
+		markers_.lines.push_back(in);
+		markers_.num_lines = 0;
+	}
 
 	LexResult lex();
 
+	/**
+	 * @brief Lexes the next token. Returns eof, repeatedly, at the end of the input.
+	 */
+	Token next();
+
+	char const* input() const { return input_; }
+
+	/**
+	 * @brief Lines seen so far.
+	 */
+	LineMarkers const& markers() const { return markers_; }
+
 private:
-	std::vector<char const*> lines_;
+	LineMarkers markers_;
 	char const* input_;
 	int cursor_;
 	int input_len_;
@@ -41,14 +79,21 @@ private:
 	Token lex_consume_ambiguous_lexeme();
 	Token lex_consume_string_literal();
 
-	void track_newline(std::vector<Token>& tokens);
-
-	bool peek(char const* seq);
+	/**
+	 * @brief True if 'seq' follows the current character. The length is known at
+	 * compile time.
+	 */
+	template<std::size_t N>
+	bool peek(char const (&seq)[N]) const
+	{
+		constexpr std::size_t len = N - 1;
+		return cursor_ + len < (std::size_t)input_len_ && memcmp(&input_[cursor_ + 1], seq, len) == 0;
+	}
 
 	Token new_token(TokenType token_type, int size);
 
 public:
-	static void print_tokens(std::vector<Token> const& tokens);
+	static void print_tokens(LexResult const& tokens);
 };
 
 #endif
\ No newline at end of file
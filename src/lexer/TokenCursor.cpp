@@ -5,7 +5,7 @@
 bool
 TokenCursor::has_tokens() const
 {
-	return _index <= _tokens.size();
+	return _index == 0 || available(_index - 1);
 }
 
 Token
@@ -13,97 +13,134 @@ TokenCursor::peek(int index) const
 {
 	if( index != -1 )
 	{
-		return _tokens[index];
+		return available(index) ? token_at(index) : Token{};
 	}
 	else
 	{
-		int ind = _index;
-		while( _tokens[ind].type == TokenType::line_comment )
-		{
+		unsigned int ind = _index;
+		while( available(ind) && type_at(ind) == TokenType::line_comment )
 			ind++;
-			if( ind >= _tokens.size() )
-			{
-				return Token{};
-			}
-		}
-		return _tokens[ind];
+
+		if( !available(ind) )
+			return Token{};
+
+		return token_at(ind);
 	}
 }
 
-ConsumeResult
-TokenCursor::consume(TokenType expected)
+TokenType
+TokenCursor::peek_type() const
 {
-	if( auto tok = next_token(); tok->type == expected )
+	unsigned int ind = _index;
+	while( available(ind) && type_at(ind) == TokenType::line_comment )
+		ind++;
+
+	if( !available(ind) )
+		return TokenType::bad;
+
+	return type_at(ind);
+}
+
+TokenType
+TokenCursor::peek_type_ahead(unsigned int n) const
+{
+	unsigned int ind = _index;
+	while( true )
 	{
-		_index += 1;
-		return ConsumeResult{tok};
+		while( available(ind) && type_at(ind) == TokenType::line_comment )
+			ind++;
+
+		if( !available(ind) )
+			return TokenType::bad;
+
+		if( n == 0 )
+			return type_at(ind);
+
+		n -= 1;
+		ind += 1;
 	}
+}
+
+Token
+ConsumeResult::as() const
+{
+	return index == -1 ? Token{} : cursor->token_at(index);
+}
+
+ConsumeResult
+TokenCursor::consume_index(int index)
+{
+	// The tokens before this one are dropped. This one stays until the next consume,
+	// so the result can still read it.
+	if( _stream )
+		_stream->release(index);
+	_index += 1;
+
+	return ConsumeResult{this, index, type_at(index), true};
+}
+
+ConsumeResult
+TokenCursor::fail(int index) const
+{
+	return ConsumeResult{this, index, index == -1 ? TokenType::bad : type_at(index), false};
+}
+
+ConsumeResult
+TokenCursor::consume(TokenType expected)
+{
+	if( auto ind = next_token(); ind != -1 && type_at(ind) == expected )
+		return consume_index(ind);
 	else
-	{
-		return ConsumeResult::fail(tok);
-	}
+		return fail(ind);
 }
 
 ConsumeResult
 TokenCursor::consume(TokenType expected_one, TokenType expected_two)
 {
-	auto tok = next_token();
-	if( tok->type == expected_one || tok->type == expected_two )
-	{
-		_index += 1;
-		return ConsumeResult{tok};
-	}
+	auto ind = next_token();
+	if( ind == -1 )
+		return fail(ind);
+
+	auto type = type_at(ind);
+	if( type == expected_one || type == expected_two )
+		return consume_index(ind);
 	else
-	{
-		return ConsumeResult::fail(tok);
-	}
+		return fail(ind);
 }
 
 ConsumeResult
 TokenCursor::consume(std::initializer_list<TokenType> expecteds)
 {
-	auto tok = next_token();
+	auto ind = next_token();
+	if( ind == -1 )
+		return fail(ind);
+
+	auto type = type_at(ind);
 	for( auto& exp : expecteds )
 	{
-		if( tok->type == exp )
-		{
-			_index += 1;
-			return ConsumeResult{tok};
-		}
+		if( type == exp )
+			return consume_index(ind);
 	}
-	return ConsumeResult::fail(tok);
+	return fail(ind);
 }
 
-Token const*
+/**
+ * @brief Skips ignored tokens and returns the index of the next token, or -1.
+ */
+int
 TokenCursor::next_token()
 {
-	if( _index >= _tokens.size() )
-	{
-		return nullptr;
-	}
-
-	while( _tokens[_index].type == TokenType::line_comment )
-	{
+	while( available(_index) && type_at(_index) == TokenType::line_comment )
 		_index++;
-		if( _index >= _tokens.size() )
-		{
-			return nullptr;
-		}
-	}
 
-	return &_tokens[_index];
+	if( !available(_index) )
+		return -1;
+
+	return _index;
 }
 
 ConsumeResult
 TokenCursor::consume_if_expected(TokenType expected)
 {
-	if( auto tok = next_token(); tok->type == expected )
-	{
-		_index += 1;
-		return ConsumeResult{tok};
-	}
-	else
-	{
-		return ConsumeResult::fail(tok);
-	}
+	return consume(expected);
 }
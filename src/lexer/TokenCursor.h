@@ -1,61 +1,119 @@
 #pragma once
 
+#include "Lexer.h"
+#include "TokenStream.h"
 #include "token.h"
 
 #include <vector>
 
+class TokenCursor;
+
+/**
+ * @brief The index of the consumed token, or of the unexpected one on failure.
+ *
+ * The token itself is read from the cursor's tokens by as(). A streamed token is
+ * dropped by the consume after the one that returned it, so read it before consuming
+ * again. The kind is kept here since parsers often check it later.
+ */
 class ConsumeResult
 {
+	friend class TokenCursor;
+
+	TokenCursor const* cursor = nullptr;
+	// -1 if past the end of the tokens.
+	int index = -1;
+	TokenType type = TokenType::bad;
 	bool success = false;
-	Token const* tok = nullptr;
 
-	ConsumeResult(Token const* tok, bool success)
-		: success(success)
-		, tok(tok)
+	ConsumeResult(TokenCursor const* cursor, int index, TokenType type, bool success)
+		: cursor(cursor)
+		, index(index)
+		, type(type)
+		, success(success)
 	{}
 
 public:
-	ConsumeResult(Token const* tok)
-		: ConsumeResult(tok, true)
-	{}
-
 	bool ok() const { return success; }
 
-	Token as() const { return *tok; }
+	int token_index() const { return index; }
 
-	// TODO: Panic if !success?
-	Token unwrap() const { return *tok; }
+	TokenType token_type() const { return type; }
 
-	static ConsumeResult fail(Token const* tok) { return ConsumeResult(tok, false); }
+	Token as() const;
+
+	// TODO: Panic if !success?
+	Token unwrap() const { return as(); }
 };
 
+/**
+ * @brief Reads the tokens of a LexResult, or pulls them from a TokenStream.
+ */
 class TokenCursor
 {
-	std::vector<Token> const& _tokens;
+	friend class ConsumeResult;
+
+	// One of the two is set.
+	LexResult const* _tokens = nullptr;
+	TokenStream* _stream = nullptr;
 	int _index;
 
 private:
-	Token const* next_token();
+	int next_token();
+	ConsumeResult consume_index(int index);
+	ConsumeResult fail(int index) const;
+
+	bool available(unsigned int index) const
+	{
+		return _stream ? _stream->fill(index) : index < _tokens->size();
+	}
+	TokenType type_at(unsigned int index) const
+	{
+		return _stream ? _stream->type(index) : _tokens->type(index);
+	}
+	Token token_at(unsigned int index) const
+	{
+		return _stream ? _stream->token(index) : _tokens->token(index);
+	}
 
 public:
-	TokenCursor(std::vector<Token> const& toks)
-		: _tokens(toks)
+	TokenCursor(LexResult const& toks)
+		: _tokens(&toks)
+		, _index(0){};
+
+	TokenCursor(TokenStream& stream)
+		: _stream(&stream)
 		, _index(0){};
 
 	int get_index() const { return _index; }
 
+	/**
+	 * @brief Indices of the comment tokens, in order. Complete up to the current token.
+	 */
+	Vec<int> const& comments() const { return _stream ? _stream->comments() : _tokens->comments; }
+
 	bool has_tokens() const;
 
 	/**
 	 * @brief Peeks at next non-whitespace/ignored token
 	 *
-	 * If index is specified, ignored tokens can be peeked.
+	 * If index is specified, ignored tokens can be peeked. When streaming, the index
+	 * must not be before the current token.
 	 *
 	 * @param index
 	 * @return Token
 	 */
 	Token peek(int index = -1) const;
 
+	/**
+	 * @brief Same as peek but only reads the token kind.
+	 */
+	TokenType peek_type() const;
+
+	/**
+	 * @brief Kind of the n-th upcoming token, skipping ignored tokens. 0 is the next token.
+	 */
+	TokenType peek_type_ahead(unsigned int n) const;
+
 	ConsumeResult consume_if_expected(TokenType expected);
 
 	ConsumeResult consume(TokenType expected);
@@ -63,4 +121,4 @@ public:
 	// TODO: Template?
 	ConsumeResult consume(TokenType expected_one, TokenType expected_two);
 	ConsumeResult consume(std::initializer_list<TokenType> expecteds);
-};
\ No newline at end of file
+};
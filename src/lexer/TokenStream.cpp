@@ -0,0 +1,91 @@
+#include "TokenStream.h"
+
+#include <cassert>
+#include <type_traits>
+
+TokenStream::TokenStream(char const* input, unsigned int capacity)
+	: lexer(input)
+{
+	unsigned int size = 16;
+	while( size < capacity )
+		size *= 2;
+
+	kinds.resize(size);
+	literal_types.resize(size);
+	offsets.resize(size);
+	lengths.resize(size);
+	line_nums.resize(size);
+	mask = size - 1;
+}
+
+Token
+TokenStream::token(unsigned int index) const
+{
+	// A released slot may already hold a later token.
+	assert(first <= index && index < last);
+	auto slot = index & mask;
+
+	Token token{TokenType(kinds[slot])};
+	token.literal_type = LiteralType(literal_types[slot]);
+	token.start = lexer.input() + offsets[slot];
+	token.size = lengths[slot];
+	token.neighborhood.lines = &lexer.markers();
+	token.neighborhood.line_num = line_nums[slot];
+
+	return token;
+}
+
+/**
+ * @brief Lexes until 'index' is available, then keeps going until the ring is full so
+ * the lexer runs in batches rather than once per peek.
+ */
+bool
+TokenStream::fill_slow(unsigned int index)
+{
+	while( !at_eof && (last <= index || last - first < capacity()) )
+	{
+		if( last - first == capacity() )
+			grow();
+
+		auto token = lexer.next();
+		auto slot = last & mask;
+		kinds[slot] = static_cast<std::uint8_t>(token.type);
+		literal_types[slot] = static_cast<std::uint8_t>(token.literal_type);
+		offsets[slot] = token.start - lexer.input();
+		lengths[slot] = token.size;
+		line_nums[slot] = token.neighborhood.line_num;
+
+		if( token.type == TokenType::line_comment )
+			comment_indices.push_back(last);
+		if( token.type == TokenType::eof )
+			at_eof = true;
+
+		last += 1;
+	}
+
+	return index < last;
+}
+
+/**
+ * @brief Doubles the ring. Only happens when the parser looks further ahead than ever before.
+ */
+void
+TokenStream::grow()
+{
+	auto size = capacity() * 2;
+	auto new_mask = size - 1;
+
+	auto regrow = [&](auto& ring) {
+		std::remove_reference_t<decltype(ring)> grown(size);
+		for( auto i = first; i < last; i++ )
+			grown[i & new_mask] = ring[i & mask];
+		ring.swap(grown);
+	};
+
+	regrow(kinds);
+	regrow(literal_types);
+	regrow(offsets);
+	regrow(lengths);
+	regrow(line_nums);
+	mask = new_mask;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Lexer.h"
+#include "common/Vec.h"
+#include "token.h"
+
+#include <cstdint>
+
+/**
+ * @brief Lexes tokens as the parser asks for them.
+ *
+ * Only the tokens from the parser's position up to its furthest lookahead are kept,
+ * in a ring that grows to the longest lookahead seen. Token indices count from the
+ * start of the input, so spans stay valid after their tokens are dropped.
+ */
+class TokenStream
+{
+	Lexer lexer;
+
+	// Ring of the tokens [first, last), laid out like LexResult. The capacity is a power of two.
+	Vec<std::uint8_t> kinds;
+	Vec<std::uint8_t> literal_types;
+	Vec<std::uint32_t> offsets;
+	Vec<std::uint32_t> lengths;
+	Vec<std::uint32_t> line_nums;
+	unsigned int mask = 0;
+	unsigned int first = 0;
+	unsigned int last = 0;
+	bool at_eof = false;
+
+	// Indices of every comment token, also the dropped ones.
+	Vec<int> comment_indices;
+
+public:
+	TokenStream(char const* input, unsigned int capacity = 256);
+
+	/**
+	 * @brief Lexes up to 'index'. False if the input ends before it.
+	 */
+	bool fill(unsigned int index) { return index < last || fill_slow(index); }
+
+	/**
+	 * @brief Tokens before 'index' are not needed anymore.
+	 */
+	void release(unsigned int index)
+	{
+		if( index > first )
+			first = index < last ? index : last;
+	}
+
+	// 'index' must be filled and not released.
+	TokenType type(unsigned int index) const { return TokenType(kinds[index & mask]); }
+	Token token(unsigned int index) const;
+
+	Vec<int> const& comments() const { return comment_indices; }
+	LineMarkers const& markers() const { return lexer.markers(); }
+	unsigned int capacity() const { return mask + 1; }
+
+private:
+	bool fill_slow(unsigned int index);
+	void grow();
+};
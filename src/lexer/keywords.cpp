@@ -29,6 +29,9 @@ KeywordIdentifierTuple keywords[] =
 	{"switch", TokenType::switch_keyword},
 	{"case", TokenType::case_keyword},
 	{"default", TokenType::default_keyword},
+	{"async", TokenType::async_keyword},
+	{"await", TokenType::await_keyword},
+	{"namespace", TokenType::namespace_keyword},
 	// clang-format off
 };
 // clang-format on
@@ -96,6 +99,7 @@ static DebugTokenTypeString debug_tokentype_string[] = {
 	{TokenType::union_keyword, "union"},
 	{TokenType::enum_keyword, "enum"},
 	{TokenType::dot, "dot"},
+	{TokenType::at, "at"},
 	{TokenType::eof, "<EOF>"},
 	{TokenType::bad, "bad"},
 	{TokenType::for_keyword, "for"},
@@ -107,6 +111,9 @@ static DebugTokenTypeString debug_tokentype_string[] = {
 	{TokenType::switch_keyword, "switch"},
 	{TokenType::case_keyword, "case"},
 	{TokenType::default_keyword, "default"},
+	{TokenType::async_keyword, "async"},
+	{TokenType::await_keyword, "await"},
+	{TokenType::namespace_keyword, "namespace"},
 };
 
 char const*
@@ -0,0 +1,485 @@
+#include "scan.h"
+
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SCAN_AVX2 1
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_SSE2 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define SCAN_NEON 1
+#endif
+
+using Lines = std::vector<char const*>;
+
+namespace
+{
+struct ScanFns
+{
+	ScanIsa isa;
+	char const* (*whitespace)(char const*, char const*, Lines&);
+	char const* (*identifier)(char const*, char const*);
+	char const* (*line_end)(char const*, char const*);
+	char const* (*string_body)(char const*, char const*);
+};
+
+inline bool
+is_whitespace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool
+is_identifier(char c)
+{
+	// Letters are the only characters that land in a-z when 0x20 is set.
+	unsigned char lower = (unsigned char)c | 0x20;
+	return (lower >= 'a' && lower <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+/**
+ * @brief Appends the position of each set bit in 'mask', one bit per byte at 'p'.
+ */
+inline void
+push_lines(Lines& lines, char const* p, std::uint32_t mask)
+{
+	while( mask )
+	{
+		lines.push_back(p + __builtin_ctz(mask));
+		mask &= mask - 1;
+	}
+}
+
+char const*
+whitespace_scalar(char const* p, char const* end, Lines& lines)
+{
+	for( ; p < end && is_whitespace(*p); p++ )
+	{
+		if( *p == '\n' )
+			lines.push_back(p);
+	}
+	return p;
+}
+
+char const*
+identifier_scalar(char const* p, char const* end)
+{
+	while( p < end && is_identifier(*p) )
+		p++;
+	return p;
+}
+
+char const*
+line_end_scalar(char const* p, char const* end)
+{
+	while( p < end && *p != '\n' )
+		p++;
+	return p;
+}
+
+char const*
+string_body_scalar(char const* p, char const* end)
+{
+	while( p < end && *p != '"' && *p != '\\' )
+		p++;
+	return p;
+}
+
+#ifdef SCAN_SSE2
+inline __m128i
+in_range_sse2(__m128i v, char lo, char hi)
+{
+	// Unsigned v - lo <= hi - lo, using min because SSE2 has no unsigned compare.
+	__m128i offset = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+	return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(hi - lo)), offset);
+}
+
+char const*
+whitespace_sse2(char const* p, char const* end, Lines& lines)
+{
+	for( ; end - p >= 16; p += 16 )
+	{
+		__m128i v = _mm_loadu_si128((__m128i const*)p);
+		__m128i newline = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+		__m128i ws = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), newline));
+
+		std::uint32_t newlines = _mm_movemask_epi8(newline);
+		std::uint32_t other = ~(std::uint32_t)_mm_movemask_epi8(ws) & 0xFFFF;
+		if( other )
+		{
+			std::uint32_t stop = __builtin_ctz(other);
+			push_lines(lines, p, newlines & ((1u << stop) - 1));
+			return p + stop;
+		}
+		push_lines(lines, p, newlines);
+	}
+	return whitespace_scalar(p, end, lines);
+}
+
+char const*
+identifier_sse2(char const* p, char const* end)
+{
+	for( ; end - p >= 16; p += 16 )
+	{
+		__m128i v = _mm_loadu_si128((__m128i const*)p);
+		__m128i letter = in_range_sse2(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+		__m128i digit = in_range_sse2(v, '0', '9');
+		__m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+
+		std::uint32_t ident = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), underscore));
+		std::uint32_t other = ~ident & 0xFFFF;
+		if( other )
+			return p + __builtin_ctz(other);
+	}
+	return identifier_scalar(p, end);
+}
+
+char const*
+line_end_sse2(char const* p, char const* end)
+{
+	for( ; end - p >= 16; p += 16 )
+	{
+		__m128i v = _mm_loadu_si128((__m128i const*)p);
+		std::uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+		if( mask )
+			return p + __builtin_ctz(mask);
+	}
+	return line_end_scalar(p, end);
+}
+
+char const*
+string_body_sse2(char const* p, char const* end)
+{
+	for( ; end - p >= 16; p += 16 )
+	{
+		__m128i v = _mm_loadu_si128((__m128i const*)p);
+		__m128i stop = _mm_or_si128(
+			_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+		std::uint32_t mask = _mm_movemask_epi8(stop);
+		if( mask )
+			return p + __builtin_ctz(mask);
+	}
+	return string_body_scalar(p, end);
+}
+#endif
+
+#ifdef SCAN_AVX2
+#define SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+
+SCAN_TARGET_AVX2 inline __m256i
+in_range_avx2(__m256i v, char lo, char hi)
+{
+	__m256i offset = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+	return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(hi - lo)), offset);
+}
+
+SCAN_TARGET_AVX2 char const*
+whitespace_avx2(char const* p, char const* end, Lines& lines)
+{
+	for( ; end - p >= 32; p += 32 )
+	{
+		__m256i v = _mm256_loadu_si256((__m256i const*)p);
+		__m256i newline = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+		__m256i ws = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), newline));
+
+		std::uint32_t newlines = _mm256_movemask_epi8(newline);
+		std::uint32_t other = ~(std::uint32_t)_mm256_movemask_epi8(ws);
+		if( other )
+		{
+			std::uint32_t stop = __builtin_ctz(other);
+			push_lines(lines, p, newlines & ((1u << stop) - 1));
+			return p + stop;
+		}
+		push_lines(lines, p, newlines);
+	}
+	return whitespace_scalar(p, end, lines);
+}
+
+SCAN_TARGET_AVX2 char const*
+identifier_avx2(char const* p, char const* end)
+{
+	for( ; end - p >= 32; p += 32 )
+	{
+		__m256i v = _mm256_loadu_si256((__m256i const*)p);
+		__m256i letter = in_range_avx2(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+		__m256i digit = in_range_avx2(v, '0', '9');
+		__m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+
+		std::uint32_t ident =
+			_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letter, digit), underscore));
+		if( ~ident )
+			return p + __builtin_ctz(~ident);
+	}
+	return identifier_scalar(p, end);
+}
+
+SCAN_TARGET_AVX2 char const*
+line_end_avx2(char const* p, char const* end)
+{
+	for( ; end - p >= 32; p += 32 )
+	{
+		__m256i v = _mm256_loadu_si256((__m256i const*)p);
+		std::uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+		if( mask )
+			return p + __builtin_ctz(mask);
+	}
+	return line_end_scalar(p, end);
+}
+
+SCAN_TARGET_AVX2 char const*
+string_body_avx2(char const* p, char const* end)
+{
+	for( ; end - p >= 32; p += 32 )
+	{
+		__m256i v = _mm256_loadu_si256((__m256i const*)p);
+		__m256i stop = _mm256_or_si256(
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+		std::uint32_t mask = _mm256_movemask_epi8(stop);
+		if( mask )
+			return p + __builtin_ctz(mask);
+	}
+	return string_body_scalar(p, end);
+}
+#endif
+
+#ifdef SCAN_NEON
+/**
+ * @brief NEON has no movemask. Narrowing the compare result gives 4 bits per byte.
+ */
+inline std::uint64_t
+mask_neon(uint8x16_t cmp)
+{
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+}
+
+inline uint8x16_t
+in_range_neon(uint8x16_t v, char lo, char hi)
+{
+	return vcleq_u8(vsubq_u8(v, vdupq_n_u8(lo)), vdupq_n_u8(hi - lo));
+}
+
+inline void
+push_lines_neon(Lines& lines, char const* p, std::uint64_t mask)
+{
+	while( mask )
+	{
+		auto index = __builtin_ctzll(mask) >> 2;
+		lines.push_back(p + index);
+		mask &= ~(std::uint64_t(0xF) << (index * 4));
+	}
+}
+
+char const*
+whitespace_neon(char const* p, char const* end, Lines& lines)
+{
+	for( ; end - p >= 16; p += 16 )
+	{
+		uint8x16_t v = vld1q_u8((std::uint8_t const*)p);
+		uint8x16_t newline = vceqq_u8(v, vdupq_n_u8('\n'));
+		uint8x16_t ws = vorrq_u8(
+			vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t'))),
+			vorrq_u8(vceqq_u8(v, vdupq_n_u8('\r')), newline));
+
+		std::uint64_t newlines = mask_neon(newline);
+		std::uint64_t other = ~mask_neon(ws);
+		if( other )
+		{
+			auto stop = __builtin_ctzll(other) >> 2;
+			push_lines_neon(lines, p, newlines & ((std::uint64_t(1) << (stop * 4)) - 1));
+			return p + stop;
+		}
+		push_lines_neon(lines, p, newlines);
+	}
+	return whitespace_scalar(p, end, lines);
+}
+
+char const*
+identifier_neon(char const* p, char const* end)
+{
+	for( ; end - p >= 16; p += 16 )
+	{
+		uint8x16_t v = vld1q_u8((std::uint8_t const*)p);
+		uint8x16_t letter = in_range_neon(vorrq_u8(v, vdupq_n_u8(0x20)), 'a', 'z');
+		uint8x16_t digit = in_range_neon(v, '0', '9');
+		uint8x16_t underscore = vceqq_u8(v, vdupq_n_u8('_'));
+
+		std::uint64_t other = ~mask_neon(vorrq_u8(vorrq_u8(letter, digit), underscore));
+		if( other )
+			return p + (__builtin_ctzll(other) >> 2);
+	}
+	return identifier_scalar(p, end);
+}
+
+char const*
+line_end_neon(char const* p, char const* end)
+{
+	for( ; end - p >= 16; p += 16 )
+	{
+		uint8x16_t v = vld1q_u8((std::uint8_t const*)p);
+		std::uint64_t mask = mask_neon(vceqq_u8(v, vdupq_n_u8('\n')));
+		if( mask )
+			return p + (__builtin_ctzll(mask) >> 2);
+	}
+	return line_end_scalar(p, end);
+}
+
+char const*
+string_body_neon(char const* p, char const* end)
+{
+	for( ; end - p >= 16; p += 16 )
+	{
+		uint8x16_t v = vld1q_u8((std::uint8_t const*)p);
+		std::uint64_t mask =
+			mask_neon(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))));
+		if( mask )
+			return p + (__builtin_ctzll(mask) >> 2);
+	}
+	return string_body_scalar(p, end);
+}
+#endif
+
+ScanFns const scalar_fns{
+	ScanIsa::scalar, whitespace_scalar, identifier_scalar, line_end_scalar, string_body_scalar};
+
+ScanFns
+fns_for(ScanIsa isa)
+{
+	switch( isa )
+	{
+#ifdef SCAN_SSE2
+	case ScanIsa::sse2:
+		return ScanFns{isa, whitespace_sse2, identifier_sse2, line_end_sse2, string_body_sse2};
+#endif
+#ifdef SCAN_AVX2
+	case ScanIsa::avx2:
+		return ScanFns{isa, whitespace_avx2, identifier_avx2, line_end_avx2, string_body_avx2};
+#endif
+#ifdef SCAN_NEON
+	case ScanIsa::neon:
+		return ScanFns{isa, whitespace_neon, identifier_neon, line_end_neon, string_body_neon};
+#endif
+	default:
+		return scalar_fns;
+	}
+}
+
+ScanIsa
+best_isa()
+{
+	for( auto isa : {ScanIsa::avx2, ScanIsa::neon, ScanIsa::sse2} )
+	{
+		if( scan_isa_supported(isa) )
+			return isa;
+	}
+	return ScanIsa::scalar;
+}
+
+// Picked on first use, so lexing from a static initializer of another file still finds
+// it set, and threads that lex at once see it picked once.
+ScanFns&
+active()
+{
+	static ScanFns fns = fns_for(best_isa());
+	return fns;
+}
+} // namespace
+
+bool
+scan_isa_supported(ScanIsa isa)
+{
+	switch( isa )
+	{
+	case ScanIsa::scalar:
+		return true;
+	case ScanIsa::sse2:
+#ifdef SCAN_SSE2
+		return true;
+#else
+		return false;
+#endif
+	case ScanIsa::avx2:
+#ifdef SCAN_AVX2
+		// Needed if this runs before main, from a static initializer.
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+	case ScanIsa::neon:
+#ifdef SCAN_NEON
+		return true;
+#else
+		return false;
+#endif
+	}
+	return false;
+}
+
+ScanIsa
+scan_isa()
+{
+	return active().isa;
+}
+
+bool
+scan_set_isa(ScanIsa isa)
+{
+	if( !scan_isa_supported(isa) )
+		return false;
+
+	active() = fns_for(isa);
+	return true;
+}
+
+char const*
+scan_isa_name(ScanIsa isa)
+{
+	switch( isa )
+	{
+	case ScanIsa::scalar:
+		return "scalar";
+	case ScanIsa::sse2:
+		return "sse2";
+	case ScanIsa::avx2:
+		return "avx2";
+	case ScanIsa::neon:
+		return "neon";
+	}
+	return "unknown";
+}
+
+char const*
+scan_whitespace(char const* p, char const* end, Lines& lines)
+{
+	return active().whitespace(p, end, lines);
+}
+
+char const*
+scan_identifier(char const* p, char const* end)
+{
+	return active().identifier(p, end);
+}
+
+char const*
+scan_line_end(char const* p, char const* end)
+{
+	return active().line_end(p, end);
+}
+
+char const*
+scan_string_body(char const* p, char const* end)
+{
+	return active().string_body(p, end);
+}
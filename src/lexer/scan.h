@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief Scanners for the long runs of characters in a source file.
+ *
+ * Each scanner returns the first position in [p, end) that is not part of the run,
+ * or end. They compare 16 or 32 bytes at a time with SSE2, AVX2 or NEON, and fall
+ * back to a byte loop. The instruction set is picked from the cpu on first use.
+ */
+enum class ScanIsa
+{
+	scalar,
+	sse2,
+	avx2,
+	neon,
+};
+
+ScanIsa scan_isa();
+
+/**
+ * @brief Forces the scanners to an instruction set, e.g. to compare them in a
+ * benchmark. Returns false, and changes nothing, if the cpu does not support it.
+ *
+ * Not thread safe. Call it only from main while nothing lexes, e.g. before a TaskPool
+ * is created, never from a static initializer.
+ */
+bool scan_set_isa(ScanIsa isa);
+
+bool scan_isa_supported(ScanIsa isa);
+
+char const* scan_isa_name(ScanIsa isa);
+
+/**
+ * @brief Spaces, tabs and line breaks. The position of each '\n' is appended to 'lines'.
+ */
+char const* scan_whitespace(char const* p, char const* end, std::vector<char const*>& lines);
+
+/**
+ * @brief [a-zA-Z0-9_]
+ */
+char const* scan_identifier(char const* p, char const* end);
+
+/**
+ * @brief Up to the next '\n'.
+ */
+char const* scan_line_end(char const* p, char const* end);
+
+/**
+ * @brief Up to the next '"' or '\\'.
+ */
+char const* scan_string_body(char const* p, char const* end);
@@ -50,6 +50,8 @@ enum class TokenType
 
 	comma,
 	dot,
+	// @
+	at,
 	semicolon,
 	colon,
 	colon_colon,
@@ -70,6 +72,9 @@ enum class TokenType
 	for_keyword,
 	else_keyword,
 	while_keyword,
+	async_keyword,
+	await_keyword,
+	namespace_keyword,
 
 	eof,
 	bad,
@@ -92,10 +97,14 @@ struct LineMarkers
 
 struct TokenNeighborhood
 {
-	LineMarkers lines;
-	int line_num;
+	// Owned by the LexResult.
+	LineMarkers const* lines = nullptr;
+	int line_num = 0;
 };
 
+/**
+ * @brief View of a token. Tokens are stored as parallel arrays in LexResult.
+ */
 struct Token
 {
 	TokenNeighborhood neighborhood;
@@ -103,7 +112,6 @@ struct Token
 	LiteralType literal_type = LiteralType::none;
 	char const* start = nullptr;
 	unsigned int size = 0;
-	unsigned int num_trailing_newlines = 0;
 
 	Token(){};
 	Token(TokenType type)
@@ -1,146 +1,367 @@
-#include "ast2/Ast.h"
-#include "ast2/AstGen.h"
-#include "ast2/AstNode.h"
-#include "ast2/AstTags.h"
-#include "codegen2/Codegen.h"
+#include "codegen2/CGBitcode.h"
 #include "common/OwnPtr.h"
-#include "lexer/Lexer.h"
-#include "lexer/TokenCursor.h"
-#include "llvm/IR/LegacyPassManager.h"
-#include "llvm/MC/TargetRegistry.h"
-#include "llvm/Support/FileSystem.h"
-#include "llvm/Support/Host.h"
+#include "driver/CompilerInstance.h"
+#include "frontend/Frontend.h"
+#include "server/CompileServer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/Target/TargetMachine.h"
-#include "llvm/Target/TargetOptions.h"
-#include "sema2/Sema2.h"
-#include "sema2/SemaGen.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <thread>
 #include <vector>
 
-using namespace sema;
 using namespace cg;
-using namespace ast;
+using namespace driver;
 using namespace llvm;
 
+/**
+ * @brief Parses the thread count of an option like --jobs=<n>. Prints an error and
+ * returns false if it is not a number, or an absurd one.
+ */
+static bool
+parse_jobs(String const& arg, char const* prefix, unsigned int& jobs)
+{
+	static constexpr unsigned long max_jobs = 1024;
+
+	auto text = arg.c_str() + strlen(prefix);
+	char* end = nullptr;
+	errno = 0;
+	unsigned long value = 0;
+	// strtoul skips spaces and accepts a sign, so require a digit first.
+	if( std::isdigit(static_cast<unsigned char>(*text)) )
+		value = std::strtoul(text, &end, 10);
+
+	if( end == nullptr || *end != '\0' || errno == ERANGE || value > max_jobs )
+	{
+		std::cout << "Expected a thread count from 0 to " << max_jobs << " in " << arg
+				  << std::endl;
+		return false;
+	}
+
+	jobs = value;
+	return true;
+}
+
+/**
+ * @brief sushi --thinlto-link [-O<n>] [--thinlto-jobs=<n>] a.bc b.bc ...
+ */
 int
-emit(llvm::Module* Module)
+thinlto_link_main(Vec<String> const& args)
 {
-	auto& Mod = *Module;
+	CGOptions cg_options;
+	unsigned int jobs = 0;
+	Vec<String> inputs;
+	for( unsigned int i = 1; i < args.size(); i++ )
+	{
+		String const& arg = args[i];
+		if( arg == "-O0" || arg == "-O1" || arg == "-O2" || arg == "-O3" )
+		{
+			cg_options.opt_level = arg[2] - '0';
+		}
+		else if( arg.rfind("--thinlto-jobs=", 0) == 0 )
+		{
+			if( !parse_jobs(arg, "--thinlto-jobs=", jobs) )
+				return -1;
+		}
+		else if( arg == "--save-temps" )
+		{
+			cg_options.save_temps = true;
+		}
+		else if( arg.rfind("-", 0) == 0 )
+		{
+			std::cout << "Unknown option " << arg << std::endl;
+			return -1;
+		}
+		else
+		{
+			inputs.push_back(arg);
+		}
+	}
 
-	auto CPU = "generic";
-	auto Features = "";
+	if( inputs.empty() )
+	{
+		std::cout << "Please specify bitcode files" << std::endl;
+		return -1;
+	}
 
 	InitializeNativeTarget();
 	InitializeNativeTargetAsmParser();
 	InitializeNativeTargetAsmPrinter();
-	TargetOptions opt;
-	auto RM = Optional<Reloc::Model>();
 
-	// auto TargetTriple = sys::getDefaultTargetTriple();
-	std::string TargetTriple = "aarch64-app-darwin";
-	// std::cout << "Target: " << TargetTriple << std::endl;
-
-	std::string Error;
-	auto Target = TargetRegistry::lookupTarget(TargetTriple, Error);
-	if( !Target )
+	auto linkr = thinlto_link(inputs, cg_options, jobs);
+	if( !linkr.ok() )
 	{
-		errs() << Error;
+		linkr.unwrap_error()->print();
 		return -1;
 	}
 
-	auto TheTargetMachine = Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM);
+	for( auto& object : linkr.unwrap() )
+		std::cout << object << std::endl;
 
-	Mod.setDataLayout(TheTargetMachine->createDataLayout());
-	Mod.setTargetTriple(TargetTriple);
+	return 0;
+}
 
-	auto Filename = "output.o";
-	std::error_code EC;
-	raw_fd_ostream dest(Filename, EC, sys::fs::OF_None);
+/**
+ * @brief The command line of a compile.
+ */
+struct Invocation
+{
+	CompileOptions options;
+	Vec<String> inputs;
+	// --stats: print the time of each phase to stderr.
+	bool stats = false;
+};
 
-	if( EC )
+bool
+parse_options(Vec<String> const& args, Invocation& invocation)
+{
+	auto& options = invocation.options;
+	auto& cg_options = options.cg_options;
+	for( auto const& arg : args )
 	{
-		errs() << "Could not open file: " << EC.message();
-		return -1;
+		if( arg == "-fno-strict-aliasing" )
+		{
+			cg_options.strict_aliasing = false;
+		}
+		else if( arg == "-g" )
+		{
+			cg_options.debug_info = DebugInfoKind::Full;
+		}
+		else if( arg == "-gline-tables-only" )
+		{
+			cg_options.debug_info = DebugInfoKind::LineTablesOnly;
+		}
+		else if( arg == "-O0" || arg == "-O1" || arg == "-O2" || arg == "-O3" )
+		{
+			cg_options.opt_level = arg[2] - '0';
+		}
+		else if( arg == "--emit=obj" )
+		{
+			options.emit_kind = EmitKind::Object;
+		}
+		else if( arg == "--emit=bc" )
+		{
+			options.emit_kind = EmitKind::Bitcode;
+		}
+		else if( arg == "--thinlto" )
+		{
+			cg_options.thinlto = true;
+		}
+		else if( arg == "-fprofile-generate" )
+		{
+			cg_options.profile = ProfileKind::Generate;
+		}
+		else if( arg.rfind("-fprofile-generate=", 0) == 0 )
+		{
+			cg_options.profile = ProfileKind::Generate;
+			cg_options.profile_file = arg.substr(strlen("-fprofile-generate="));
+		}
+		else if( arg.rfind("-fprofile-use=", 0) == 0 )
+		{
+			cg_options.profile = ProfileKind::Use;
+			cg_options.profile_file = arg.substr(strlen("-fprofile-use="));
+
+			if( !std::ifstream{cg_options.profile_file}.good() )
+			{
+				std::cout << "Could not open profile " << cg_options.profile_file << std::endl;
+				return false;
+			}
+		}
+		else if( arg == "-fonly-reachable" )
+		{
+			options.only_reachable = true;
+		}
+		else if( arg.rfind("--root=", 0) == 0 )
+		{
+			options.roots.push_back(Symbol::intern(arg.substr(strlen("--root="))));
+		}
+		else if( arg.rfind("--jobs=", 0) == 0 )
+		{
+			if( !parse_jobs(arg, "--jobs=", options.jobs) )
+				return false;
+		}
+		else if( arg.rfind("--interface=", 0) == 0 )
+		{
+			options.interfaces.push_back(arg.substr(strlen("--interface=")));
+		}
+		else if( arg.rfind("--emit-interface=", 0) == 0 )
+		{
+			options.emit_interface = arg.substr(strlen("--emit-interface="));
+		}
+		else if( arg.rfind("--target=", 0) == 0 )
+		{
+			options.target_triple = arg.substr(strlen("--target="));
+		}
+		else if( arg == "--stats" )
+		{
+			invocation.stats = true;
+		}
+		else if( arg.rfind("-", 0) == 0 )
+		{
+			std::cout << "Unknown option " << arg << std::endl;
+			return false;
+		}
+		else
+		{
+			invocation.inputs.push_back(arg);
+		}
 	}
 
-	legacy::PassManager pass;
-	auto FileType = CGFT_ObjectFile;
+	if( cg_options.thinlto && options.emit_kind != EmitKind::Bitcode )
+	{
+		std::cout << "--thinlto requires --emit=bc" << std::endl;
+		return false;
+	}
 
-	if( TheTargetMachine->addPassesToEmitFile(pass, dest, nullptr, FileType) )
+	if( invocation.inputs.empty() )
 	{
-		errs() << "TheTargetMachine can't emit a file of this type";
-		return -1;
+		std::cout << "Please specify a file" << std::endl;
+		return false;
 	}
 
-	pass.run(Mod);
-	dest.flush();
-	return 0;
+	if( options.keep_tokens() && invocation.inputs.size() > 1 )
+	{
+		std::cout << "-g and -gline-tables-only take a single file" << std::endl;
+		return false;
+	}
+
+	return true;
 }
 
+/**
+ * @brief Compiles the inputs and writes output.o, or output.bc with --emit=bc.
+ */
 int
-main(int argc, char* argv[])
+compile(CompilerInstance& instance, Invocation const& invocation)
 {
-	if( argc == 1 )
+	auto options = invocation.options;
+	options.echo = true;
+
+	auto output = instance.compile_files(invocation.inputs, options);
+	if( invocation.stats )
+		output.stats.print(std::cerr);
+
+	if( !output.ok() )
 	{
-		std::cout << "Please specify a file" << std::endl;
+		output.error->print();
 		return -1;
 	}
 
-	auto filepath = argv[argc - 1];
-
-	std::ifstream file{filepath};
-	if( !file.good() )
+	auto Filename = options.emit_kind == EmitKind::Bitcode ? "output.bc" : "output.o";
+	std::ofstream dest{Filename, std::ios::binary};
+	if( !dest.write(output.buffer.data(), output.buffer.size()) )
 	{
-		std::cout << "Could not open file " << filepath << std::endl;
+		errs() << "Could not open file: " << Filename;
 		return -1;
 	}
 
-	std::stringstream buffer;
-	buffer << file.rdbuf();
-	std::string filedata = buffer.str();
+	return 0;
+}
 
-	std::cout << filedata << std::endl;
+/**
+ * @brief sushi --serve=<socket> [--serve-jobs=<n>]
+ *
+ * Each compile runs in a child process forked from the server, so the child starts
+ * with the target initialized and the files that did not change since an earlier
+ * compile already parsed. The server parses a client's files after its compile
+ * started, while no other client waits. The server itself never runs sema or codegen,
+ * so it does not grow. Compiles of different clients run at the same time, up to
+ * --serve-jobs of them, or one per core if it is 0 or not given.
+ */
+int
+serve_main(Vec<String> const& serve_args)
+{
+	auto socket_path = serve_args[0].substr(strlen("--serve="));
+	unsigned int max_jobs = 0;
+	for( unsigned int i = 1; i < serve_args.size(); i++ )
+	{
+		if( serve_args[i].rfind("--serve-jobs=", 0) == 0 )
+		{
+			if( !parse_jobs(serve_args[i], "--serve-jobs=", max_jobs) )
+				return -1;
+		}
+		else
+		{
+			std::cout << "Unknown option " << serve_args[i] << std::endl;
+			return -1;
+		}
+	}
+	if( max_jobs == 0 )
+		max_jobs = std::max(1u, std::thread::hardware_concurrency());
 
-	Lexer lex{filedata.c_str()};
+	// The instance sets up the target here, but creates its threads and LLVMContext
+	// in the child on the first compile.
+	CompilerInstance instance;
+	frontend::FileCache files;
+	instance.set_file_cache(&files);
 
-	auto lex_result = lex.lex();
+	auto handler = [&instance, &files](Vec<String> const& args) -> server::Prepared {
+		if( !args.empty() && args[0] == "--thinlto-link" )
+			return {[args]() { return thinlto_link_main(args); }};
 
-	Lexer::print_tokens(lex_result.tokens);
+		Invocation invocation;
+		if( !parse_options(args, invocation) )
+			return {[]() { return -1; }};
 
-	TokenCursor cursor{lex_result.tokens};
-	Ast ast;
-	AstGen gen{ast, cursor};
-	auto result = gen.parse();
-	if( !result.ok() )
-		result.unwrap_error()->print();
+		// Parse in the server once no client waits, so the next compile finds the files in
+		// the cache. The warm-up runs in the directory of the server.
+		auto const& options = invocation.options;
+		Vec<String> paths;
+		for( auto const& input : invocation.inputs )
+			paths.push_back(std::filesystem::absolute(input).string());
 
-	sema::Sema2 sema;
+		auto warm = [&files, paths, jobs = options.jobs, keep_tokens = options.keep_tokens()]() {
+			TaskPool pool{jobs};
+			frontend::Frontend front{pool, keep_tokens, &files};
+			front.start(paths);
+			for( unsigned int i = 0; i < front.size(); i++ )
+				front.wait(i);
+		};
 
-	auto sema_result = sema::sema_module(sema, result.unwrap());
-	// auto sema_result = sema.sema(result.unwrap());
-	if( !sema_result.ok() )
-		sema_result.unwrap_error()->print();
+		return {[&instance, invocation]() { return compile(instance, invocation); }, warm};
+	};
 
-	CG cg{sema};
+	return server::serve(socket_path, handler, max_jobs);
+}
 
-	auto cgr = cg.codegen_module(sema_result.unwrap());
-	if( !cgr.ok() )
+int
+main(int argc, char* argv[])
+{
+	if( argc == 1 )
 	{
-		cgr.unwrap_error()->print();
-		// return 0;
+		std::cout << "Please specify a file" << std::endl;
+		return -1;
 	}
 
-	std::string Str;
-	raw_string_ostream OS(Str);
+	String first = argv[1];
+	Vec<String> args(argv + 1, argv + argc);
+	if( first.rfind("--serve=", 0) == 0 )
+		return serve_main(args);
+
+	// The args after --server=<socket> go to the server. If no server is listening,
+	// they are compiled here.
+	if( first.rfind("--server=", 0) == 0 )
+	{
+		args.erase(args.begin());
+		auto code = server::request(first.substr(strlen("--server=")), args);
+		if( code )
+			return *code;
+	}
 
-	cg.Module->print(OS, nullptr);
+	if( !args.empty() && args[0] == "--thinlto-link" )
+		return thinlto_link_main(args);
 
-	std::cout << Str;
+	Invocation invocation;
+	if( !parse_options(args, invocation) )
+		return -1;
 
-	return emit(cg.Module.get());
-}
\ No newline at end of file
+	CompilerInstance instance;
+	return compile(instance, invocation);
+}
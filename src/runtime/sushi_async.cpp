@@ -0,0 +1,162 @@
+#include "sushi_async.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+// Layout of the start of a switched-resume coroutine frame.
+struct CoroFrame
+{
+	void (*resume)(void*);
+	void (*destroy)(void*);
+};
+
+bool
+is_done(void* handle)
+{
+	return static_cast<CoroFrame*>(handle)->resume == nullptr;
+}
+
+struct Executor
+{
+	// Coroutines that can run. Each appears at most once.
+	std::deque<void*> ready;
+	// Futures that have been started.
+	std::unordered_map<void*, bool> started;
+	// Coroutines waiting on each future.
+	std::unordered_map<void*, std::vector<void*>> waiters;
+
+	void schedule(void* handle)
+	{
+		if( std::find(ready.begin(), ready.end(), handle) == ready.end() )
+			ready.push_back(handle);
+	}
+
+	void start(void* future)
+	{
+		if( is_done(future) || started.count(future) != 0 )
+			return;
+
+		started[future] = true;
+		schedule(future);
+	}
+
+	void run_one()
+	{
+		void* handle = ready.front();
+		ready.pop_front();
+
+		static_cast<CoroFrame*>(handle)->resume(handle);
+		if( !is_done(handle) )
+			return;
+
+		// The frame belongs to whoever awaits it, forget about it here.
+		started.erase(handle);
+		auto iter = waiters.find(handle);
+		if( iter == waiters.end() )
+			return;
+		for( auto waiter : iter->second )
+			schedule(waiter);
+		waiters.erase(iter);
+	}
+
+	// Called before a frame is destroyed so the executor never resumes it again.
+	void forget(void* handle)
+	{
+		ready.erase(std::remove(ready.begin(), ready.end(), handle), ready.end());
+		started.erase(handle);
+		waiters.erase(handle);
+	}
+};
+
+Executor executor;
+
+sushi_coro_alloc_fn coro_alloc = [](std::uint64_t size) { return std::malloc(size); };
+sushi_coro_free_fn coro_free = [](void* frame) { std::free(frame); };
+
+void
+check_not_consumed(void* future)
+{
+	if( future != nullptr )
+		return;
+
+	std::fprintf(stderr, "sushi: awaited a future that was already consumed\n");
+	std::abort();
+}
+
+} // namespace
+
+void
+sushi_set_coro_allocator(sushi_coro_alloc_fn alloc, sushi_coro_free_fn free)
+{
+	coro_alloc = alloc;
+	coro_free = free;
+}
+
+void*
+sushi_coro_alloc(std::uint64_t size)
+{
+	return coro_alloc(size);
+}
+
+void
+sushi_coro_free(void* frame)
+{
+	coro_free(frame);
+}
+
+void
+sushi_await(void* waiter, void* future)
+{
+	check_not_consumed(future);
+	if( is_done(future) )
+		return;
+
+	auto& future_waiters = executor.waiters[future];
+	if( std::find(future_waiters.begin(), future_waiters.end(), waiter) == future_waiters.end() )
+		future_waiters.push_back(waiter);
+	executor.start(future);
+}
+
+void
+sushi_block_on(void** futures, std::int32_t count)
+{
+	for( int i = 0; i < count; i++ )
+		check_not_consumed(futures[i]);
+	for( int i = 0; i < count; i++ )
+		executor.start(futures[i]);
+
+	auto all_done = [&]() {
+		for( int i = 0; i < count; i++ )
+			if( !is_done(futures[i]) )
+				return false;
+		return true;
+	};
+
+	while( !all_done() )
+	{
+		if( executor.ready.empty() )
+		{
+			std::fprintf(stderr, "sushi: deadlock, awaited futures can never finish\n");
+			std::abort();
+		}
+
+		executor.run_one();
+	}
+}
+
+void
+sushi_drop(void* future)
+{
+	if( future == nullptr )
+		return;
+
+	executor.forget(future);
+	static_cast<CoroFrame*>(future)->destroy(future);
+}
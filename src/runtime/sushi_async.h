@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Runtime support for sushi async fns.
+ *
+ * A future is the handle of a switched-resume LLVM coroutine. Its frame starts with
+ * the resume and destroy fn pointers, and the resume pointer is null once the
+ * coroutine reached its final suspend point.
+ *
+ * The executor is single threaded. Futures do not run until something waits on them,
+ * either an async fn awaiting them or sushi_block_on.
+ *
+ * Awaiting a null future aborts. Codegen nulls a future variable when it consumes it.
+ */
+extern "C" {
+
+typedef void* (*sushi_coro_alloc_fn)(std::uint64_t size);
+typedef void (*sushi_coro_free_fn)(void* frame);
+
+/**
+ * @brief Sets the allocator used for coroutine frames. Defaults to malloc and free.
+ * Frames allocated before the change are still freed with the previous free fn.
+ */
+void sushi_set_coro_allocator(sushi_coro_alloc_fn alloc, sushi_coro_free_fn free);
+
+void* sushi_coro_alloc(std::uint64_t size);
+void sushi_coro_free(void* frame);
+
+/**
+ * @brief Resumes 'waiter' once 'future' is done, starting 'future' if needed.
+ * Called by an async fn before it suspends.
+ */
+void sushi_await(void* waiter, void* future);
+
+/**
+ * @brief Runs the executor until every future in 'futures' is done.
+ * Aborts if nothing is runnable but some future is still pending.
+ */
+void sushi_block_on(void** futures, std::int32_t count);
+
+/**
+ * @brief Destroys a future that goes out of scope without being consumed.
+ * Does nothing if 'future' is null, which is what consuming a future leaves behind.
+ */
+void sushi_drop(void* future);
+}
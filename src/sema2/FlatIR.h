@@ -0,0 +1,171 @@
+#pragma once
+#include "IR.h"
+#include "MemberTypeInstance.h"
+#include "TypeInstance.h"
+#include "ast2/AstNode.h"
+#include "common/String.h"
+#include "common/Symbol.h"
+#include "common/Vec.h"
+
+#include <cstdint>
+
+namespace ir
+{
+
+/**
+ * @brief Index of an expression in FlatFunction::exprs.
+ */
+struct ExprId
+{
+	static constexpr std::uint32_t invalid = ~std::uint32_t(0);
+
+	std::uint32_t index = invalid;
+
+	bool valid() const { return index != invalid; }
+};
+
+/**
+ * @brief Index of a statement in FlatFunction::stmts.
+ */
+struct StmtId
+{
+	static constexpr std::uint32_t invalid = ~std::uint32_t(0);
+
+	std::uint32_t index = invalid;
+
+	bool valid() const { return index != invalid; }
+};
+
+/**
+ * @brief Range of a side array of FlatFunction, e.g. FlatFunction::extra.
+ */
+struct FlatRange
+{
+	std::uint32_t start = 0;
+	std::uint32_t size = 0;
+};
+
+/**
+ * @brief Names bound by an if arrow or a case on an enum member.
+ */
+struct FlatBinding
+{
+	Symbol name;
+	sema::TypeInstance type_instance;
+};
+
+struct FlatExpr
+{
+	IRExprType type;
+	ast::AstNode* node;
+	sema::TypeInstance type_instance;
+
+	// Call: call target. BinOp, ArrayAccess: lhs and rhs.
+	// MemberAccess, IndirectMemberAccess, AddressOf, Deref, Is: operand in lhs.
+	ExprId lhs;
+	ExprId rhs;
+
+	// Call: ExprIds in extra.
+	// Await: ExprIds of the futures in extra.
+	// Initializer: (member index, ExprId) pairs in extra.
+	FlatRange children;
+
+	union
+	{
+		// NumberLiteral
+		long long number;
+		// Id, ValueDecl
+		Symbol symbol;
+		// BinOp
+		ast::BinOp op;
+		// MemberAccess, IndirectMemberAccess: FlatFunction::members
+		// StringLiteral: FlatFunction::strings
+		// Is: FlatFunction::types, the checked type.
+		std::uint32_t index;
+	} data;
+};
+
+struct FlatStmt
+{
+	IRStmtType type;
+	ast::AstNode* node;
+
+	// Condition or operand. Assign: lhs.
+	ExprId expr;
+	// Assign: rhs.
+	ExprId rhs;
+
+	// If: then. For, While, Else, Case: body. Switch: block. Let: the initializing assign.
+	StmtId body;
+	// If: else.
+	StmtId else_stmt;
+	// For: init and end of loop statements.
+	StmtId init;
+	StmtId step;
+
+	// Block: StmtIds in extra.
+	FlatRange children;
+	// If, Case: FlatFunction::bindings
+	FlatRange bindings;
+
+	// Let
+	Symbol name{};
+	sema::TypeInstance type_instance;
+
+	// Case
+	long long case_value = 0;
+	bool is_default = false;
+
+	// Assign
+	ast::AssignOp op = ast::AssignOp::assign;
+};
+
+/**
+ * @brief Function body stored in flat arrays addressed by 32-bit ids.
+ *
+ * Children are referenced by index, and lists of children are ranges of 'extra',
+ * so the body can be walked without chasing pointers and copied as plain data.
+ */
+struct FlatFunction
+{
+	Vec<FlatExpr> exprs;
+	Vec<FlatStmt> stmts;
+	Vec<std::uint32_t> extra;
+
+	Vec<FlatBinding> bindings;
+	Vec<sema::MemberTypeInstance> members;
+	Vec<sema::TypeInstance> types;
+	Vec<String> strings;
+
+	StmtId body;
+
+	FlatExpr const& expr(ExprId id) const { return exprs[id.index]; }
+	FlatStmt const& stmt(StmtId id) const { return stmts[id.index]; }
+
+	ExprId child_expr(FlatRange range, std::uint32_t i) const
+	{
+		return ExprId{extra[range.start + i]};
+	}
+	StmtId child_stmt(FlatRange range, std::uint32_t i) const
+	{
+		return StmtId{extra[range.start + i]};
+	}
+
+	struct Designator
+	{
+		sema::MemberTypeInstance const& member;
+		ExprId expr;
+	};
+	Designator designator(FlatRange range, std::uint32_t i) const
+	{
+		auto ind = range.start + i * 2;
+		return Designator{members[extra[ind]], ExprId{extra[ind + 1]}};
+	}
+
+	FlatBinding const& binding(FlatRange range, std::uint32_t i) const
+	{
+		return bindings[range.start + i];
+	}
+};
+
+} // namespace ir
@@ -0,0 +1,85 @@
+#include "Generics.h"
+
+using namespace sema;
+
+Vec<unsigned int>
+Generics::key(Symbol name, Vec<TypeInstance> const& type_args)
+{
+	Vec<unsigned int> result;
+	result.push_back(name.id());
+	for( auto& type_arg : type_args )
+		result.push_back(type_arg.id());
+
+	return result;
+}
+
+void
+Generics::add_decl(Symbol name, ast::AstNode* decl)
+{
+	decls.insert_or_assign(name, decl);
+}
+
+ast::AstNode*
+Generics::lookup_decl(Symbol name) const
+{
+	auto iter = decls.find(name);
+	if( iter != decls.end() )
+		return iter->second;
+	else
+		return nullptr;
+}
+
+std::optional<Type const*>
+Generics::lookup_instance(Symbol name, Vec<TypeInstance> const& type_args) const
+{
+	auto iter = instances.find(key(name, type_args));
+	if( iter != instances.end() )
+		return iter->second;
+	else
+		return std::optional<Type const*>();
+}
+
+void
+Generics::add_instance(Symbol name, Vec<TypeInstance> const& type_args, Type const* type)
+{
+	instances.insert_or_assign(key(name, type_args), type);
+	if( type )
+		instance_args.insert_or_assign(type, std::make_pair(name, type_args));
+}
+
+std::pair<Symbol, Vec<TypeInstance>> const*
+Generics::lookup_instance_args(Type const* type) const
+{
+	auto iter = instance_args.find(type);
+	if( iter != instance_args.end() )
+		return &iter->second;
+	else
+		return nullptr;
+}
+
+void
+Generics::push_bindings(Vec<Binding> bound)
+{
+	bindings.push_back(std::move(bound));
+}
+
+void
+Generics::pop_bindings()
+{
+	bindings.pop_back();
+}
+
+std::optional<TypeInstance>
+Generics::lookup_binding(Symbol name) const
+{
+	if( bindings.empty() )
+		return std::optional<TypeInstance>();
+
+	for( auto& binding : bindings.back() )
+	{
+		if( binding.first == name )
+			return binding.second;
+	}
+
+	return std::optional<TypeInstance>();
+}
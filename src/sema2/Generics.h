@@ -0,0 +1,67 @@
+#pragma once
+
+#include "TypeInstance.h"
+#include "ast2/AstNode.h"
+#include "common/Symbol.h"
+#include "common/Vec.h"
+#include "type/Type.h"
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace sema
+{
+
+/**
+ * @brief Generic declarations and their instantiations.
+ *
+ * Generic fns and structs are not analysed where they are declared. Each use with
+ * new type arguments analyses the declaration again with the type parameters bound,
+ * see sema/sema_generics.h. Instantiations are cached by the canonical ids of their
+ * type arguments, so each one is generated once per module.
+ */
+class Generics
+{
+public:
+	using Binding = std::pair<Symbol, TypeInstance>;
+
+private:
+	std::unordered_map<Symbol, ast::AstNode*> decls;
+	// Keyed by the template name id followed by TypeInstance ids of the arguments.
+	// Null while the instantiation is in progress.
+	std::map<Vec<unsigned int>, Type const*> instances;
+	// Template name and type arguments of each instantiated struct.
+	std::unordered_map<Type const*, std::pair<Symbol, Vec<TypeInstance>>> instance_args;
+	// Type parameter bindings of the instantiations being analysed. Innermost is last.
+	Vec<Vec<Binding>> bindings;
+
+	static Vec<unsigned int> key(Symbol name, Vec<TypeInstance> const& type_args);
+
+public:
+	void add_decl(Symbol name, ast::AstNode* decl);
+	ast::AstNode* lookup_decl(Symbol name) const;
+
+	/**
+	 * @brief Finds an instantiation.
+	 *
+	 * @return Nullopt if not instantiated. Null if the instantiation is in progress.
+	 */
+	std::optional<Type const*> lookup_instance(Symbol name, Vec<TypeInstance> const& type_args) const;
+	void add_instance(Symbol name, Vec<TypeInstance> const& type_args, Type const* type);
+	/**
+	 * @brief Template name and type arguments of an instantiation, e.g. Box and i32
+	 * for Box<i32>. Null if type is not an instantiation.
+	 */
+	std::pair<Symbol, Vec<TypeInstance>> const* lookup_instance_args(Type const* type) const;
+
+	void push_bindings(Vec<Binding> bound);
+	void pop_bindings();
+	/**
+	 * @brief Type argument bound to a type parameter of the innermost instantiation.
+	 */
+	std::optional<TypeInstance> lookup_binding(Symbol name) const;
+};
+
+} // namespace sema
@@ -3,6 +3,7 @@
 #include "TypeInstance.h"
 #include "ast2/AstNode.h"
 #include "common/String.h"
+#include "common/Symbol.h"
 #include "common/Vec.h"
 #include "type/Type.h"
 
@@ -29,6 +30,7 @@ struct IRStruct;
 struct IRUnion;
 struct IRParam;
 struct IRElse;
+struct FlatFunction;
 
 struct IRModule
 {
@@ -68,6 +70,8 @@ struct IRFunction
 	//
 	IRProto* proto;
 	IRBlock* block;
+	// The block lowered for codegen.
+	FlatFunction* body;
 };
 
 struct IRExternFn
@@ -86,6 +90,10 @@ struct IRProto
 
 	// Function
 	sema::Type const* fn_type;
+
+	ast::AttributeSet attributes;
+	// Coroutine. fn_type returns a future of rt.
+	bool is_async;
 };
 
 struct IRValueDecl
@@ -116,6 +124,8 @@ struct IRParam
 		IRVarArg* var_arg;
 	} data;
 	IRParamType type;
+
+	ast::AttributeSet attributes;
 };
 
 struct IRTypeDeclaraor
@@ -187,6 +197,8 @@ struct IRId
 {
 	//
 	Vec<String*>* name;
+	// name joined, e.g. Enum#Member.
+	Symbol symbol;
 	sema::TypeInstance type_instance;
 	ast::AstNode* node;
 
@@ -383,6 +395,15 @@ struct IRDeref
 	sema::TypeInstance type_instance;
 };
 
+struct IRAwait
+{
+	//
+	ast::AstNode* node;
+	Vec<IRExpr*>* futures;
+	// Result of the future if there is one future, void otherwise.
+	sema::TypeInstance type_instance;
+};
+
 struct IREmpty
 {
 	//
@@ -440,7 +461,8 @@ enum class IRExprType
 	IndirectMemberAccess,
 	AddressOf,
 	Empty,
-	Deref
+	Deref,
+	Await
 };
 
 struct IRExpr
@@ -460,6 +482,7 @@ struct IRExpr
 		IRInitializer* initializer;
 		IRAddressOf* addr_of;
 		IRDeref* deref;
+		IRAwait* await_expr;
 		IREmpty* empty;
 		IRMemberAccess* member_access;
 		IRIndirectMemberAccess* indirect_member_access;
@@ -0,0 +1,952 @@
+#include "ModuleInterface.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+using namespace sema;
+using namespace sema::interface_format;
+
+namespace sema
+{
+namespace interface_format
+{
+
+// The file is the header, then the entries, members, slots and strings, each at an
+// offset aligned to 8. Numbers are in the byte order of the writer, which the reader
+// checks. Strings are not null terminated. The header holds a checksum of the rest.
+
+static constexpr char magic[8] = {'s', 'u', 's', 'h', 'i', 'm', 'i', '\0'};
+static constexpr std::uint32_t byte_order = 0x01020304;
+static constexpr std::uint32_t no_array = 0xFFFFFFFF;
+
+struct StringRef
+{
+	std::uint32_t offset;
+	std::uint32_t size;
+};
+
+/**
+ * @brief A type named by a declaration. 'owner' is the entry that defines it, plus 1, or
+ * 0 for the builtin types. An enum member's type is owned by its enum.
+ */
+struct TypeRef
+{
+	StringRef name;
+	std::uint32_t owner;
+	std::uint32_t indirection;
+	std::uint32_t array_size;
+};
+
+enum class EntryKind : std::uint32_t
+{
+	Fn,
+	Struct,
+	Union,
+	Enum,
+	Future,
+};
+
+enum EntryFlags : std::uint32_t
+{
+	VarArg = 1 << 0,
+};
+
+struct Entry
+{
+	StringRef name;
+	EntryKind kind;
+	std::uint32_t flags;
+	// Fn attributes, see ast::AttributeSet.
+	std::uint32_t attributes;
+	// Params, fields or enum members.
+	std::uint32_t first_member;
+	std::uint32_t member_count;
+	// Declared return type of a fn, result type of a future.
+	TypeRef result;
+};
+
+enum class MemberKind : std::uint32_t
+{
+	// A fn param, or a struct or union field.
+	Value,
+	EnumId,
+	EnumStruct,
+};
+
+struct Member
+{
+	std::int64_t nominal;
+	StringRef name;
+	MemberKind kind;
+	// Order index, see MemberTypeInstance::idx.
+	std::uint32_t idx;
+	// Param attributes.
+	std::uint32_t attributes;
+	// Fields of an EnumStruct member.
+	std::uint32_t first_field;
+	std::uint32_t field_count;
+	TypeRef type;
+};
+
+/**
+ * @brief A name to look up. Enum members are found under their type names too, e.g.
+ * Shape#Circle, which lead to the enum.
+ */
+struct Slot
+{
+	std::uint32_t hash;
+	// Entry index plus 1, 0 for an unused slot.
+	std::uint32_t entry;
+	StringRef name;
+};
+
+struct Header
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byte_order;
+	std::uint32_t entry_count;
+	std::uint32_t entries_offset;
+	std::uint32_t member_count;
+	std::uint32_t members_offset;
+	// A power of 2.
+	std::uint32_t slot_count;
+	std::uint32_t slots_offset;
+	std::uint32_t strings_size;
+	std::uint32_t strings_offset;
+	// Of the bytes after the header.
+	std::uint64_t checksum;
+};
+
+static_assert(sizeof(Header) == 56);
+static_assert(sizeof(Entry) == 48);
+static_assert(sizeof(Member) == 56);
+static_assert(sizeof(Slot) == 16);
+
+} // namespace interface_format
+} // namespace sema
+
+// FNV-1a. Part of the format, so it must not change within a version.
+static std::uint32_t
+hash_name(char const* name, std::size_t size)
+{
+	std::uint32_t hash = 2166136261u;
+	for( std::size_t i = 0; i < size; i++ )
+	{
+		hash ^= static_cast<unsigned char>(name[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// FNV-1a, 64 bit.
+static std::uint64_t
+checksum(char const* data, std::size_t size)
+{
+	std::uint64_t hash = 14695981039346656037ull;
+	for( std::size_t i = 0; i < size; i++ )
+	{
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static constexpr std::uint32_t fn_attributes =
+	(unsigned int)ast::Attribute::Inline | (unsigned int)ast::Attribute::NoInline |
+	(unsigned int)ast::Attribute::Hot | (unsigned int)ast::Attribute::Cold;
+static constexpr std::uint32_t param_attributes = (unsigned int)ast::Attribute::NoAlias |
+												  (unsigned int)ast::Attribute::ReadOnly |
+												  (unsigned int)ast::Attribute::NoCapture;
+
+// The same attributes parse_attributes() and Sema2 accept.
+static bool
+valid_fn_attributes(std::uint32_t mask)
+{
+	ast::AttributeSet attributes{mask};
+	return (mask & ~fn_attributes) == 0 &&
+		   !(attributes.has(ast::Attribute::Inline) && attributes.has(ast::Attribute::NoInline)) &&
+		   !(attributes.has(ast::Attribute::Hot) && attributes.has(ast::Attribute::Cold));
+}
+
+static bool
+in_bounds(std::size_t size, std::uint64_t offset, std::uint64_t count, std::size_t element)
+{
+	return offset % 8 == 0 && offset + count * element <= size;
+}
+
+ModuleInterface::ModuleInterface(String const& path, char const* data, std::size_t size)
+	: path_(path)
+	, data_(data)
+	, size_(size)
+{}
+
+ModuleInterface::~ModuleInterface()
+{
+	munmap(const_cast<char*>(data_), size_);
+}
+
+SemaResult<std::shared_ptr<ModuleInterface const>>
+ModuleInterface::open(String const& path)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if( fd < 0 )
+		return SemaError("Could not open interface " + path);
+
+	struct stat status;
+	if( fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header)) )
+	{
+		close(fd);
+		return SemaError(path + " is not a module interface.");
+	}
+
+	std::size_t size = status.st_size;
+	void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if( data == MAP_FAILED )
+		return SemaError("Could not map interface " + path);
+
+	std::shared_ptr<ModuleInterface const> interface{
+		new ModuleInterface(path, static_cast<char const*>(data), size)};
+
+	auto const& header = interface->header();
+	if( std::memcmp(header.magic, magic, sizeof(magic)) != 0 )
+		return SemaError(path + " is not a module interface.");
+
+	if( header.version != version || header.byte_order != byte_order )
+		return SemaError(path + " was written by another version of sushi.");
+
+	if( !in_bounds(size, header.entries_offset, header.entry_count, sizeof(Entry)) ||
+		!in_bounds(size, header.members_offset, header.member_count, sizeof(Member)) ||
+		!in_bounds(size, header.slots_offset, header.slot_count, sizeof(Slot)) ||
+		!in_bounds(size, header.strings_offset, header.strings_size, 1) ||
+		(header.slot_count & (header.slot_count - 1)) != 0 ||
+		header.checksum != checksum(interface->data_ + sizeof(Header), size - sizeof(Header)) ||
+		!interface->validate() )
+		return SemaError(path + " is damaged.");
+
+	return interface;
+}
+
+Header const&
+ModuleInterface::header() const
+{
+	return *reinterpret_cast<Header const*>(data_);
+}
+
+unsigned int
+ModuleInterface::entry_count() const
+{
+	return header().entry_count;
+}
+
+std::optional<String>
+ModuleInterface::string(StringRef const& ref) const
+{
+	auto const& header = this->header();
+	if( std::uint64_t{ref.offset} + ref.size > header.strings_size )
+		return std::nullopt;
+
+	return String(data_ + header.strings_offset + ref.offset, ref.size);
+}
+
+Entry const*
+ModuleInterface::entry(std::uint32_t index) const
+{
+	auto const& header = this->header();
+	if( index >= header.entry_count )
+		return nullptr;
+
+	return reinterpret_cast<Entry const*>(data_ + header.entries_offset) + index;
+}
+
+Member const*
+ModuleInterface::members(std::uint32_t first, std::uint32_t count) const
+{
+	auto const& header = this->header();
+	if( std::uint64_t{first} + count > header.member_count )
+		return nullptr;
+
+	return reinterpret_cast<Member const*>(data_ + header.members_offset) + first;
+}
+
+std::optional<std::uint32_t>
+ModuleInterface::find(Symbol symbol) const
+{
+	auto const& header = this->header();
+	if( header.slot_count == 0 )
+		return std::nullopt;
+
+	auto const& name = symbol.str();
+	auto hash = hash_name(name.data(), name.size());
+	auto slots = reinterpret_cast<Slot const*>(data_ + header.slots_offset);
+	auto mask = header.slot_count - 1;
+	for( std::uint32_t probe = 0; probe < header.slot_count; probe++ )
+	{
+		auto const& slot = slots[(hash + probe) & mask];
+		if( slot.entry == 0 )
+			return std::nullopt;
+
+		if( slot.hash == hash && slot.name.size == name.size() &&
+			std::uint64_t{slot.name.offset} + slot.name.size <= header.strings_size &&
+			std::memcmp(data_ + header.strings_offset + slot.name.offset, name.data(), name.size()) ==
+				0 )
+			return slot.entry - 1;
+	}
+
+	return std::nullopt;
+}
+
+bool
+ModuleInterface::valid_type(TypeRef const& ref) const
+{
+	if( !string(ref.name) || ref.owner > header().entry_count )
+		return false;
+
+	// Fn types are not named by other declarations.
+	return ref.owner == 0 || entry(ref.owner - 1)->kind != EntryKind::Fn;
+}
+
+bool
+ModuleInterface::valid_values(
+	std::uint32_t first, std::uint32_t count, MemberKind kind, bool is_params) const
+{
+	auto values = members(first, count);
+	if( values == nullptr )
+		return false;
+
+	// Layouts and codegen index the fields by idx, so they must be a permutation.
+	Vec<bool> seen(count, false);
+	for( std::uint32_t i = 0; i < count; i++ )
+	{
+		auto const& value = values[i];
+		if( value.kind != kind || value.idx >= count || seen[value.idx] || !string(value.name) ||
+			!valid_type(value.type) )
+			return false;
+		seen[value.idx] = true;
+
+		bool is_pointer = value.type.indirection != 0 && value.type.array_size == no_array;
+		if( is_params ? (value.attributes & ~param_attributes) != 0 ||
+							(value.attributes != 0 && !is_pointer)
+					  : value.attributes != 0 )
+			return false;
+
+		if( kind != MemberKind::EnumId && kind != MemberKind::EnumStruct &&
+			(value.first_field != 0 || value.field_count != 0) )
+			return false;
+	}
+
+	return true;
+}
+
+bool
+ModuleInterface::validate() const
+{
+	auto const& header = this->header();
+	for( std::uint32_t index = 0; index < header.entry_count; index++ )
+	{
+		auto const& entry = *this->entry(index);
+		if( !string(entry.name) )
+			return false;
+
+		switch( entry.kind )
+		{
+		case EntryKind::Fn:
+			if( (entry.flags & ~VarArg) != 0 || !valid_fn_attributes(entry.attributes) ||
+				!valid_type(entry.result) ||
+				!valid_values(entry.first_member, entry.member_count, MemberKind::Value, true) )
+				return false;
+			break;
+		case EntryKind::Struct:
+		case EntryKind::Union:
+			if( entry.flags != 0 || entry.attributes != 0 ||
+				!valid_values(entry.first_member, entry.member_count, MemberKind::Value, false) )
+				return false;
+			break;
+		case EntryKind::Enum:
+		{
+			auto enum_members = members(entry.first_member, entry.member_count);
+			if( entry.flags != 0 || entry.attributes != 0 || enum_members == nullptr )
+				return false;
+
+			Vec<bool> seen(entry.member_count, false);
+			for( std::uint32_t i = 0; i < entry.member_count; i++ )
+			{
+				auto const& member = enum_members[i];
+				if( member.idx >= entry.member_count || seen[member.idx] ||
+					!string(member.name) || member.attributes != 0 )
+					return false;
+				seen[member.idx] = true;
+
+				if( member.kind == MemberKind::EnumStruct )
+				{
+					if( !valid_values(
+							member.first_field, member.field_count, MemberKind::Value, false) )
+						return false;
+				}
+				else if(
+					member.kind != MemberKind::EnumId || member.first_field != 0 ||
+					member.field_count != 0 )
+					return false;
+			}
+			break;
+		}
+		case EntryKind::Future:
+			if( entry.flags != 0 || entry.attributes != 0 || entry.member_count != 0 ||
+				!valid_type(entry.result) )
+				return false;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool
+ModuleInterface::materialize(Sema2& sema, Symbol name) const
+{
+	auto index = find(name);
+	if( !index )
+		return false;
+
+	return materialize_entry(sema, *index, 0);
+}
+
+std::optional<TypeInstance>
+ModuleInterface::resolve(Sema2& sema, TypeRef const& ref, unsigned int depth) const
+{
+	if( ref.owner != 0 && !materialize_entry(sema, ref.owner - 1, depth + 1) )
+		return std::nullopt;
+
+	auto name = string(ref.name);
+	if( !name )
+		return std::nullopt;
+
+	auto iter = sema.types.types.find(Symbol::intern(*name));
+	if( iter == sema.types.types.end() )
+		return std::nullopt;
+
+	auto type = TypeInstance::OfType(&iter->second);
+	if( ref.indirection != 0 )
+		type = type.PointerTo(ref.indirection);
+	if( ref.array_size != no_array )
+		type = TypeInstance::ArrayOf(type, ref.array_size);
+
+	return type;
+}
+
+namespace
+{
+struct ValueDecls
+{
+	std::map<String, ir::IRValueDecl*>* decls;
+	std::map<String, MemberTypeInstance> types;
+};
+} // namespace
+
+static std::optional<ValueDecls>
+make_value_decls(
+	Sema2& sema,
+	Member const* members,
+	std::uint32_t count,
+	std::function<std::optional<TypeInstance>(TypeRef const&)> const& resolve,
+	std::function<std::optional<String>(StringRef const&)> const& string)
+{
+	if( members == nullptr )
+		return std::nullopt;
+
+	ValueDecls result{sema.create_member_map(), {}};
+	for( std::uint32_t i = 0; i < count; i++ )
+	{
+		auto const& member = members[i];
+		auto name = string(member.name);
+		auto type = resolve(member.type);
+		if( !name || !type )
+			return std::nullopt;
+
+		auto ir_name = sema.create_name(name->data(), name->size());
+		result.decls->emplace(*name, sema.ValueDecl(nullptr, ir_name, sema.TypeDecl(nullptr, *type)));
+		result.types.emplace(*name, MemberTypeInstance(*type, *name, member.idx));
+	}
+
+	return result;
+}
+
+bool
+ModuleInterface::materialize_entry(Sema2& sema, std::uint32_t index, unsigned int depth) const
+{
+	// Types only name types declared before them, so this is only reached by a damaged
+	// file.
+	if( depth > 256 )
+		return false;
+
+	auto entry = this->entry(index);
+	if( entry == nullptr )
+		return false;
+
+	auto namer = string(entry->name);
+	if( !namer )
+		return false;
+	auto const& name = *namer;
+
+	// Already materialized, e.g. as a type named by an earlier declaration.
+	if( entry->kind != EntryKind::Fn && sema.types.types.count(Symbol::intern(name)) != 0 )
+		return true;
+
+	auto resolve = [this, &sema, depth](TypeRef const& ref) {
+		return this->resolve(sema, ref, depth);
+	};
+	auto string = [this](StringRef const& ref) { return this->string(ref); };
+	auto members = this->members(entry->first_member, entry->member_count);
+	auto ir_name = sema.create_name(name.data(), name.size());
+
+	switch( entry->kind )
+	{
+	case EntryKind::Fn:
+	{
+		if( members == nullptr )
+			return false;
+
+		auto args = sema.create_argslist();
+		Vec<MemberTypeInstance> params;
+		for( std::uint32_t i = 0; i < entry->member_count; i++ )
+		{
+			auto const& member = members[i];
+			auto param_name = string(member.name);
+			auto type = resolve(member.type);
+			if( !param_name || !type )
+				return false;
+
+			auto decl = sema.ValueDecl(
+				nullptr,
+				sema.create_name(param_name->data(), param_name->size()),
+				sema.TypeDecl(nullptr, *type));
+			args->push_back(sema.IRParam(nullptr, decl, ast::AttributeSet{member.attributes}));
+			params.emplace_back(*type, *param_name, member.idx);
+		}
+
+		bool is_var_arg = (entry->flags & VarArg) != 0;
+		if( is_var_arg )
+			args->push_back(sema.IRParam(nullptr, sema.VarArg(nullptr)));
+
+		auto rt = resolve(entry->result);
+		if( !rt )
+			return false;
+
+		auto fn_type = sema.CreateType(Type::Function(name, params, *rt, is_var_arg));
+		sema.add_imported_type(fn_type);
+		sema.add_imported_value(Symbol::intern(name), TypeInstance::OfType(fn_type));
+
+		auto proto = sema.Proto(
+			nullptr,
+			ir_name,
+			args,
+			sema.TypeDecl(nullptr, *rt),
+			fn_type,
+			ast::AttributeSet{entry->attributes},
+			false);
+		sema.emit_generated(sema.TLS(sema.ExternFn(nullptr, proto)));
+		return true;
+	}
+	case EntryKind::Struct:
+	case EntryKind::Union:
+	{
+		auto declsr = make_value_decls(sema, members, entry->member_count, resolve, string);
+		if( !declsr )
+			return false;
+		auto& decls = *declsr;
+
+		if( entry->kind == EntryKind::Struct )
+		{
+			auto type = sema.CreateType(Type::Struct(name, decls.types));
+			sema.add_imported_type(type);
+			sema.emit_generated(sema.TLS(sema.Struct(nullptr, type, decls.decls)));
+		}
+		else
+		{
+			auto type = sema.CreateType(Type::Union(name, decls.types));
+			sema.add_imported_type(type);
+			sema.emit_generated(sema.TLS(sema.Union(nullptr, type, decls.decls)));
+		}
+		return true;
+	}
+	case EntryKind::Enum:
+	{
+		if( members == nullptr )
+			return false;
+
+		auto enum_type = sema.CreateType(Type::EnumPartial(name));
+		auto ir_members = sema.create_enum_member_map();
+		std::map<String, MemberTypeInstance> member_types;
+		for( std::uint32_t i = 0; i < entry->member_count; i++ )
+		{
+			auto const& member = members[i];
+			auto member_name = string(member.name);
+			if( !member_name )
+				return false;
+
+			auto ir_member_name = sema.create_name(member_name->data(), member_name->size());
+			auto nominal = EnumNominal(member.nominal);
+			auto type_name = name + "#" + *member_name;
+
+			ir::IREnumMember* ir_member;
+			if( member.kind == MemberKind::EnumStruct )
+			{
+				auto declsr = make_value_decls(
+					sema,
+					this->members(member.first_field, member.field_count),
+					member.field_count,
+					resolve,
+					string);
+				if( !declsr )
+					return false;
+
+				auto type = Type::Struct(type_name, declsr->types, nominal);
+				type.set_dependent_type(enum_type);
+				auto dep_type = sema.CreateType(type);
+				sema.add_imported_type(dep_type);
+
+				ir_member = sema.EnumMemberStruct(
+					nullptr,
+					dep_type,
+					sema.Struct(nullptr, dep_type, declsr->decls),
+					ir_member_name,
+					nominal);
+			}
+			else
+			{
+				auto type = sema.CreateType(Type::Primitive(type_name, nominal));
+				type->set_dependent_type(enum_type);
+				sema.add_imported_type(type);
+
+				ir_member = sema.EnumMemberId(nullptr, type, ir_member_name, nominal);
+			}
+
+			ir_members->emplace(*member_name, ir_member);
+			member_types.emplace(
+				*member_name,
+				MemberTypeInstance(TypeInstance::OfType(ir_member->type), *member_name, member.idx));
+		}
+
+		enum_type->set_enum_members(member_types);
+		sema.add_imported_type(enum_type);
+		sema.emit_generated(sema.TLS(sema.Enum(nullptr, enum_type, ir_members)));
+		return true;
+	}
+	case EntryKind::Future:
+	{
+		auto result = resolve(entry->result);
+		if( !result )
+			return false;
+
+		sema.types.future_type(*result);
+		return true;
+	}
+	}
+
+	return false;
+}
+
+namespace
+{
+class InterfaceWriter
+{
+	Vec<Entry> entries;
+	Vec<Member> members;
+	String strings;
+	// Entry index plus 1 of each type written.
+	std::unordered_map<Type const*, std::uint32_t> type_entries;
+	// Names to find, and their entry.
+	Vec<std::pair<StringRef, std::uint32_t>> names;
+
+public:
+	void add_fn(ir::IRProto const* proto);
+	std::uint32_t add_type(Type const* type);
+	bool write(String const& path);
+
+private:
+	StringRef add_string(String const& string);
+	TypeRef type_ref(TypeInstance type);
+	void fill_value(Member& member, MemberTypeInstance const& value);
+};
+} // namespace
+
+StringRef
+InterfaceWriter::add_string(String const& string)
+{
+	StringRef ref{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(string.size())};
+	strings += string;
+	return ref;
+}
+
+TypeRef
+InterfaceWriter::type_ref(TypeInstance type)
+{
+	TypeRef ref{};
+	ref.owner = add_type(type.type);
+	ref.name = add_string(type.type->get_name());
+	ref.indirection = type.indirection_level;
+	ref.array_size = type.is_array_type() ? type.array_size : no_array;
+	return ref;
+}
+
+void
+InterfaceWriter::fill_value(Member& member, MemberTypeInstance const& value)
+{
+	member.name = add_string(value.name);
+	member.kind = MemberKind::Value;
+	member.idx = value.idx;
+	member.type = type_ref(value.type);
+}
+
+std::uint32_t
+InterfaceWriter::add_type(Type const* type)
+{
+	// Enum members are written with their enum.
+	auto dependent = type->get_dependent_type();
+	if( dependent != type )
+		return add_type(dependent);
+
+	if( !type->is_struct_type() && !type->is_union_type() && !type->is_enum_type() &&
+		!type->is_future_type() )
+		return 0;
+
+	auto found = type_entries.find(type);
+	if( found != type_entries.end() )
+		return found->second;
+
+	// Types named by this one are added while it is written, so reserve its entry and
+	// its members first.
+	std::uint32_t index = entries.size();
+	entries.emplace_back();
+	type_entries.emplace(type, index + 1);
+
+	Entry entry{};
+	entry.name = add_string(type->get_name());
+	names.emplace_back(entry.name, index);
+
+	if( type->is_future_type() )
+	{
+		entry.kind = EntryKind::Future;
+		entry.result = type_ref(type->future_result_type());
+		entries[index] = entry;
+		return index + 1;
+	}
+
+	entry.kind = type->is_struct_type() ? EntryKind::Struct
+				 : type->is_union_type() ? EntryKind::Union
+										 : EntryKind::Enum;
+	entry.first_member = members.size();
+	entry.member_count = type->get_member_count();
+	members.resize(members.size() + entry.member_count);
+
+	for( std::uint32_t i = 0; i < entry.member_count; i++ )
+	{
+		auto value = type->get_member(i);
+		Member member{};
+		if( entry.kind != EntryKind::Enum )
+		{
+			fill_value(member, value);
+			members[entry.first_member + i] = member;
+			continue;
+		}
+
+		auto member_type = value.type.type;
+		member.name = add_string(value.name);
+		member.idx = value.idx;
+		member.nominal = member_type->as_nominal().value;
+		names.emplace_back(add_string(member_type->get_name()), index);
+
+		if( member_type->is_struct_type() )
+		{
+			member.kind = MemberKind::EnumStruct;
+			member.first_field = members.size();
+			member.field_count = member_type->get_member_count();
+			members.resize(members.size() + member.field_count);
+			for( std::uint32_t field = 0; field < member.field_count; field++ )
+			{
+				Member field_member{};
+				fill_value(field_member, member_type->get_member(field));
+				members[member.first_field + field] = field_member;
+			}
+		}
+		else
+		{
+			member.kind = MemberKind::EnumId;
+		}
+
+		members[entry.first_member + i] = member;
+	}
+
+	entries[index] = entry;
+	return index + 1;
+}
+
+void
+InterfaceWriter::add_fn(ir::IRProto const* proto)
+{
+	std::uint32_t index = entries.size();
+	entries.emplace_back();
+
+	Entry entry{};
+	entry.kind = EntryKind::Fn;
+	entry.name = add_string(*proto->name);
+	entry.attributes = proto->attributes.mask;
+	names.emplace_back(entry.name, index);
+
+	Vec<ir::IRParam const*> params;
+	for( auto param : *proto->args )
+	{
+		if( param->type == ir::IRParamType::VarArg )
+			entry.flags |= VarArg;
+		else
+			params.push_back(param);
+	}
+
+	entry.first_member = members.size();
+	entry.member_count = params.size();
+	members.resize(members.size() + params.size());
+	for( std::uint32_t i = 0; i < params.size(); i++ )
+	{
+		auto decl = params[i]->data.value_decl;
+		Member member{};
+		fill_value(member, MemberTypeInstance(decl->type_decl->type_instance, *decl->name, i));
+		member.attributes = params[i]->attributes.mask;
+		members[entry.first_member + i] = member;
+	}
+
+	entry.result = type_ref(proto->rt->type_instance);
+	entries[index] = entry;
+}
+
+static std::uint32_t
+align8(std::uint32_t offset)
+{
+	return (offset + 7) & ~7u;
+}
+
+bool
+InterfaceWriter::write(String const& path)
+{
+	// At most half full.
+	std::uint32_t slot_count = 1;
+	while( slot_count < names.size() * 2 )
+		slot_count *= 2;
+
+	Vec<Slot> slots(slot_count, Slot{});
+	for( auto const& [name, entry] : names )
+	{
+		auto hash = hash_name(strings.data() + name.offset, name.size);
+		for( std::uint32_t probe = 0;; probe++ )
+		{
+			auto& slot = slots[(hash + probe) & (slot_count - 1)];
+			if( slot.entry == 0 )
+			{
+				slot = Slot{hash, entry + 1, name};
+				break;
+			}
+
+			// The first declaration of a name wins, as in the scopes.
+			if( slot.hash == hash && slot.name.size == name.size &&
+				std::memcmp(
+					strings.data() + slot.name.offset, strings.data() + name.offset, name.size) ==
+					0 )
+				break;
+		}
+	}
+
+	Header header{};
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = ModuleInterface::version;
+	header.byte_order = byte_order;
+	header.entry_count = entries.size();
+	header.entries_offset = align8(sizeof(Header));
+	header.member_count = members.size();
+	header.members_offset = align8(header.entries_offset + entries.size() * sizeof(Entry));
+	header.slot_count = slot_count;
+	header.slots_offset = align8(header.members_offset + members.size() * sizeof(Member));
+	header.strings_size = strings.size();
+	header.strings_offset = align8(header.slots_offset + slot_count * sizeof(Slot));
+
+	String file(header.strings_offset + strings.size(), '\0');
+	std::memcpy(file.data() + header.entries_offset, entries.data(), entries.size() * sizeof(Entry));
+	std::memcpy(file.data() + header.members_offset, members.data(), members.size() * sizeof(Member));
+	std::memcpy(file.data() + header.slots_offset, slots.data(), slots.size() * sizeof(Slot));
+	std::memcpy(file.data() + header.strings_offset, strings.data(), strings.size());
+	header.checksum = checksum(file.data() + sizeof(Header), file.size() - sizeof(Header));
+	std::memcpy(file.data(), &header, sizeof(header));
+
+	// A compile may have the old file mapped, and would fault on a truncated one. Write
+	// a new file and rename it over the old, so the mapping keeps the old contents.
+	auto tmp_path = path + ".tmp." + std::to_string(getpid());
+	{
+		std::ofstream stream{tmp_path, std::ios::binary | std::ios::trunc};
+		stream.write(file.data(), file.size());
+		stream.close();
+		if( !stream.good() )
+		{
+			std::remove(tmp_path.c_str());
+			return false;
+		}
+	}
+
+	if( std::rename(tmp_path.c_str(), path.c_str()) != 0 )
+	{
+		std::remove(tmp_path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+SemaResult<bool>
+sema::write_module_interface(String const& path, Vec<DeclaredModule> const& modules)
+{
+	InterfaceWriter writer;
+	for( auto const& module : modules )
+	{
+		for( auto const& item : module.items )
+		{
+			if( item.proto != nullptr )
+			{
+				// A caller of an async fn must create its coroutine frame, which other
+				// modules cannot do yet.
+				if( !item.proto->is_async )
+					writer.add_fn(item.proto);
+				continue;
+			}
+
+			auto stmt = item.stmt;
+			switch( stmt->type )
+			{
+			case ir::IRTopLevelType::Struct:
+				writer.add_type(stmt->stmt.struct_decl->struct_type);
+				break;
+			case ir::IRTopLevelType::Union:
+				writer.add_type(stmt->stmt.union_decl->union_type);
+				break;
+			case ir::IRTopLevelType::Enum:
+				writer.add_type(stmt->stmt.enum_decl->enum_type);
+				break;
+			case ir::IRTopLevelType::ExternFn:
+			case ir::IRTopLevelType::Function:
+				break;
+			}
+		}
+	}
+
+	if( !writer.write(path) )
+		return SemaError("Could not write interface " + path);
+
+	return true;
+}
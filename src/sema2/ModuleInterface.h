@@ -0,0 +1,100 @@
+#pragma once
+
+#include "SemaGen.h"
+#include "SemaResult.h"
+#include "common/String.h"
+#include "common/Symbol.h"
+#include "common/Vec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace sema
+{
+
+namespace interface_format
+{
+struct Header;
+struct Entry;
+struct Member;
+struct TypeRef;
+struct StringRef;
+enum class MemberKind : std::uint32_t;
+} // namespace interface_format
+
+/**
+ * @brief The exported declarations of a module, i.e. its structs, unions, enums and
+ * fn prototypes, read from a file written by write_module_interface().
+ *
+ * The file is mapped, not read. Opening it only checks the header, and a name is
+ * found through a hash table in the file, so a large interface costs nothing until
+ * its names are used. Sema2 materializes a declaration into its Types, and as extern
+ * declarations for codegen, the first time it looks up the name and misses.
+ *
+ * Generic fns and structs are not exported, nor are async fns. Instantiations used
+ * by exported signatures are, under their instance name.
+ */
+class ModuleInterface
+{
+public:
+	/**
+	 * @brief Incremented on every change to the format. Files of other versions are
+	 * rejected.
+	 */
+	static constexpr std::uint32_t version = 2;
+
+	static SemaResult<std::shared_ptr<ModuleInterface const>> open(String const& path);
+	~ModuleInterface();
+
+	ModuleInterface(ModuleInterface const&) = delete;
+	ModuleInterface& operator=(ModuleInterface const&) = delete;
+
+	String const& path() const { return path_; }
+	unsigned int entry_count() const;
+
+	bool has(Symbol name) const { return find(name).has_value(); }
+
+	/**
+	 * @brief Defines the declaration and the types it names in 'sema'. Returns false if
+	 * the interface has no such name, or the file is damaged.
+	 */
+	bool materialize(Sema2& sema, Symbol name) const;
+
+private:
+	String path_;
+	char const* data_ = nullptr;
+	std::size_t size_ = 0;
+
+	ModuleInterface(String const& path, char const* data, std::size_t size);
+
+	interface_format::Header const& header() const;
+	std::optional<std::uint32_t> find(Symbol name) const;
+	interface_format::Entry const* entry(std::uint32_t index) const;
+	interface_format::Member const* members(std::uint32_t first, std::uint32_t count) const;
+	std::optional<String> string(interface_format::StringRef const& ref) const;
+
+	/**
+	 * @brief Checks every entry and member, so that materializing trusts the file. The
+	 * checksum only catches accidental damage.
+	 */
+	bool validate() const;
+	bool valid_type(interface_format::TypeRef const& ref) const;
+	bool valid_values(
+		std::uint32_t first,
+		std::uint32_t count,
+		interface_format::MemberKind kind,
+		bool is_params) const;
+
+	bool materialize_entry(Sema2& sema, std::uint32_t index, unsigned int depth) const;
+	std::optional<TypeInstance>
+	resolve(Sema2& sema, interface_format::TypeRef const& ref, unsigned int depth) const;
+};
+
+/**
+ * @brief Writes the interface of the declared modules, as one module.
+ */
+SemaResult<bool> write_module_interface(String const& path, Vec<DeclaredModule> const& modules);
+
+} // namespace sema
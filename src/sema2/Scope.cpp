@@ -1,104 +1,221 @@
 #include "Scope.h"
 
+#include <cassert>
+
 using namespace sema;
 
-Scope::Scope(Types* ty)
-	: types(ty)
-	, parent(nullptr)
-{}
+static unsigned int
+slot_hash(Symbol name, unsigned int mask)
+{
+	// Fibonacci hashing; Symbol ids are sequential.
+	return (name.id() * 2654435769u) & mask;
+}
 
-Scope::Scope(Scope* par)
-	: types(par->types)
-	, parent(par){};
+ScopeStack::ScopeStack()
+	: slots(64, Slot{Symbol{}, -1, -1})
+{
+	frames.push_back(Frame{0, std::optional<TypeInstance>(), false});
+}
 
 void
-Scope::add_value_identifier(String const& name, TypeInstance id)
+ScopeStack::push()
 {
-	auto iter = names.emplace(String{name}, id);
+	frames.push_back(Frame{(unsigned int)bindings.size(), std::optional<TypeInstance>(), false});
 }
 
 void
-Scope::add_type_identifier(Type const* id)
+ScopeStack::push_isolated()
 {
-	auto iter = types_in_scope.emplace(id->get_name(), id);
+	frames.push_back(Frame{(unsigned int)bindings.size(), std::optional<TypeInstance>(), true});
+	update_hidden();
 }
 
-Type const*
-Scope::lookup_type(String const& name) const
+void
+ScopeStack::update_hidden()
 {
-	auto me = types_in_scope.find(name);
-	if( me == types_in_scope.end() )
+	hidden_begin = 0;
+	hidden_end = 0;
+	for( int i = frames.size() - 1; i > 0; i-- )
 	{
-		if( parent == nullptr )
+		if( frames[i].isolated )
 		{
-			return nullptr;
-		}
-		else
-		{
-			return parent->lookup_type(name);
+			hidden_begin = frames[1].bindings_begin;
+			hidden_end = frames[i].bindings_begin;
+			return;
 		}
 	}
-	else
+}
+
+int
+ScopeStack::visible(int binding) const
+{
+	while( binding >= (int)hidden_begin && binding < (int)hidden_end )
+		binding = bindings[binding].shadowed;
+
+	return binding;
+}
+
+void
+ScopeStack::pop()
+{
+	assert(frames.size() > 1 && "Popped the module scope.");
+
+	auto begin = frames.back().bindings_begin;
+	for( int i = bindings.size() - 1; i >= (int)begin; i-- )
 	{
-		return me->second;
+		auto& binding = bindings[i];
+		auto& slot = slot_for(binding.name);
+		if( binding.is_type )
+			slot.type = binding.shadowed;
+		else
+			slot.value = binding.shadowed;
 	}
+
+	bindings.resize(begin);
+	bool isolated = frames.back().isolated;
+	frames.pop_back();
+
+	if( isolated )
+		update_hidden();
 }
 
-TypeInstance const*
-Scope::lookup_value_type(String const& name) const
+ScopeStack::Slot&
+ScopeStack::slot_for(Symbol name)
 {
-	auto me = names.find(name);
-	if( me == names.end() )
+	unsigned int mask = slots.size() - 1;
+	for( unsigned int i = slot_hash(name, mask);; i = (i + 1) & mask )
 	{
-		if( parent == nullptr )
-		{
-			return nullptr;
-		}
-		else
+		auto& slot = slots[i];
+		if( slot.name == name )
+			return slot;
+
+		if( slot.name.empty() )
 		{
-			return parent->lookup_value_type(name);
+			// Keep the load factor under 1/2.
+			if( (used_slots + 1) * 2 > slots.size() )
+			{
+				grow();
+				return slot_for(name);
+			}
+
+			used_slots += 1;
+			slot.name = name;
+			return slot;
 		}
 	}
-	else
-	{
-		return &me->second;
-	}
 }
 
-std::optional<TypeInstance>
-Scope::get_expected_return() const
+ScopeStack::Slot const*
+ScopeStack::find_slot(Symbol name) const
 {
-	if( !expected_return.has_value() )
+	unsigned int mask = slots.size() - 1;
+	for( unsigned int i = slot_hash(name, mask);; i = (i + 1) & mask )
 	{
-		if( parent == nullptr )
-		{
-			return std::optional<TypeInstance>();
-		}
-		else
-		{
-			return parent->get_expected_return();
-		}
+		auto& slot = slots[i];
+		if( slot.name == name )
+			return &slot;
+
+		if( slot.name.empty() )
+			return nullptr;
 	}
-	else
+}
+
+void
+ScopeStack::grow()
+{
+	Vec<Slot> old_slots(slots.size() * 2, Slot{Symbol{}, -1, -1});
+	old_slots.swap(slots);
+
+	unsigned int mask = slots.size() - 1;
+	for( auto& old_slot : old_slots )
 	{
-		return expected_return;
+		if( old_slot.name.empty() )
+			continue;
+
+		unsigned int i = slot_hash(old_slot.name, mask);
+		while( !slots[i].name.empty() )
+			i = (i + 1) & mask;
+		slots[i] = old_slot;
 	}
 }
 
 void
-Scope::set_expected_return(TypeInstance n)
+ScopeStack::bind(Binding binding)
+{
+	auto& slot = slot_for(binding.name);
+	int& innermost = binding.is_type ? slot.type : slot.value;
+
+	// The first declaration in a scope wins.
+	if( innermost >= (int)frames.back().bindings_begin )
+		return;
+
+	binding.shadowed = innermost;
+	innermost = bindings.size();
+	bindings.push_back(binding);
+}
+
+void
+ScopeStack::add_value_identifier(Symbol name, TypeInstance id)
+{
+	bind(Binding{name, false, id, nullptr, -1});
+}
+
+void
+ScopeStack::add_type_identifier(Type const* id)
+{
+	bind(Binding{Symbol::intern(id->get_name()), true, TypeInstance(), id, -1});
+}
+
+Type const*
+ScopeStack::lookup_type(Symbol name) const
 {
-	expected_return = n;
+	auto slot = find_slot(name);
+	if( !slot )
+		return nullptr;
+
+	auto binding = visible(slot->type);
+	if( binding < 0 )
+		return nullptr;
+
+	return bindings[binding].type;
+}
+
+TypeInstance const*
+ScopeStack::lookup_value_type(Symbol name) const
+{
+	auto slot = find_slot(name);
+	if( !slot )
+		return nullptr;
+
+	auto binding = visible(slot->value);
+	if( binding < 0 )
+		return nullptr;
+
+	return &bindings[binding].value;
+}
+
+std::optional<TypeInstance>
+ScopeStack::get_expected_return() const
+{
+	for( auto frame = frames.rbegin(); frame != frames.rend(); ++frame )
+	{
+		if( frame->expected_return.has_value() )
+			return frame->expected_return;
+		if( frame->isolated )
+			break;
+	}
+
+	return std::optional<TypeInstance>();
 }
 
 void
-Scope::clear_expected_return()
+ScopeStack::set_expected_return(TypeInstance n)
 {
-	expected_return = std::optional<TypeInstance>();
+	frames.back().expected_return = n;
 }
 
-Scope*
-Scope::get_parent()
+void
+ScopeStack::clear_expected_return()
 {
-	return parent;
+	frames.back().expected_return = std::optional<TypeInstance>();
 }
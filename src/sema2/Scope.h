@@ -1,35 +1,87 @@
 #pragma once
 #include "Types.h"
 #include "common/String.h"
+#include "common/Symbol.h"
+#include "common/Vec.h"
 #include "type/Type.h"
 
-#include <map>
 #include <optional>
 namespace sema
 {
 // TODO: ScopeExitType => return, yield, etc.
-class Scope
+/**
+ * @brief All scopes of the function (or module) being analysed as one flat stack.
+ *
+ * Bindings are pushed onto a single stack and an open addressing table maps each
+ * name to its innermost value and type binding. Shadowed bindings are restored on
+ * pop, so lookups are O(1) at any nesting depth and push/pop reuse their storage.
+ */
+class ScopeStack
 {
-	Scope* parent = nullptr;
-	std::map<String, Type const*> types_in_scope;
+	struct Binding
+	{
+		Symbol name;
+		bool is_type;
+		TypeInstance value;
+		Type const* type;
+		// Binding of the same name and kind this one shadows, or -1.
+		int shadowed;
+	};
 
-	Types* types;
-	std::map<String, TypeInstance> names;
-	std::optional<TypeInstance> expected_return;
+	struct Frame
+	{
+		unsigned int bindings_begin;
+		std::optional<TypeInstance> expected_return;
+		// Hides the bindings of all enclosing frames except the module scope.
+		bool isolated;
+	};
+
+	struct Slot
+	{
+		// Symbol{} marks an unused slot. Names are never removed, only unbound.
+		Symbol name;
+		// Innermost bindings, or -1.
+		int value;
+		int type;
+	};
+
+	Vec<Binding> bindings;
+	Vec<Frame> frames;
+	// Size is a power of 2.
+	Vec<Slot> slots;
+	unsigned int used_slots = 0;
+	// Bindings in [hidden_begin, hidden_end) are hidden by the innermost isolated frame.
+	unsigned int hidden_begin = 0;
+	unsigned int hidden_end = 0;
+
+	Slot& slot_for(Symbol name);
+	Slot const* find_slot(Symbol name) const;
+	void grow();
+	void bind(Binding binding);
+	int visible(int binding) const;
+	void update_hidden();
 
 public:
-	bool is_in_scope = true;
+	ScopeStack();
 
-	Scope(Types* parent);
-	Scope(Scope* parent);
+	void push();
+	/**
+	 * @brief Pushes a scope that only sees module scope bindings, e.g. for
+	 * analysing a generic instantiation from inside another function.
+	 */
+	void push_isolated();
+	void pop();
+	/**
+	 * @brief Number of scopes, including the module scope.
+	 */
+	unsigned int depth() const { return frames.size(); }
 
-	void add_value_identifier(String const& name, TypeInstance id);
+	void add_value_identifier(Symbol name, TypeInstance id);
 	void add_type_identifier(Type const* id);
-	Type const* lookup_type(String const& name) const;
-	TypeInstance const* lookup_value_type(String const& name) const;
+	Type const* lookup_type(Symbol name) const;
+	TypeInstance const* lookup_value_type(Symbol name) const;
 	std::optional<TypeInstance> get_expected_return() const;
 	void set_expected_return(TypeInstance n);
 	void clear_expected_return();
-	Scope* get_parent();
 };
-} // namespace sema
\ No newline at end of file
+} // namespace sema
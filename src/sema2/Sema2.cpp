@@ -1,16 +1,25 @@
 
 #include "Sema2.h"
 
+#include "ModuleInterface.h"
+#include "lowering/lower_flat.h"
+
+#include <cassert>
 #include <iostream>
 
 using namespace ast;
 using namespace sema;
 
-Sema2::Sema2()
+Sema2::Sema2(ast::Ast const& ast)
+	: types_(std::make_shared<Types>())
+	, generics_(std::make_shared<Generics>())
+	, type_args_(std::make_shared<TypeArgs>())
+	, interfaces_(std::make_shared<Vec<std::shared_ptr<ModuleInterface const>>>())
+	, handed_ir_(std::make_shared<HandedIR>())
+	, types(*types_)
+	, generics(*generics_)
 {
-	scopes.reserve(100);
-	scopes.emplace_back(&types);
-	current_scope = &scopes.back();
+	add_ast(ast);
 
 	for( auto& ty : types.types )
 	{
@@ -19,21 +28,131 @@ Sema2::Sema2()
 	}
 }
 
-Scope*
+Sema2::Sema2(Sema2 const& module, BodyWorker)
+	: types_(module.types_)
+	, generics_(module.generics_)
+	, type_args_(module.type_args_)
+	, interfaces_(module.interfaces_)
+	, imported_values_(module.imported_values_)
+	, imported_types_(module.imported_types_)
+	, scopes(module.scopes)
+	, body_worker_(true)
+	, handed_ir_(module.handed_ir_)
+	, types(*types_)
+	, generics(*generics_)
+{}
+
+Sema2::~Sema2()
+{
+	if( body_worker_ )
+	{
+		std::lock_guard<std::mutex> lock{handed_ir_->mutex};
+		handed_ir_->ir.take(ir_);
+	}
+}
+
+void
+Sema2::add_ast(ast::Ast const& ast)
+{
+	auto& type_args = ast.all_type_args();
+	type_args_->insert(type_args.begin(), type_args.end());
+}
+
+void
+Sema2::add_interface(std::shared_ptr<ModuleInterface const> interface)
+{
+	interfaces_->push_back(std::move(interface));
+}
+
+void
+Sema2::add_imported_value(Symbol name, TypeInstance type)
+{
+	imported_values_.emplace(name, type);
+}
+
+void
+Sema2::add_imported_type(Type const* type)
+{
+	imported_types_.emplace(Symbol::intern(type->get_name()), type);
+}
+
+bool
+Sema2::import(Symbol name)
+{
+	if( imported_values_.count(name) != 0 || imported_types_.count(name) != 0 )
+		return false;
+
+	for( auto const& interface : *interfaces_ )
+	{
+		if( !interface->has(name) )
+			continue;
+
+		// Materializing adds to the shared types.
+		if( body_worker_ )
+		{
+			defer_to_serial();
+			return false;
+		}
+
+		return interface->materialize(*this, name);
+	}
+
+	return false;
+}
+
+SemaError
+Sema2::defer_to_serial()
+{
+	assert(body_worker_);
+	deferred_ = true;
+	return SemaError("Deferred to the module's Sema2.");
+}
+
+void
 Sema2::push_scope()
 {
-	auto s = Scope(current_scope);
-	scopes.push_back(s);
-	current_scope = &scopes.back();
+	scopes.push();
+}
 
-	return current_scope;
+void
+Sema2::push_isolated_scope()
+{
+	scopes.push_isolated();
 }
 
 void
 Sema2::pop_scope()
 {
-	current_scope->is_in_scope = false;
-	current_scope = current_scope->get_parent();
+	scopes.pop();
+}
+
+void
+Sema2::reset_to_module_scope()
+{
+	while( scopes.depth() > 1 )
+		scopes.pop();
+	switch_context_.reset();
+}
+
+ast::AstList<ast::AstNode*>*
+Sema2::type_args(ast::AstNode const* node) const
+{
+	auto iter = type_args_->find(node);
+	return iter != type_args_->end() ? iter->second : nullptr;
+}
+
+void
+Sema2::emit_generated(ir::IRTopLevelStmt* stmt)
+{
+	generated.push_back(stmt);
+}
+
+Vec<ir::IRTopLevelStmt*>
+Sema2::take_generated()
+{
+	Vec<ir::IRTopLevelStmt*> result;
+	result.swap(generated);
+	return result;
 }
 
 Type*
@@ -43,112 +162,134 @@ Sema2::CreateType(Type ty)
 }
 
 void
-Sema2::add_value_identifier(String const& name, TypeInstance id)
+Sema2::add_value_identifier(Symbol name, TypeInstance id)
 {
-	return current_scope->add_value_identifier(name, id);
+	return scopes.add_value_identifier(name, id);
 }
 
 void
 Sema2::add_type_identifier(Type const* id)
 {
-	return current_scope->add_type_identifier(id);
+	return scopes.add_type_identifier(id);
 }
 
 std::optional<TypeInstance>
 Sema2::get_expected_return()
 {
-	return current_scope->get_expected_return();
+	return scopes.get_expected_return();
 }
 
 void
 Sema2::set_expected_return(TypeInstance n)
 {
-	current_scope->set_expected_return(n);
+	scopes.set_expected_return(n);
 }
 
 void
 Sema2::clear_expected_return()
 {
-	current_scope->clear_expected_return();
+	scopes.clear_expected_return();
 }
 
 std::optional<TypeInstance>
-Sema2::lookup_name(String const& name)
+Sema2::lookup_name(Symbol name)
 {
-	auto ti = current_scope->lookup_value_type(name);
-	if( ti == nullptr )
+	auto ti = scopes.lookup_value_type(name);
+	if( ti != nullptr )
+		return *ti;
+
+	auto imported = imported_values_.find(name);
+	if( imported == imported_values_.end() && import(name) )
+		imported = imported_values_.find(name);
+	if( imported == imported_values_.end() )
 		return std::optional<TypeInstance>();
 
-	return *ti;
+	return imported->second;
 }
 
 Type const*
-Sema2::lookup_type(String const& name)
+Sema2::lookup_type(Symbol name)
 {
-	return current_scope->lookup_type(name);
+	auto type = scopes.lookup_type(name);
+	if( type != nullptr )
+		return type;
+
+	auto imported = imported_types_.find(name);
+	if( imported == imported_types_.end() && import(name) )
+		imported = imported_types_.find(name);
+	if( imported == imported_types_.end() )
+		return nullptr;
+
+	return imported->second;
 }
 
 Vec<ir::IRDesignator*>*
 Sema2::create_designator_list()
 {
-	return new Vec<ir::IRDesignator*>();
+	return own(new Vec<ir::IRDesignator*>());
 }
 
 Vec<ir::IRTopLevelStmt*>*
 Sema2::create_tlslist()
 {
 	//
-	return new Vec<ir::IRTopLevelStmt*>();
+	return own(new Vec<ir::IRTopLevelStmt*>());
 }
 
 std::map<String, ir::IREnumMember*>*
 Sema2::create_enum_member_map()
 {
-	return new std::map<String, ir::IREnumMember*>();
+	return own(new std::map<String, ir::IREnumMember*>());
 }
 
 std::map<String, ir::IRValueDecl*>*
 Sema2::create_member_map()
 {
-	return new std::map<String, ir::IRValueDecl*>();
+	return own(new std::map<String, ir::IRValueDecl*>());
 }
 
 std::map<String, ir::IRExpr*>*
 Sema2::create_expr_map()
 {
-	return new std::map<String, ir::IRExpr*>();
+	return own(new std::map<String, ir::IRExpr*>());
 }
 
 Vec<ir::IRStmt*>*
 Sema2::create_slist()
 {
 	//
-	return new Vec<ir::IRStmt*>();
+	return own(new Vec<ir::IRStmt*>());
 }
 
 Vec<ir::IRExpr*>*
 Sema2::create_elist()
 {
-	return new Vec<ir::IRExpr*>();
+	return own(new Vec<ir::IRExpr*>());
 }
 
 Vec<ir::IRParam*>*
 Sema2::create_argslist()
 {
-	return new Vec<ir::IRParam*>();
+	return own(new Vec<ir::IRParam*>());
+}
+
+Vec<String*>*
+Sema2::create_name_parts()
+{
+	return own(new Vec<String*>());
 }
 
 String*
 Sema2::create_name(char const* s, int size)
 {
-	return new String(s, size);
+	return own(new String(s, size));
 }
 
 ir::IRModule*
 Sema2::Module(AstNode* node, Vec<ir::IRTopLevelStmt*>* stmts)
 {
 	//
-	auto mod = new ir::IRModule;
+	auto mod = own(new ir::IRModule);
 
 	mod->node = node;
 	mod->stmts = stmts;
@@ -159,7 +300,7 @@ Sema2::Module(AstNode* node, Vec<ir::IRTopLevelStmt*>* stmts)
 ir::IRTopLevelStmt*
 Sema2::TLS(ir::IRExternFn* fn)
 {
-	auto nod = new ir::IRTopLevelStmt;
+	auto nod = own(new ir::IRTopLevelStmt);
 
 	nod->node = fn->node;
 	nod->stmt.extern_fn = fn;
@@ -171,7 +312,7 @@ Sema2::TLS(ir::IRExternFn* fn)
 ir::IRTopLevelStmt*
 Sema2::TLS(ir::IRFunction* fn)
 {
-	auto nod = new ir::IRTopLevelStmt;
+	auto nod = own(new ir::IRTopLevelStmt);
 
 	nod->node = fn->node;
 	nod->stmt.fn = fn;
@@ -183,7 +324,7 @@ Sema2::TLS(ir::IRFunction* fn)
 ir::IRTopLevelStmt*
 Sema2::TLS(ir::IRStruct* st)
 {
-	auto nod = new ir::IRTopLevelStmt;
+	auto nod = own(new ir::IRTopLevelStmt);
 
 	nod->node = st->node;
 	nod->stmt.struct_decl = st;
@@ -195,7 +336,7 @@ Sema2::TLS(ir::IRStruct* st)
 ir::IRTopLevelStmt*
 Sema2::TLS(ir::IRUnion* st)
 {
-	auto nod = new ir::IRTopLevelStmt;
+	auto nod = own(new ir::IRTopLevelStmt);
 
 	nod->node = st->node;
 	nod->stmt.union_decl = st;
@@ -207,7 +348,7 @@ Sema2::TLS(ir::IRUnion* st)
 ir::IRTopLevelStmt*
 Sema2::TLS(ir::IREnum* st)
 {
-	auto nod = new ir::IRTopLevelStmt;
+	auto nod = own(new ir::IRTopLevelStmt);
 
 	nod->node = st->node;
 	nod->stmt.enum_decl = st;
@@ -219,11 +360,12 @@ Sema2::TLS(ir::IREnum* st)
 ir::IRFunction*
 Sema2::Fn(ast::AstNode* node, ir::IRProto* proto, ir::IRBlock* block)
 {
-	auto nod = new ir::IRFunction;
+	auto nod = own(new ir::IRFunction);
 
 	nod->node = node;
 	nod->proto = proto;
 	nod->block = block;
+	nod->body = own(lower_flat(block));
 
 	return nod;
 }
@@ -231,7 +373,7 @@ Sema2::Fn(ast::AstNode* node, ir::IRProto* proto, ir::IRBlock* block)
 ir::IRCall*
 Sema2::FnCall(ast::AstNode* node, ir::IRExpr* call_target, ir::IRArgs* args)
 {
-	auto nod = new ir::IRCall;
+	auto nod = own(new ir::IRCall);
 
 	nod->node = node;
 	nod->call_target = call_target;
@@ -243,7 +385,7 @@ Sema2::FnCall(ast::AstNode* node, ir::IRExpr* call_target, ir::IRArgs* args)
 ir::IRExternFn*
 Sema2::ExternFn(ast::AstNode* node, ir::IRProto* proto)
 {
-	auto nod = new ir::IRExternFn;
+	auto nod = own(new ir::IRExternFn);
 
 	nod->node = node;
 	nod->proto = proto;
@@ -257,15 +399,19 @@ Sema2::Proto(
 	String* name,
 	Vec<ir::IRParam*>* args,
 	ir::IRTypeDeclaraor* rt,
-	Type const* fn_type)
+	Type const* fn_type,
+	ast::AttributeSet attributes,
+	bool is_async)
 {
-	auto nod = new ir::IRProto;
+	auto nod = own(new ir::IRProto);
 
 	nod->node = node;
 	nod->name = name;
 	nod->args = args;
 	nod->rt = rt;
 	nod->fn_type = fn_type;
+	nod->attributes = attributes;
+	nod->is_async = is_async;
 
 	return nod;
 }
@@ -273,7 +419,7 @@ Sema2::Proto(
 ir::IRBlock*
 Sema2::Block(ast::AstNode* node, Vec<ir::IRStmt*>* stmts)
 {
-	auto nod = new ir::IRBlock;
+	auto nod = own(new ir::IRBlock);
 
 	nod->node = node;
 	nod->stmts = stmts;
@@ -284,7 +430,7 @@ Sema2::Block(ast::AstNode* node, Vec<ir::IRStmt*>* stmts)
 ir::IRReturn*
 Sema2::Return(ast::AstNode* node, ir::IRExpr* expr)
 {
-	auto nod = new ir::IRReturn;
+	auto nod = own(new ir::IRReturn);
 
 	nod->node = node;
 	nod->expr = expr;
@@ -295,7 +441,7 @@ Sema2::Return(ast::AstNode* node, ir::IRExpr* expr)
 ir::IRValueDecl*
 Sema2::ValueDecl(ast::AstNode* node, String* name, ir::IRTypeDeclaraor* rt)
 {
-	auto nod = new ir::IRValueDecl;
+	auto nod = own(new ir::IRValueDecl);
 
 	nod->node = node;
 	nod->name = name;
@@ -307,7 +453,7 @@ Sema2::ValueDecl(ast::AstNode* node, String* name, ir::IRTypeDeclaraor* rt)
 ir::IRTypeDeclaraor*
 Sema2::TypeDecl(ast::AstNode* node, sema::TypeInstance type)
 {
-	auto nod = new ir::IRTypeDeclaraor;
+	auto nod = own(new ir::IRTypeDeclaraor);
 
 	nod->node = node;
 	nod->type_instance = type;
@@ -318,7 +464,7 @@ Sema2::TypeDecl(ast::AstNode* node, sema::TypeInstance type)
 ir::IRExpr*
 Sema2::Expr(ir::IRCall* call)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = call->node;
 	nod->expr.call = call;
@@ -335,7 +481,7 @@ Sema2::Expr(ir::IRCall* call)
 ir::IRExpr*
 Sema2::Expr(ir::IRNumberLiteral* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.num_literal = nl;
@@ -349,7 +495,7 @@ Sema2::Expr(ir::IRNumberLiteral* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRStringLiteral* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.str_literal = nl;
@@ -363,7 +509,7 @@ Sema2::Expr(ir::IRStringLiteral* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRId* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.id = nl;
@@ -377,7 +523,7 @@ Sema2::Expr(ir::IRId* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRValueDecl* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.decl = nl;
@@ -391,7 +537,7 @@ Sema2::Expr(ir::IRValueDecl* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRBinOp* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.binop = nl;
@@ -405,7 +551,7 @@ Sema2::Expr(ir::IRBinOp* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRMemberAccess* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.member_access = nl;
@@ -419,7 +565,7 @@ Sema2::Expr(ir::IRMemberAccess* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRIndirectMemberAccess* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.indirect_member_access = nl;
@@ -433,7 +579,7 @@ Sema2::Expr(ir::IRIndirectMemberAccess* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRAddressOf* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.addr_of = nl;
@@ -447,7 +593,7 @@ Sema2::Expr(ir::IRAddressOf* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRDeref* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.deref = nl;
@@ -457,10 +603,24 @@ Sema2::Expr(ir::IRDeref* nl)
 
 	return nod;
 }
+
+ir::IRExpr*
+Sema2::Expr(ir::IRAwait* nl)
+{
+	auto nod = own(new ir::IRExpr);
+
+	nod->node = nl->node;
+	nod->expr.await_expr = nl;
+	nod->type = ir::IRExprType::Await;
+	nod->type_instance = nl->type_instance;
+	nod->discriminations = nullptr;
+
+	return nod;
+}
 ir::IRExpr*
 Sema2::Expr(ir::IRArrayAccess* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.array_access = nl;
@@ -474,7 +634,7 @@ Sema2::Expr(ir::IRArrayAccess* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IREmpty* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.empty = nl;
@@ -488,13 +648,13 @@ Sema2::Expr(ir::IREmpty* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRIs* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.is = nl;
 	nod->type = ir::IRExprType::Is;
 	nod->type_instance = nl->type_instance;
-	nod->discriminations = new Vec<ir::IRIs*>();
+	nod->discriminations = own(new Vec<ir::IRIs*>());
 
 	// TODO: Rewrite this so I don't have to manually pass up descriminations
 	// through all possible expr nodes.
@@ -508,7 +668,7 @@ Sema2::Expr(ir::IRIs* nl)
 ir::IRExpr*
 Sema2::Expr(ir::IRInitializer* nl)
 {
-	auto nod = new ir::IRExpr;
+	auto nod = own(new ir::IRExpr);
 
 	nod->node = nl->node;
 	nod->expr.initializer = nl;
@@ -522,7 +682,7 @@ Sema2::Expr(ir::IRInitializer* nl)
 ir::IRStmt*
 Sema2::Stmt(ir::IRReturn* ret)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 
 	nod->node = ret->node;
 	nod->stmt.ret = ret;
@@ -534,7 +694,7 @@ Sema2::Stmt(ir::IRReturn* ret)
 ir::IRStmt*
 Sema2::Stmt(ir::IRExpr* expr)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 
 	nod->node = expr->node;
 	nod->stmt.expr = expr;
@@ -546,7 +706,7 @@ Sema2::Stmt(ir::IRExpr* expr)
 ir::IRStmt*
 Sema2::Stmt(ir::IRLet* expr)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 
 	nod->node = expr->node;
 	nod->stmt.let = expr;
@@ -558,7 +718,7 @@ Sema2::Stmt(ir::IRLet* expr)
 ir::IRStmt*
 Sema2::Stmt(ir::IRAssign* expr)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 
 	nod->node = expr->node;
 	nod->stmt.assign = expr;
@@ -570,7 +730,7 @@ Sema2::Stmt(ir::IRAssign* expr)
 ir::IRStmt*
 Sema2::Stmt(ir::IRIf* e)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 	nod->node = e->node;
 	nod->stmt.if_stmt = e;
 	nod->type = ir::IRStmtType::If;
@@ -580,7 +740,7 @@ Sema2::Stmt(ir::IRIf* e)
 ir::IRStmt*
 Sema2::Stmt(ir::IRFor* e)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 	nod->node = e->node;
 	nod->stmt.for_stmt = e;
 	nod->type = ir::IRStmtType::For;
@@ -590,7 +750,7 @@ Sema2::Stmt(ir::IRFor* e)
 ir::IRStmt*
 Sema2::Stmt(ir::IRWhile* e)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 	nod->node = e->node;
 	nod->stmt.while_stmt = e;
 	nod->type = ir::IRStmtType::While;
@@ -600,7 +760,7 @@ Sema2::Stmt(ir::IRWhile* e)
 ir::IRStmt*
 Sema2::Stmt(ir::IRElse* e)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 
 	nod->node = e->node;
 	nod->stmt.else_stmt = e;
@@ -611,7 +771,7 @@ Sema2::Stmt(ir::IRElse* e)
 ir::IRStmt*
 Sema2::Stmt(ir::IRBlock* e)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 
 	nod->node = e->node;
 	nod->stmt.block = e;
@@ -622,7 +782,7 @@ Sema2::Stmt(ir::IRBlock* e)
 ir::IRStmt*
 Sema2::Stmt(ir::IRSwitch* sw)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 
 	nod->node = sw->node;
 	nod->stmt.switch_stmt = sw;
@@ -633,7 +793,7 @@ Sema2::Stmt(ir::IRSwitch* sw)
 ir::IRStmt*
 Sema2::Stmt(ir::IRCase* c)
 {
-	auto nod = new ir::IRStmt;
+	auto nod = own(new ir::IRStmt);
 
 	nod->node = c->node;
 	nod->stmt.case_stmt = c;
@@ -644,7 +804,7 @@ Sema2::Stmt(ir::IRCase* c)
 ir::IRArgs*
 Sema2::Args(ast::AstNode* node, Vec<ir::IRExpr*>* args)
 {
-	auto nod = new ir::IRArgs;
+	auto nod = own(new ir::IRArgs);
 
 	nod->node = node;
 	nod->args = args;
@@ -655,7 +815,7 @@ Sema2::Args(ast::AstNode* node, Vec<ir::IRExpr*>* args)
 ir::IRNumberLiteral*
 Sema2::NumberLiteral(ast::AstNode* node, sema::TypeInstance type_instance, long long val)
 {
-	auto nod = new ir::IRNumberLiteral;
+	auto nod = own(new ir::IRNumberLiteral);
 
 	nod->node = node;
 	nod->val = val;
@@ -667,7 +827,7 @@ Sema2::NumberLiteral(ast::AstNode* node, sema::TypeInstance type_instance, long
 ir::IRStringLiteral*
 Sema2::StringLiteral(ast::AstNode* node, sema::TypeInstance type_instance, String* name)
 {
-	auto nod = new ir::IRStringLiteral;
+	auto nod = own(new ir::IRStringLiteral);
 
 	nod->node = node;
 	nod->value = name;
@@ -677,12 +837,18 @@ Sema2::StringLiteral(ast::AstNode* node, sema::TypeInstance type_instance, Strin
 }
 
 ir::IRId*
-Sema2::Id(ast::AstNode* node, Vec<String*>* name_parts, sema::TypeInstance type, bool is_type_id)
+Sema2::Id(
+	ast::AstNode* node,
+	Vec<String*>* name_parts,
+	Symbol name,
+	sema::TypeInstance type,
+	bool is_type_id)
 {
-	auto nod = new ir::IRId;
+	auto nod = own(new ir::IRId);
 
 	nod->node = node;
 	nod->name = name_parts;
+	nod->symbol = name;
 	nod->type_instance = type;
 	nod->is_type_id = is_type_id;
 
@@ -693,7 +859,7 @@ ir::IRSwitch*
 Sema2::Switch(ast::AstNode* node, ir::IRExpr* expr, ir::IRBlock* block)
 {
 	//
-	auto nod = new ir::IRSwitch;
+	auto nod = own(new ir::IRSwitch);
 
 	nod->node = node;
 	nod->expr = expr;
@@ -705,7 +871,7 @@ Sema2::Switch(ast::AstNode* node, ir::IRExpr* expr, ir::IRBlock* block)
 ir::IRCase*
 Sema2::CaseDefault(ast::AstNode* node, ir::IRStmt* stmt)
 {
-	auto nod = new ir::IRCase;
+	auto nod = own(new ir::IRCase);
 
 	nod->node = node;
 	nod->value = 0;
@@ -720,7 +886,7 @@ ir::IRCase*
 Sema2::Case(ast::AstNode* node, long long expr, ir::IRStmt* stmt)
 {
 	//
-	auto nod = new ir::IRCase;
+	auto nod = own(new ir::IRCase);
 
 	nod->node = node;
 	nod->value = expr;
@@ -735,7 +901,7 @@ ir::IRCase*
 Sema2::Case(ast::AstNode* node, long long expr, ir::IRStmt* stmt, Vec<ir::IRParam*>* args)
 {
 	//
-	auto nod = new ir::IRCase;
+	auto nod = own(new ir::IRCase);
 
 	nod->node = node;
 	nod->value = expr;
@@ -749,7 +915,7 @@ Sema2::Case(ast::AstNode* node, long long expr, ir::IRStmt* stmt, Vec<ir::IRPara
 ir::IRLet*
 Sema2::Let(ast::AstNode* node, String* name, ir::IRAssign* assign)
 {
-	auto nod = new ir::IRLet;
+	auto nod = own(new ir::IRLet);
 
 	nod->node = node;
 	nod->name = name;
@@ -766,7 +932,7 @@ Sema2::Is(
 	ir::IRTypeDeclaraor* type_decl,
 	sema::TypeInstance bool_type)
 {
-	auto nod = new ir::IRIs;
+	auto nod = own(new ir::IRIs);
 
 	nod->node = node;
 	nod->type_decl = type_decl;
@@ -779,7 +945,7 @@ Sema2::Is(
 ir::IRLet*
 Sema2::LetEmpty(ast::AstNode* node, String* name, sema::TypeInstance type)
 {
-	auto nod = new ir::IRLet;
+	auto nod = own(new ir::IRLet);
 
 	nod->node = node;
 	nod->name = name;
@@ -792,7 +958,7 @@ Sema2::LetEmpty(ast::AstNode* node, String* name, sema::TypeInstance type)
 ir::IRIf*
 Sema2::If(ast::AstNode* node, ir::IRExpr* bool_expr, ir::IRStmt* body, ir::IRElse* else_stmt)
 {
-	auto nod = new ir::IRIf;
+	auto nod = own(new ir::IRIf);
 
 	nod->node = node;
 	nod->expr = bool_expr;
@@ -811,7 +977,7 @@ Sema2::IfArrow(
 	ir::IRElse* else_stmt,
 	Vec<ir::IRParam*>* args)
 {
-	auto nod = new ir::IRIf;
+	auto nod = own(new ir::IRIf);
 
 	nod->node = node;
 	nod->expr = cond;
@@ -825,7 +991,7 @@ Sema2::IfArrow(
 ir::IRElse*
 Sema2::Else(ast::AstNode* node, ir::IRStmt* stmt)
 {
-	auto nod = new ir::IRElse;
+	auto nod = own(new ir::IRElse);
 
 	nod->node = node;
 	nod->stmt = stmt;
@@ -836,7 +1002,7 @@ Sema2::Else(ast::AstNode* node, ir::IRStmt* stmt)
 ir::IRAssign*
 Sema2::Assign(ast::AstNode* node, ast::AssignOp op, ir::IRExpr* lhs, ir::IRExpr* rhs)
 {
-	auto nod = new ir::IRAssign;
+	auto nod = own(new ir::IRAssign);
 
 	nod->op = op;
 	nod->node = node;
@@ -850,7 +1016,7 @@ ir::IRBinOp*
 Sema2::BinOp(
 	ast::AstNode* node, ast::BinOp op, ir::IRExpr* lhs, ir::IRExpr* rhs, sema::TypeInstance type)
 {
-	auto nod = new ir::IRBinOp;
+	auto nod = own(new ir::IRBinOp);
 
 	nod->op = op;
 	nod->node = node;
@@ -865,7 +1031,7 @@ ir::IRStruct*
 Sema2::Struct(
 	ast::AstNode* node, sema::Type const* type, std::map<String, ir::IRValueDecl*>* members)
 {
-	auto nod = new ir::IRStruct;
+	auto nod = own(new ir::IRStruct);
 
 	nod->node = node;
 	nod->members = members;
@@ -878,7 +1044,7 @@ ir::IRUnion*
 Sema2::Union(
 	ast::AstNode* node, sema::Type const* type, std::map<String, ir::IRValueDecl*>* members)
 {
-	auto nod = new ir::IRUnion;
+	auto nod = own(new ir::IRUnion);
 
 	nod->node = node;
 	nod->members = members;
@@ -891,7 +1057,7 @@ ir::IREnum*
 Sema2::Enum(
 	ast::AstNode* node, sema::Type const* type, std::map<String, ir::IREnumMember*>* members)
 {
-	auto nod = new ir::IREnum;
+	auto nod = own(new ir::IREnum);
 
 	nod->node = node;
 	nod->members = members;
@@ -909,7 +1075,7 @@ Sema2::EnumMemberStruct(
 	EnumNominal idx)
 {
 	//
-	auto nod = new ir::IREnumMember;
+	auto nod = own(new ir::IREnumMember);
 
 	nod->contained_type = ir::IREnumMember::Type::Struct;
 	nod->node = node;
@@ -925,7 +1091,7 @@ ir::IREnumMember*
 Sema2::EnumMemberId(ast::AstNode* node, sema::Type const* type, String* name, EnumNominal idx)
 {
 	//
-	auto nod = new ir::IREnumMember;
+	auto nod = own(new ir::IREnumMember);
 
 	nod->contained_type = ir::IREnumMember::Type::Id;
 	nod->node = node;
@@ -940,7 +1106,7 @@ ir::IRMemberAccess*
 Sema2::MemberAccess(
 	ast::AstNode* node, ir::IRExpr* expr, sema::MemberTypeInstance member, String* member_name)
 {
-	auto nod = new ir::IRMemberAccess;
+	auto nod = own(new ir::IRMemberAccess);
 
 	nod->node = node;
 	nod->member_name = member_name;
@@ -954,7 +1120,7 @@ ir::IRIndirectMemberAccess*
 Sema2::IndirectMemberAccess(
 	ast::AstNode* node, ir::IRExpr* expr, sema::MemberTypeInstance member, String* member_name)
 {
-	auto nod = new ir::IRIndirectMemberAccess;
+	auto nod = own(new ir::IRIndirectMemberAccess);
 
 	nod->node = node;
 	nod->member_name = member_name;
@@ -967,7 +1133,7 @@ Sema2::IndirectMemberAccess(
 ir::IRVarArg*
 Sema2::VarArg(ast::AstNode* node)
 {
-	auto nod = new ir::IRVarArg;
+	auto nod = own(new ir::IRVarArg);
 
 	nod->node = node;
 
@@ -977,7 +1143,7 @@ Sema2::VarArg(ast::AstNode* node)
 ir::IRAddressOf*
 Sema2::AddressOf(ast::AstNode* node, ir::IRExpr* expr, sema::TypeInstance type)
 {
-	auto nod = new ir::IRAddressOf;
+	auto nod = own(new ir::IRAddressOf);
 
 	nod->node = node;
 	nod->expr = expr;
@@ -989,7 +1155,7 @@ Sema2::AddressOf(ast::AstNode* node, ir::IRExpr* expr, sema::TypeInstance type)
 ir::IRDeref*
 Sema2::Deref(ast::AstNode* node, ir::IRExpr* expr, sema::TypeInstance type)
 {
-	auto nod = new ir::IRDeref;
+	auto nod = own(new ir::IRDeref);
 
 	nod->node = node;
 	nod->expr = expr;
@@ -998,10 +1164,22 @@ Sema2::Deref(ast::AstNode* node, ir::IRExpr* expr, sema::TypeInstance type)
 	return nod;
 }
 
+ir::IRAwait*
+Sema2::Await(ast::AstNode* node, Vec<ir::IRExpr*>* futures, sema::TypeInstance type)
+{
+	auto nod = own(new ir::IRAwait);
+
+	nod->node = node;
+	nod->futures = futures;
+	nod->type_instance = type;
+
+	return nod;
+}
+
 ir::IREmpty*
 Sema2::Empty(ast::AstNode* node, sema::TypeInstance void_type)
 {
-	auto nod = new ir::IREmpty;
+	auto nod = own(new ir::IREmpty);
 
 	nod->node = node;
 	nod->type_instance = void_type;
@@ -1013,7 +1191,7 @@ ir::IRArrayAccess*
 Sema2::ArrayAcess(
 	ast::AstNode* node, ir::IRExpr* array_target, ir::IRExpr* expr, sema::TypeInstance type)
 {
-	auto nod = new ir::IRArrayAccess;
+	auto nod = own(new ir::IRArrayAccess);
 
 	nod->node = node;
 	nod->expr = expr;
@@ -1024,13 +1202,14 @@ Sema2::ArrayAcess(
 }
 
 ir::IRParam*
-Sema2::IRParam(ast::AstNode* node, ir::IRValueDecl* decl)
+Sema2::IRParam(ast::AstNode* node, ir::IRValueDecl* decl, ast::AttributeSet attributes)
 {
-	auto nod = new ir::IRParam;
+	auto nod = own(new ir::IRParam);
 
 	nod->node = node;
 	nod->data.value_decl = decl;
 	nod->type = ir::IRParamType::ValueDecl;
+	nod->attributes = attributes;
 
 	return nod;
 }
@@ -1038,11 +1217,12 @@ Sema2::IRParam(ast::AstNode* node, ir::IRValueDecl* decl)
 ir::IRParam*
 Sema2::IRParam(ast::AstNode* node, ir::IRVarArg* decl)
 {
-	auto nod = new ir::IRParam;
+	auto nod = own(new ir::IRParam);
 
 	nod->node = node;
 	nod->data.var_arg = decl;
 	nod->type = ir::IRParamType::VarArg;
+	nod->attributes = ast::AttributeSet::None();
 
 	return nod;
 }
@@ -1051,7 +1231,7 @@ ir::IRFor*
 Sema2::For(
 	ast::AstNode* node, ir::IRExpr* condition, ir::IRStmt* init, ir::IRStmt* end, ir::IRStmt* body)
 {
-	auto nod = new ir::IRFor;
+	auto nod = own(new ir::IRFor);
 
 	nod->node = node;
 	nod->condition = condition;
@@ -1064,7 +1244,7 @@ Sema2::For(
 ir::IRWhile*
 Sema2::While(ast::AstNode* node, ir::IRExpr* condition, ir::IRStmt* body)
 {
-	auto nod = new ir::IRWhile;
+	auto nod = own(new ir::IRWhile);
 
 	nod->node = node;
 	nod->condition = condition;
@@ -1081,7 +1261,7 @@ Sema2::Initializer(
 	sema::TypeInstance type_instance)
 {
 	//
-	auto nod = new ir::IRInitializer;
+	auto nod = own(new ir::IRInitializer);
 
 	nod->node = node;
 	nod->initializers = initializers;
@@ -1094,7 +1274,7 @@ Sema2::Initializer(
 ir::IRDesignator*
 Sema2::Designator(ast::AstNode* node, sema::MemberTypeInstance member, ir::IRExpr* expr)
 {
-	auto nod = new ir::IRDesignator;
+	auto nod = own(new ir::IRDesignator);
 
 	nod->node = node;
 	nod->member = member;
@@ -1,4 +1,5 @@
 #pragma once
+#include "Generics.h"
 #include "IR.h"
 #include "Scope.h"
 #include "SemaResult.h"
@@ -6,16 +7,23 @@
 #include "Types.h"
 #include "ast2/Ast.h"
 #include "ast2/AstNode.h"
+#include "common/Owned.h"
 #include "common/String.h"
+#include "common/Symbol.h"
 #include "common/Vec.h"
 #include "type/Type.h"
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 
 namespace sema
 {
 
+class ModuleInterface;
+
 struct SwitchContext
 {
 	TypeInstance cond_expr_type;
@@ -28,9 +36,24 @@ struct SwitchContext
 class Sema2
 {
 	using TagType = SemaTag;
+	using TypeArgs = std::unordered_map<ast::AstNode const*, ast::AstList<ast::AstNode*>*>;
+
+	// Shared with the body workers of this Sema2, see Sema2(Sema2 const&, BodyWorker).
+	std::shared_ptr<Types> types_;
+	std::shared_ptr<Generics> generics_;
+	// Type arguments from every Ast being analysed.
+	std::shared_ptr<TypeArgs> type_args_;
 
-	Vec<Scope> scopes;
-	Scope* current_scope = nullptr;
+	// Interfaces of other modules, see ModuleInterface. Shared with the body workers.
+	std::shared_ptr<Vec<std::shared_ptr<ModuleInterface const>>> interfaces_;
+	// Declarations materialized from the interfaces. Looked up after the scopes, so the
+	// declarations of this module shadow them.
+	std::unordered_map<Symbol, TypeInstance> imported_values_;
+	std::unordered_map<Symbol, Type const*> imported_types_;
+
+	ScopeStack scopes;
+	bool body_worker_ = false;
+	bool deferred_ = false;
 
 	// We must track the current module so we can emit
 	// generated functions.
@@ -39,13 +62,85 @@ class Sema2
 
 	std::optional<SwitchContext> switch_context_;
 
+	// IR made by this Sema2, freed with it. A body worker hands its IR over to the module's
+	// Sema2 when it is destroyed, since the results of its bodies outlive it.
+	struct HandedIR
+	{
+		std::mutex mutex;
+		Owned ir;
+	};
+	Owned ir_;
+	std::shared_ptr<HandedIR> handed_ir_;
+
+	template<typename T>
+	T* own(T* object)
+	{
+		return ir_.own(object);
+	}
+
 public:
-	Types types;
-	Sema2();
+	Types& types;
+	Generics& generics;
+	Sema2(ast::Ast const& ast);
+
+	struct BodyWorker
+	{};
+
+	/**
+	 * @brief Checks fn bodies on another thread. Shares the types, generics and type
+	 * arguments of 'module', which must not change while workers run, and starts with
+	 * a copy of its module scope.
+	 *
+	 * Generic instantiation changes the shared types, so a worker does not instantiate.
+	 * It defers the body instead, see defer_to_serial().
+	 */
+	Sema2(Sema2 const& module, BodyWorker);
+	~Sema2();
+
+	bool is_body_worker() const { return body_worker_; }
 
-	Scope* push_scope();
+	/**
+	 * @brief Marks the body being checked by a worker as needing the module's Sema2.
+	 * Returns the error that unwinds the worker.
+	 */
+	SemaError defer_to_serial();
+	bool deferred() const { return deferred_; }
+	void clear_deferred() { deferred_ = false; }
+
+	/**
+	 * @brief Makes the nodes of another file's Ast available for analysis.
+	 */
+	void add_ast(ast::Ast const& ast);
+
+	/**
+	 * @brief Makes the declarations of another module available. Each is materialized
+	 * the first time a lookup misses its name.
+	 */
+	void add_interface(std::shared_ptr<ModuleInterface const> interface);
+	void add_imported_value(Symbol name, TypeInstance type);
+	void add_imported_type(Type const* type);
+
+	void push_scope();
+	void push_isolated_scope();
 	void pop_scope();
-	void add_value_identifier(String const& name, TypeInstance id);
+	/**
+	 * @brief Pops back to the module scope, e.g. after a body failed to check and left
+	 * its scopes open.
+	 */
+	void reset_to_module_scope();
+
+	/**
+	 * @brief Type arguments of an Id or TypeDeclarator, or null.
+	 */
+	ast::AstList<ast::AstNode*>* type_args(ast::AstNode const* node) const;
+
+	/**
+	 * @brief Queues a top level statement created during analysis, e.g. a generic
+	 * instantiation. They are emitted ahead of the statement being analysed.
+	 */
+	void emit_generated(ir::IRTopLevelStmt* stmt);
+	Vec<ir::IRTopLevelStmt*> take_generated();
+	void add_value_identifier(Symbol name, TypeInstance id);
 	void add_type_identifier(Type const* id);
 
 	std::optional<TypeInstance> get_expected_return();
@@ -60,8 +155,13 @@ public:
 
 	// SemaResult<TypeInstance> expected(ast::AstNode* node, ast::NodeType type);
 
-	std::optional<TypeInstance> lookup_name(String const& name);
-	Type const* lookup_type(String const& name);
+	std::optional<TypeInstance> lookup_name(Symbol name);
+	Type const* lookup_type(Symbol name);
+
+private:
+	bool import(Symbol name);
+
+public:
 
 	Vec<ir::IRDesignator*>* create_designator_list();
 	Vec<ir::IRTopLevelStmt*>* create_tlslist();
@@ -71,6 +171,7 @@ public:
 	Vec<ir::IRStmt*>* create_slist();
 	Vec<ir::IRExpr*>* create_elist();
 	Vec<ir::IRParam*>* create_argslist();
+	Vec<String*>* create_name_parts();
 	String* create_name(char const* s, int size);
 
 	ir::IRModule* Module(ast::AstNode* node, Vec<ir::IRTopLevelStmt*>* stmts);
@@ -87,7 +188,9 @@ public:
 		String* name,
 		Vec<ir::IRParam*>* args,
 		ir::IRTypeDeclaraor* rt,
-		Type const* fn_type);
+		Type const* fn_type,
+		ast::AttributeSet attributes,
+		bool is_async);
 	ir::IRBlock* Block(ast::AstNode* node, Vec<ir::IRStmt*>* stmts);
 	ir::IRReturn* Return(ast::AstNode* node, ir::IRExpr* expr);
 	ir::IRValueDecl* ValueDecl(ast::AstNode* node, String* name, ir::IRTypeDeclaraor* rt);
@@ -102,6 +205,7 @@ public:
 	ir::IRExpr* Expr(ir::IRIndirectMemberAccess*);
 	ir::IRExpr* Expr(ir::IRAddressOf*);
 	ir::IRExpr* Expr(ir::IRDeref*);
+	ir::IRExpr* Expr(ir::IRAwait*);
 	ir::IRExpr* Expr(ir::IRArrayAccess*);
 	ir::IRExpr* Expr(ir::IREmpty*);
 	ir::IRExpr* Expr(ir::IRIs*);
@@ -123,7 +227,11 @@ public:
 	ir::IRStringLiteral*
 	StringLiteral(ast::AstNode* node, TypeInstance type_instance, String* name);
 	ir::IRId*
-	Id(ast::AstNode* node, Vec<String*>* name_parts, sema::TypeInstance type, bool is_type_id);
+	Id(ast::AstNode* node,
+	   Vec<String*>* name_parts,
+	   Symbol name,
+	   sema::TypeInstance type,
+	   bool is_type_id);
 	ir::IRSwitch* Switch(ast::AstNode* node, ir::IRExpr* expr, ir::IRBlock* block);
 	ir::IRCase* CaseDefault(ast::AstNode* node, ir::IRStmt* stmt);
 	ir::IRCase* Case(ast::AstNode* node, long long expr, ir::IRStmt* stmt);
@@ -154,10 +262,11 @@ public:
 	ir::IRVarArg* VarArg(ast::AstNode*);
 	ir::IRAddressOf* AddressOf(ast::AstNode*, ir::IRExpr* expr, sema::TypeInstance);
 	ir::IRDeref* Deref(ast::AstNode*, ir::IRExpr* expr, sema::TypeInstance);
+	ir::IRAwait* Await(ast::AstNode*, Vec<ir::IRExpr*>* futures, sema::TypeInstance);
 	ir::IREmpty* Empty(ast::AstNode*, sema::TypeInstance);
 	ir::IRArrayAccess*
 	ArrayAcess(ast::AstNode*, ir::IRExpr* array_target, ir::IRExpr* expr, sema::TypeInstance);
-	ir::IRParam* IRParam(ast::AstNode*, ir::IRValueDecl* decl);
+	ir::IRParam* IRParam(ast::AstNode*, ir::IRValueDecl* decl, ast::AttributeSet attributes);
 	ir::IRParam* IRParam(ast::AstNode*, ir::IRVarArg* var_arg);
 	ir::IRFor*
 	For(ast::AstNode*, ir::IRExpr* condition, ir::IRStmt* init, ir::IRStmt* end, ir::IRStmt* body);
@@ -4,9 +4,16 @@
 
 #include "ast2/AstCasts.h"
 #include "lowering/lower_for.h"
+#include "sema/sema_generics.h"
 #include "sema/sema_id.h"
+#include "FlatIR.h"
 #include "sema_expected.h"
 
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <unordered_map>
+
 using namespace sema;
 using namespace ir;
 using namespace ast;
@@ -18,39 +25,16 @@ NotImpl()
 }
 
 static String*
-to_single_name(Sema2& sema, AstList<String*>* list)
+to_name(Sema2& sema, Symbol symbol)
 {
-	auto name = sema.create_name("", 0);
-
-	bool first = true;
-	for( auto part : list )
-	{
-		if( !first )
-			*name += "#";
-		*name += *part;
-
-		first = false;
-	}
-
-	return name;
+	auto const& name = symbol.str();
+	return sema.create_name(name.c_str(), name.size());
 }
 
 static String
 idname(AstId id)
 {
-	auto name = String();
-
-	bool first = true;
-	for( auto part : id.name_parts )
-	{
-		if( !first )
-			name += "#";
-		name += *part;
-
-		first = false;
-	}
-
-	return name;
+	return id.name.str();
 }
 
 static SemaResult<String*>
@@ -61,7 +45,7 @@ as_name(Sema2& sema, ast::AstNode* ast)
 		return idr;
 	auto id = idr.unwrap();
 
-	return to_single_name(sema, id.name_parts);
+	return to_name(sema, id.name);
 }
 
 static bool
@@ -72,6 +56,19 @@ compatible_binop_int_types(Sema2& sema, sema::TypeInstance lhs, sema::TypeInstan
 
 SemaResult<IRModule*>
 sema::sema_module(Sema2& sema, AstNode* node)
+{
+	auto declaredr = sema_declarations(sema, node);
+	if( !declaredr.ok() )
+		return declaredr;
+
+	Vec<DeclaredModule> modules;
+	modules.push_back(declaredr.unwrap());
+
+	return sema_bodies(sema, modules, nullptr);
+}
+
+SemaResult<DeclaredModule>
+sema::sema_declarations(Sema2& sema, AstNode* node)
 {
 	auto result = expected(node, ast::as_module);
 	if( !result.ok() )
@@ -79,18 +76,220 @@ sema::sema_module(Sema2& sema, AstNode* node)
 
 	auto mod = node->data.mod;
 
-	auto stmts = sema.create_tlslist();
-
+	DeclaredModule declared{node, {}};
 	for( auto statement : mod.statements )
 	{
-		auto statement_result = sema_tls(sema, statement);
-		if( !statement_result.ok() )
-			return statement_result;
+		auto genericr = sema_generic_decl(sema, statement);
+		if( !genericr.ok() )
+			return genericr;
+		if( genericr.unwrap() )
+			continue;
+
+		DeclaredItem item{statement};
+		if( statement->type == NodeType::Fn )
+		{
+			auto protor = sema_fn_proto(sema, statement->data.fn.prototype);
+			if( !protor.ok() )
+				return protor;
+
+			item.proto = protor.unwrap();
+		}
+		else
+		{
+			auto statement_result = sema_tls(sema, statement);
+			if( !statement_result.ok() )
+				return statement_result;
+
+			item.stmt = statement_result.unwrap();
+		}
+
+		item.generated = sema.take_generated();
+		declared.items.push_back(std::move(item));
+	}
+
+	return declared;
+}
+
+namespace
+{
+struct BodyJob
+{
+	DeclaredItem* item;
+	std::optional<SemaResult<IRFunction*>> result;
+	bool deferred = false;
+	bool reached = false;
+};
+} // namespace
+
+static void
+sema_body_jobs(Sema2& sema, BodyJob* const* begin, BodyJob* const* end)
+{
+	std::optional<Sema2> worker;
+	for( auto iter = begin; iter != end; iter++ )
+	{
+		auto job = *iter;
+		if( !worker )
+			worker.emplace(sema, Sema2::BodyWorker{});
+
+		job->result.emplace(sema_fn_body(*worker, job->item->node, job->item->proto));
+		job->deferred = worker->deferred();
+
+		// A failed body can leave its scopes on the stack.
+		if( job->deferred || !job->result->ok() )
+			worker.reset();
+	}
+}
+
+/**
+ * @brief Checks the bodies of 'wave', which is in source order. Returns the first
+ * error in that order.
+ */
+static SemaResult<bool>
+sema_body_wave(Sema2& sema, Vec<BodyJob*> const& wave, TaskPool* pool)
+{
+	if( pool != nullptr && !wave.empty() )
+	{
+		// A few chunks per thread, so a thread that draws large bodies does not hold
+		// up the rest. Each chunk copies the module scope once.
+		unsigned int const chunks = (pool->size() + 1) * 4;
+		unsigned int const chunk_size = (wave.size() + chunks - 1) / chunks;
+
+		std::atomic<unsigned int> remaining{0};
+		for( unsigned int begin = 0; begin < wave.size(); begin += chunk_size )
+		{
+			auto end = std::min<unsigned int>(begin + chunk_size, wave.size());
+			remaining.fetch_add(1);
+			pool->spawn(
+				[&sema, &remaining, first = &wave[begin], last = wave.data() + end]() {
+					sema_body_jobs(sema, first, last);
+					remaining.fetch_sub(1, std::memory_order_release);
+				});
+		}
+
+		pool->run_until([&remaining]() { return remaining.load(std::memory_order_acquire) == 0; });
+	}
+
+	for( auto job : wave )
+	{
+		if( !job->result || job->deferred )
+		{
+			job->result.emplace(sema_fn_body(sema, job->item->node, job->item->proto));
+			auto generated = sema.take_generated();
+			job->item->generated.insert(
+				job->item->generated.end(), generated.begin(), generated.end());
+		}
+
+		if( !job->result->ok() )
+			return std::move(*job->result);
 
-		stmts->push_back(statement_result.unwrap());
+		job->item->stmt = sema.TLS(job->result->unwrap());
 	}
 
-	return sema.Module(node, stmts);
+	return true;
+}
+
+/**
+ * @brief Names referenced by the body of 'fn' and of the instantiations it generated.
+ */
+static void
+collect_references(DeclaredItem const& item, Vec<Symbol>& names)
+{
+	auto collect = [&names](IRFunction const* fn) {
+		for( auto const& expr : fn->body->exprs )
+		{
+			if( expr.type == IRExprType::Id )
+				names.push_back(expr.data.symbol);
+		}
+	};
+
+	collect(item.stmt->stmt.fn);
+	for( auto generated : item.generated )
+	{
+		if( generated->type == IRTopLevelType::Function )
+			collect(generated->stmt.fn);
+	}
+}
+
+SemaResult<IRModule*>
+sema::sema_bodies(
+	Sema2& sema, Vec<DeclaredModule>& modules, TaskPool* pool, Vec<Symbol> const* roots)
+{
+	Vec<BodyJob> jobs;
+	for( auto& module : modules )
+	{
+		for( auto& item : module.items )
+		{
+			if( item.proto != nullptr )
+				jobs.push_back(BodyJob{&item});
+		}
+	}
+
+	Vec<BodyJob*> wave;
+	std::unordered_map<Symbol, BodyJob*> fns;
+	if( roots == nullptr )
+	{
+		for( auto& job : jobs )
+			wave.push_back(&job);
+	}
+	else
+	{
+		for( auto& job : jobs )
+			fns.emplace(Symbol::intern(*job.item->proto->name), &job);
+
+		for( auto root : *roots )
+		{
+			auto iter = fns.find(root);
+			if( iter == fns.end() )
+				return SemaError("Root '" + root.str() + "' is not a declared fn.");
+
+			if( !iter->second->reached )
+			{
+				iter->second->reached = true;
+				wave.push_back(iter->second);
+			}
+		}
+	}
+
+	while( !wave.empty() )
+	{
+		std::sort(wave.begin(), wave.end());
+		auto waver = sema_body_wave(sema, wave, pool);
+		if( !waver.ok() )
+			return waver;
+
+		if( roots == nullptr )
+			break;
+
+		Vec<Symbol> names;
+		for( auto job : wave )
+			collect_references(*job->item, names);
+
+		wave.clear();
+		for( auto name : names )
+		{
+			auto iter = fns.find(name);
+			if( iter != fns.end() && !iter->second->reached )
+			{
+				iter->second->reached = true;
+				wave.push_back(iter->second);
+			}
+		}
+	}
+
+	auto stmts = sema.create_tlslist();
+	for( auto& module : modules )
+	{
+		for( auto& item : module.items )
+		{
+			// An instantiation is generated once, by the first item to use it, so it
+			// is kept even if that item is an unreached fn.
+			stmts->insert(stmts->end(), item.generated.begin(), item.generated.end());
+			if( item.stmt != nullptr )
+				stmts->push_back(item.stmt);
+		}
+	}
+
+	return sema.Module(modules.empty() ? nullptr : modules[0].node, stmts);
 }
 
 SemaResult<IRTopLevelStmt*>
@@ -303,7 +502,8 @@ sema_if_arrow(Sema2& sema, Vec<ir::IRIs*>* discriminations, ast::AstNode* ast)
 				" != " + sema::to_string(decl_param->type_decl->type_instance));
 
 		args->push_back(parsed_param);
-		sema.add_value_identifier(*decl_param->name, decl_param->type_decl->type_instance);
+		sema.add_value_identifier(
+			Symbol::intern(*decl_param->name), decl_param->type_decl->type_instance);
 		ind++;
 	}
 
@@ -484,6 +684,30 @@ sema::sema_struct_tls(Sema2& sema, ast::AstNode* ast)
 	return sema_value_decl(sema, ast);
 }
 
+static bool
+is_owned_future(TypeInstance type)
+{
+	return type.indirection_level == 0 && !type.is_array_type() && type.type->is_future_type();
+}
+
+static SemaResult<ir::IRExpr*>
+sema_id_expr(Sema2& sema, ast::AstNode* ast)
+{
+	auto litr = sema_id(sema, ast);
+	if( !litr.ok() )
+		return litr;
+	auto idt = litr.unwrap();
+	switch( idt.type )
+	{
+	case sema_id_t::Type::Id:
+		return sema.Expr(idt.id);
+	case sema_id_t::Type::Initializer:
+		return sema.Expr(idt.initializer);
+	}
+
+	return NotImpl();
+}
+
 SemaResult<ir::IRExpr*>
 sema::sema_expr_any(Sema2& sema, ast::AstNode* expr_node)
 {
@@ -523,17 +747,17 @@ sema::sema_expr_any(Sema2& sema, ast::AstNode* expr_node)
 	}
 	case NodeType::Id:
 	{
-		auto litr = sema_id(sema, expr_node);
-		if( !litr.ok() )
-			return litr;
-		auto idt = litr.unwrap();
-		switch( idt.type )
-		{
-		case sema_id_t::Type::Id:
-			return sema.Expr(idt.id);
-		case sema_id_t::Type::Initializer:
-			return sema.Expr(idt.initializer);
-		}
+		auto idr = sema_id_expr(sema, expr_node);
+		if( !idr.ok() )
+			return idr;
+		auto id = idr.unwrap();
+
+		// A future owns its frame and awaiting it frees the frame, so a copy would be
+		// left dangling. Future variables are only read by await, see sema_await.
+		if( is_owned_future(id->type_instance) )
+			return SemaError("A future can only be awaited, it cannot be copied or reassigned.");
+
+		return id;
 	}
 	case NodeType::Expr:
 	{
@@ -587,6 +811,14 @@ sema::sema_expr_any(Sema2& sema, ast::AstNode* expr_node)
 
 		return sema.Expr(litr.unwrap());
 	}
+	case NodeType::Await:
+	{
+		auto litr = sema_await(sema, expr_node);
+		if( !litr.ok() )
+			return litr;
+
+		return sema.Expr(litr.unwrap());
+	}
 	case NodeType::Is:
 	{
 		auto litr = sema_is(sema, expr_node);
@@ -631,7 +863,8 @@ inject_function_args(sema::Sema2& sema, Vec<ir::IRParam*>& args)
 		if( arg->type == ir::IRParamType::ValueDecl )
 		{
 			auto value_decl = arg->data.value_decl;
-			sema.add_value_identifier(*value_decl->name, value_decl->type_decl->type_instance);
+			sema.add_value_identifier(
+				Symbol::intern(*value_decl->name), value_decl->type_decl->type_instance);
 		}
 	}
 }
@@ -647,16 +880,29 @@ sema::sema_fn(Sema2& sema, ast::AstNode* ast)
 	auto protor = sema_fn_proto(sema, fn.prototype);
 	if( !protor.ok() )
 		return protor;
-	auto proto = protor.unwrap();
+
+	return sema_fn_body(sema, ast, protor.unwrap());
+}
+
+SemaResult<ir::IRFunction*>
+sema::sema_fn_body(Sema2& sema, ast::AstNode* ast, ir::IRProto* proto)
+{
+	auto fnr = expected(ast, ast::as_fn);
+	if( !fnr.ok() )
+		return fnr;
+	auto fn = fnr.unwrap();
 
 	auto maybe_return_type = proto->fn_type->get_return_type();
 	assert(
 		maybe_return_type.has_value() &&
 		"Function prototype did not provide return type. (Missing infer?)");
 
+	// Async fns return their result through the future.
+	auto return_type = proto->is_async ? proto->rt->type_instance : maybe_return_type.value();
+
 	sema.push_scope();
 	inject_function_args(sema, *proto->args);
-	sema.set_expected_return(maybe_return_type.value());
+	sema.set_expected_return(return_type);
 	auto bodyr = sema_block(sema, fn.body, false);
 	if( !bodyr.ok() )
 		return bodyr;
@@ -675,17 +921,30 @@ sema::sema_fn_args(Sema2& sema, ast::AstNode* ast, sema::Type const& fn_type)
 	auto args = argsr.unwrap();
 
 	auto argslist = sema.create_elist();
-	int arg_count = 0;
 	for( auto argexpr : args.exprs )
 	{
-		if( arg_count >= fn_type.get_member_count() && !fn_type.is_var_arg() )
+		if( argslist->size() >= fn_type.get_member_count() && !fn_type.is_var_arg() )
 			return SemaError("Too many arguments!");
 
 		auto exprr = sema_expr(sema, argexpr);
 		if( !exprr.ok() )
 			return exprr;
 
-		auto expr = exprr.unwrap();
+		argslist->push_back(exprr.unwrap());
+	}
+
+	return sema_fn_args(sema, ast, argslist, fn_type);
+}
+
+SemaResult<ir::IRArgs*>
+sema::sema_fn_args(
+	Sema2& sema, ast::AstNode* ast, Vec<ir::IRExpr*>* argslist, sema::Type const& fn_type)
+{
+	int arg_count = 0;
+	for( auto expr : *argslist )
+	{
+		if( arg_count >= fn_type.get_member_count() && !fn_type.is_var_arg() )
+			return SemaError("Too many arguments!");
 
 		if( arg_count < fn_type.get_member_count() )
 		{
@@ -693,8 +952,6 @@ sema::sema_fn_args(Sema2& sema, ast::AstNode* ast, sema::Type const& fn_type)
 				return SemaError("Mismatched argument type.");
 		}
 
-		argslist->push_back(exprr.unwrap());
-
 		arg_count += 1;
 	}
 
@@ -720,6 +977,10 @@ sema::sema_fn_call(Sema2& sema, ast::AstNode* ast)
 		return fn_callr;
 	auto fn_call = fn_callr.unwrap();
 
+	auto generic = generic_call_decl(sema, fn_call.call_target);
+	if( generic )
+		return sema_generic_fn_call(sema, ast, generic);
+
 	auto call_targetr = sema_expr(sema, fn_call.call_target);
 	if( !call_targetr.ok() )
 		return call_targetr;
@@ -868,6 +1129,54 @@ sema::sema_deref(Sema2& sema, ast::AstNode* ast)
 	return sema.Deref(ast, expr, expr->type_instance.PointerElementType());
 }
 
+/**
+ * @brief Like sema_expr, but a future variable may be named directly.
+ */
+static SemaResult<ir::IRExpr*>
+sema_await_operand(Sema2& sema, ast::AstNode* ast)
+{
+	auto exprr = expected(ast, ast::as_expr);
+	if( !exprr.ok() )
+		return exprr;
+	auto expr_node = exprr.unwrap().expr;
+
+	if( expr_node->type == NodeType::Id )
+		return sema_id_expr(sema, expr_node);
+
+	return sema_expr_any(sema, expr_node);
+}
+
+SemaResult<ir::IRAwait*>
+sema::sema_await(Sema2& sema, ast::AstNode* ast)
+{
+	auto awaitr = expected(ast, ast::as_await);
+	if( !awaitr.ok() )
+		return awaitr;
+	auto await_node = awaitr.unwrap();
+
+	auto futures = sema.create_elist();
+	for( auto future_node : await_node.futures )
+	{
+		auto exprr = sema_await_operand(sema, future_node);
+		if( !exprr.ok() )
+			return exprr;
+		auto expr = exprr.unwrap();
+
+		auto type = expr->type_instance;
+		if( type.indirection_level != 0 || type.is_array_type() || !type.type->is_future_type() )
+			return SemaError("Cannot await '" + to_string(type) + "'. Expected a future.");
+
+		futures->push_back(expr);
+	}
+
+	// Awaiting several futures only waits for them. Their results are taken by awaiting
+	// each one.
+	auto type = futures->size() == 1 ? futures->front()->type_instance.type->future_result_type()
+									 : sema.types.VoidType();
+
+	return sema.Await(ast, futures, type);
+}
+
 SemaResult<ir::IRReturn*>
 sema::sema_return(Sema2& sema, ast::AstNode* ast)
 {
@@ -947,7 +1256,7 @@ sema::sema_let(Sema2& sema, ast::AstNode* ast)
 		type_declr->type_instance =
 			sema.types.non_inferred(type_declr->type_instance, rhs->type_instance);
 
-		sema.add_value_identifier(*name, type_declr->type_instance);
+		sema.add_value_identifier(Symbol::intern(*name), type_declr->type_instance);
 		auto lhs_expr = sema.Expr(sema.ValueDecl(let.identifier, name, type_declr));
 		return sema.Let(ast, name, sema.Assign(ast, ast::AssignOp::assign, lhs_expr, rhs));
 	}
@@ -957,7 +1266,7 @@ sema::sema_let(Sema2& sema, ast::AstNode* ast)
 			return SemaError("Cannot declare untyped variable without initialization "
 							 "expression.");
 
-		sema.add_value_identifier(*name, type_declr->type_instance);
+		sema.add_value_identifier(Symbol::intern(*name), type_declr->type_instance);
 		return sema.LetEmpty(ast, name, type_declr->type_instance);
 	}
 }
@@ -1012,7 +1321,7 @@ sema_enum_case(Sema2& sema, ast::AstNode* ast, ast::AstCase& case_node)
 		return SemaError("Case labels can only contain enum member ids.");
 
 	auto id_node = case_node.const_expr->data.id;
-	auto const_name = sema.lookup_type(idname(id_node));
+	auto const_name = sema.lookup_type(id_node.name);
 	if( !const_name )
 		return SemaError("Unrecognized case label.");
 
@@ -1056,7 +1365,8 @@ sema_enum_case(Sema2& sema, ast::AstNode* ast, ast::AstCase& case_node)
 					" != " + sema::to_string(decl_param->type_decl->type_instance));
 
 			args->push_back(parsed_param);
-			sema.add_value_identifier(*decl_param->name, decl_param->type_decl->type_instance);
+			sema.add_value_identifier(
+				Symbol::intern(*decl_param->name), decl_param->type_decl->type_instance);
 		}
 
 		auto stmt = sema_block(sema, ifarrow.block, false);
@@ -1375,8 +1685,14 @@ sema::sema_fn_param(Sema2& sema, ast::AstNode* ast)
 		auto value_declr = sema_value_decl(sema, ast);
 		if( !value_declr.ok() )
 			return value_declr;
+		auto value_decl = value_declr.unwrap();
 
-		return sema.IRParam(ast, value_declr.unwrap());
+		auto maybe_attributes = ast->data.value_decl.attributes;
+		auto attributes = maybe_attributes ? *maybe_attributes : ast::AttributeSet::None();
+		if( !attributes.empty() && !value_decl->type_decl->type_instance.is_pointer_type() )
+			return SemaError("Parameter attributes can only be applied to pointer parameters.");
+
+		return sema.IRParam(ast, value_decl, attributes);
 	}
 	case AstVarArg::nt:
 		return sema.IRParam(ast, sema.VarArg(ast));
@@ -1396,9 +1712,24 @@ sema::sema_fn_proto(Sema2& sema, ast::AstNode* ast)
 	auto idr = expected(fn_proto.name, ast::as_id);
 	if( !idr.ok() )
 		return idr;
-	auto id = idr.unwrap();
 
-	auto name = to_single_name(sema, id.name_parts);
+	return sema_fn_proto(sema, ast, idr.unwrap().name);
+}
+
+SemaResult<ir::IRProto*>
+sema::sema_fn_proto(Sema2& sema, ast::AstNode* ast, Symbol symbol)
+{
+	auto fn_protor = expected(ast, ast::as_fn_proto);
+	if( !fn_protor.ok() )
+		return fn_protor;
+	auto fn_proto = fn_protor.unwrap();
+
+	// The fn type is added under the name of the fn, which would hide the type.
+	auto shadowed = sema.lookup_type(symbol);
+	if( shadowed && !shadowed->is_function_type() )
+		return SemaError("'" + symbol.str() + "' is the name of a type, not a fn.");
+
+	auto name = to_name(sema, symbol);
 
 	auto argsr = expected(fn_proto.params, ast::as_fn_param_list);
 	if( !argsr.ok() )
@@ -1424,16 +1755,24 @@ sema::sema_fn_proto(Sema2& sema, ast::AstNode* ast)
 
 	auto rt = rt_type_declr.unwrap();
 
+	// Calling an async fn creates the coroutine and returns a future of its result.
+	auto call_result_type = rt->type_instance;
+	if( fn_proto.is_async )
+		call_result_type = TypeInstance::OfType(sema.types.future_type(rt->type_instance));
+
 	auto membersr = params_to_members(argslist);
 	if( !membersr.ok() )
 		return membersr;
 	auto members = membersr.unwrap();
 	auto fn_type =
-		sema.CreateType(Type::Function(*name, members.vec, rt->type_instance, is_var_arg));
+		sema.CreateType(Type::Function(*name, members.vec, call_result_type, is_var_arg));
 	sema.add_type_identifier(fn_type);
-	sema.add_value_identifier(*name, TypeInstance::OfType(fn_type));
+	sema.add_value_identifier(symbol, TypeInstance::OfType(fn_type));
 
-	return sema.Proto(ast, name, argslist, rt, fn_type);
+	auto attributes =
+		fn_proto.attributes ? *fn_proto.attributes : ast::AttributeSet::None();
+
+	return sema.Proto(ast, name, argslist, rt, fn_type, attributes, fn_proto.is_async);
 }
 
 struct unpack_struct_node_t
@@ -1474,14 +1813,27 @@ unpack_struct_node(Sema2& sema, ast::AstNode* ast)
 
 SemaResult<ir::IRStruct*>
 sema::sema_struct(Sema2& sema, ast::AstNode* ast)
+{
+	auto structr = expected(ast, ast::as_struct);
+	if( !structr.ok() )
+		return structr;
+
+	auto idr = expected(structr.unwrap().type_name, ast::as_id);
+	if( !idr.ok() )
+		return idr;
+
+	return sema_struct(sema, ast, idname(idr.unwrap()));
+}
+
+SemaResult<ir::IRStruct*>
+sema::sema_struct(Sema2& sema, ast::AstNode* ast, String const& name)
 {
 	auto structr = unpack_struct_node(sema, ast);
 	if( !structr.ok() )
 		return structr;
 	auto unpacked = structr.unwrap();
 
-	auto fn_type =
-		sema.CreateType(Type::Struct(idname(unpacked.name), members_to_members(*unpacked.members)));
+	auto fn_type = sema.CreateType(Type::Struct(name, members_to_members(*unpacked.members)));
 	sema.add_type_identifier(fn_type);
 
 	return sema.Struct(ast, fn_type, unpacked.members);
@@ -1496,14 +1848,19 @@ sema::sema_initializer(Sema2& sema, ast::AstNode* ast)
 		return initializerr;
 	auto initializer = initializerr.unwrap();
 	// TODO: Somehow expect id??
-	auto type_namer = as_name(sema, initializer.type_name->data.expr.expr);
-	if( !type_namer.ok() )
-		return type_namer;
-	auto type_name = type_namer.unwrap();
+	auto type_id_node = initializer.type_name->data.expr.expr;
+	auto idr = expected(type_id_node, ast::as_id);
+	if( !idr.ok() )
+		return idr;
 
-	auto initializer_type = sema.lookup_type(*type_name);
-	if( !initializer_type )
-		return SemaError("Initializer for unknown type.");
+	auto initializer_typer = sema_type_name(sema, type_id_node, idr.unwrap().name);
+	if( !initializer_typer.ok() )
+		return initializer_typer;
+	auto initializer_instance = initializer_typer.unwrap();
+	if( initializer_instance.is_pointer_type() || initializer_instance.is_array_type() )
+		return SemaError("Initializer for non-struct type '" + to_string(initializer_instance) + "'.");
+	auto initializer_type = initializer_instance.type;
+	auto type_name = to_name(sema, Symbol::intern(initializer_type->get_name()));
 
 	auto designators = sema.create_designator_list();
 
@@ -1714,17 +2071,23 @@ sema::sema_type_decl(Sema2& sema, ast::AstNode* ast)
 
 	if( !type_decl.empty )
 	{
-		// TODO: Leaks
-		auto type = sema.lookup_type(*to_single_name(sema, type_decl.name));
+		auto typer = sema_type_name(sema, ast, type_decl.symbol);
+		if( !typer.ok() )
+			return typer;
 
-		// TODO: Leaks
-		if( !type )
-			return SemaError("Could not find type '" + *to_single_name(sema, type_decl.name) + "'");
-
-		auto type_instance = TypeInstance::PointerTo(type, type_decl.indirection_level);
+		// A type parameter may be bound to a pointer or array type.
+		auto type_instance = typer.unwrap();
+		if( type_decl.indirection_level > 0 )
+		{
+			if( type_instance.is_array_type() )
+				return SemaError("Pointers to arrays are not supported.");
+			type_instance = type_instance.PointerTo(type_decl.indirection_level);
+		}
 
 		if( type_decl.array_size > 0 )
 		{
+			if( type_instance.is_array_type() )
+				return SemaError("Arrays of arrays are not supported.");
 			type_instance = TypeInstance::ArrayOf(type_instance, type_decl.array_size);
 		}
 
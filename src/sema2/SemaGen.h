@@ -7,11 +7,52 @@
 #include "SemaResult.h"
 #include "ast2/Ast.h"
 #include "ast2/AstCasts.h"
+#include "common/TaskPool.h"
 
 namespace sema
 {
 
+/**
+ * @brief A top level statement after sema_declarations. Fns only have their
+ * prototype until sema_bodies checks the body.
+ */
+struct DeclaredItem
+{
+	ast::AstNode* node;
+	ir::IRTopLevelStmt* stmt = nullptr;
+	ir::IRProto* proto = nullptr;
+	// Must be defined before the item, e.g. instantiations it uses.
+	Vec<ir::IRTopLevelStmt*> generated;
+};
+
+struct DeclaredModule
+{
+	ast::AstNode* node;
+	Vec<DeclaredItem> items;
+};
+
 SemaResult<ir::IRModule*> sema_module(Sema2& sema, ast::AstNode* ast);
+
+/**
+ * @brief Analyses everything but fn bodies, and adds each fn to the module scope, so
+ * any body can call any fn of the modules declared before sema_bodies.
+ */
+SemaResult<DeclaredModule> sema_declarations(Sema2& sema, ast::AstNode* ast);
+
+/**
+ * @brief Checks the fn bodies of the modules and returns them as one module.
+ *
+ * Bodies are checked on the pool, if there is one, by workers that share the
+ * declarations of 'sema'. A body that needs a generic instantiated is checked again by
+ * 'sema' afterwards. Errors are reported in source order.
+ *
+ * With 'roots', only the fns reachable from the roots are checked and returned: the
+ * roots first, then each fn their bodies reference, and so on. The other fns keep
+ * just their prototype and never reach codegen. A root that names no fn of the modules
+ * is an error.
+ */
+SemaResult<ir::IRModule*> sema_bodies(
+	Sema2& sema, Vec<DeclaredModule>& modules, TaskPool* pool, Vec<Symbol> const* roots = nullptr);
 SemaResult<ir::IRTopLevelStmt*> sema_tls(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRStmt*> sema_stmt(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRIf*> sema_if(Sema2& sema, ast::AstNode* ast);
@@ -24,7 +65,10 @@ SemaResult<ir::IRExpr*> sema_expr_any(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRExpr*> sema_expr(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRExternFn*> sema_extern_fn(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRFunction*> sema_fn(Sema2& sema, ast::AstNode* ast);
+SemaResult<ir::IRFunction*> sema_fn_body(Sema2& sema, ast::AstNode* ast, ir::IRProto* proto);
 SemaResult<ir::IRArgs*> sema_fn_args(Sema2& sema, ast::AstNode* ast, sema::Type const& fn_type);
+SemaResult<ir::IRArgs*> sema_fn_args(
+	Sema2& sema, ast::AstNode* ast, Vec<ir::IRExpr*>* args, sema::Type const& fn_type);
 SemaResult<ir::IRCall*> sema_fn_call(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRArrayAccess*> sema_array_access(Sema2& sema, ast::AstNode* ast);
 
@@ -32,6 +76,7 @@ SemaResult<ir::IRMemberAccess*> sema_member_access(Sema2& sema, ast::AstNode* as
 SemaResult<ir::IRIndirectMemberAccess*> sema_indirect_member_access(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRAddressOf*> sema_addressof(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRDeref*> sema_deref(Sema2& sema, ast::AstNode* ast);
+SemaResult<ir::IRAwait*> sema_await(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRReturn*> sema_return(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRLet*> sema_let(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRSwitch*> sema_switch(Sema2& sema, ast::AstNode* ast);
@@ -41,7 +86,9 @@ SemaResult<ir::IRBinOp*> sema_binop(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRBlock*> sema_block(Sema2& sema, ast::AstNode* ast, bool new_scope);
 SemaResult<ir::IRParam*> sema_fn_param(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRProto*> sema_fn_proto(Sema2& sema, ast::AstNode* ast);
+SemaResult<ir::IRProto*> sema_fn_proto(Sema2& sema, ast::AstNode* ast, Symbol name);
 SemaResult<ir::IRStruct*> sema_struct(Sema2& sema, ast::AstNode* ast);
+SemaResult<ir::IRStruct*> sema_struct(Sema2& sema, ast::AstNode* ast, String const& name);
 SemaResult<ir::IRInitializer*> sema_initializer(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IRUnion*> sema_union(Sema2& sema, ast::AstNode* ast);
 SemaResult<ir::IREnum*> sema_enum(Sema2& sema, ast::AstNode* ast);
@@ -3,8 +3,75 @@
 // TODO: Fix circular deps.
 #include "type/Type.h"
 
+#include <mutex>
+#include <unordered_map>
+
 using namespace sema;
 
+namespace
+{
+struct TypeKey
+{
+	Type const* type;
+	int indirection_level;
+	// -1 if not an array.
+	int array_size;
+
+	bool operator==(TypeKey const& other) const
+	{
+		return type == other.type && indirection_level == other.indirection_level &&
+			   array_size == other.array_size;
+	}
+};
+
+struct TypeKeyHash
+{
+	std::size_t operator()(TypeKey const& key) const noexcept
+	{
+		auto hash = std::hash<Type const*>{}(key.type);
+		hash = hash * 31 + key.indirection_level;
+		return hash * 31 + key.array_size;
+	}
+};
+
+struct TypeTable
+{
+	std::mutex mutex;
+	std::unordered_map<TypeKey, unsigned int, TypeKeyHash> ids;
+};
+
+TypeTable&
+type_table()
+{
+	static TypeTable table;
+	return table;
+}
+} // namespace
+
+unsigned int
+TypeInstance::intern(Type const* type, int indirection_level, int array_size)
+{
+	// Fn bodies are checked on several threads. Each thread remembers the ids it has
+	// seen, so the shared table is only locked for a type the thread has not used yet.
+	thread_local std::unordered_map<TypeKey, unsigned int, TypeKeyHash> seen;
+
+	TypeKey key{type, indirection_level, array_size};
+	auto iter = seen.find(key);
+	if( iter != seen.end() )
+		return iter->second;
+
+	auto& table = type_table();
+	unsigned int id;
+	{
+		std::lock_guard<std::mutex> lock{table.mutex};
+		// Ids start at 1.
+		id = table.ids.emplace(key, table.ids.size() + 1).first->second;
+	}
+
+	seen.emplace(key, id);
+	return id;
+}
+
 EnumNominal
 TypeInstance::as_nominal() const
 {
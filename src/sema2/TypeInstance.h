@@ -1,9 +1,19 @@
 #pragma once
 #include "type/EnumNominal.h"
 
+#include <functional>
+
 namespace sema
 {
 class Type;
+
+/**
+ * @brief A type with its pointer and array modifiers.
+ *
+ * Every distinct (type, indirection, array size) is interned to a canonical id,
+ * so comparing and hashing are integer operations. The intern table is global
+ * and thread safe like the Symbol table.
+ */
 class TypeInstance
 {
 private:
@@ -11,26 +21,34 @@ private:
 		: type(type)
 		, indirection_level(indir)
 		, is_array_(false)
-		, array_size(0){};
+		, array_size(0)
+		, id_(intern(type, indir, -1)){};
 
 	TypeInstance(Type const* type, int indir, int array_size)
 		: type(type)
 		, indirection_level(indir)
 		, is_array_(true)
-		, array_size(array_size){};
+		, array_size(array_size)
+		, id_(intern(type, indir, array_size)){};
 
 	bool is_array_ = false;
+	// 0 for default constructed instances.
+	unsigned int id_ = 0;
+
+	static unsigned int intern(Type const* type, int indirection_level, int array_size);
 
 public:
 	TypeInstance() = default;
 	int array_size;
 	int indirection_level;
 	Type const* type;
-	bool operator==(const TypeInstance& rhs)
-	{
-		return this->indirection_level == rhs.indirection_level && this->type == rhs.type;
-	}
-	bool operator!=(const TypeInstance& rhs) { return !operator==(rhs); }
+	bool operator==(const TypeInstance& rhs) const { return id_ == rhs.id_; }
+	bool operator!=(const TypeInstance& rhs) const { return id_ != rhs.id_; }
+
+	/**
+	 * @brief Canonical id. Equal types have equal ids.
+	 */
+	unsigned int id() const { return id_; }
 
 	// Enum related
 	EnumNominal as_nominal() const;
@@ -53,4 +71,10 @@ public:
 	static TypeInstance ArrayOf(TypeInstance type, int array_size);
 };
 
-}; // namespace sema
\ No newline at end of file
+}; // namespace sema
+
+template<>
+struct std::hash<sema::TypeInstance>
+{
+	std::size_t operator()(sema::TypeInstance const& type) const noexcept { return type.id(); }
+};
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common/Vec.h"
+
+namespace sema
+{
+
+/**
+ * @brief Storage layout of a type, matching the LLVM types emitted by codegen.
+ */
+struct TypeLayout
+{
+	unsigned int size = 0;
+	unsigned int align = 1;
+	// Byte offset of each member in member order. Structs and enums only.
+	Vec<unsigned int> member_offsets;
+};
+
+/**
+ * @brief Sizes and ABI alignments of the scalar types on the target. Codegen fills it
+ * in from the target's data layout.
+ */
+struct TargetLayout
+{
+	unsigned int pointer_size;
+	unsigned int pointer_align;
+	// Alignment of the integers of 1, 2, 4 and 8 bytes.
+	unsigned int int_align[4];
+};
+
+} // namespace sema
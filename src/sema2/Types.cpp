@@ -2,6 +2,9 @@
 
 #include "Types.h"
 
+#include <algorithm>
+#include <cassert>
+
 using namespace sema;
 
 static char const infer_type_name[] = "@_infer";
@@ -36,7 +39,9 @@ Types::Types()
 Type*
 Types::define_type(Type type)
 {
-	auto emplaced = types.emplace(type.get_name(), type);
+	auto emplaced = types.emplace(Symbol::intern(type.get_name()), type);
+	if( emplaced.second )
+		emplaced.first->second.id_ = next_type_id_++;
 
 	return &emplaced.first->second;
 }
@@ -53,6 +58,12 @@ Types::void_type()
 	return this->void_type_;
 }
 
+Type const*
+Types::i64_type()
+{
+	return this->i64_type_;
+}
+
 Type const*
 Types::i32_type()
 {
@@ -71,6 +82,12 @@ Types::i8_type()
 	return this->i8_type_;
 }
 
+Type const*
+Types::u64_type()
+{
+	return this->u64_type_;
+}
+
 Type const*
 Types::u32_type()
 {
@@ -95,6 +112,13 @@ Types::bool_type()
 	return this->bool_type_;
 }
 
+Type const*
+Types::future_type(TypeInstance result_type)
+{
+	// Types are keyed by name, so this defines each future type once.
+	return define_type(Type::Future("future<" + to_string(result_type) + ">", result_type));
+}
+
 bool
 Types::equal_types(TypeInstance l, TypeInstance r)
 {
@@ -150,6 +174,149 @@ Types::non_inferred(TypeInstance l, TypeInstance r)
 	assert(false);
 }
 
+static unsigned int
+align_to(unsigned int offset, unsigned int align)
+{
+	return (offset + align - 1) / align * align;
+}
+
+void
+Types::set_target(TargetLayout const& target)
+{
+	target_ = target;
+	layouts_.clear();
+}
+
+// Index into TargetLayout::int_align of an integer of 'size' bytes.
+static unsigned int
+int_align_index(unsigned int size)
+{
+	switch( size )
+	{
+	case 1:
+		return 0;
+	case 2:
+		return 1;
+	case 4:
+		return 2;
+	default:
+		assert(size == 8);
+		return 3;
+	}
+}
+
+TypeLayout const&
+Types::layout(TypeInstance type)
+{
+	assert(target_.has_value() && "Types::set_target must be called before layout");
+
+	auto id = type.id();
+	if( id >= layouts_.size() )
+		layouts_.resize(id + 1);
+
+	if( !layouts_[id].has_value() )
+	{
+		// Computing may layout members and grow the cache.
+		auto computed = compute_layout(type);
+		layouts_[id] = std::move(computed);
+	}
+
+	return *layouts_[id];
+}
+
+TypeLayout
+Types::compute_layout(TypeInstance type)
+{
+	TypeLayout result;
+
+	if( type.is_array_type() )
+	{
+		auto element = layout(type.ArrayElementType());
+		result.size = element.size * type.array_size;
+		result.align = element.align;
+		return result;
+	}
+
+	// Futures are coroutine handles.
+	if( type.indirection_level > 0 || type.type->is_future_type() )
+	{
+		result.size = target_->pointer_size;
+		result.align = target_->pointer_align;
+		return result;
+	}
+
+	// Enum members without fields are stored as their parent enum.
+	Type const* base = type.type;
+	if( !base->is_struct_type() )
+		base = base->get_dependent_type();
+
+	if( base->is_struct_type() )
+	{
+		for( int i = 0; i < base->get_member_count(); i++ )
+		{
+			auto member = layout(base->get_member(i).type);
+			result.size = align_to(result.size, member.align);
+			result.member_offsets.push_back(result.size);
+			result.size += member.size;
+			result.align = std::max(result.align, member.align);
+		}
+		result.size = align_to(result.size, result.align);
+	}
+	else if( base->is_union_type() )
+	{
+		// Matches codegen, which stores the first largest member.
+		for( int i = 0; i < base->get_member_count(); i++ )
+		{
+			auto member = layout(base->get_member(i).type);
+			if( member.size > result.size )
+			{
+				result.size = member.size;
+				result.align = member.align;
+			}
+		}
+	}
+	else if( base->is_enum_type() )
+	{
+		// { i32 kind, largest payload }
+		TypeLayout payload;
+		for( int i = 0; i < base->get_member_count(); i++ )
+		{
+			auto member_type = base->get_member(i).type;
+			if( !member_type.is_struct_type() )
+				continue;
+
+			auto member = layout(member_type);
+			if( member.size > payload.size )
+				payload = member;
+		}
+
+		result.member_offsets.push_back(0);
+		result.size = 4;
+		result.align = target_->int_align[int_align_index(4)];
+		if( payload.size > 0 )
+		{
+			result.size = align_to(result.size, payload.align);
+			result.member_offsets.push_back(result.size);
+			result.size += payload.size;
+			result.align = std::max(result.align, payload.align);
+		}
+		result.size = align_to(result.size, result.align);
+	}
+	else if( base->int_width() > 0 )
+	{
+		result.size = base->int_width() / 8;
+		result.align = target_->int_align[int_align_index(result.size)];
+	}
+	else if( base == bool_type_ )
+	{
+		result.size = 1;
+		result.align = target_->int_align[int_align_index(1)];
+	}
+
+	// void, infer and function types are not stored by value.
+	return result;
+}
+
 TypeInstance
 Types::BoolType()
 {
@@ -171,5 +338,9 @@ Types::InferType()
 String
 sema::to_string(TypeInstance ty)
 {
-	return ty.type->get_name() + std::string(ty.indirection_level, '*');
+	auto result = ty.type->get_name() + std::string(ty.indirection_level, '*');
+	if( ty.is_array_type() )
+		result += "[" + std::to_string(ty.array_size) + "]";
+
+	return result;
 }
\ No newline at end of file
@@ -3,10 +3,14 @@
 
 #include "MemberTypeInstance.h"
 #include "TypeInstance.h"
+#include "TypeLayout.h"
 #include "common/String.h"
+#include "common/Symbol.h"
+#include "common/Vec.h"
 #include "type/Type.h"
 
-#include <map>
+#include <optional>
+#include <unordered_map>
 
 namespace sema
 {
@@ -26,12 +30,23 @@ private:
 	Type const* u8_type_;
 	Type const* bool_type_;
 
+	unsigned int next_type_id_ = 1;
+	// Indexed by TypeInstance::id
+	Vec<std::optional<TypeLayout>> layouts_;
+	std::optional<TargetLayout> target_;
+
 public:
-	std::map<String, Type> types;
+	// Node based, so Type pointers are stable.
+	std::unordered_map<Symbol, Type> types;
 	Types();
 
 	Type* define_type(Type type);
 
+	/**
+	 * @brief One past the largest Type::id handed out.
+	 */
+	unsigned int type_id_end() const { return next_type_id_; }
+
 	Type const* infer_type();
 	Type const* void_type();
 	Type const* i64_type();
@@ -44,6 +59,12 @@ public:
 	Type const* u8_type();
 	Type const* bool_type();
 
+	/**
+	 * @brief Type of a call to an async fn returning result_type, e.g. future<i32>.
+	 * The same Type for every call with the same result type.
+	 */
+	Type const* future_type(TypeInstance result_type);
+
 	bool equal_types(TypeInstance l, TypeInstance r);
 	bool is_infer_type(TypeInstance l);
 	bool is_integer_type(TypeInstance l);
@@ -52,11 +73,23 @@ public:
 
 	TypeInstance non_inferred(TypeInstance l, TypeInstance r);
 
+	/**
+	 * @brief Must be set before the first call to layout().
+	 */
+	void set_target(TargetLayout const& target);
+
+	/**
+	 * @brief Size, alignment and member offsets of a type on the target. Computed once
+	 * per type.
+	 */
+	TypeLayout const& layout(TypeInstance type);
+
 	TypeInstance BoolType();
 	TypeInstance VoidType();
 	TypeInstance InferType();
 
 private:
+	TypeLayout compute_layout(TypeInstance type);
 };
 
 String to_string(TypeInstance ty);
@@ -0,0 +1,280 @@
+#include "lower_flat.h"
+
+#include <cassert>
+
+using namespace sema;
+using namespace ir;
+
+namespace
+{
+class FlatLowering
+{
+	FlatFunction& flat;
+
+public:
+	FlatLowering(FlatFunction& flat)
+		: flat(flat)
+	{}
+
+	ExprId expr(IRExpr* ir_expr);
+	StmtId stmt(IRStmt* ir_stmt);
+	StmtId block(IRBlock* ir_block);
+
+private:
+	ExprId push(FlatExpr const& flat_expr);
+	StmtId push(FlatStmt const& flat_stmt);
+	StmtId else_stmt(IRElse* ir_else);
+	StmtId assign(IRAssign* ir_assign);
+	FlatRange bindings(Vec<IRParam*>* params);
+	FlatRange extra(Vec<std::uint32_t> const& ids);
+	std::uint32_t member(sema::MemberTypeInstance const& member);
+};
+} // namespace
+
+ExprId
+FlatLowering::push(FlatExpr const& flat_expr)
+{
+	flat.exprs.push_back(flat_expr);
+	return ExprId{static_cast<std::uint32_t>(flat.exprs.size() - 1)};
+}
+
+StmtId
+FlatLowering::push(FlatStmt const& flat_stmt)
+{
+	flat.stmts.push_back(flat_stmt);
+	return StmtId{static_cast<std::uint32_t>(flat.stmts.size() - 1)};
+}
+
+FlatRange
+FlatLowering::extra(Vec<std::uint32_t> const& ids)
+{
+	FlatRange range{static_cast<std::uint32_t>(flat.extra.size()), 0};
+	flat.extra.insert(flat.extra.end(), ids.begin(), ids.end());
+	range.size = ids.size();
+	return range;
+}
+
+std::uint32_t
+FlatLowering::member(sema::MemberTypeInstance const& member)
+{
+	flat.members.push_back(member);
+	return flat.members.size() - 1;
+}
+
+FlatRange
+FlatLowering::bindings(Vec<IRParam*>* params)
+{
+	FlatRange range{static_cast<std::uint32_t>(flat.bindings.size()), 0};
+	if( !params )
+		return range;
+
+	for( auto param : *params )
+	{
+		auto ir_value_decl = param->data.value_decl;
+		flat.bindings.push_back(FlatBinding{
+			Symbol::intern(*ir_value_decl->name), ir_value_decl->type_decl->type_instance});
+	}
+	range.size = params->size();
+	return range;
+}
+
+ExprId
+FlatLowering::expr(IRExpr* ir_expr)
+{
+	FlatExpr flat_expr{ir_expr->type, ir_expr->node, ir_expr->type_instance};
+
+	// Children are lowered first so lists of them are contiguous in extra.
+	switch( ir_expr->type )
+	{
+	case IRExprType::Call:
+	{
+		auto ir_call = ir_expr->expr.call;
+		flat_expr.lhs = expr(ir_call->call_target);
+
+		Vec<std::uint32_t> args;
+		for( auto arg : *ir_call->args->args )
+			args.push_back(expr(arg).index);
+		flat_expr.children = extra(args);
+		break;
+	}
+	case IRExprType::ArrayAccess:
+		flat_expr.lhs = expr(ir_expr->expr.array_access->array_target);
+		flat_expr.rhs = expr(ir_expr->expr.array_access->expr);
+		break;
+	case IRExprType::NumberLiteral:
+		flat_expr.data.number = ir_expr->expr.num_literal->val;
+		break;
+	case IRExprType::StringLiteral:
+		flat.strings.push_back(*ir_expr->expr.str_literal->value);
+		flat_expr.data.index = flat.strings.size() - 1;
+		break;
+	case IRExprType::Id:
+		flat_expr.data.symbol = ir_expr->expr.id->symbol;
+		break;
+	case IRExprType::ValueDecl:
+		flat_expr.data.symbol = Symbol::intern(*ir_expr->expr.decl->name);
+		break;
+	case IRExprType::Is:
+		flat_expr.lhs = expr(ir_expr->expr.is->lhs);
+		flat.types.push_back(ir_expr->expr.is->type_decl->type_instance);
+		flat_expr.data.index = flat.types.size() - 1;
+		break;
+	case IRExprType::Initializer:
+	{
+		Vec<std::uint32_t> designators;
+		for( auto designator : *ir_expr->expr.initializer->initializers )
+		{
+			auto member_index = member(designator->member);
+			designators.push_back(member_index);
+			designators.push_back(expr(designator->expr).index);
+		}
+		flat_expr.children = extra(designators);
+		// Ranges count list elements; designators take two words each.
+		flat_expr.children.size /= 2;
+		break;
+	}
+	case IRExprType::BinOp:
+		flat_expr.data.op = ir_expr->expr.binop->op;
+		flat_expr.lhs = expr(ir_expr->expr.binop->lhs);
+		flat_expr.rhs = expr(ir_expr->expr.binop->rhs);
+		break;
+	case IRExprType::MemberAccess:
+		flat_expr.lhs = expr(ir_expr->expr.member_access->expr);
+		flat_expr.data.index = member(ir_expr->expr.member_access->member);
+		break;
+	case IRExprType::IndirectMemberAccess:
+		flat_expr.lhs = expr(ir_expr->expr.indirect_member_access->expr);
+		flat_expr.data.index = member(ir_expr->expr.indirect_member_access->member);
+		break;
+	case IRExprType::AddressOf:
+		flat_expr.lhs = expr(ir_expr->expr.addr_of->expr);
+		break;
+	case IRExprType::Deref:
+		flat_expr.lhs = expr(ir_expr->expr.deref->expr);
+		break;
+	case IRExprType::Await:
+	{
+		Vec<std::uint32_t> futures;
+		for( auto future : *ir_expr->expr.await_expr->futures )
+			futures.push_back(expr(future).index);
+		flat_expr.children = extra(futures);
+		break;
+	}
+	case IRExprType::Empty:
+		break;
+	}
+
+	return push(flat_expr);
+}
+
+StmtId
+FlatLowering::assign(IRAssign* ir_assign)
+{
+	FlatStmt flat_stmt{IRStmtType::Assign, ir_assign->node};
+	flat_stmt.op = ir_assign->op;
+	flat_stmt.expr = expr(ir_assign->lhs);
+	flat_stmt.rhs = expr(ir_assign->rhs);
+	return push(flat_stmt);
+}
+
+StmtId
+FlatLowering::else_stmt(IRElse* ir_else)
+{
+	FlatStmt flat_stmt{IRStmtType::Else, ir_else->node};
+	flat_stmt.body = stmt(ir_else->stmt);
+	return push(flat_stmt);
+}
+
+StmtId
+FlatLowering::block(IRBlock* ir_block)
+{
+	FlatStmt flat_stmt{IRStmtType::Block, ir_block->node};
+
+	Vec<std::uint32_t> stmts;
+	for( auto ir_stmt : *ir_block->stmts )
+		stmts.push_back(stmt(ir_stmt).index);
+	flat_stmt.children = extra(stmts);
+
+	return push(flat_stmt);
+}
+
+StmtId
+FlatLowering::stmt(IRStmt* ir_stmt)
+{
+	FlatStmt flat_stmt{ir_stmt->type, ir_stmt->node};
+
+	switch( ir_stmt->type )
+	{
+	case IRStmtType::ExprStmt:
+		flat_stmt.expr = expr(ir_stmt->stmt.expr);
+		break;
+	case IRStmtType::Return:
+		flat_stmt.expr = expr(ir_stmt->stmt.ret->expr);
+		break;
+	case IRStmtType::Assign:
+		return assign(ir_stmt->stmt.assign);
+	case IRStmtType::Let:
+	{
+		auto ir_let = ir_stmt->stmt.let;
+		flat_stmt.node = ir_let->node;
+		flat_stmt.name = Symbol::intern(*ir_let->name);
+		flat_stmt.type_instance = ir_let->type_instance;
+		if( !ir_let->is_empty() )
+			flat_stmt.body = assign(ir_let->assign);
+		break;
+	}
+	case IRStmtType::If:
+	{
+		auto ir_if = ir_stmt->stmt.if_stmt;
+		flat_stmt.expr = expr(ir_if->expr);
+		flat_stmt.bindings = bindings(ir_if->discriminations);
+		flat_stmt.body = stmt(ir_if->stmt);
+		if( ir_if->else_stmt )
+			flat_stmt.else_stmt = else_stmt(ir_if->else_stmt);
+		break;
+	}
+	case IRStmtType::For:
+	{
+		auto ir_for = ir_stmt->stmt.for_stmt;
+		flat_stmt.init = stmt(ir_for->init);
+		flat_stmt.expr = expr(ir_for->condition);
+		flat_stmt.body = stmt(ir_for->body);
+		flat_stmt.step = stmt(ir_for->end);
+		break;
+	}
+	case IRStmtType::While:
+		flat_stmt.expr = expr(ir_stmt->stmt.while_stmt->condition);
+		flat_stmt.body = stmt(ir_stmt->stmt.while_stmt->body);
+		break;
+	case IRStmtType::Else:
+		return else_stmt(ir_stmt->stmt.else_stmt);
+	case IRStmtType::Block:
+		return block(ir_stmt->stmt.block);
+	case IRStmtType::Switch:
+		flat_stmt.expr = expr(ir_stmt->stmt.switch_stmt->expr);
+		flat_stmt.body = block(ir_stmt->stmt.switch_stmt->block);
+		break;
+	case IRStmtType::Case:
+	{
+		auto ir_case = ir_stmt->stmt.case_stmt;
+		flat_stmt.case_value = ir_case->value;
+		flat_stmt.is_default = ir_case->is_default;
+		flat_stmt.bindings = bindings(ir_case->discriminations);
+		flat_stmt.body = stmt(ir_case->block);
+		break;
+	}
+	}
+
+	return push(flat_stmt);
+}
+
+FlatFunction*
+sema::lower_flat(IRBlock* block)
+{
+	auto flat = new FlatFunction;
+
+	FlatLowering lowering{*flat};
+	flat->body = lowering.block(block);
+
+	return flat;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../FlatIR.h"
+#include "../IR.h"
+
+namespace sema
+{
+/**
+ * @brief Copies a function body into the flat encoding consumed by codegen.
+ *
+ * This is the first phase of the flat IR. SemaGen still allocates the pointer IR of
+ * every body and this copies it in a second pass, so the front end does more work than
+ * without the flat IR. Only codegen is faster. The second phase has SemaGen write the
+ * FlatFunction directly and drops the pointer IR of bodies, see the TODO in readme.md.
+ */
+ir::FlatFunction* lower_flat(ir::IRBlock* block);
+} // namespace sema
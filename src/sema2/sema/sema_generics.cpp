@@ -0,0 +1,437 @@
+#include "sema_generics.h"
+
+#include "../SemaGen.h"
+#include "../sema_expected.h"
+
+using namespace sema;
+using namespace ast;
+
+static AstNode*
+unwrap_expr(AstNode* node)
+{
+	while( node->type == NodeType::Expr )
+		node = node->data.expr.expr;
+
+	return node;
+}
+
+static AstList<AstNode*>*
+type_params_of(AstNode* decl)
+{
+	switch( decl->type )
+	{
+	case NodeType::Fn:
+		return decl->data.fn.prototype->data.fn_proto->type_params;
+	case NodeType::Struct:
+		return decl->data.structstmt.type_params;
+	default:
+		return nullptr;
+	}
+}
+
+static Symbol
+decl_name(AstNode* decl)
+{
+	switch( decl->type )
+	{
+	case NodeType::Fn:
+		return decl->data.fn.prototype->data.fn_proto->name->data.id.name;
+	case NodeType::Struct:
+		return decl->data.structstmt.type_name->data.id.name;
+	default:
+		return Symbol{};
+	}
+}
+
+String
+sema::mangle_instance(Symbol name, Vec<TypeInstance> const& type_args)
+{
+	String result = name.str() + "<";
+	for( int i = 0; i < type_args.size(); i++ )
+	{
+		if( i != 0 )
+			result += ",";
+		result += to_string(type_args[i]);
+	}
+	result += ">";
+
+	return result;
+}
+
+SemaResult<bool>
+sema::sema_generic_decl(Sema2& sema, AstNode* ast)
+{
+	switch( ast->type )
+	{
+	case NodeType::Fn:
+	case NodeType::Struct:
+		break;
+	case NodeType::ExternFn:
+		if( ast->data.extern_fn.prototype->data.fn_proto->type_params )
+			return SemaError("Extern functions cannot have type parameters.");
+		return false;
+	default:
+		return false;
+	}
+
+	if( !type_params_of(ast) )
+		return false;
+
+	sema.generics.add_decl(decl_name(ast), ast);
+	return true;
+}
+
+SemaResult<Vec<TypeInstance>>
+sema::sema_type_args(Sema2& sema, AstList<AstNode*>* type_args)
+{
+	Vec<TypeInstance> result;
+	for( auto type_arg : type_args )
+	{
+		auto type_declr = sema_type_decl(sema, type_arg);
+		if( !type_declr.ok() )
+			return type_declr;
+
+		result.push_back(type_declr.unwrap()->type_instance);
+	}
+
+	return result;
+}
+
+SemaResult<TypeInstance>
+sema::sema_type_name(Sema2& sema, AstNode* ast, Symbol name)
+{
+	auto type_args = sema.type_args(ast);
+	// Instances are added to the shared types, which body workers only read.
+	if( type_args && sema.is_body_worker() )
+		return sema.defer_to_serial();
+	if( type_args && name == Symbol::intern("future") )
+	{
+		if( type_args->list.size() != 1 )
+			return SemaError("'future' expects 1 type argument.");
+
+		auto argsr = sema_type_args(sema, type_args);
+		if( !argsr.ok() )
+			return argsr;
+
+		return TypeInstance::OfType(sema.types.future_type(argsr.unwrap()[0]));
+	}
+	if( type_args )
+	{
+		auto decl = sema.generics.lookup_decl(name);
+		if( !decl || decl->type != NodeType::Struct )
+			return SemaError("'" + name.str() + "' is not a generic struct.");
+
+		auto argsr = sema_type_args(sema, type_args);
+		if( !argsr.ok() )
+			return argsr;
+
+		auto instancer = instantiate_struct(sema, decl, argsr.unwrap());
+		if( !instancer.ok() )
+			return instancer;
+
+		return TypeInstance::OfType(instancer.unwrap());
+	}
+
+	auto binding = sema.generics.lookup_binding(name);
+	if( binding.has_value() )
+		return binding.value();
+
+	auto type = sema.lookup_type(name);
+	if( !type )
+	{
+		if( sema.generics.lookup_decl(name) )
+			return SemaError("Missing type arguments for '" + name.str() + "'.");
+		return SemaError("Could not find type '" + name.str() + "'");
+	}
+
+	return TypeInstance::OfType(type);
+}
+
+static SemaResult<Vec<Generics::Binding>>
+bind_type_params(AstNode* decl, Vec<TypeInstance> const& type_args)
+{
+	auto type_params = type_params_of(decl);
+	if( type_params->list.size() != type_args.size() )
+		return SemaError(
+			"'" + decl_name(decl).str() + "' expects " + std::to_string(type_params->list.size()) +
+			" type arguments, received " + std::to_string(type_args.size()) + ".");
+
+	Vec<Generics::Binding> bindings;
+	for( int i = 0; i < type_args.size(); i++ )
+		bindings.emplace_back(type_params->list[i]->data.id.name, type_args[i]);
+
+	return bindings;
+}
+
+/**
+ * @brief Analyses a generic declaration with its type parameters bound, in a scope
+ * that only sees module level names.
+ */
+template<typename T, typename F>
+static SemaResult<T>
+with_bindings(Sema2& sema, Vec<Generics::Binding> bindings, F analyse)
+{
+	auto switch_context = sema.switch_context();
+	sema.switch_context_clear();
+	sema.push_isolated_scope();
+	sema.generics.push_bindings(std::move(bindings));
+
+	SemaResult<T> result = analyse();
+
+	sema.generics.pop_bindings();
+	sema.pop_scope();
+	sema.switch_context_set(switch_context);
+
+	return result;
+}
+
+SemaResult<Type const*>
+sema::instantiate_struct(Sema2& sema, AstNode* decl, Vec<TypeInstance> const& type_args)
+{
+	auto name = decl_name(decl);
+	auto cached = sema.generics.lookup_instance(name, type_args);
+	if( cached.has_value() )
+	{
+		if( !cached.value() )
+			return SemaError("Generic struct '" + name.str() + "' contains itself.");
+		return cached.value();
+	}
+
+	auto bindingsr = bind_type_params(decl, type_args);
+	if( !bindingsr.ok() )
+		return bindingsr;
+
+	// Marks the instantiation as in progress.
+	sema.generics.add_instance(name, type_args, nullptr);
+
+	auto instance_name = mangle_instance(name, type_args);
+	auto structr = with_bindings<ir::IRStruct*>(
+		sema, bindingsr.unwrap(), [&]() { return sema_struct(sema, decl, instance_name); });
+	if( !structr.ok() )
+		return structr;
+	auto struct_ir = structr.unwrap();
+
+	sema.generics.add_instance(name, type_args, struct_ir->struct_type);
+	sema.emit_generated(sema.TLS(struct_ir));
+
+	return struct_ir->struct_type;
+}
+
+SemaResult<Type const*>
+sema::instantiate_fn(Sema2& sema, AstNode* decl, Vec<TypeInstance> const& type_args)
+{
+	auto name = decl_name(decl);
+	auto cached = sema.generics.lookup_instance(name, type_args);
+	if( cached.has_value() )
+		return cached.value();
+
+	auto bindingsr = bind_type_params(decl, type_args);
+	if( !bindingsr.ok() )
+		return bindingsr;
+
+	auto instance_name = Symbol::intern(mangle_instance(name, type_args));
+	auto fnr = with_bindings<ir::IRFunction*>(
+		sema,
+		bindingsr.unwrap(),
+		[&]() -> SemaResult<ir::IRFunction*>
+		{
+			auto protor = sema_fn_proto(sema, decl->data.fn.prototype, instance_name);
+			if( !protor.ok() )
+				return protor;
+			auto proto = protor.unwrap();
+
+			// Cached before the body so recursive calls find it.
+			sema.generics.add_instance(name, type_args, proto->fn_type);
+
+			return sema_fn_body(sema, decl, proto);
+		});
+	if( !fnr.ok() )
+		return fnr;
+	auto fn = fnr.unwrap();
+
+	sema.emit_generated(sema.TLS(fn));
+
+	return fn->proto->fn_type;
+}
+
+AstNode*
+sema::generic_call_decl(Sema2& sema, AstNode* call_target)
+{
+	auto target = unwrap_expr(call_target);
+	if( target->type != NodeType::Id )
+		return nullptr;
+
+	auto name = target->data.id.name;
+	auto decl = sema.generics.lookup_decl(name);
+	if( !decl || decl->type != NodeType::Fn )
+		return nullptr;
+
+	// A local with the same name shadows the generic fn.
+	if( sema.lookup_name(name).has_value() )
+		return nullptr;
+
+	return decl;
+}
+
+static SemaError
+cannot_infer(AstNode* type_decl_node, TypeInstance arg)
+{
+	return SemaError(
+		"Cannot infer type arguments of '" + type_decl_node->data.type_declarator.symbol.str() +
+		"' from argument of type '" + to_string(arg) + "'.");
+}
+
+/**
+ * @brief Matches a parameter type declarator against an argument type, binding the
+ * type parameters it mentions, e.g. Box<T>* against Box<i32>* binds T to i32.
+ */
+static SemaResult<bool>
+unify(
+	Sema2& sema,
+	AstList<AstNode*>* type_params,
+	AstNode* type_decl_node,
+	TypeInstance arg,
+	Vec<std::optional<TypeInstance>>& inferred)
+{
+	auto type_decl = type_decl_node->data.type_declarator;
+	if( type_decl.empty )
+		return true;
+
+	if( type_decl.array_size > 0 )
+	{
+		if( !arg.is_array_type() || arg.array_size != type_decl.array_size )
+			return cannot_infer(type_decl_node, arg);
+		arg = arg.ArrayElementType();
+	}
+
+	int indirection = type_decl.indirection_level;
+	if( indirection > 0 )
+	{
+		if( arg.is_array_type() || arg.indirection_level < indirection )
+			return cannot_infer(type_decl_node, arg);
+		arg = TypeInstance::PointerTo(arg.type, arg.indirection_level - indirection);
+	}
+
+	auto type_args = sema.type_args(type_decl_node);
+	if( type_args )
+	{
+		auto instance =
+			arg.is_struct_type() ? sema.generics.lookup_instance_args(arg.type) : nullptr;
+		if( !instance || instance->first != type_decl.symbol ||
+			instance->second.size() != type_args->list.size() )
+			return cannot_infer(type_decl_node, arg);
+
+		for( int i = 0; i < type_args->list.size(); i++ )
+		{
+			auto unifiedr =
+				unify(sema, type_params, type_args->list[i], instance->second[i], inferred);
+			if( !unifiedr.ok() )
+				return unifiedr;
+		}
+
+		return true;
+	}
+
+	for( int i = 0; i < type_params->list.size(); i++ )
+	{
+		if( type_params->list[i]->data.id.name != type_decl.symbol )
+			continue;
+
+		if( inferred[i].has_value() && inferred[i].value() != arg )
+			return SemaError(
+				"Conflicting types for type parameter '" + type_decl.symbol.str() + "': '" +
+				to_string(inferred[i].value()) + "' and '" + to_string(arg) + "'.");
+
+		inferred[i] = arg;
+	}
+
+	return true;
+}
+
+static SemaResult<Vec<TypeInstance>>
+infer_type_args(Sema2& sema, AstNode* decl, Vec<ir::IRExpr*> const& args)
+{
+	auto fn_proto = decl->data.fn.prototype->data.fn_proto;
+	auto type_params = fn_proto->type_params;
+
+	Vec<std::optional<TypeInstance>> inferred(type_params->list.size());
+
+	int arg_index = 0;
+	for( auto param : fn_proto->params->data.fn_params.params )
+	{
+		if( arg_index >= args.size() || param->type != NodeType::ValueDecl )
+			break;
+
+		auto unifiedr = unify(
+			sema,
+			type_params,
+			param->data.value_decl.type_name,
+			args[arg_index++]->type_instance,
+			inferred);
+		if( !unifiedr.ok() )
+			return unifiedr;
+	}
+
+	Vec<TypeInstance> result;
+	for( int i = 0; i < inferred.size(); i++ )
+	{
+		if( !inferred[i].has_value() )
+			return SemaError(
+				"Cannot infer type parameter '" + type_params->list[i]->data.id.name.str() +
+				"' of '" + decl_name(decl).str() + "'.");
+
+		result.push_back(inferred[i].value());
+	}
+
+	return result;
+}
+
+SemaResult<ir::IRCall*>
+sema::sema_generic_fn_call(Sema2& sema, AstNode* ast, AstNode* decl)
+{
+	if( sema.is_body_worker() )
+		return sema.defer_to_serial();
+
+	auto fn_callr = expected(ast, ast::as_fn_call);
+	if( !fn_callr.ok() )
+		return fn_callr;
+	auto fn_call = fn_callr.unwrap();
+	auto target = unwrap_expr(fn_call.call_target);
+
+	auto exprsr = expected(fn_call.args, ast::as_expr_list);
+	if( !exprsr.ok() )
+		return exprsr;
+
+	auto args = sema.create_elist();
+	for( auto argexpr : exprsr.unwrap().exprs )
+	{
+		auto exprr = sema_expr(sema, argexpr);
+		if( !exprr.ok() )
+			return exprr;
+
+		args->push_back(exprr.unwrap());
+	}
+
+	auto explicit_type_args = sema.type_args(target);
+	auto type_argsr = explicit_type_args ? sema_type_args(sema, explicit_type_args)
+										 : infer_type_args(sema, decl, *args);
+	if( !type_argsr.ok() )
+		return type_argsr;
+
+	auto fn_typer = instantiate_fn(sema, decl, type_argsr.unwrap());
+	if( !fn_typer.ok() )
+		return fn_typer;
+	auto fn_type = fn_typer.unwrap();
+
+	auto argsr = sema_fn_args(sema, fn_call.args, args, *fn_type);
+	if( !argsr.ok() )
+		return argsr;
+
+	auto instance_name = fn_type->get_name();
+	auto name_parts = sema.create_name_parts();
+	name_parts->push_back(sema.create_name(instance_name.c_str(), instance_name.size()));
+	auto call_target = sema.Id(
+		target, name_parts, Symbol::intern(instance_name), TypeInstance::OfType(fn_type), false);
+
+	return sema.FnCall(ast, sema.Expr(call_target), argsr.unwrap());
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "../IR.h"
+#include "../Sema2.h"
+#include "../SemaResult.h"
+#include "ast2/Ast.h"
+#include "ast2/AstCasts.h"
+
+namespace sema
+{
+
+/**
+ * @brief Name of an instantiation, e.g. max<i32> or Box<u8*>.
+ */
+String mangle_instance(Symbol name, Vec<TypeInstance> const& type_args);
+
+/**
+ * @brief Records a generic fn or struct declaration.
+ *
+ * @return True if the declaration is generic. It is analysed when instantiated.
+ */
+SemaResult<bool> sema_generic_decl(Sema2& sema, ast::AstNode* ast);
+
+/**
+ * @brief Resolves the type named by an Id or TypeDeclarator, without modifiers.
+ *
+ * Instantiates the struct if the node has type arguments and resolves type
+ * parameters bound by the instantiation being analysed.
+ */
+SemaResult<TypeInstance> sema_type_name(Sema2& sema, ast::AstNode* ast, Symbol name);
+
+SemaResult<Vec<TypeInstance>> sema_type_args(Sema2& sema, ast::AstList<ast::AstNode*>* type_args);
+
+SemaResult<Type const*>
+instantiate_struct(Sema2& sema, ast::AstNode* decl, Vec<TypeInstance> const& type_args);
+SemaResult<Type const*>
+instantiate_fn(Sema2& sema, ast::AstNode* decl, Vec<TypeInstance> const& type_args);
+
+/**
+ * @brief The generic fn declaration a call target names, or null.
+ */
+ast::AstNode* generic_call_decl(Sema2& sema, ast::AstNode* call_target);
+
+/**
+ * @brief Analyses a call to a generic fn. Type arguments that are not given
+ * explicitly are inferred from the argument types.
+ */
+SemaResult<ir::IRCall*> sema_generic_fn_call(Sema2& sema, ast::AstNode* ast, ast::AstNode* decl);
+
+} // namespace sema
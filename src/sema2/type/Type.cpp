@@ -107,6 +107,13 @@ Type::get_return_type() const
 	return this->return_type;
 }
 
+TypeInstance
+Type::future_result_type() const
+{
+	assert(cls == TypeClassification::future_cls);
+	return this->return_type;
+}
+
 Type const*
 Type::get_dependent_type() const
 {
@@ -156,6 +163,15 @@ Type::EnumPartial(String const& name)
 	return Type{name, {}, TypeClassification::enum_cls};
 }
 
+Type
+Type::Future(String const& name, TypeInstance result_type)
+{
+	auto type = Type{name};
+	type.cls = TypeClassification::future_cls;
+	type.return_type = result_type;
+	return type;
+}
+
 Type
 Type::Primitive(String name)
 {
@@ -23,8 +23,11 @@ namespace sema
  * or arguments for functions.
  *
  */
+class Types;
 class Type
 {
+	friend class Types;
+
 private:
 	enum class TypeClassification
 	{
@@ -33,6 +36,7 @@ private:
 		union_cls,
 		enum_cls,
 		enum_member_cls,
+		future_cls,
 		primitive,
 	};
 
@@ -44,7 +48,7 @@ private:
 	// For integers
 	int int_width_ = 0;
 
-	// For functions return type
+	// For functions return type. For futures the result type.
 	TypeInstance return_type;
 	bool is_var_arg_;
 
@@ -54,6 +58,8 @@ private:
 
 	// All Type classes
 	String name;
+	// Dense id assigned by Types::define_type. 0 if not defined.
+	unsigned int id_ = 0;
 
 	Type(String name);
 	Type(String name, std::map<String, MemberTypeInstance> members, TypeClassification);
@@ -67,14 +73,20 @@ public:
 	bool is_struct_type() const { return cls == TypeClassification::struct_cls; }
 	bool is_union_type() const { return cls == TypeClassification::union_cls; }
 	bool is_enum_type() const { return cls == TypeClassification::enum_cls; }
+	bool is_future_type() const { return cls == TypeClassification::future_cls; }
 	String get_name() const;
+	unsigned int id() const { return id_; }
 
 	// Enum members only
 	EnumNominal as_nominal() const;
+	bool is_enum_member() const { return nominal_.has_value(); }
 
 	// Integer types
 	int int_width() const { return int_width_; }
 
+	// Futures only. Type produced by awaiting the future.
+	TypeInstance future_result_type() const;
+
 	// TODO: Assert we are a function.
 	bool is_var_arg() const { return is_var_arg_; }
 
@@ -93,6 +105,7 @@ public:
 	static Type Struct(String const& name, std::map<String, MemberTypeInstance>, EnumNominal);
 	static Type Union(String const& name, std::map<String, MemberTypeInstance> members);
 	static Type EnumPartial(String const& name);
+	static Type Future(String const& name, TypeInstance result_type);
 	static Type Primitive(String name);
 	static Type Primitive(String name, int bit_width);
 	static Type Primitive(String name, EnumNominal);
@@ -0,0 +1,692 @@
+#include "CompileServer.h"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_map>
+
+using namespace server;
+
+// A request is a 4 byte payload size, sent with the client's stdin, stdout and stderr
+// attached, then the payload: the working directory and each arg, each ended by a
+// null. The reply is the 4 byte exit code.
+static constexpr std::uint32_t max_request_size = 1 << 24;
+static constexpr int passed_fd_count = 3;
+
+// A client that connects but does not finish its request is dropped after this. The
+// server reads the requests of all its clients at once, so it holds up no one else.
+static constexpr int receive_timeout_seconds = 10;
+
+// For the signal handlers.
+static char listening_path[sizeof(sockaddr_un::sun_path)];
+// Written to by the SIGCHLD handler, so the server wakes up to reply to the client.
+static int child_exited_pipe[2] = {-1, -1};
+
+static bool
+make_address(String const& socket_path, sockaddr_un& address)
+{
+	if( socket_path.size() >= sizeof(address.sun_path) )
+	{
+		std::cout << "Socket path is too long: " << socket_path << std::endl;
+		return false;
+	}
+
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+	return true;
+}
+
+static int
+connect_to(sockaddr_un const& address)
+{
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if( fd < 0 )
+		return -1;
+
+	if( connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0 )
+	{
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static bool
+write_all(int fd, void const* data, std::size_t size)
+{
+	auto bytes = static_cast<char const*>(data);
+	while( size > 0 )
+	{
+		auto written = write(fd, bytes, size);
+		if( written < 0 && errno == EINTR )
+			continue;
+		if( written <= 0 )
+			return false;
+
+		bytes += written;
+		size -= written;
+	}
+
+	return true;
+}
+
+static bool
+read_all(int fd, void* data, std::size_t size)
+{
+	auto bytes = static_cast<char*>(data);
+	while( size > 0 )
+	{
+		auto got = read(fd, bytes, size);
+		if( got < 0 && errno == EINTR )
+			continue;
+		if( got <= 0 )
+			return false;
+
+		bytes += got;
+		size -= got;
+	}
+
+	return true;
+}
+
+static void
+flush_output()
+{
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+}
+
+static void
+remove_socket_and_exit(int)
+{
+	unlink(listening_path);
+	_exit(0);
+}
+
+static void
+notify_child_exited(int)
+{
+	int saved_errno = errno;
+	char byte = 0;
+	// Full if earlier exits were not read yet, which wakes the server all the same.
+	(void)!write(child_exited_pipe[1], &byte, 1);
+	errno = saved_errno;
+}
+
+namespace
+{
+struct Request
+{
+	String cwd;
+	Vec<String> args;
+	int fds[passed_fd_count] = {-1, -1, -1};
+
+	~Request()
+	{
+		for( int fd : fds )
+		{
+			if( fd >= 0 )
+				close(fd);
+		}
+	}
+};
+} // namespace
+
+namespace
+{
+enum class Progress
+{
+	Waiting,
+	Done,
+	Failed,
+};
+
+/**
+ * @brief A client whose request is still arriving, or that waits for a free job.
+ */
+struct Pending
+{
+	Request request;
+	std::chrono::steady_clock::time_point deadline;
+	bool has_fds = false;
+	bool ready = false;
+	// Bytes of the size, then of the payload.
+	std::size_t received = 0;
+	std::uint32_t size = 0;
+	String payload;
+};
+} // namespace
+
+/**
+ * @brief Reads what arrived on a non-blocking connection into 'data' and adds it to
+ * 'received'.
+ */
+static Progress
+read_some(int fd, void* data, std::size_t size, std::size_t& received)
+{
+	while( size > 0 )
+	{
+		auto got = read(fd, data, size);
+		if( got < 0 && errno == EINTR )
+			continue;
+		if( got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) )
+			return Progress::Waiting;
+		if( got <= 0 )
+			return Progress::Failed;
+
+		data = static_cast<char*>(data) + got;
+		size -= got;
+		received += got;
+	}
+
+	return Progress::Done;
+}
+
+/**
+ * @brief Reads what arrived of the request on 'connection', and parses it once all of it
+ * did.
+ */
+static Progress
+receive_request(int connection, Pending& pending)
+{
+	auto& request = pending.request;
+	if( !pending.has_fds )
+	{
+		iovec io{&pending.size, sizeof(pending.size)};
+
+		union
+		{
+			char buffer[CMSG_SPACE(sizeof(int) * passed_fd_count)];
+			cmsghdr align;
+		} control;
+
+		msghdr message{};
+		message.msg_iov = &io;
+		message.msg_iovlen = 1;
+		message.msg_control = control.buffer;
+		message.msg_controllen = sizeof(control.buffer);
+
+		ssize_t got;
+		do
+			got = recvmsg(connection, &message, MSG_DONTWAIT);
+		while( got < 0 && errno == EINTR );
+
+		if( got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) )
+			return Progress::Waiting;
+		if( got <= 0 )
+			return Progress::Failed;
+
+		for( auto header = CMSG_FIRSTHDR(&message); header != nullptr;
+			 header = CMSG_NXTHDR(&message, header) )
+		{
+			if( header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS &&
+				header->cmsg_len == CMSG_LEN(sizeof(int) * passed_fd_count) )
+				std::memcpy(request.fds, CMSG_DATA(header), sizeof(request.fds));
+		}
+
+		if( request.fds[passed_fd_count - 1] < 0 )
+			return Progress::Failed;
+
+		pending.has_fds = true;
+		pending.received = got;
+	}
+
+	// The size may arrive in pieces after the first byte.
+	auto const size_bytes = sizeof(pending.size);
+	if( pending.received < size_bytes )
+	{
+		auto progress = read_some(
+			connection,
+			reinterpret_cast<char*>(&pending.size) + pending.received,
+			size_bytes - pending.received,
+			pending.received);
+		if( progress != Progress::Done )
+			return progress;
+	}
+
+	if( pending.size == 0 || pending.size > max_request_size )
+		return Progress::Failed;
+
+	if( pending.payload.empty() )
+		pending.payload.resize(pending.size);
+
+	auto payload_received = pending.received - size_bytes;
+	auto progress = read_some(
+		connection,
+		pending.payload.data() + payload_received,
+		pending.size - payload_received,
+		pending.received);
+	if( progress != Progress::Done )
+		return progress;
+
+	auto const& payload = pending.payload;
+	if( payload.back() != '\0' )
+		return Progress::Failed;
+
+	std::size_t begin = 0;
+	bool first = true;
+	while( begin < payload.size() )
+	{
+		auto end = payload.find('\0', begin);
+		auto part = payload.substr(begin, end - begin);
+		if( first )
+			request.cwd = part;
+		else
+			request.args.push_back(part);
+
+		first = false;
+		begin = end + 1;
+	}
+
+	return Progress::Done;
+}
+
+/**
+ * @brief Runs the handler with the stdin, stdout, stderr and working directory of the
+ * client, then restores those of the server.
+ */
+static Prepared
+prepare_job(Request const& request, Handler const& handler, int const saved_fds[], int saved_cwd)
+{
+	flush_output();
+	for( int i = 0; i < passed_fd_count; i++ )
+		dup2(request.fds[i], i);
+
+	Prepared prepared;
+	if( chdir(request.cwd.c_str()) != 0 )
+	{
+		std::cout << "Could not change to " << request.cwd << std::endl;
+		prepared.job = []() { return -1; };
+	}
+	else
+	{
+		prepared = handler(request.args);
+	}
+
+	flush_output();
+	for( int i = 0; i < passed_fd_count; i++ )
+		dup2(saved_fds[i], i);
+
+	if( fchdir(saved_cwd) != 0 )
+		std::perror("fchdir");
+
+	return prepared;
+}
+
+namespace
+{
+/**
+ * @brief The server's fds, which a child closes. It keeps only those of its client.
+ */
+struct ServerFds
+{
+	int listener;
+	int const* saved_fds;
+	int saved_cwd;
+	// Connections of the running jobs, by the pid of their child.
+	std::unordered_map<pid_t, int> const& connections;
+	// Clients without a job yet, by their connection.
+	std::unordered_map<int, Pending> const& pending;
+};
+} // namespace
+
+/**
+ * @brief Forks a child that runs the job for the client on 'connection', which the server
+ * replies on. Returns its pid, or -1.
+ */
+static pid_t
+start_job(Request const& request, int connection, Job const& job, ServerFds const& server)
+{
+	flush_output();
+
+	pid_t child = fork();
+	if( child != 0 )
+	{
+		if( child < 0 )
+			std::perror("fork");
+		return child;
+	}
+
+	std::signal(SIGINT, SIG_DFL);
+	std::signal(SIGTERM, SIG_DFL);
+	std::signal(SIGPIPE, SIG_DFL);
+	std::signal(SIGCHLD, SIG_DFL);
+
+	close(server.listener);
+	close(child_exited_pipe[0]);
+	close(child_exited_pipe[1]);
+	for( int i = 0; i < passed_fd_count; i++ )
+		close(server.saved_fds[i]);
+	close(server.saved_cwd);
+	close(connection);
+	for( auto [pid, other] : server.connections )
+		close(other);
+	// The stdout of another client must not stay open until this job exits.
+	for( auto const& [other, other_pending] : server.pending )
+	{
+		if( &other_pending.request == &request )
+			continue;
+
+		close(other);
+		for( int fd : other_pending.request.fds )
+		{
+			if( fd >= 0 )
+				close(fd);
+		}
+	}
+
+	for( int i = 0; i < passed_fd_count; i++ )
+		dup2(request.fds[i], i);
+
+	int code = -1;
+	if( chdir(request.cwd.c_str()) == 0 )
+		code = job();
+	flush_output();
+	// Skip the exit handlers, they belong to the server.
+	_exit(code);
+}
+
+/**
+ * @brief Replies to the clients whose children exited.
+ */
+static void
+reap_jobs(std::unordered_map<pid_t, int>& connections)
+{
+	while( true )
+	{
+		int status = 0;
+		pid_t child = waitpid(-1, &status, WNOHANG);
+		if( child < 0 && errno == EINTR )
+			continue;
+		if( child <= 0 )
+			return;
+
+		auto iter = connections.find(child);
+		if( iter == connections.end() )
+			continue;
+
+		std::int32_t code = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+		write_all(iter->second, &code, sizeof(code));
+		close(iter->second);
+		connections.erase(iter);
+	}
+}
+
+int
+server::serve(String const& socket_path, Handler const& handler, unsigned int max_jobs)
+{
+	sockaddr_un address;
+	if( !make_address(socket_path, address) )
+		return -1;
+
+	// A socket file with no server behind it is left over from a server that was killed.
+	int existing = connect_to(address);
+	if( existing >= 0 )
+	{
+		close(existing);
+		std::cout << "A compile server is already listening on " << socket_path << std::endl;
+		return -1;
+	}
+	unlink(socket_path.c_str());
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if( listener < 0 )
+	{
+		std::perror("socket");
+		return -1;
+	}
+
+	// Clients hand the server their files and directories, so keep other users out.
+	auto old_mask = umask(0077);
+	int bound = bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+	umask(old_mask);
+	if( bound != 0 || listen(listener, 16) != 0 )
+	{
+		std::perror(socket_path.c_str());
+		close(listener);
+		return -1;
+	}
+
+	if( pipe(child_exited_pipe) != 0 )
+	{
+		std::perror("pipe");
+		close(listener);
+		unlink(socket_path.c_str());
+		return -1;
+	}
+	for( int fd : child_exited_pipe )
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	std::memcpy(listening_path, address.sun_path, sizeof(listening_path));
+	std::signal(SIGINT, remove_socket_and_exit);
+	std::signal(SIGTERM, remove_socket_and_exit);
+	std::signal(SIGCHLD, notify_child_exited);
+	// A client that goes away must not take the server with it.
+	std::signal(SIGPIPE, SIG_IGN);
+
+	int saved_fds[passed_fd_count];
+	for( int i = 0; i < passed_fd_count; i++ )
+		saved_fds[i] = dup(i);
+	int saved_cwd = open(".", O_RDONLY);
+
+	std::unordered_map<pid_t, int> connections;
+	std::unordered_map<int, Pending> pending;
+	// Connections whose request arrived, in order.
+	std::deque<int> ready;
+	// Warm-ups of the jobs started, run while no client waits.
+	std::deque<std::function<void()>> warm_ups;
+	ServerFds server_fds{listener, saved_fds, saved_cwd, connections, pending};
+
+	std::cout << "Listening on " << socket_path << std::endl;
+
+	while( true )
+	{
+		reap_jobs(connections);
+
+		// The clients over the limit wait in 'ready'.
+		while( !ready.empty() && connections.size() < max_jobs )
+		{
+			int connection = ready.front();
+			ready.pop_front();
+			auto const& request = pending.at(connection).request;
+
+			auto prepared = prepare_job(request, handler, saved_fds, saved_cwd);
+			pid_t child = start_job(request, connection, prepared.job, server_fds);
+			pending.erase(connection);
+			if( child < 0 )
+			{
+				std::int32_t code = -1;
+				write_all(connection, &code, sizeof(code));
+				close(connection);
+				continue;
+			}
+
+			connections.emplace(child, connection);
+			if( prepared.warm )
+				warm_ups.push_back(std::move(prepared.warm));
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		auto next_deadline = std::chrono::steady_clock::time_point::max();
+		Vec<pollfd> polled{{child_exited_pipe[0], POLLIN, 0}, {listener, POLLIN, 0}};
+		for( auto iter = pending.begin(); iter != pending.end(); )
+		{
+			auto& [connection, client] = *iter;
+			if( client.ready )
+			{
+				++iter;
+				continue;
+			}
+
+			if( client.deadline <= now )
+			{
+				close(connection);
+				iter = pending.erase(iter);
+				continue;
+			}
+
+			next_deadline = std::min(next_deadline, client.deadline);
+			polled.push_back({connection, POLLIN, 0});
+			++iter;
+		}
+
+		int timeout = -1;
+		if( !warm_ups.empty() )
+			timeout = 0;
+		else if( next_deadline != std::chrono::steady_clock::time_point::max() )
+			timeout = std::chrono::ceil<std::chrono::milliseconds>(next_deadline - now).count();
+
+		int events = poll(polled.data(), polled.size(), timeout);
+		if( events < 0 )
+		{
+			if( errno == EINTR )
+				continue;
+			std::perror("poll");
+			break;
+		}
+
+		// Nothing to do for a client, so warm up for the next compiles.
+		if( events == 0 )
+		{
+			if( !warm_ups.empty() )
+			{
+				auto warm = std::move(warm_ups.front());
+				warm_ups.pop_front();
+				warm();
+			}
+			continue;
+		}
+
+		char drained[64];
+		while( read(child_exited_pipe[0], drained, sizeof(drained)) > 0 )
+			;
+
+		for( unsigned int i = 2; i < polled.size(); i++ )
+		{
+			if( polled[i].revents == 0 )
+				continue;
+
+			int connection = polled[i].fd;
+			auto& client = pending.at(connection);
+			auto progress = receive_request(connection, client);
+			if( progress == Progress::Done )
+			{
+				client.ready = true;
+				client.payload = String();
+				ready.push_back(connection);
+			}
+			else if( progress == Progress::Failed )
+			{
+				close(connection);
+				pending.erase(connection);
+			}
+		}
+
+		if( (polled[1].revents & POLLIN) == 0 )
+			continue;
+
+		int connection = accept(listener, nullptr, nullptr);
+		if( connection < 0 )
+		{
+			if( errno == EINTR || errno == ECONNABORTED )
+				continue;
+			std::perror("accept");
+			break;
+		}
+
+		fcntl(connection, F_SETFL, fcntl(connection, F_GETFL) | O_NONBLOCK);
+		pending[connection].deadline =
+			std::chrono::steady_clock::now() + std::chrono::seconds(receive_timeout_seconds);
+	}
+
+	close(listener);
+	unlink(listening_path);
+	return -1;
+}
+
+std::optional<int>
+server::request(String const& socket_path, Vec<String> const& args)
+{
+	sockaddr_un address;
+	if( !make_address(socket_path, address) )
+		return std::nullopt;
+
+	int connection = connect_to(address);
+	if( connection < 0 )
+		return std::nullopt;
+
+	std::error_code error;
+	String payload = std::filesystem::current_path(error).string();
+	payload.push_back('\0');
+	for( auto const& arg : args )
+	{
+		payload += arg;
+		payload.push_back('\0');
+	}
+
+	std::uint32_t size = payload.size();
+	iovec io{&size, sizeof(size)};
+
+	union
+	{
+		char buffer[CMSG_SPACE(sizeof(int) * passed_fd_count)];
+		cmsghdr align;
+	} control;
+	std::memset(control.buffer, 0, sizeof(control.buffer));
+
+	msghdr message{};
+	message.msg_iov = &io;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+	auto header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(int) * passed_fd_count);
+	int fds[passed_fd_count] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+	std::memcpy(CMSG_DATA(header), fds, sizeof(fds));
+
+	// Output written so far must come before the server's.
+	flush_output();
+
+	std::int32_t code = -1;
+	ssize_t sent;
+	do
+		sent = sendmsg(connection, &message, 0);
+	while( sent < 0 && errno == EINTR );
+
+	bool ok = sent > 0 &&
+			  write_all(
+				  connection,
+				  reinterpret_cast<char const*>(&size) + sent,
+				  sizeof(size) - sent) &&
+			  write_all(connection, payload.data(), payload.size()) &&
+			  read_all(connection, &code, sizeof(code));
+	close(connection);
+
+	if( !ok )
+	{
+		std::cout << "The compile server on " << socket_path << " dropped the request"
+				  << std::endl;
+		return -1;
+	}
+
+	return code;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "common/String.h"
+#include "common/Vec.h"
+
+#include <functional>
+#include <optional>
+
+namespace server
+{
+
+/**
+ * @brief Runs in a child process forked from the server and returns the exit code of one
+ * client. Whatever it allocates or breaks is gone when the child exits.
+ */
+using Job = std::function<int()>;
+
+struct Prepared
+{
+	Job job;
+	/**
+	 * @brief Runs in the server after the job started, once no client is waiting, e.g. to
+	 * parse the client's files into a cache that later children are forked with. Runs
+	 * with the working directory and stdio of the server. May be empty.
+	 */
+	std::function<void()> warm;
+};
+
+/**
+ * @brief Prepares the compile of one client in the server and returns the job that
+ * compiles. It should be quick, since other clients wait for it. It and the job run with
+ * the working directory and the stdin, stdout and stderr of the client.
+ */
+using Handler = std::function<Prepared(Vec<String> const& args)>;
+
+/**
+ * @brief Listens on a Unix socket. The requests of all clients are read as they arrive.
+ * The handler runs in the server for one client at a time, then its job runs in a child
+ * while the server goes on to the next client. At most 'max_jobs' children run at once.
+ * Each client gets the exit code of its job, or 128 plus the signal that killed it, when
+ * the child exits.
+ *
+ * Only the user that started the server can connect. Returns only if the socket could
+ * not be set up. SIGINT and SIGTERM remove the socket and exit.
+ */
+int serve(String const& socket_path, Handler const& handler, unsigned int max_jobs);
+
+/**
+ * @brief Runs the args on the server listening on the socket, with the working
+ * directory and the stdin, stdout and stderr of this process. Returns the exit code, or
+ * nothing if no server is listening.
+ */
+std::optional<int> request(String const& socket_path, Vec<String> const& args);
+
+} // namespace server
@@ -1,47 +1,44 @@
-#include "ast/ast.h"
+#include "ast2/Ast.h"
+#include "ast2/AstGen.h"
+#include "ast2/AstNode.h"
 #include "format/pretty_print_ast.h"
 #include "lexer/Lexer.h"
 #include "lexer/TokenCursor.h"
-#include "parser/ParseResult.h"
-#include "parser/parsers/Parser.h"
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <vector>
 
 using namespace ast;
-using namespace parser;
+using namespace format;
 
-void
-pretty_print(std::vector<Token> const& tokens)
+struct FormatOptions
 {
-	TokenCursor cursor{tokens};
-	Parser parse{cursor};
-	auto mod_result = parse.parse_module();
+	// Exit with 1 if any file is not formatted, instead of printing it.
+	bool check = false;
+	// Write the result back to the file.
+	bool in_place = false;
+	// 1-based, inclusive. 0 formats the whole file.
+	unsigned int first_line = 0;
+	unsigned int last_line = 0;
+	LayoutOptions layout;
+};
 
-	if( mod_result.ok() )
-	{
-		auto mod = mod_result.unwrap();
-		pretty_print_ast(tokens, mod.get());
-	}
-	else
-	{
-		mod_result.unwrap_error()->print();
-	}
+static void
+print_usage()
+{
+	std::cout << "Usage: sushi_format [--check] [-i] [--lines=first:last] [--width=N] file..."
+			  << std::endl;
 }
 
-int
-main(int argc, char* argv[])
+/**
+ * @brief Formats the file. Returns -1 on error, 1 if the file was not formatted, 0 otherwise.
+ */
+static int
+format_file(char const* filepath, FormatOptions const& options)
 {
-	if( argc == 1 )
-	{
-		std::cout << "Please specify a file" << std::endl;
-		return -1;
-	}
-
-	auto filepath = argv[argc - 1];
-
 	std::ifstream file{filepath};
 	if( !file.good() )
 	{
@@ -52,12 +49,112 @@ main(int argc, char* argv[])
 	std::stringstream buffer;
 	buffer << file.rdbuf();
 	std::string filedata = buffer.str();
+	file.close();
 
 	Lexer lex{filedata.c_str()};
-
 	auto lex_result = lex.lex();
 
-	pretty_print(lex_result.tokens);
+	TokenCursor cursor{lex_result};
+	Ast ast;
+	AstGen gen{ast, cursor};
+	auto result = gen.parse();
+	if( !result.ok() )
+	{
+		std::cout << filepath << ": ";
+		result.unwrap_error()->print();
+		return -1;
+	}
+
+	String formatted;
+	if( options.first_line != 0 )
+	{
+		auto edits = pretty_print_lines(
+			lex_result, ast, result.unwrap(), options.first_line, options.last_line, options.layout);
+		formatted = apply_edits(filedata, edits);
+	}
+	else
+	{
+		formatted = pretty_print_ast(lex_result, ast, result.unwrap(), options.layout);
+	}
+
+	bool changed = formatted != filedata;
+	if( options.check )
+	{
+		if( changed )
+			std::cout << filepath << " is not formatted." << std::endl;
+	}
+	else if( options.in_place )
+	{
+		if( changed )
+		{
+			std::ofstream out{filepath, std::ios::binary | std::ios::trunc};
+			out << formatted;
+		}
+	}
+	else
+	{
+		std::cout << formatted;
+	}
+
+	return changed ? 1 : 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+	FormatOptions options;
+	std::vector<char const*> filepaths;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		char const* arg = argv[i];
+		if( strcmp(arg, "--check") == 0 )
+		{
+			options.check = true;
+		}
+		else if( strcmp(arg, "-i") == 0 )
+		{
+			options.in_place = true;
+		}
+		else if( strncmp(arg, "--lines=", 8) == 0 )
+		{
+			if( sscanf(arg + 8, "%u:%u", &options.first_line, &options.last_line) != 2 ||
+				options.first_line == 0 || options.last_line < options.first_line )
+			{
+				std::cout << "Bad line range " << arg << std::endl;
+				return -1;
+			}
+		}
+		else if( strncmp(arg, "--width=", 8) == 0 )
+		{
+			options.layout.max_width = atoi(arg + 8);
+		}
+		else if( arg[0] == '-' )
+		{
+			print_usage();
+			return -1;
+		}
+		else
+		{
+			filepaths.push_back(arg);
+		}
+	}
+
+	if( filepaths.empty() )
+	{
+		print_usage();
+		return -1;
+	}
+
+	int status = 0;
+	for( auto filepath : filepaths )
+	{
+		int file_status = format_file(filepath, options);
+		if( file_status < 0 )
+			return -1;
+		if( options.check && file_status > 0 )
+			status = 1;
+	}
 
-	return 0;
-}
\ No newline at end of file
+	return status;
+}
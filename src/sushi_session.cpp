@@ -0,0 +1,292 @@
+#include "ast2/Ast.h"
+#include "ast2/AstGen.h"
+#include "frontend/Session.h"
+#include "lexer/Lexer.h"
+#include "lexer/TokenCursor.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+
+using namespace frontend;
+
+/**
+ * @brief Replays edits on a Session and compares it with a fresh Session of the same text
+ * after each one. For the session tests.
+ *
+ * Usage: sushi_session file < edits
+ *        sushi_session --fuzz=<edits> [--seed=<n>] file
+ *
+ * Each edit on stdin is a line 'offset removed size', followed by the 'size' bytes to
+ * insert. After each edit it prints the pieces that were parsed again, the dirty pieces
+ * and the diagnostics of check().
+ */
+static void
+print_usage()
+{
+	std::cout << "Usage: sushi_session [--fuzz=<edits>] [--seed=<n>] file < edits" << std::endl;
+}
+
+static bool
+parses(String const& text)
+{
+	Lexer lexer{text.c_str()};
+	auto tokens = lexer.lex();
+	TokenCursor cursor{tokens};
+	ast::Ast ast;
+	ast::AstGen gen{ast, cursor};
+	return gen.parse().ok();
+}
+
+static bool
+same_diagnostics(Vec<Diagnostic> const& l, Vec<Diagnostic> const& r)
+{
+	if( l.size() != r.size() )
+		return false;
+
+	for( unsigned int i = 0; i < l.size(); i++ )
+	{
+		if( l[i].offset != r[i].offset || l[i].message != r[i].message )
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief The text of each item, from its first to its last token that is not a comment.
+ * Which piece has the trivia between items depends on the edits, so only the items are
+ * compared.
+ */
+static Vec<String>
+item_texts(Session const& session, String const& text)
+{
+	Vec<String> result;
+	for( unsigned int i = 0; i < session.piece_count(); i++ )
+	{
+		if( !session.item(i) )
+			continue;
+
+		auto offset = session.piece_offset(i);
+		auto end = i + 1 < session.piece_count() ? session.piece_offset(i + 1) : text.size();
+		auto piece = text.substr(offset, end - offset);
+		Lexer lexer{piece.c_str()};
+		auto tokens = lexer.lex();
+
+		std::optional<unsigned int> first;
+		unsigned int last = 0;
+		for( unsigned int t = 0; t < tokens.size(); t++ )
+		{
+			if( tokens.type(t) == TokenType::line_comment || tokens.type(t) == TokenType::eof )
+				continue;
+
+			if( !first )
+				first = tokens.offsets[t];
+			last = tokens.offsets[t] + tokens.lengths[t];
+		}
+
+		result.push_back(first ? piece.substr(*first, last - *first) : String());
+	}
+
+	return result;
+}
+
+/**
+ * @brief True if the session has the text, and the items and diagnostics of a fresh
+ * session of that text.
+ */
+static bool
+same_as_fresh(Session& session, Vec<Diagnostic> const& diagnostics, String const& text)
+{
+	if( session.text() != text )
+		return false;
+
+	Session fresh{text};
+	if( !same_diagnostics(diagnostics, fresh.check()) )
+		return false;
+
+	return item_texts(session, text) == item_texts(fresh, text);
+}
+
+static void
+print_check(Session& session, Vec<Diagnostic> const& diagnostics)
+{
+	std::cout << "pieces " << session.piece_count() << std::endl;
+	for( auto const& diagnostic : diagnostics )
+		std::cout << "diagnostic " << diagnostic.offset << " " << diagnostic.message << std::endl;
+}
+
+static void
+print_dirty(Session& session)
+{
+	std::cout << "dirty";
+	for( unsigned int i = 0; i < session.piece_count(); i++ )
+	{
+		if( session.dirty(i) )
+			std::cout << " " << i;
+	}
+	std::cout << std::endl;
+}
+
+static int
+replay(String text)
+{
+	Session session{text};
+	print_dirty(session);
+	print_check(session, session.check());
+
+	unsigned int offset;
+	unsigned int removed;
+	unsigned int size;
+	while( std::cin >> offset >> removed >> size )
+	{
+		std::cin.get();
+		String inserted(size, '\0');
+		std::cin.read(inserted.data(), size);
+		if( !std::cin || offset + removed > text.size() )
+		{
+			std::cout << "Bad edit at " << offset << std::endl;
+			return -1;
+		}
+
+		auto reparse = session.edit(offset, removed, inserted);
+		text.replace(offset, removed, inserted);
+		std::cout << "reparse " << reparse.first << " " << reparse.removed << " "
+				  << reparse.added << std::endl;
+		print_dirty(session);
+
+		auto diagnostics = session.check();
+		print_check(session, diagnostics);
+		std::cout << (same_as_fresh(session, diagnostics, text) ? "fresh same" : "fresh differs")
+				  << std::endl;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Makes random edits of the kinds an editor does: typing, deleting, and pasting
+ * text from elsewhere in the file. An edit that breaks the text is undone after its
+ * check(). Broken text is compared only by its text, since where a broken region is split
+ * depends on the edits that led to it.
+ */
+static int
+fuzz(String text, unsigned int edits, unsigned int seed)
+{
+	static char const* const snippets[] = {
+		"x", "1", " ", "\n", ";", "+", "(", ")", "{", "}", "// note\n", "fn ", "i32",
+		"let y: i32 = 2;\n", "fn extra(): i32 {\n    return 4;\n}\n"};
+
+	std::mt19937 random{seed};
+	auto below = [&random](unsigned int n) {
+		return n == 0 ? 0 : std::uniform_int_distribution<unsigned int>{0, n - 1}(random);
+	};
+
+	Session session{text};
+	session.check();
+
+	unsigned int compared = 0;
+	unsigned int differ = 0;
+	for( unsigned int i = 0; i < edits; i++ )
+	{
+		unsigned int offset = below(text.size() + 1);
+		unsigned int removed = below(std::min<unsigned int>(text.size() - offset, 8) + 1);
+		String inserted;
+		switch( below(3) )
+		{
+		case 0:
+			inserted = snippets[below(sizeof(snippets) / sizeof(snippets[0]))];
+			break;
+		case 1:
+		{
+			unsigned int from = below(text.size() + 1);
+			inserted = text.substr(from, below(24));
+			break;
+		}
+		default:
+			break;
+		}
+
+		auto replaced = text.substr(offset, removed);
+		session.edit(offset, removed, inserted);
+		text.replace(offset, removed, inserted);
+		auto diagnostics = session.check();
+
+		bool same = session.text() == text;
+		bool broken = !parses(text);
+		if( same && !broken )
+		{
+			compared += 1;
+			same = same_as_fresh(session, diagnostics, text);
+		}
+
+		if( same && broken )
+		{
+			session.edit(offset, inserted.size(), replaced);
+			text.replace(offset, inserted.size(), replaced);
+			diagnostics = session.check();
+
+			compared += 1;
+			same = same_as_fresh(session, diagnostics, text);
+		}
+
+		if( !same )
+		{
+			differ += 1;
+			std::cout << "Edit " << i << " differs: " << offset << " " << removed << " '"
+					  << inserted << "'" << (broken ? " undone" : "") << std::endl;
+		}
+	}
+
+	std::cout << "fuzz " << edits << " edits, " << compared << " compared, " << differ
+			  << " differ" << std::endl;
+	return differ == 0 ? 0 : 1;
+}
+
+int
+main(int argc, char* argv[])
+{
+	unsigned int fuzz_edits = 0;
+	unsigned int seed = 1;
+	char const* filepath = nullptr;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		char const* arg = argv[i];
+		if( strncmp(arg, "--fuzz=", 7) == 0 )
+			fuzz_edits = atoi(arg + 7);
+		else if( strncmp(arg, "--seed=", 7) == 0 )
+			seed = atoi(arg + 7);
+		else if( arg[0] == '-' || filepath )
+		{
+			print_usage();
+			return -1;
+		}
+		else
+			filepath = arg;
+	}
+
+	if( !filepath )
+	{
+		print_usage();
+		return -1;
+	}
+
+	std::ifstream file{filepath};
+	if( !file.good() )
+	{
+		std::cout << "Could not open file " << filepath << std::endl;
+		return -1;
+	}
+
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+
+	if( fuzz_edits != 0 )
+		return fuzz(buffer.str(), fuzz_edits, seed);
+
+	return replay(buffer.str());
+}
@@ -3,18 +3,28 @@ const child = require("child_process");
 const fs = require("fs");
 
 const sushi = path.join(__dirname, "..", "build", "sushi");
+const sushiFormatter = path.join(__dirname, "..", "build", "sushi_format");
+const sushiSessionReplay = path.join(__dirname, "..", "build", "sushi_session");
 const cppHarnessFilepath = path.join(
   __dirname,
   "clang_harness",
   "clang_harness.cpp"
 );
+// Programs with async fns link against the executor.
+const asyncRuntimeFilepath = path.join(
+  __dirname,
+  "..",
+  "src",
+  "runtime",
+  "sushi_async.cpp"
+);
 
-async function sushiCompile({ filepath, cwd }) {
+async function sushiCompile({ filepath, cwd, args = [] }) {
   const absFilepath = path.resolve(filepath);
 
   return new Promise((resolve, reject) => {
     child.exec(
-      `${sushi} ${absFilepath}`,
+      `${sushi} ${args.join(" ")} ${absFilepath}`,
       {
         cwd: cwd,
       },
@@ -32,8 +42,99 @@ async function sushiCompile({ filepath, cwd }) {
   });
 }
 
-async function clangCompile({ objectFiles, cwd }) {
-  const cmd = `clang++ ${cppHarnessFilepath} ${objectFiles.join(" ")} -o test`;
+async function sushiThinLTOLink({ inputs, cwd, args = [] }) {
+  const absInputs = inputs.map((input) => path.resolve(cwd, input));
+
+  return new Promise((resolve, reject) => {
+    child.exec(
+      `${sushi} --thinlto-link ${args.join(" ")} ${absInputs.join(" ")}`,
+      {
+        cwd: cwd,
+      },
+      (err, stdout, stderr) => {
+        if (err) {
+          console.log(stdout, err, stderr);
+          reject(new Error("Sushi link rejected.\n" + stdout));
+          return;
+        }
+
+        // Prints the objects it wrote, one per line.
+        resolve(stdout.split("\n").filter((line) => line.length > 0));
+      }
+    );
+  });
+}
+
+// Resolves with the exit code and stdout, since --check exits with 1 by design.
+async function sushiFormat({ filepaths, cwd, args = [] }) {
+  const absFilepaths = filepaths.map((filepath) => path.resolve(filepath));
+
+  return new Promise((resolve) => {
+    child.exec(
+      `${sushiFormatter} ${args.join(" ")} ${absFilepaths.join(" ")}`,
+      {
+        cwd: cwd,
+      },
+      (err, stdout, stderr) => {
+        resolve({ status: err ? err.code : 0, stdout: stdout });
+      }
+    );
+  });
+}
+
+// Replays the edits on a session of the file. Resolves with the exit code and stdout.
+async function sushiSession({ filepath, cwd, edits = [], args = [] }) {
+  const absFilepath = path.resolve(filepath);
+  const input = edits
+    .map(
+      ({ offset, removed, inserted }) =>
+        `${offset} ${removed} ${Buffer.byteLength(inserted)}\n${inserted}`
+    )
+    .join("");
+
+  return new Promise((resolve) => {
+    const proc = child.exec(
+      `${sushiSessionReplay} ${args.join(" ")} ${absFilepath}`,
+      {
+        cwd: cwd,
+      },
+      (err, stdout, stderr) => {
+        if (err) {
+          console.log(stdout, err, stderr);
+        }
+
+        resolve({ status: err ? err.code : 0, stdout: stdout });
+      }
+    );
+    proc.stdin.end(input);
+  });
+}
+
+// Starts a compile server. Resolves with its process once it listens on the socket.
+async function sushiServe({ socketPath, cwd, args = [] }) {
+  return new Promise((resolve, reject) => {
+    const proc = child.spawn(sushi, [`--serve=${socketPath}`, ...args], {
+      cwd: cwd,
+      stdio: ["ignore", "pipe", "inherit"],
+    });
+
+    let stdout = "";
+    proc.stdout.on("data", (data) => {
+      stdout += data;
+      if (stdout.includes("Listening on")) {
+        resolve(proc);
+      }
+    });
+    proc.on("exit", () => {
+      reject(new Error("Sushi server exited.\n" + stdout));
+    });
+  });
+}
+
+async function clangCompile({ objectFiles, cwd, args = [] }) {
+  const cmd = `clang++ ${args.join(" ")} ${cppHarnessFilepath} ${objectFiles.join(
+    " "
+  )} -o test`;
 
   return new Promise((resolve, reject) => {
     child.exec(
@@ -63,7 +164,7 @@ async function run({ binary, cwd }) {
       },
       (err, stdout, stderr) => {
         if (err) {
-          reject();
+          reject(new Error(`'${binary}' failed.\n` + stderr));
           return;
         }
 
@@ -73,12 +174,12 @@ async function run({ binary, cwd }) {
   });
 }
 
-async function compileAndRun({ filepath, cwd }) {
+async function compileAndRun({ filepath, cwd, objectFiles = [], args = [] }) {
   const delFolder = createTestFolder({ cwd: cwd });
   try {
-    await sushiCompile({ filepath: filepath, cwd: cwd });
+    await sushiCompile({ filepath: filepath, cwd: cwd, args: args });
 
-    await clangCompile({ objectFiles: ["output.o"], cwd: cwd });
+    await clangCompile({ objectFiles: ["output.o", ...objectFiles], cwd: cwd });
 
     const result = await run({ binary: "test", cwd: cwd });
 
@@ -101,5 +202,15 @@ function createTestFolder({ cwd }) {
 }
 
 module.exports = {
+  sushi,
+  asyncRuntimeFilepath,
   compileAndRun,
+  sushiCompile,
+  sushiThinLTOLink,
+  sushiFormat,
+  sushiSession,
+  sushiServe,
+  clangCompile,
+  run,
+  createTestFolder,
 };
@@ -0,0 +1,80 @@
+const {
+  asyncRuntimeFilepath,
+  compileAndRun,
+  sushiCompile,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("Async", () => {
+  test("Await futures on the executor", async () => {
+    const filename = "executor.async.sushi.test";
+    const testFile = path.join(__dirname, "executor.async.sushi");
+
+    const result = await compileAndRun({
+      filepath: testFile,
+      cwd: path.join(cwd, filename),
+      objectFiles: [asyncRuntimeFilepath],
+    });
+
+    expect(result).toBe("135");
+  });
+
+  test("By-value params and results with an i64 after an i32", async () => {
+    const filename = "wide.async.sushi.test";
+    const testFile = path.join(__dirname, "wide.async.sushi");
+
+    const result = await compileAndRun({
+      filepath: testFile,
+      cwd: path.join(cwd, filename),
+      objectFiles: [asyncRuntimeFilepath],
+    });
+
+    expect(result).toBe("105");
+  });
+
+  test("Unawaited futures are destroyed", async () => {
+    const filename = "drop.async.sushi.test";
+    const testFile = path.join(__dirname, "drop.async.sushi");
+
+    const result = await compileAndRun({
+      filepath: testFile,
+      cwd: path.join(cwd, filename),
+      objectFiles: [asyncRuntimeFilepath, path.join(__dirname, "frames.cpp")],
+    });
+
+    // 16 from the awaited future, and no frame left alive.
+    expect(result).toBe("160");
+  });
+
+  test("Awaiting a consumed future aborts", async () => {
+    const filename = "twice.async.sushi.test";
+    const testFile = path.join(__dirname, "twice.async.sushi");
+
+    await expect(
+      compileAndRun({
+        filepath: testFile,
+        cwd: path.join(cwd, filename),
+        objectFiles: [asyncRuntimeFilepath],
+      })
+    ).rejects.toThrow("awaited a future that was already consumed");
+  });
+
+  test("Futures cannot be copied", async () => {
+    const filename = "copy.async.sushi.test";
+    const testFile = path.join(__dirname, "copy.async.sushi");
+    const testCwd = path.join(cwd, filename);
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      await expect(
+        sushiCompile({ filepath: testFile, cwd: testCwd })
+      ).rejects.toThrow("A future can only be awaited");
+    } finally {
+      delFolder();
+    }
+  });
+});
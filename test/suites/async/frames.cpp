@@ -0,0 +1,36 @@
+#include "../../../src/runtime/sushi_async.h"
+
+#include <cstdlib>
+
+// Counts the coroutine frames that are alive, to check that futures are destroyed.
+
+namespace
+{
+int live = 0;
+
+void*
+count_alloc(std::uint64_t size)
+{
+	live++;
+	return std::malloc(size);
+}
+
+void
+count_free(void* frame)
+{
+	live--;
+	std::free(frame);
+}
+} // namespace
+
+extern "C" void
+track_frames()
+{
+	sushi_set_coro_allocator(count_alloc, count_free);
+}
+
+extern "C" int
+live_frames()
+{
+	return live;
+}
@@ -0,0 +1,55 @@
+const {
+  sushiCompile,
+  clangCompile,
+  run,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("Attributes", () => {
+  test("Fn and param attributes", async () => {
+    const testCwd = path.join(cwd, "fnparam.attributes.sushi.test");
+    const testFile = path.join(__dirname, "fnparam.attributes.sushi");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const ir = await sushiCompile({ filepath: testFile, cwd: testCwd });
+      await clangCompile({ objectFiles: ["output.o"], cwd: testCwd });
+      const result = await run({ binary: "test", cwd: testCwd });
+
+      expect(ir).toMatch(
+        /define i32 @sum\(i32\* noalias readonly %0, i32\* noalias nocapture %1\) #(\d+)/
+      );
+      const sumAttrs = ir.match(/define i32 @sum\(.*\) #(\d+)/)[1];
+      const testAttrs = ir.match(/define i32 @test_sushi\(\) #(\d+)/)[1];
+      expect(ir).toMatch(
+        new RegExp(`attributes #${sumAttrs} = \\{ alwaysinline hot \\}`)
+      );
+      expect(ir).toMatch(
+        new RegExp(`attributes #${testAttrs} = \\{ cold noinline \\}`)
+      );
+      expect(result).toBe("7");
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("Param attributes only apply to pointers", async () => {
+    const testCwd = path.join(cwd, "nonpointer.attributes.sushi.test");
+    const testFile = path.join(__dirname, "nonpointer.attributes.sushi");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      await expect(
+        sushiCompile({ filepath: testFile, cwd: testCwd })
+      ).rejects.toThrow(
+        "Parameter attributes can only be applied to pointer parameters."
+      );
+    } finally {
+      delFolder();
+    }
+  });
+});
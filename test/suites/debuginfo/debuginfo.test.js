@@ -0,0 +1,40 @@
+const {
+  sushiCompile,
+  clangCompile,
+  run,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("Debug info", () => {
+  test("Struct layout matches the target", async () => {
+    const testFile = path.join(__dirname, "layout.debuginfo.sushi");
+    const testCwd = path.join(cwd, "layout.debuginfo.sushi.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const ir = await sushiCompile({
+        filepath: testFile,
+        cwd: testCwd,
+        args: ["-g"],
+      });
+      await clangCompile({ objectFiles: ["output.o"], cwd: testCwd });
+      const result = await run({ binary: "test", cwd: testCwd });
+
+      // The i64 is aligned to 8 on the target, not 4 as in LLVM's default layout.
+      expect(ir).toMatch(
+        /DW_TAG_structure_type, name: "Sample".*size: 128, align: 64/
+      );
+      expect(ir).toMatch(
+        /DW_TAG_member, name: "total".*size: 64, align: 64, offset: 64/
+      );
+      expect(ir).toMatch(/!DILocation\(line: 7,/);
+      expect(result).toBe("9");
+    } finally {
+      delFolder();
+    }
+  });
+});
@@ -0,0 +1,62 @@
+const {
+  compileAndRun,
+  sushiCompile,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("Driver", () => {
+  const testFile = path.join(__dirname, "options.driver.sushi");
+
+  test("--jobs takes a thread count", async () => {
+    const result = await compileAndRun({
+      filepath: testFile,
+      cwd: path.join(cwd, "options.driver.sushi.test"),
+      args: ["--jobs=2"],
+    });
+
+    expect(result).toBe("3");
+  });
+
+  test("--jobs rejects what is not a thread count", async () => {
+    const testCwd = path.join(cwd, "options.driver.sushi.bad-jobs.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      for (const arg of ["--jobs=x", "--jobs=", "--jobs=-1", "--jobs=4096"]) {
+        await expect(
+          sushiCompile({ filepath: testFile, cwd: testCwd, args: [arg] })
+        ).rejects.toThrow("Expected a thread count");
+      }
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("--target sets the target triple", async () => {
+    const testCwd = path.join(cwd, "options.driver.sushi.target.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const ir = await sushiCompile({
+        filepath: testFile,
+        cwd: testCwd,
+        args: ["--target=aarch64-unknown-linux-gnu"],
+      });
+      expect(ir).toMatch('target triple = "aarch64-unknown-linux-gnu"');
+
+      await expect(
+        sushiCompile({
+          filepath: testFile,
+          cwd: testCwd,
+          args: ["--target=nonsense-unknown-nowhere"],
+        })
+      ).rejects.toThrow("nonsense-unknown-nowhere");
+    } finally {
+      delFolder();
+    }
+  });
+});
@@ -0,0 +1,19 @@
+const { compileAndRun } = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("Fn pointers", () => {
+  test("Calls through fn pointers", async () => {
+    const testdir = "calls.fn-pointer.sushi.test";
+    const testFile = path.join(__dirname, "calls.fn-pointer.sushi");
+
+    const result = await compileAndRun({
+      filepath: testFile,
+      cwd: path.join(cwd, testdir),
+    });
+
+    expect(result).toBe("10");
+  });
+});
@@ -0,0 +1,123 @@
+const { sushiFormat, createTestFolder } = require("../../compile-and-run");
+
+const path = require("path");
+const fs = require("fs");
+
+const cwd = __dirname;
+const suites = path.join(__dirname, "..");
+
+const unformatted = path.join(__dirname, "comments.format.sushi");
+const formatted = [
+  "// Adds one.",
+  "fn add_one(a: i32): i32 {",
+  "    // The result.",
+  "    let b: i32 = a + 1; // trailing",
+  "    return b;",
+  "}",
+  "",
+  "fn test_sushi(): i32 { // after the brace",
+  "    return add_one(4); // also trailing",
+  "}",
+  "",
+].join("\n");
+
+// Every fixture of the other suites.
+function fixtures() {
+  return fs
+    .readdirSync(suites)
+    .filter((suite) => suite !== "format")
+    .flatMap((suite) =>
+      fs
+        .readdirSync(path.join(suites, suite))
+        .filter((file) => file.endsWith(".sushi"))
+        .map((file) => path.join(suites, suite, file))
+    );
+}
+
+describe("Format", () => {
+  test("Formatting the fixtures is idempotent", async () => {
+    const testCwd = path.join(cwd, "idempotent.format.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const files = fixtures();
+      expect(files.length).toBeGreaterThan(0);
+
+      for (const file of files) {
+        const once = await sushiFormat({ filepaths: [file], cwd: testCwd });
+        expect(once.status).toBe(0);
+
+        const copy = path.join(testCwd, path.basename(file));
+        fs.writeFileSync(copy, once.stdout);
+        const twice = await sushiFormat({ filepaths: [copy], cwd: testCwd });
+        expect(twice.stdout).toBe(once.stdout);
+      }
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("Leading and trailing comments stay in place", async () => {
+    const result = await sushiFormat({ filepaths: [unformatted], cwd: cwd });
+
+    expect(result.status).toBe(0);
+    expect(result.stdout).toBe(formatted);
+  });
+
+  test("--lines only formats the items it overlaps", async () => {
+    const original = fs.readFileSync(unformatted, "utf8").split("\n");
+    const expected = formatted.split("\n");
+
+    // Line 3 is in add_one, so test_sushi keeps its extra spaces.
+    const first = await sushiFormat({
+      filepaths: [unformatted],
+      cwd: cwd,
+      args: ["--lines=3:3"],
+    });
+    expect(first.stdout).toBe(
+      [...expected.slice(0, 6), ...original.slice(6)].join("\n")
+    );
+
+    // Lines 8 to 9 are in test_sushi, so add_one is left as it is.
+    const second = await sushiFormat({
+      filepaths: [unformatted],
+      cwd: cwd,
+      args: ["--lines=8:9"],
+    });
+    expect(second.stdout).toBe(
+      [...original.slice(0, 6), ...expected.slice(6)].join("\n")
+    );
+  });
+
+  test("--check exits with 1 only if a file is not formatted", async () => {
+    const testCwd = path.join(cwd, "check.format.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const clean = path.join(testCwd, "clean.sushi");
+      fs.writeFileSync(clean, formatted);
+
+      const passed = await sushiFormat({
+        filepaths: [clean],
+        cwd: testCwd,
+        args: ["--check"],
+      });
+      expect(passed.status).toBe(0);
+      expect(passed.stdout).toBe("");
+
+      const failed = await sushiFormat({
+        filepaths: [clean, unformatted],
+        cwd: testCwd,
+        args: ["--check"],
+      });
+      expect(failed.status).toBe(1);
+      expect(failed.stdout).toContain("comments.format.sushi is not formatted.");
+      expect(failed.stdout).not.toContain("clean.sushi");
+
+      // The file is left as it is.
+      expect(fs.readFileSync(clean, "utf8")).toBe(formatted);
+    } finally {
+      delFolder();
+    }
+  });
+});
@@ -0,0 +1,19 @@
+const { compileAndRun } = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("Generics", () => {
+  test("Generic fns and structs", async () => {
+    const filename = "monomorphize.generics.sushi.test";
+    const testFile = path.join(__dirname, "monomorphize.generics.sushi");
+
+    const result = await compileAndRun({
+      filepath: testFile,
+      cwd: path.join(cwd, filename),
+    });
+
+    expect(result).toBe("47");
+  });
+});
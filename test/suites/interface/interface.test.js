@@ -0,0 +1,122 @@
+const {
+  sushiCompile,
+  clangCompile,
+  run,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+const fs = require("fs");
+
+const cwd = __dirname;
+
+// The header fields read here, see ModuleInterface.cpp.
+const membersOffsetAt = 28;
+const checksumAt = 48;
+const headerSize = 56;
+const memberIdxAt = 20;
+
+// FNV-1a, 64 bit, of the bytes after the header.
+function checksum(file) {
+  let hash = 14695981039346656037n;
+  for (const byte of file.subarray(headerSize)) {
+    hash ^= BigInt(byte);
+    hash = (hash * 1099511628211n) & 0xffffffffffffffffn;
+  }
+  return hash;
+}
+
+async function writeShapesInterface(shapesCwd) {
+  createTestFolder({ cwd: shapesCwd });
+  await sushiCompile({
+    filepath: path.join(__dirname, "shapes.interface.sushi"),
+    cwd: shapesCwd,
+    args: ["--emit-interface=shapes.smi"],
+  });
+  return path.join(shapesCwd, "shapes.smi");
+}
+
+describe("Module interface", () => {
+  test("Uses the types and fns of a module through its interface", async () => {
+    const testCwd = path.join(cwd, "interface.test");
+    const shapesCwd = path.join(testCwd, "shapes");
+    const mainCwd = path.join(testCwd, "main");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      createTestFolder({ cwd: shapesCwd });
+      await sushiCompile({
+        filepath: path.join(__dirname, "shapes.interface.sushi"),
+        cwd: shapesCwd,
+        args: ["--emit-interface=shapes.smi"],
+      });
+
+      // main declares nothing but test_sushi, so Shape, Point, area and manhattan
+      // must come from the interface.
+      createTestFolder({ cwd: mainCwd });
+      const output = await sushiCompile({
+        filepath: path.join(__dirname, "main.interface.sushi"),
+        cwd: mainCwd,
+        args: ["--interface=../shapes/shapes.smi"],
+      });
+      expect(output).toContain("declare i32 @area");
+
+      await clangCompile({
+        objectFiles: ["main/output.o", "shapes/output.o"],
+        cwd: testCwd,
+      });
+      const result = await run({ binary: "test", cwd: testCwd });
+
+      expect(result).toBe("26");
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("Rejects an interface whose checksum does not match", async () => {
+    const testCwd = path.join(cwd, "interface.checksum.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const smi = await writeShapesInterface(path.join(testCwd, "shapes"));
+      const file = fs.readFileSync(smi);
+      file[file.length - 1] ^= 0xff;
+      fs.writeFileSync(smi, file);
+
+      await expect(
+        sushiCompile({
+          filepath: path.join(__dirname, "main.interface.sushi"),
+          cwd: testCwd,
+          args: ["--interface=shapes/shapes.smi"],
+        })
+      ).rejects.toThrow("is damaged");
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("Rejects an interface with a field index out of range", async () => {
+    const testCwd = path.join(cwd, "interface.idx.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const smi = await writeShapesInterface(path.join(testCwd, "shapes"));
+      const file = fs.readFileSync(smi);
+      const membersOffset = file.readUInt32LE(membersOffsetAt);
+      file.writeUInt32LE(0xffff, membersOffset + memberIdxAt);
+      // Still matches, so only the checks of the entries can reject it.
+      file.writeBigUInt64LE(checksum(file), checksumAt);
+      fs.writeFileSync(smi, file);
+
+      await expect(
+        sushiCompile({
+          filepath: path.join(__dirname, "main.interface.sushi"),
+          cwd: testCwd,
+          args: ["--interface=shapes/shapes.smi"],
+        })
+      ).rejects.toThrow("is damaged");
+    } finally {
+      delFolder();
+    }
+  });
+});
@@ -0,0 +1,19 @@
+const { compileAndRun } = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("Layout", () => {
+  test("Unions and enums of structs with an i64 after an i32", async () => {
+    const filename = "wide.layout.sushi.test";
+    const testFile = path.join(__dirname, "wide.layout.sushi");
+
+    const result = await compileAndRun({
+      filepath: testFile,
+      cwd: path.join(cwd, filename),
+    });
+
+    expect(result).toBe("11");
+  });
+});
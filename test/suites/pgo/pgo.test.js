@@ -0,0 +1,86 @@
+const {
+  sushiCompile,
+  clangCompile,
+  run,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+const child = require("child_process");
+
+const cwd = __dirname;
+
+async function mergeProfile({ cwd, profile }) {
+  return new Promise((resolve, reject) => {
+    child.exec(
+      `llvm-profdata merge -o default.profdata ${profile}`,
+      { cwd: cwd },
+      (err, stdout, stderr) => {
+        if (err) {
+          console.log(err, stderr);
+          reject(new Error("Failed to merge profile"));
+          return;
+        }
+
+        resolve(stdout);
+      }
+    );
+  });
+}
+
+// The text of the fn's definition in the IR, from 'define' to its closing brace.
+function definitionOf(ir, name) {
+  const start = ir.search(new RegExp(`^define [^\\n]*@${name}\\(`, "m"));
+  if (start < 0) {
+    return "";
+  }
+
+  return ir.slice(start, ir.indexOf("\n}\n", start));
+}
+
+// The speedup is measured by bench/pgo_bench.sh, not here, since run times are noisy.
+describe("PGO", () => {
+  test("Switch dispatch with profile-use", async () => {
+    const filename = "dispatch.pgo.sushi.test";
+    const testFile = path.join(__dirname, "dispatch.pgo.sushi");
+    const testCwd = path.join(cwd, filename);
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      // Instrumented build writes dispatch.profraw when run.
+      await sushiCompile({
+        filepath: testFile,
+        cwd: testCwd,
+        args: ["-O2", "-fprofile-generate=dispatch.profraw"],
+      });
+      await clangCompile({
+        objectFiles: ["output.o"],
+        cwd: testCwd,
+        args: ["-fprofile-generate"],
+      });
+      const instrumented = await run({ binary: "test", cwd: testCwd });
+      await mergeProfile({ cwd: testCwd, profile: "dispatch.profraw" });
+
+      const ir = await sushiCompile({
+        filepath: testFile,
+        cwd: testCwd,
+        args: ["-O2", "-fprofile-use=default.profdata"],
+      });
+      await clangCompile({ objectFiles: ["output.o"], cwd: testCwd });
+      const optimized = await run({ binary: "test", cwd: testCwd });
+
+      // The loop of test_sushi is the hot code. The profile gives the fn its entry
+      // count and the branches in the loop their weights.
+      const hot = definitionOf(ir, "test_sushi");
+      expect(hot).toMatch(/^define [^\n]*!prof ![0-9]+ \{/);
+      expect(hot).toMatch(/(br|switch) [^\n]*!prof ![0-9]+/);
+      expect(ir).toMatch(/!\{!"function_entry_count", i64 1\}/);
+      expect(ir).toMatch(/!\{!"branch_weights"/);
+
+      expect(instrumented).toBe("12272");
+      expect(optimized).toBe("12272");
+    } finally {
+      delFolder();
+    }
+  });
+});
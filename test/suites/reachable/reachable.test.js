@@ -0,0 +1,75 @@
+const {
+  sushiCompile,
+  clangCompile,
+  run,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("Reachable", () => {
+  test("Only fns reachable from the roots are checked and emitted", async () => {
+    const filename = "helpers.reachable.sushi.test";
+    const testFile = path.join(__dirname, "helpers.reachable.sushi");
+    const testCwd = path.join(cwd, filename);
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      // unused_broken does not type check, so this fails unless it is skipped.
+      const output = await sushiCompile({
+        filepath: testFile,
+        cwd: testCwd,
+        args: ["-fonly-reachable", "--root=test_sushi"],
+      });
+      expect(output).not.toContain("@unused_helper");
+      expect(output).toContain("@later");
+
+      await clangCompile({ objectFiles: ["output.o"], cwd: testCwd });
+      const result = await run({ binary: "test", cwd: testCwd });
+
+      expect(result).toBe("41");
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("A root that names no fn is an error", async () => {
+    const filename = "helpers.reachable.sushi.root.test";
+    const testFile = path.join(__dirname, "helpers.reachable.sushi");
+    const testCwd = path.join(cwd, filename);
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      await expect(
+        sushiCompile({
+          filepath: testFile,
+          cwd: testCwd,
+          args: ["-fonly-reachable", "--root=test_sushi", "--root=test_suhsi"],
+        })
+      ).rejects.toThrow("Root 'test_suhsi' is not a declared fn.");
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("-fonly-reachable without main or --root is an error", async () => {
+    const filename = "helpers.reachable.sushi.no-root.test";
+    const testFile = path.join(__dirname, "helpers.reachable.sushi");
+    const testCwd = path.join(cwd, filename);
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      await expect(
+        sushiCompile({
+          filepath: testFile,
+          cwd: testCwd,
+          args: ["-fonly-reachable"],
+        })
+      ).rejects.toThrow("-fonly-reachable needs a root.");
+    } finally {
+      delFolder();
+    }
+  });
+});
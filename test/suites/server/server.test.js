@@ -0,0 +1,157 @@
+const {
+  sushi,
+  compileAndRun,
+  sushiCompile,
+  sushiServe,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+const fs = require("fs");
+const child = require("child_process");
+const net = require("net");
+
+const cwd = __dirname;
+const testFile = path.join(__dirname, "request.server.sushi");
+
+/**
+ * Runs the test with a server listening on a socket in 'testCwd'.
+ */
+async function withServer(testCwd, args, test) {
+  const delFolder = createTestFolder({ cwd: testCwd });
+  const socketPath = path.join(testCwd, "sushi.sock");
+  const server = await sushiServe({ socketPath, cwd: testCwd, args });
+  const exited = new Promise((resolve) => server.on("exit", resolve));
+  try {
+    await test(socketPath);
+  } finally {
+    server.kill("SIGTERM");
+    await exited;
+    delFolder();
+  }
+}
+
+describe("Compile server", () => {
+  test("Compiles for clients of --server", async () => {
+    const testCwd = path.join(cwd, "server.test");
+    await withServer(testCwd, [], async (socketPath) => {
+      const result = await compileAndRun({
+        filepath: testFile,
+        cwd: path.join(testCwd, "client"),
+        args: [`--server=${socketPath}`],
+      });
+
+      expect(result).toBe("12");
+    });
+  });
+
+  test("Reports errors to the client and keeps serving", async () => {
+    const testCwd = path.join(cwd, "server.errors.test");
+    await withServer(testCwd, [], async (socketPath) => {
+      const rangeFile = path.join(testCwd, "range.sushi");
+      fs.writeFileSync(rangeFile, "fn test_sushi(): i32 {\n\treturn 99999999999;\n}\n");
+      await expect(
+        sushiCompile({
+          filepath: rangeFile,
+          cwd: testCwd,
+          args: [`--server=${socketPath}`],
+        })
+      ).rejects.toThrow("Integer literal is out of range");
+
+      const result = await compileAndRun({
+        filepath: testFile,
+        cwd: path.join(testCwd, "client"),
+        args: [`--server=${socketPath}`],
+      });
+
+      expect(result).toBe("12");
+    });
+  });
+
+  test("Compiles of different clients run at the same time", async () => {
+    const testCwd = path.join(cwd, "server.parallel.test");
+    await withServer(testCwd, ["--serve-jobs=2"], async (socketPath) => {
+      // The first client's compile echoes more than a pipe holds, into a pipe that is
+      // not read until the second client is done. A server that compiles one client at
+      // a time never gets to the second.
+      let source = "";
+      for (let i = 0; i < 3000; i++) {
+        source += `fn f${i}(a: i32): i32 {\n\treturn a + ${i};\n}\n\n`;
+      }
+      source += "fn test_sushi(): i32 {\n\treturn f2(1);\n}\n";
+      fs.writeFileSync(path.join(testCwd, "large.sushi"), source);
+
+      const goFile = path.join(testCwd, "go");
+      const blocked = child.spawn(
+        "sh",
+        [
+          "-c",
+          `${sushi} --server=${socketPath} large.sushi | ` +
+            `(while [ ! -e ${goFile} ]; do sleep 0.05; done; cat > /dev/null)`,
+        ],
+        { cwd: testCwd, stdio: "inherit" }
+      );
+      const blockedExit = new Promise((resolve) => blocked.on("exit", resolve));
+
+      try {
+        const result = await compileAndRun({
+          filepath: testFile,
+          cwd: path.join(testCwd, "client"),
+          args: [`--server=${socketPath}`],
+        });
+
+        expect(result).toBe("12");
+      } finally {
+        fs.writeFileSync(goFile, "");
+      }
+
+      expect(await blockedExit).toBe(0);
+    });
+  });
+
+  test("A client that sends nothing does not hold up the others", async () => {
+    const testCwd = path.join(cwd, "server.silent.test");
+    await withServer(testCwd, [], async (socketPath) => {
+      const silent = net.connect(socketPath);
+      await new Promise((resolve) => silent.on("connect", resolve));
+      try {
+        // Within the test timeout, well before the server drops the silent client.
+        const result = await compileAndRun({
+          filepath: testFile,
+          cwd: path.join(testCwd, "client"),
+          args: [`--server=${socketPath}`],
+        });
+
+        expect(result).toBe("12");
+      } finally {
+        silent.destroy();
+      }
+    });
+  });
+
+  test("Compiles locally if no server is listening", async () => {
+    const result = await compileAndRun({
+      filepath: testFile,
+      cwd: path.join(cwd, "server.local.test"),
+      args: [`--server=${path.join(cwd, "missing.sock")}`],
+    });
+
+    expect(result).toBe("12");
+  });
+
+  test("--serve-jobs rejects what is not a thread count", async () => {
+    const testCwd = path.join(cwd, "server.bad-jobs.test");
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      await expect(
+        sushiServe({
+          socketPath: path.join(testCwd, "sushi.sock"),
+          cwd: testCwd,
+          args: ["--serve-jobs=x"],
+        })
+      ).rejects.toThrow("Expected a thread count");
+    } finally {
+      delFolder();
+    }
+  });
+});
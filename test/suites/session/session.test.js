@@ -0,0 +1,164 @@
+const { sushiSession } = require("../../compile-and-run");
+
+const path = require("path");
+const fs = require("fs");
+
+const cwd = __dirname;
+const testFile = path.join(__dirname, "edits.session.sushi");
+const text = fs.readFileSync(testFile, "utf8");
+
+// Pieces of the fixture: Point, sum, twice, test_sushi.
+
+/**
+ * The state after opening the file, then after each edit.
+ */
+function parseSteps(stdout) {
+  const steps = [];
+  let step = null;
+  for (const line of stdout.split("\n")) {
+    const [word, ...rest] = line.split(" ");
+    if (word === "reparse" || steps.length === 0) {
+      step = { diagnostics: [], fresh: null };
+      steps.push(step);
+    }
+
+    if (word === "reparse") {
+      const [first, removed, added] = rest.map(Number);
+      step.reparse = { first, removed, added };
+    } else if (word === "dirty") {
+      step.dirty = rest.map(Number);
+    } else if (word === "pieces") {
+      step.pieces = Number(rest[0]);
+    } else if (word === "diagnostic") {
+      step.diagnostics.push({
+        offset: Number(rest[0]),
+        message: rest.slice(1).join(" "),
+      });
+    } else if (word === "fresh") {
+      step.fresh = rest[0];
+    }
+  }
+
+  return steps;
+}
+
+async function replay(edits) {
+  const result = await sushiSession({ filepath: testFile, cwd: cwd, edits });
+  expect(result.status).toBe(0);
+  return parseSteps(result.stdout);
+}
+
+describe("Session", () => {
+  test("Opening checks every piece", async () => {
+    const [open] = await replay([]);
+
+    expect(open.pieces).toBe(4);
+    expect(open.dirty).toEqual([0, 1, 2, 3]);
+    expect(open.diagnostics).toEqual([]);
+  });
+
+  test("A body edit only dirties its fn", async () => {
+    const offset = text.indexOf("return a + a;") + "return a + a".length;
+    const [, edited] = await replay([{ offset, removed: 0, inserted: " + 1" }]);
+
+    expect(edited.reparse).toEqual({ first: 2, removed: 1, added: 1 });
+    expect(edited.dirty).toEqual([2]);
+    expect(edited.diagnostics).toEqual([]);
+    expect(edited.fresh).toBe("same");
+  });
+
+  test("A struct change dirties the pieces that name it", async () => {
+    const offset = text.indexOf("y: i32;") + "y: ".length;
+    const [, edited] = await replay([{ offset, removed: 3, inserted: "i64" }]);
+
+    expect(edited.reparse).toEqual({ first: 0, removed: 1, added: 1 });
+    expect(edited.dirty).toEqual([0, 1, 3]);
+    expect(edited.fresh).toBe("same");
+  });
+
+  test("A prototype change dirties its callers", async () => {
+    const offset = text.indexOf("(a: i32): i32") + "(a: i32)".length;
+    const [, edited] = await replay([
+      { offset, removed: ": i32".length, inserted: ": i64" },
+    ]);
+
+    expect(edited.dirty).toEqual([2, 3]);
+    expect(edited.diagnostics.map((d) => d.message)).toEqual([
+      "Incorrect return type.",
+      "Incorrect return type.",
+    ]);
+    expect(edited.fresh).toBe("same");
+  });
+
+  test("A broken item does not take its neighbours with it", async () => {
+    const offset = text.indexOf("return a + a;\n}") + "return a + a;\n".length;
+    const [, broken, fixed] = await replay([
+      { offset, removed: 1, inserted: "" },
+      { offset, removed: 0, inserted: "}" },
+    ]);
+
+    // twice is split from test_sushi at the line that starts the next fn, so it
+    // fails where test_sushi begins, and test_sushi still parses.
+    const testBegin = text.indexOf("fn test_sushi") - 1;
+    expect(broken.reparse.first).toBe(2);
+    expect(broken.diagnostics).toEqual([
+      { offset: testBegin, message: "Expected ';'" },
+      { offset: testBegin, message: "Unrecognized variable 'twice'" },
+    ]);
+    expect(broken.dirty).not.toContain(0);
+    expect(broken.dirty).not.toContain(1);
+    expect(broken.fresh).toBe("same");
+
+    expect(fixed.diagnostics).toEqual([]);
+    expect(fixed.fresh).toBe("same");
+  });
+
+  test("Edits that move item boundaries", async () => {
+    const offset = text.indexOf("return a + a;") + "return a + a;\n".length;
+    const inserted = "}\n\nfn half(a: i32): i32 {\n\treturn a;\n";
+    const [, split, joined] = await replay([
+      { offset, removed: 0, inserted },
+      { offset, removed: inserted.length, inserted: "" },
+    ]);
+
+    expect(split.reparse).toEqual({ first: 2, removed: 1, added: 2 });
+    expect(split.pieces).toBe(5);
+    expect(split.fresh).toBe("same");
+
+    expect(joined.reparse).toEqual({ first: 2, removed: 2, added: 1 });
+    expect(joined.pieces).toBe(4);
+    expect(joined.dirty).toEqual([2]);
+    expect(joined.fresh).toBe("same");
+  });
+
+  test("Body edits past the reuse limit of the analysis", async () => {
+    // Each body edit adds a chunk and checks a body, so 400 pairs make the Sema2 again.
+    const offset = text.indexOf("return a + a;") + "return a + a".length;
+    const edits = [];
+    for (let i = 0; i < 400; i++) {
+      edits.push({ offset, removed: 0, inserted: " + 1" });
+      edits.push({ offset, removed: " + 1".length, inserted: "" });
+    }
+    const steps = await replay(edits);
+
+    expect(steps.length).toBe(edits.length + 1);
+    for (const step of steps.slice(1)) {
+      expect(step.dirty).toEqual([2]);
+      expect(step.diagnostics).toEqual([]);
+      expect(step.fresh).toBe("same");
+    }
+  });
+
+  test("Random edits match a fresh session", async () => {
+    for (const seed of [1, 2, 3]) {
+      const result = await sushiSession({
+        filepath: testFile,
+        cwd: cwd,
+        args: ["--fuzz=500", `--seed=${seed}`],
+      });
+
+      expect(result.stdout).toMatch(/fuzz 500 edits, 500 compared, 0 differ/);
+      expect(result.status).toBe(0);
+    }
+  });
+});
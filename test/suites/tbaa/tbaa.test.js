@@ -0,0 +1,57 @@
+const {
+  sushiCompile,
+  clangCompile,
+  run,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+
+const cwd = __dirname;
+
+describe("TBAA", () => {
+  const testFile = path.join(__dirname, "fields.tbaa.sushi");
+
+  test("Struct path tags with target offsets", async () => {
+    const testCwd = path.join(cwd, "fields.tbaa.sushi.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const ir = await sushiCompile({ filepath: testFile, cwd: testCwd });
+      await clangCompile({ objectFiles: ["output.o"], cwd: testCwd });
+      const result = await run({ binary: "test", cwd: testCwd });
+
+      // Members are laid out by name: balance, flags, id. The i64 keeps the
+      // i32s after it at 8 and 12.
+      expect(ir).toMatch(
+        /!\{!"Account", !\d+, i64 0, !\d+, i64 8, !\d+, i64 12\}/
+      );
+      expect(ir).toMatch(/!\{!"int64", !\d+, i64 0\}/);
+      expect(ir).toMatch(/load i32, i32\* %\d+, align 4, !tbaa/);
+      expect(result).toBe("6");
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("-fno-strict-aliasing attaches no TBAA", async () => {
+    const testCwd = path.join(cwd, "fields.tbaa.sushi.no-strict.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      const ir = await sushiCompile({
+        filepath: testFile,
+        cwd: testCwd,
+        args: ["-fno-strict-aliasing"],
+      });
+      await clangCompile({ objectFiles: ["output.o"], cwd: testCwd });
+      const result = await run({ binary: "test", cwd: testCwd });
+
+      expect(ir).not.toMatch(/!tbaa/);
+      expect(ir).not.toMatch(/Sushi TBAA/);
+      expect(result).toBe("6");
+    } finally {
+      delFolder();
+    }
+  });
+});
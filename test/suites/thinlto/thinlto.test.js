@@ -0,0 +1,100 @@
+const {
+  sushiCompile,
+  sushiThinLTOLink,
+  clangCompile,
+  run,
+  createTestFolder,
+} = require("../../compile-and-run");
+
+const path = require("path");
+const fs = require("fs");
+
+const cwd = __dirname;
+
+// The text of the fn's definition in the IR, from 'define' to its closing brace.
+function definitionOf(ir, name) {
+  const start = ir.search(new RegExp(`^define [^\\n]*@${name}\\(`, "m"));
+  if (start < 0) {
+    return "";
+  }
+
+  return ir.slice(start, ir.indexOf("\n}\n", start));
+}
+
+describe("ThinLTO", () => {
+  test("Imports and inlines across modules", async () => {
+    const testCwd = path.join(cwd, "thinlto.test");
+    const modules = ["math", "main"];
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      // Each module writes output.bc into its own folder.
+      for (const module of modules) {
+        const moduleCwd = path.join(testCwd, module);
+        createTestFolder({ cwd: moduleCwd });
+        await sushiCompile({
+          filepath: path.join(__dirname, `${module}.thinlto.sushi`),
+          cwd: moduleCwd,
+          args: ["-O2", "--emit=bc", "--thinlto"],
+        });
+      }
+
+      const objectFiles = await sushiThinLTOLink({
+        inputs: modules.map((module) => path.join(module, "output.bc")),
+        cwd: testCwd,
+        args: ["-O2", "--thinlto-jobs=2", "--save-temps"],
+      });
+
+      // The module of main imports square from math, and inlines it into test_sushi.
+      const task = objectFiles.find((objectFile) =>
+        definitionOf(
+          fs.readFileSync(
+            path.join(testCwd, objectFile.replace(/\.o$/, ".import.ll")),
+            "utf8"
+          ),
+          "test_sushi"
+        )
+      );
+      expect(task).toBeDefined();
+
+      const imported = fs.readFileSync(
+        path.join(testCwd, task.replace(/\.o$/, ".import.ll")),
+        "utf8"
+      );
+      expect(imported).toMatch(/^define available_externally [^\n]*@square\(/m);
+
+      const optimized = fs.readFileSync(
+        path.join(testCwd, task.replace(/\.o$/, ".precodegen.ll")),
+        "utf8"
+      );
+      const testSushi = definitionOf(optimized, "test_sushi");
+      expect(testSushi).not.toBe("");
+      expect(testSushi).not.toMatch(/call [^\n]*@square\(/);
+
+      await clangCompile({ objectFiles: objectFiles, cwd: testCwd });
+
+      const result = await run({ binary: "test", cwd: testCwd });
+
+      expect(result).toBe("55");
+    } finally {
+      delFolder();
+    }
+  });
+
+  test("--thinlto-jobs rejects what is not a thread count", async () => {
+    const testCwd = path.join(cwd, "thinlto.bad-jobs.test");
+
+    const delFolder = createTestFolder({ cwd: testCwd });
+    try {
+      await expect(
+        sushiThinLTOLink({
+          inputs: ["missing.bc"],
+          cwd: testCwd,
+          args: ["--thinlto-jobs=x"],
+        })
+      ).rejects.toThrow("Expected a thread count");
+    } finally {
+      delFolder();
+    }
+  });
+});